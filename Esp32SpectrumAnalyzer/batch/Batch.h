@@ -0,0 +1,64 @@
+#ifndef Batch_h
+#define Batch_h
+
+#include "Analyzer.h"
+#include "LevelQuantizer.h"
+#include "SimAudio.h"
+#include "SimConfig.h"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define POOL_CHUNK_FRAMES 16 //frames a worker takes at a time, so the locks of the pool cost little next to the FFTs
+
+//binary output (.bands): a BandsHeader, the band table (noOfBands unsigned shorts), then every frame in order: noOfBands floats (band levels,
+//as convertToBands gives them) or, with --rows, noOfBands bytes (rows lit on the LED matrix). Little endian, as written by the host.
+#define BANDS_MAGIC "SADB"
+#define BANDS_VERSION 1
+
+enum BandsKind{
+  BANDS_LEVELS, //float band levels
+  BANDS_ROWS //rows lit per band (uint8)
+};
+
+struct __attribute__((packed)) BandsHeader{
+  char magic[4]; //BANDS_MAGIC
+  uint8_t version; //BANDS_VERSION
+  uint8_t kind; //BandsKind
+  uint8_t noOfBands; //bands per frame
+  uint8_t noOfRows; //rows of the matrix (0 with BANDS_LEVELS)
+  uint32_t samplingFrequency; //sample rate the audio was analysed at (Hz)
+  uint16_t fftSize; //samples per frame
+  uint16_t hop; //samples from the start of a frame to the start of the next
+  uint32_t noOfFrames; //frames that follow
+};
+
+//work stealing pool over a run of frames. Each worker starts with an equal share of the chunks and takes them from the front of its range;
+//a worker that runs out splits off the back half of the range of another worker. Every frame is worked on once, by whichever worker gets to it,
+//so the results do not depend on the number of workers as long as a frame only writes its own output.
+class FramePool {
+  private:
+    struct Range{
+      std::mutex lock; //guards begin and end
+      uint32_t begin; //first chunk left
+      uint32_t end; //one past the last chunk left
+    };
+
+    uint8_t _noOfWorkers; //number of workers
+    Range* _ranges; //chunks each worker has left
+    std::atomic<uint32_t> _steals; //ranges split off from another worker in the last run
+    bool take(uint8_t worker, uint32_t* chunk); //takes the next chunk of the worker's own range
+    bool steal(uint8_t worker); //moves the back half of another worker's range into the worker's own. False if every range is empty.
+
+  public:
+    FramePool(uint8_t noOfWorkers); //constructor
+    ~FramePool();
+    //calls work(worker, first, last) for every chunk of [0, noOfFrames) until all are done. Worker 0 is the calling thread.
+    void run(uint32_t noOfFrames, const std::function<void(uint8_t worker, uint32_t first, uint32_t last)>& work);
+    uint8_t getNoOfWorkers(); //returns the number of workers
+    uint32_t getSteals(); //returns the ranges split off in the last run
+};
+
+#endif
@@ -0,0 +1,326 @@
+//Offline analysis of recordings with the band math of the firmware (the native-batch environment in platformio.ini). Every WAV file is turned
+//into the samples the I2S ADC would deliver (see sim/SimAudio.h), cut into frames of FFT_SIZE samples, and the frames are analysed in parallel,
+//each worker with its own Analyzer. The band levels are written to a binary file (see Batch.h) or CSV. Only the FFT engine is available:
+//the filter bank carries its state from block to block, so its frames cannot be analysed apart.
+//
+//usage: .pio/build/native-batch/program [--gain 0.5] -- [--threads <n>] [--hop <samples>] [--preset octave|third|linear] [--bands <n>]
+//                                      [--rows <n>] [--format bin|csv] [--out-dir <dir>] [--scaling] <file.wav>...
+//
+//  --threads   workers (default: one per CPU)
+//  --hop       samples between the starts of two frames (default FFT_SIZE, as on the device)
+//  --preset    band table preset with --bands bands (default: the band table of main.cpp, whose number of bands --bands cannot change)
+//  --rows      writes the rows lit on a matrix of this height instead of the levels, with the AGC of the display run over the frames in order
+//  --scaling   analyses every file with 1, 2, 4... up to --threads workers and reports the frames per second of each, and whether the
+//              levels are identical to those of one worker
+#include "Batch.h"
+#include <chrono>
+
+#define ARRAYSIZE(a) (sizeof(a)/sizeof(a[0]))
+
+static unsigned short _defaultBandTable[] = {100, 250, 500, 750, 1000, 2000, 4000, 6000, 8000, 10000}; //_bandTable of main.cpp
+
+struct BatchOptions{
+  uint8_t noOfThreads; //workers
+  uint16_t hop; //samples between the starts of two frames
+  unsigned short bandTable[MAX_VIEW_BANDS]; //upper frequency of each band
+  uint8_t noOfBands; //bands per frame
+  uint8_t noOfRows; //rows to quantize to (0 to write the levels)
+  bool csv; //flag to indicate CSV is written instead of the binary format
+  std::string outDirectory; //directory the output goes to (empty for beside the input)
+  bool scaling; //flag to indicate the throughput is measured with 1 to noOfThreads workers
+  std::vector<std::string> files; //WAV files to analyse
+};
+
+//analyser of a worker (AnalyzerMemory is too big for the stack of a thread, and each worker needs its own)
+struct Worker{
+  AnalyzerMemory* memory; //buffers of the analyser
+  Analyzer* analyzer; //analyser with the band table of the run
+  float levels[MAX_VIEW_BANDS]; //band levels of the frame analysed last
+};
+
+static BatchOptions _options;
+static Worker* _workers = nullptr;
+
+static void printUsage(){
+  fprintf(stderr, "usage: program [sim options] -- [--threads <n>] [--hop <samples>] [--preset octave|third|linear] [--bands <n>] [--rows <n>]\n"
+    "                                [--format bin|csv] [--out-dir <dir>] [--scaling] <file.wav>...\n");
+}
+
+static bool parseArguments(const std::vector<std::string>& arguments){
+  std::string preset;
+  unsigned long noOfBands = ARRAYSIZE(_defaultBandTable);
+  bool bandsGiven = false;
+  unsigned hardwareThreads = std::thread::hardware_concurrency();
+
+  _options.noOfThreads = hardwareThreads == 0 ? 1 : (hardwareThreads > 255 ? 255 : hardwareThreads);
+  _options.hop = FFT_SIZE;
+  _options.noOfRows = 0;
+  _options.csv = false;
+  _options.scaling = false;
+
+  for (size_t i = 0; i < arguments.size(); i++) {
+    const std::string& option = arguments[i];
+    bool hasValue = i + 1 < arguments.size();
+
+    if(option == "--threads" && hasValue){
+      unsigned long threads = strtoul(arguments[++i].c_str(), nullptr, 10);
+      _options.noOfThreads = threads < 1 ? 1 : (threads > 255 ? 255 : threads);
+    }else if(option == "--hop" && hasValue){
+      _options.hop = strtoul(arguments[++i].c_str(), nullptr, 10);
+    }else if(option == "--preset" && hasValue){
+      preset = arguments[++i];
+    }else if(option == "--bands" && hasValue){
+      noOfBands = strtoul(arguments[++i].c_str(), nullptr, 10);
+      bandsGiven = true;
+    }else if(option == "--rows" && hasValue){
+      _options.noOfRows = strtoul(arguments[++i].c_str(), nullptr, 10);
+    }else if(option == "--format" && hasValue){
+      _options.csv = arguments[++i] == "csv";
+    }else if(option == "--out-dir" && hasValue){
+      _options.outDirectory = arguments[++i];
+    }else if(option == "--scaling"){
+      _options.scaling = true;
+    }else if(option.compare(0, 2, "--") == 0){
+      printUsage();
+      return false;
+    }else{
+      _options.files.push_back(option);
+    }
+  }
+
+  if(_options.files.empty() || _options.hop == 0 || _options.hop > FFT_SIZE || noOfBands < 1 || noOfBands > MAX_VIEW_BANDS){
+    printUsage();
+    return false;
+  }
+
+  //the band table of main.cpp has its own number of bands
+  if(bandsGiven && preset.empty()){
+    fprintf(stderr, "--bands needs a --preset\n");
+    printUsage();
+    return false;
+  }
+
+  _options.noOfBands = noOfBands;
+  if(preset.empty()){
+    _options.noOfBands = ARRAYSIZE(_defaultBandTable);
+    memcpy(_options.bandTable, _defaultBandTable, sizeof(_defaultBandTable));
+    return true;
+  }
+
+  BandLayout layout;
+  if(preset == "octave"){
+    layout = LAYOUT_OCTAVE;
+  }else if(preset == "third"){
+    layout = LAYOUT_THIRD_OCTAVE;
+  }else if(preset == "linear"){
+    layout = LAYOUT_LINEAR;
+  }else{
+    printUsage();
+    return false;
+  }
+
+  //the presets depend on the sampling frequency and the FFT size, so an analyser works them out
+  AnalyzerMemory* memory = new AnalyzerMemory();
+  Analyzer analyzer(memory, ARRAYSIZE(_defaultBandTable), _defaultBandTable);
+  analyzer.makeBandTable(layout, _options.noOfBands, _options.bandTable);
+  delete memory;
+  return true;
+}
+
+//reads the file as the I2S ADC would sample it. Returns false if it cannot be read.
+static bool loadSamples(const std::string& path, uint32_t samplingFrequency, std::vector<AudioSample>& samples){
+  AudioSource source;
+  if(!source.begin(path, "", g_simConfig.gain, samplingFrequency)){
+    return false;
+  }
+
+  samples.resize(source.getLength());
+  for (AudioSample& sample : samples) {
+    sample = source.nextRaw();
+  }
+  return true;
+}
+
+//analyses the frames with the workers of the pool into levels (noOfFrames x noOfBands). Returns the time it took in seconds.
+static double analyze(const std::vector<AudioSample>& samples, uint32_t noOfFrames, FramePool* pool, float* levels){
+  uint8_t noOfBands = _options.noOfBands;
+  auto start = std::chrono::steady_clock::now();
+
+  pool->run(noOfFrames, [&](uint8_t w, uint32_t first, uint32_t last){
+    Worker& worker = _workers[w];
+    for (uint32_t f = first; f < last; f++) {
+      worker.analyzer->loadSamples(&samples[(size_t)f * _options.hop]);
+      worker.analyzer->convertToBands(worker.levels);
+      memcpy(&levels[(size_t)f * noOfBands], worker.levels, noOfBands * sizeof(float));
+    }
+  });
+
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//the AGC follows the frames in order, so this runs on one thread after the analysis
+static void quantize(float* levels, uint32_t noOfFrames, uint8_t* rows){
+  LevelQuantizer quantizer(_options.noOfRows);
+  uint8_t noOfBands = _options.noOfBands;
+  float frameScale = (float)_options.hop / FFT_SIZE;
+
+  for (uint32_t f = 0; f < noOfFrames; f++) {
+    float* frame = &levels[(size_t)f * noOfBands];
+    quantizer.update(frame, noOfBands, frameScale);
+    for (uint8_t b = 0; b < noOfBands; b++) {
+      rows[(size_t)f * noOfBands + b] = quantizer.quantize(frame[b]);
+    }
+  }
+}
+
+static std::string outputPath(const std::string& input){
+  size_t nameStart = input.find_last_of('/') + 1; //0 if there is no directory
+  size_t extension = input.find_last_of('.');
+  std::string stem = extension != std::string::npos && extension > nameStart ? input.substr(0, extension) : input;
+
+  if(!_options.outDirectory.empty()){
+    stem = _options.outDirectory + "/" + stem.substr(nameStart);
+  }
+  return stem + (_options.csv ? ".csv" : ".bands");
+}
+
+static bool writeOutput(const std::string& path, const float* levels, const uint8_t* rows, uint32_t noOfFrames, uint32_t samplingFrequency){
+  FILE* file = fopen(path.c_str(), "wb");
+  if(file == nullptr){
+    fprintf(stderr, "unable to write %s\n", path.c_str());
+    return false;
+  }
+
+  uint8_t noOfBands = _options.noOfBands;
+  if(_options.csv){
+    fprintf(file, "time");
+    for (uint8_t b = 0; b < noOfBands; b++) {
+      fprintf(file, ",%u", _options.bandTable[b]);
+    }
+    fprintf(file, "\n");
+
+    for (uint32_t f = 0; f < noOfFrames; f++) {
+      fprintf(file, "%.6f", (double)f * _options.hop / samplingFrequency); //start of the frame
+      for (uint8_t b = 0; b < noOfBands; b++) {
+        size_t i = (size_t)f * noOfBands + b;
+        if(rows != nullptr){
+          fprintf(file, ",%u", rows[i]);
+        }else{
+          fprintf(file, ",%.9g", levels[i]); //enough digits to read back the same float
+        }
+      }
+      fprintf(file, "\n");
+    }
+  }else{
+    BandsHeader header;
+    memcpy(header.magic, BANDS_MAGIC, sizeof(header.magic));
+    header.version = BANDS_VERSION;
+    header.kind = rows != nullptr ? BANDS_ROWS : BANDS_LEVELS;
+    header.noOfBands = noOfBands;
+    header.noOfRows = _options.noOfRows;
+    header.samplingFrequency = samplingFrequency;
+    header.fftSize = FFT_SIZE;
+    header.hop = _options.hop;
+    header.noOfFrames = noOfFrames;
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(_options.bandTable, sizeof(unsigned short), noOfBands, file);
+    if(rows != nullptr){
+      fwrite(rows, 1, (size_t)noOfFrames * noOfBands, file);
+    }else{
+      fwrite(levels, sizeof(float), (size_t)noOfFrames * noOfBands, file);
+    }
+  }
+
+  bool written = ferror(file) == 0;
+  written = fclose(file) == 0 && written;
+  if(!written){
+    fprintf(stderr, "unable to write %s\n", path.c_str());
+  }
+  return written;
+}
+
+//analyses the file with 1, 2, 4... workers and compares the levels with those of one worker. Returns false if any differ.
+static bool measureScaling(const std::vector<AudioSample>& samples, uint32_t noOfFrames, const float* levels){
+  size_t noOfLevels = (size_t)noOfFrames * _options.noOfBands;
+  float* scaledLevels = new float[noOfLevels];
+  double singleSeconds = 0;
+  bool identical = true;
+
+  printf("%8s %12s %9s %8s %10s\n", "threads", "frames/s", "speedup", "steals", "identical");
+  for (uint16_t threads = 1; threads <= _options.noOfThreads; threads = threads < _options.noOfThreads && threads * 2 > _options.noOfThreads ? _options.noOfThreads : threads * 2) {
+    FramePool pool(threads);
+    double seconds = analyze(samples, noOfFrames, &pool, scaledLevels);
+    singleSeconds = threads == 1 ? seconds : singleSeconds;
+
+    bool same = memcmp(scaledLevels, levels, noOfLevels * sizeof(float)) == 0;
+    identical = identical && same;
+    printf("%8u %12.0f %8.2fx %8u %10s\n", threads, noOfFrames / seconds, singleSeconds / seconds, pool.getSteals(), same ? "yes" : "NO");
+
+    if(threads == _options.noOfThreads){
+      break;
+    }
+  }
+
+  delete[] scaledLevels;
+  return identical;
+}
+
+static bool processFile(const std::string& path, FramePool* pool){
+  uint32_t samplingFrequency = _workers[0].analyzer->getSamplingFrequency();
+  std::vector<AudioSample> samples;
+
+  if(!loadSamples(path, samplingFrequency, samples)){
+    return false;
+  }
+
+  uint32_t noOfFrames = samples.size() >= FFT_SIZE ? (samples.size() - FFT_SIZE) / _options.hop + 1 : 0;
+  float* levels = new float[(size_t)noOfFrames * _options.noOfBands];
+  uint8_t* rows = _options.noOfRows > 0 ? new uint8_t[(size_t)noOfFrames * _options.noOfBands] : nullptr;
+
+  double seconds = analyze(samples, noOfFrames, pool, levels);
+  double audioSeconds = (double)samples.size() / samplingFrequency;
+  printf("%s: %u frames (%.1f s of audio) in %.3f s on %u threads: %.0f frames/s, %.0fx real time, %u steals\n", path.c_str(), noOfFrames,
+    audioSeconds, seconds, pool->getNoOfWorkers(), seconds > 0 ? noOfFrames / seconds : 0, seconds > 0 ? audioSeconds / seconds : 0, pool->getSteals());
+
+  bool ok = true;
+  if(_options.scaling){
+    ok = measureScaling(samples, noOfFrames, levels);
+  }
+
+  if(rows != nullptr){
+    quantize(levels, noOfFrames, rows);
+  }
+
+  std::string output = outputPath(path);
+  ok = writeOutput(output, levels, rows, noOfFrames, samplingFrequency) && ok;
+  printf("written to %s\n", output.c_str());
+
+  delete[] levels;
+  delete[] rows;
+  return ok;
+}
+
+void setup(){
+  if(!parseArguments(g_simConfig.programArguments)){
+    exit(2);
+  }
+
+  _workers = new Worker[_options.noOfThreads];
+  for (uint8_t w = 0; w < _options.noOfThreads; w++) {
+    _workers[w].memory = new AnalyzerMemory(); //zero initialized, as the static object on the device
+    _workers[w].analyzer = new Analyzer(_workers[w].memory, _options.noOfBands, _options.bandTable);
+  }
+
+  FramePool pool(_options.noOfThreads);
+  bool ok = true;
+  for (const std::string& file : _options.files) {
+    ok = processFile(file, &pool) && ok;
+  }
+
+  fflush(stdout);
+  exit(ok ? 0 : 1);
+}
+
+void loop(){
+}
@@ -0,0 +1,87 @@
+#include "Batch.h"
+
+FramePool::FramePool(uint8_t noOfWorkers){
+  this->_noOfWorkers = noOfWorkers > 0 ? noOfWorkers : 1;
+  this->_ranges = new Range[this->_noOfWorkers];
+  this->_steals = 0;
+}
+
+FramePool::~FramePool(){
+  delete[] this->_ranges;
+}
+
+void FramePool::run(uint32_t noOfFrames, const std::function<void(uint8_t worker, uint32_t first, uint32_t last)>& work){
+  uint32_t noOfChunks = (noOfFrames + POOL_CHUNK_FRAMES - 1) / POOL_CHUNK_FRAMES;
+  this->_steals = 0;
+
+  //equal contiguous shares to begin with, so the workers only meet when the shares turn out to take different times
+  for (uint8_t w = 0; w < this->_noOfWorkers; w++) {
+    this->_ranges[w].begin = (uint64_t)noOfChunks * w / this->_noOfWorkers;
+    this->_ranges[w].end = (uint64_t)noOfChunks * (w + 1) / this->_noOfWorkers;
+  }
+
+  auto worker = [&](uint8_t w){
+    uint32_t chunk;
+    while (this->take(w, &chunk) || (this->steal(w) && this->take(w, &chunk))) {
+      uint32_t first = chunk * POOL_CHUNK_FRAMES;
+      uint32_t last = first + POOL_CHUNK_FRAMES < noOfFrames ? first + POOL_CHUNK_FRAMES : noOfFrames;
+      work(w, first, last);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint8_t w = 1; w < this->_noOfWorkers; w++) {
+    threads.emplace_back(worker, w);
+  }
+  worker(0);
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+uint8_t FramePool::getNoOfWorkers(){
+  return this->_noOfWorkers;
+}
+
+uint32_t FramePool::getSteals(){
+  return this->_steals;
+}
+
+//PRIVATE MEMBER DEFINITIONS
+bool FramePool::take(uint8_t worker, uint32_t* chunk){
+  Range& range = this->_ranges[worker];
+  std::lock_guard<std::mutex> guard(range.lock);
+
+  if(range.begin >= range.end){
+    return false;
+  }
+  *chunk = range.begin++;
+  return true;
+}
+
+//the victims are tried in turn from the next worker on, so the thieves spread over them. A range split off is in neither range until it is
+//handed over; a thief that looks meanwhile may find nothing and stop early, which only costs parallelism at the very end of the run.
+bool FramePool::steal(uint8_t worker){
+  for (uint8_t i = 1; i < this->_noOfWorkers; i++) {
+    Range& victim = this->_ranges[(worker + i) % this->_noOfWorkers];
+    uint32_t begin, end;
+    {
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if(victim.begin >= victim.end){
+        continue;
+      }
+      end = victim.end;
+      begin = end - (end - victim.begin + 1) / 2; //the back half, the single chunk left included
+      victim.end = begin;
+    }
+
+    Range& own = this->_ranges[worker];
+    std::lock_guard<std::mutex> guard(own.lock);
+    own.begin = begin;
+    own.end = end;
+    this->_steals++;
+    return true;
+  }
+  return false;
+}
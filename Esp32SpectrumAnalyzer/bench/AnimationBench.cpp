@@ -0,0 +1,95 @@
+//drops a peak from the top row at several frame rates and prints when it falls from each row, and the time renderFrame takes per frame.
+//The animation runs on the frame clock, so the times should match those of the fastest rate to within a frame of each rate, and the
+//benchmark fails if they do not.
+#include "Bench.h"
+#include <chrono>
+
+#define ANIMATION_ROWS 10
+#define ANIMATION_COLS 10 //the peak drops in every column, so the render time is that of the default 10x10 matrix
+#define ANIMATION_SECONDS 4 //long enough for the peak to reach the bottom with the default hold and acceleration
+#define ANIMATION_REPEATS 100 //drops timed per rate, so the render time is measured over tens of thousands of frames
+
+static const unsigned short _framesPerSecond[] = {30, 43, 60, 120};
+#define NO_OF_RATES (sizeof(_framesPerSecond) / sizeof(_framesPerSecond[0]))
+
+//returns in fallTimes[row] the time (ms) the peak fell from the row, and the time renderFrame took per frame (ns)
+static double dropPeak(unsigned short framesPerSecond, float* fallTimes){
+  LedMatrix* ledMatrix = new LedMatrix(ANIMATION_ROWS, ANIMATION_COLS);
+  unsigned short values[ANIMATION_COLS];
+  int64_t frameMicros = 1000000 / framesPerSecond;
+  uint32_t noOfFrames = 0;
+  double renderNanos = 0;
+
+  for (unsigned short repeat = 0; repeat < ANIMATION_REPEATS; repeat++) {
+    for (unsigned short col = 0; col < ANIMATION_COLS; col++) {
+      values[col] = ANIMATION_ROWS; //a full bar for the first frame, then silence
+    }
+    int64_t start = (int64_t)repeat * (ANIMATION_SECONDS + 1) * 1000000LL; //the hold of the last drop is over
+    unsigned short row = ANIMATION_ROWS - 1; //the peak is clamped to the top row index
+
+    for (int64_t frameTime = frameMicros; frameTime <= ANIMATION_SECONDS * 1000000LL; frameTime += frameMicros) {
+      auto renderStart = std::chrono::steady_clock::now();
+      ledMatrix->renderFrame(values, start + frameTime, (float)frameMicros / REFERENCE_FRAME_MICROS);
+      renderNanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - renderStart).count();
+      noOfFrames++;
+      memset(values, 0, sizeof(values));
+
+      for (; row > ledMatrix->getPeakRow(0); row--) {
+        fallTimes[row] = (frameTime - frameMicros) / 1000.0f;
+      }
+    }
+    for (; row > 0; row--) {
+      fallTimes[row] = -1; //did not fall in time
+    }
+  }
+
+  delete ledMatrix;
+  return renderNanos / noOfFrames;
+}
+
+bool benchAnimation(){
+  float fallTimes[NO_OF_RATES][ANIMATION_ROWS];
+  double renderNanos[NO_OF_RATES];
+  for (unsigned short r = 0; r < NO_OF_RATES; r++) {
+    renderNanos[r] = dropPeak(_framesPerSecond[r], fallTimes[r]);
+  }
+
+  printf("%-20s", "peak falls (ms)");
+  for (unsigned short r = 0; r < NO_OF_RATES; r++) {
+    printf("%9u fps", _framesPerSecond[r]);
+  }
+  printf("\n");
+
+  float maxDifferences[NO_OF_RATES] = {};
+  for (unsigned short row = ANIMATION_ROWS - 1; row > 0; row--) {
+    printf("from row %-11u", row);
+    for (unsigned short r = 0; r < NO_OF_RATES; r++) {
+      printf("%13.0f", fallTimes[r][row]);
+      float difference = fallTimes[r][row] < 0 ? INFINITY : fabsf(fallTimes[r][row] - fallTimes[NO_OF_RATES - 1][row]);
+      maxDifferences[r] = difference > maxDifferences[r] ? difference : maxDifferences[r];
+    }
+    printf("\n");
+  }
+
+  //the reference is the fastest rate. A rate passes if every fall is within one of its own frames of the reference.
+  bool passed = true;
+  printf("%-20s", "largest difference");
+  for (unsigned short r = 0; r < NO_OF_RATES; r++) {
+    printf("%10.0f ms", maxDifferences[r]);
+    passed = passed && maxDifferences[r] <= 1000.0f / _framesPerSecond[r];
+  }
+  printf("\n");
+  printf("%-20s", "allowed difference");
+  for (unsigned short r = 0; r < NO_OF_RATES; r++) {
+    printf("%10.1f ms", 1000.0f / _framesPerSecond[r]);
+  }
+  printf("\n");
+  printf("%-20s", "render (ns/frame)");
+  for (unsigned short r = 0; r < NO_OF_RATES; r++) {
+    printf("%13.0f", renderNanos[r]);
+  }
+  printf("\n");
+  printf(passed ? "PASS: at every rate the peak falls within one of its own frames of the %u fps times\n"
+    : "FAIL: at some rate the peak does not fall within one of its own frames of the %u fps times\n", _framesPerSecond[NO_OF_RATES - 1]);
+  return passed;
+}
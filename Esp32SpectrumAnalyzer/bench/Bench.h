@@ -0,0 +1,15 @@
+#ifndef Bench_h
+#define Bench_h
+
+#include "LedMatrix.h"
+#include <string>
+#include <vector>
+
+void benchCompositor(); //prints the throughput of the LED compositor for the common matrix sizes
+bool benchAnimation(); //prints the peak animation at several frame rates. Returns false if they do not match.
+void benchCodec(); //prints the bytes per frame and encode and decode times of the frame codec and of JSON frames for the common band counts
+void benchConfigLoad(); //prints the time the settings take to load from the binary blob and from JSON
+void benchFilterBank(); //prints the latency and CPU time of the FFT and filter bank analysis engines
+bool writeTelemetry(const std::vector<std::string>& arguments); //writes telemetry records for tools/telemetry_loopback_test.py. Returns false on bad arguments.
+
+#endif
@@ -0,0 +1,30 @@
+//Host benchmarks of the render path, the frame codec, the settings store and the analysis engines (the native-bench environment in platformio.ini).
+//
+//usage: .pio/build/native-bench/program --no-led-timing --serial /dev/null --nvs .pio/bench-nvs
+//       .pio/build/native-bench/program --serial <pty> -- telemetry <bands> <fps> <frames> <frames between text lines> (see tools/telemetry_loopback_test.py)
+#include "Bench.h"
+#include "SimConfig.h"
+
+void setup(){
+  std::vector<std::string>& arguments = g_simConfig.programArguments;
+  if(!arguments.empty() && arguments[0] == "telemetry"){
+    exit(writeTelemetry(arguments) ? 0 : 2);
+  }
+
+  Serial.begin(115200); //the matrices report on the serial port, which --serial moves out of the tables
+
+  benchCompositor();
+  printf("\n");
+  bool passed = benchAnimation();
+  printf("\n");
+  benchCodec();
+  printf("\n");
+  benchConfigLoad();
+  printf("\n");
+  benchFilterBank();
+
+  exit(passed ? 0 : 1); //non-zero if a benchmark that checks its results failed
+}
+
+void loop(){
+}
@@ -0,0 +1,126 @@
+//encodes frames of music-like band levels with the keyframe interval of the streamer, and prints the bytes sent per frame and the
+//time an encode and a decode take for the common band counts, next to the same frames sent as JSON documents
+#include "Bench.h"
+#include "FrameCodec.h"
+#include "FrameStreamer.h"
+#include <chrono>
+
+#define CODEC_FRAMES 200000 //frames encoded per band count
+#define CODEC_JSON_FRAMES 20000 //frames serialized as JSON per band count
+#define CODEC_JSON_BYTES 1024 //longest JSON frame (64 bands)
+#define CODEC_SOURCE_FRAMES 4096 //frames of levels made up front, so the encode is timed on its own
+
+static const uint8_t _bandCounts[] = {3, 10, 32, 64};
+
+static uint8_t _levels[CODEC_SOURCE_FRAMES][FRAME_MAX_BANDS];
+static uint8_t _peaks[CODEC_SOURCE_FRAMES][FRAME_MAX_BANDS];
+
+//levels that move like music: mostly small steps, now and then a jump, and peaks that hold and then fall a row at a time
+static void makeLevels(uint8_t noOfBands, uint8_t noOfRows){
+  uint32_t seed = 1;
+  uint8_t levels[FRAME_MAX_BANDS] = {};
+  uint8_t peaks[FRAME_MAX_BANDS] = {};
+
+  for (uint32_t f = 0; f < CODEC_SOURCE_FRAMES; f++) {
+    for (uint8_t b = 0; b < noOfBands; b++) {
+      seed = seed * 1664525 + 1013904223;
+      uint32_t r = seed >> 8;
+      if(r % 16 == 0){
+        levels[b] = r >> 8;
+      }else if(r % 4 != 0){
+        levels[b] = constrain((int)levels[b] + (int)((r >> 8) % 21) - 10, 0, 255);
+      }
+      uint8_t row = levels[b] * noOfRows / 256;
+      peaks[b] = row >= peaks[b] ? row : (r % 8 == 0 ? peaks[b] - 1 : peaks[b]);
+    }
+    memcpy(_levels[f], levels, noOfBands);
+    memcpy(_peaks[f], peaks, noOfBands);
+  }
+}
+
+//binary frames: returns the average bytes per frame, and the time of an encode and of a decode (ns)
+static double measureBinary(uint8_t noOfBands, double* encodeNanos, double* decodeNanos){
+  static uint8_t frames[CODEC_SOURCE_FRAMES][FRAME_MAX_SIZE];
+  static size_t lengths[CODEC_SOURCE_FRAMES];
+  FrameEncoder encoder(KEYFRAME_INTERVAL);
+  FrameDecoder decoder;
+  uint64_t bytes = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t f = 0; f < CODEC_FRAMES; f++) {
+    uint32_t source = f % CODEC_SOURCE_FRAMES;
+    lengths[source] = encoder.encode(_levels[source], _peaks[source], noOfBands, 10, f * 23, 0, frames[source], FRAME_MAX_SIZE);
+    bytes += lengths[source];
+  }
+  *encodeNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / CODEC_FRAMES;
+
+  //the last CODEC_SOURCE_FRAMES frames encoded are decoded in order, starting at a keyframe
+  uint32_t first = 0;
+  while(!(frames[first][7] & FRAME_FLAG_KEYFRAME)){
+    first++;
+  }
+  uint32_t decoded = 0;
+  start = std::chrono::steady_clock::now();
+  for (uint32_t pass = 0; pass < CODEC_FRAMES / CODEC_SOURCE_FRAMES; pass++) {
+    decoder.reset();
+    for (uint32_t f = first; f < CODEC_SOURCE_FRAMES; f++) {
+      decoded += decoder.decode(frames[f], lengths[f]) == FRAME_DECODED;
+    }
+  }
+  *decodeNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / decoded;
+
+  return (double)bytes / CODEC_FRAMES;
+}
+
+//JSON documents carrying the same values: returns the average bytes per frame, and the time of a serialize and of a parse (ns)
+static double measureJson(uint8_t noOfBands, double* encodeNanos, double* decodeNanos){
+  static char frames[CODEC_SOURCE_FRAMES][CODEC_JSON_BYTES];
+  JsonDocument doc;
+  uint64_t bytes = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t f = 0; f < CODEC_JSON_FRAMES; f++) {
+    uint32_t source = f % CODEC_SOURCE_FRAMES;
+    doc.clear();
+    doc["sequence"] = f;
+    doc["timestamp"] = f * 23;
+    doc["noOfRows"] = 10;
+    JsonArray levels = doc["levels"].to<JsonArray>();
+    JsonArray peaks = doc["peaks"].to<JsonArray>();
+    for (uint8_t b = 0; b < noOfBands; b++) {
+      levels.add(_levels[source][b]);
+      peaks.add(_peaks[source][b]);
+    }
+    bytes += serializeJson(doc, frames[source], CODEC_JSON_BYTES);
+  }
+  *encodeNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / CODEC_JSON_FRAMES;
+
+  uint32_t checksum = 0;
+  start = std::chrono::steady_clock::now();
+  for (uint32_t f = 0; f < CODEC_JSON_FRAMES; f++) {
+    deserializeJson(doc, frames[f % CODEC_SOURCE_FRAMES]);
+    for (JsonVariant level : doc["levels"].as<JsonArray>()) {
+      checksum += level.as<uint8_t>();
+    }
+    for (JsonVariant peak : doc["peaks"].as<JsonArray>()) {
+      checksum += peak.as<uint8_t>();
+    }
+  }
+  *decodeNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / CODEC_JSON_FRAMES;
+
+  return checksum == 0 ? 0 : (double)bytes / CODEC_JSON_FRAMES; //the checksum keeps the parse from being optimized away
+}
+
+void benchCodec(){
+  printf("%-8s%10s%10s%10s%10s%10s%10s%10s\n", "bands", "keyframe", "average", "encode", "decode", "JSON", "serialize", "parse");
+
+  for (uint8_t noOfBands : _bandCounts) {
+    makeLevels(noOfBands, 10);
+    double encodeNanos, decodeNanos, serializeNanos, parseNanos;
+    double binaryBytes = measureBinary(noOfBands, &encodeNanos, &decodeNanos);
+    double jsonBytes = measureJson(noOfBands, &serializeNanos, &parseNanos);
+
+    printf("%-8u%8u B%8.1f B%7.0f ns%7.0f ns%8.1f B%7.0f ns%7.0f ns\n", noOfBands, FRAME_HEADER_SIZE + noOfBands * 2, binaryBytes, encodeNanos,
+      decodeNanos, jsonBytes, serializeNanos, parseNanos);
+  }
+}
@@ -0,0 +1,70 @@
+//renders frames of pseudo random bar heights into matrices of the common sizes, with each background effect and blend mode,
+//and prints the throughput in pixels per microsecond
+#include "Bench.h"
+#include <chrono>
+
+#define BENCH_FRAMES 20000 //frames rendered per measurement
+
+struct MatrixSize{
+  unsigned short rows;
+  unsigned short cols;
+};
+
+struct Layers{
+  const char* name;
+  BackgroundEffect background;
+  BlendMode bar;
+  BlendMode peak;
+};
+
+static const MatrixSize _sizes[] = { {10, 10}, {8, 32}, {16, 16}, {16, 32}, {32, 32} };
+
+static const Layers _layers[] = {
+  {"bars and peaks", BACKGROUND_NONE, BLEND_REPLACE, BLEND_REPLACE},
+  {"glow", BACKGROUND_GLOW, BLEND_REPLACE, BLEND_REPLACE},
+  {"trails", BACKGROUND_TRAILS, BLEND_REPLACE, BLEND_REPLACE},
+  {"glow, added bars", BACKGROUND_GLOW, BLEND_ADD, BLEND_LIGHTEN},
+  {"trails, added bars", BACKGROUND_TRAILS, BLEND_ADD, BLEND_ADD}
+};
+
+//renders BENCH_FRAMES frames and returns the pixels composed per microsecond
+static double measure(LedMatrix* ledMatrix, unsigned short* values){
+  unsigned short rows = ledMatrix->getNoOfRows();
+  unsigned short cols = ledMatrix->getNoOfCols();
+  uint32_t seed = 1;
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t frame = 0; frame < BENCH_FRAMES; frame++) {
+    for (unsigned short col = 0; col < cols; col++) {
+      seed = seed * 1664525 + 1013904223; //bar heights change every frame, so the peaks rise and fall as they do with music
+      values[col] = (seed >> 16) % (rows + 1);
+    }
+    ledMatrix->renderFrame(values, (int64_t)frame * REFERENCE_FRAME_MICROS, 1.0f);
+  }
+  double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+  return (double)BENCH_FRAMES * rows * cols / micros;
+}
+
+void benchCompositor(){
+  printf("%-20s", "pixels/us");
+  for (const MatrixSize& size : _sizes) {
+    printf("%9ux%-3u", size.rows, size.cols);
+  }
+  printf("\n");
+
+  for (const Layers& layers : _layers) {
+    printf("%-20s", layers.name);
+    for (const MatrixSize& size : _sizes) {
+      LedMatrix* ledMatrix = new LedMatrix(size.rows, size.cols);
+      ledMatrix->setBackground(layers.background, 24);
+      ledMatrix->setBlendModes(layers.bar, layers.peak);
+
+      unsigned short* values = new unsigned short[size.cols];
+      printf("%13.1f", measure(ledMatrix, values));
+      fflush(stdout);
+      delete[] values;
+    }
+    printf("\n");
+  }
+}
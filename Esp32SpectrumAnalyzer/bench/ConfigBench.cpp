@@ -0,0 +1,141 @@
+//loads the settings of the common matrix sizes at boot both ways: the binary blob of ConfigStore, and the same settings as the JSON document
+//of /deploy, parsed and applied. Both are read from NVS (a file in the simulation, see sim/Preferences.h), so run it with its own --nvs directory.
+#include "Bench.h"
+#include "ConfigStore.h"
+#include <chrono>
+
+#define CONFIG_LOADS 200 //loads timed per matrix size
+#define CONFIG_BANDS 16 //bands in the stored band table
+
+struct ConfigSize{
+  unsigned short rows;
+  unsigned short cols;
+};
+
+static const ConfigSize _configSizes[] = { {10, 10}, {16, 16}, {16, 32}, {32, 32} };
+
+//writes the settings as /deploy receives them
+static size_t makeDeployJson(const DisplayConfig& config, const CRGB* ledColors, unsigned short noOfLeds, const unsigned short* bandTable, String& json){
+  JsonDocument doc;
+  doc["peakDelay"] = config.peakDelay;
+  doc["peakSpeed"] = config.peakSpeed;
+  doc["speedFilter"] = config.speedFilter;
+  doc["atten"] = config.attenuationFactor;
+  doc["brightness"] = config.brightness;
+  doc["peak"]["r"] = config.peakR;
+  doc["peak"]["g"] = config.peakG;
+  doc["peak"]["b"] = config.peakB;
+
+  JsonArray bands = doc["bands"].to<JsonArray>();
+  for (uint8_t i = 0; i < config.noOfBands; i++) {
+    bands.add(bandTable[i]);
+  }
+
+  JsonArray pixels = doc["pixels"].to<JsonArray>();
+  for (unsigned short i = 0; i < noOfLeds; i++) {
+    JsonObject pixel = pixels.add<JsonObject>();
+    pixel["r"] = ledColors[i].r;
+    pixel["g"] = ledColors[i].g;
+    pixel["b"] = ledColors[i].b;
+  }
+
+  return serializeJson(doc, json);
+}
+
+//reads the JSON settings from NVS and applies them like the deploy thread does. Returns false if they are missing or invalid.
+static bool loadDeployJson(Preferences& prefs, char* buffer, size_t size, DisplayConfig* config, CRGB* ledColors, unsigned short noOfLeds, unsigned short* bandTable){
+  if(!prefs.begin("sadbench", true)){
+    return false;
+  }
+  size_t length = prefs.getBytes("config", buffer, size);
+  prefs.end();
+
+  JsonDocument doc;
+  if(length == 0 || deserializeJson(doc, buffer, length)){
+    return false;
+  }
+
+  config->peakDelay = doc["peakDelay"];
+  config->peakSpeed = doc["peakSpeed"];
+  config->speedFilter = doc["speedFilter"];
+  config->attenuationFactor = doc["atten"];
+  config->brightness = doc["brightness"];
+  config->peakR = doc["peak"]["r"];
+  config->peakG = doc["peak"]["g"];
+  config->peakB = doc["peak"]["b"];
+
+  config->noOfBands = 0;
+  for (JsonVariant band : doc["bands"].as<JsonArray>()) {
+    bandTable[config->noOfBands++] = band.as<unsigned short>();
+  }
+
+  unsigned short i = 0;
+  for (JsonVariant pixel : doc["pixels"].as<JsonArray>()) {
+    if(i < noOfLeds){
+      ledColors[i++] = CRGB(pixel["r"], pixel["g"], pixel["b"]);
+    }
+  }
+  return i == noOfLeds;
+}
+
+void benchConfigLoad(){
+  printf("%-10s%10s%10s%12s%12s\n", "matrix", "blob", "JSON", "blob load", "JSON load");
+
+  for (const ConfigSize& size : _configSizes) {
+    unsigned short noOfLeds = size.rows * size.cols;
+    DisplayConfig config = {200, 10, 0.5f, 2.0f, 80, 255, 255, 255, CONFIG_BANDS};
+    CRGB* ledColors = new CRGB[noOfLeds];
+    unsigned short bandTable[CONFIG_BANDS];
+    uint32_t seed = 1;
+    for (unsigned short i = 0; i < noOfLeds; i++) {
+      seed = seed * 1664525 + 1013904223;
+      ledColors[i] = CRGB(seed >> 24, seed >> 16, seed >> 8);
+    }
+    for (uint8_t i = 0; i < CONFIG_BANDS; i++) {
+      bandTable[i] = 60 << (i / 2);
+    }
+
+    //store the settings both ways
+    ConfigStore* configStore = new ConfigStore(noOfLeds, CONFIG_BANDS);
+    configStore->save(&config, ledColors, bandTable);
+    size_t blobSize = sizeof(ConfigHeader) + sizeof(DisplayConfig) + noOfLeds * sizeof(CRGB) + CONFIG_BANDS * sizeof(unsigned short);
+
+    String json;
+    size_t jsonSize = makeDeployJson(config, ledColors, noOfLeds, bandTable, json);
+    Preferences prefs;
+    prefs.begin("sadbench", false);
+    prefs.putBytes("config", json.c_str(), jsonSize);
+    prefs.end();
+
+    DisplayConfig loaded;
+    char* buffer = new char[jsonSize];
+    bool blobLoaded = true;
+    bool jsonLoaded = true;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < CONFIG_LOADS; i++) {
+      blobLoaded = configStore->load(&loaded, ledColors, bandTable) && blobLoaded;
+    }
+    double blobMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / CONFIG_LOADS;
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < CONFIG_LOADS; i++) {
+      jsonLoaded = loadDeployJson(prefs, buffer, jsonSize, &loaded, ledColors, noOfLeds, bandTable) && jsonLoaded;
+    }
+    double jsonMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / CONFIG_LOADS;
+
+    printf("%4ux%-5u%8u B%8u B%9.1f us%9.1f us%s\n", size.rows, size.cols, (unsigned)blobSize, (unsigned)jsonSize, blobMicros, jsonMicros,
+      blobLoaded && jsonLoaded ? "" : "  (a load failed)");
+
+    //leave no settings behind for the next run of the simulation
+    prefs.begin("sadbench", false);
+    prefs.clear();
+    prefs.end();
+    prefs.begin("sad", false);
+    prefs.remove("config");
+    prefs.end();
+    delete[] buffer;
+    delete[] ledColors;
+    delete configStore;
+  }
+}
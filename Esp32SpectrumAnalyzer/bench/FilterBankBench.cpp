@@ -0,0 +1,183 @@
+//compares the FFT engine with the filter bank engine: the time a band takes to respond to a tone that starts at a random point of a block,
+//and the CPU time per second of audio for the LED bands and for the bands of every view of main.cpp
+#include "Bench.h"
+#include "Analyzer.h"
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#define TONE_FREQ 880 //tone of the onset test, in band 4 (750 to 1000 Hz) of the LED band table
+#define TONE_BAND 4
+#define TONE_AMPLITUDE 1000 //of the 12 bit ADC samples
+#define ADC_MIDSCALE 0x800 //ADC sample of silence
+#define ADC_OFFSET 0xFFF //the analyzer takes the samples from this (channel 0)
+#define ONSETS 200 //random onsets timed per engine
+#define ONSET_LEAD (4 * FFT_SIZE) //silence before the earliest onset
+#define ONSET_TAIL (4 * FFT_SIZE) //tone after the latest onset, long enough for either engine to respond
+#define CPU_SECONDS 20 //audio analysed per CPU measurement
+
+static unsigned short _ledBands[] = {100, 250, 500, 750, 1000, 2000, 4000, 6000, 8000, 10000}; //_bandTable of main.cpp
+static unsigned short _webBands[] = {140, 190, 240, 290, 340, 390, 440, 490, 540, 590, 640, 690, 790, 930, 1110, 1310,
+  1550, 1840, 2190, 2590, 3070, 3640, 4320, 5120, 6070, 7200, 8540, 10120, 12000, 14230, 16870, 20000}; //_webBandTable of main.cpp
+static unsigned short _lightingBands[] = {250, 4000, 20000}; //_lightingBandTable of main.cpp
+#define NO_OF_LED_BANDS (sizeof(_ledBands) / sizeof(_ledBands[0]))
+#define NO_OF_WEB_BANDS (sizeof(_webBands) / sizeof(_webBands[0]))
+#define NO_OF_LIGHTING_BANDS (sizeof(_lightingBands) / sizeof(_lightingBands[0]))
+
+static const uint16_t _blockSizes[] = {256, 64, 32};
+
+static AnalyzerMemory _memory;
+static float _filterMemory[MAX_BAND_VIEWS][FILTER_BANK_ARRAYS * MAX_VIEW_BANDS];
+
+//time (ms) from the onset to the first frame whose level reached -6 dB of the steady level, median and longest over the onsets
+struct Latency{
+  float median;
+  float longest;
+};
+
+//ADC samples as the I2S driver delivers them: silence, then the tone from the onset on, over a little noise
+static void makeSamples(std::vector<AudioSample>& samples, uint32_t onset, uint32_t samplingFrequency){
+  uint32_t noise = 1;
+  for (uint32_t i = 0; i < samples.size(); i++) {
+    noise ^= noise << 13;
+    noise ^= noise >> 17;
+    noise ^= noise << 5;
+    float tone = i < onset ? 0.0f : TONE_AMPLITUDE * sinf(TWO_PI * TONE_FREQ * (float)(i - onset) / samplingFrequency);
+    samples[i] = ADC_MIDSCALE + (int)lroundf(tone) + (int)(noise % 5) - 2;
+  }
+}
+
+static Latency summarize(std::vector<float>& latencies){
+  std::sort(latencies.begin(), latencies.end());
+  return {latencies[latencies.size() / 2], latencies.back()};
+}
+
+//the display reads FFT_SIZE samples per frame, so a frame ends every FFT_SIZE samples
+static Latency measureFftLatency(){
+  Analyzer analyzer(&_memory, NO_OF_LED_BANDS, _ledBands);
+  uint32_t samplingFrequency = analyzer.getSamplingFrequency();
+  std::vector<AudioSample> samples(ONSET_LEAD + FFT_SIZE + ONSET_TAIL);
+  float bands[MAX_VIEW_BANDS];
+
+  makeSamples(samples, 0, samplingFrequency);
+  analyzer.loadSamples(&samples[FFT_SIZE]);
+  analyzer.convertToBands(bands);
+  float threshold = bands[TONE_BAND] / 2;
+
+  std::vector<float> latencies;
+  uint32_t seed = 1;
+  for (uint16_t n = 0; n < ONSETS; n++) {
+    seed = seed * 1664525 + 1013904223;
+    uint32_t onset = ONSET_LEAD + (seed >> 8) % FFT_SIZE;
+    makeSamples(samples, onset, samplingFrequency);
+
+    uint32_t end = ONSET_LEAD + FFT_SIZE;
+    for (; end <= samples.size(); end += FFT_SIZE) {
+      analyzer.loadSamples(&samples[end - FFT_SIZE]);
+      analyzer.convertToBands(bands);
+      if(bands[TONE_BAND] >= threshold){
+        break;
+      }
+    }
+    latencies.push_back((end - onset) * 1000.0f / samplingFrequency);
+  }
+  return summarize(latencies);
+}
+
+//the filter bank engine ends a frame with every block
+static Latency measureFilterBankLatency(uint16_t blockSize, uint32_t samplingFrequency){
+  FilterBank filterBank;
+  filterBank.begin(_filterMemory[0], MAX_VIEW_BANDS);
+  std::vector<AudioSample> samples(ONSET_LEAD + FFT_SIZE + ONSET_TAIL);
+  float levels[MAX_VIEW_BANDS];
+
+  makeSamples(samples, 0, samplingFrequency);
+  filterBank.design(_ledBands, NO_OF_LED_BANDS, samplingFrequency);
+  filterBank.process(samples.data(), samples.size(), ADC_OFFSET);
+  filterBank.getLevels(levels, FILTER_BANK_GAIN);
+  float threshold = levels[TONE_BAND] / 2;
+
+  std::vector<float> latencies;
+  uint32_t seed = 1;
+  for (uint16_t n = 0; n < ONSETS; n++) {
+    seed = seed * 1664525 + 1013904223;
+    uint32_t onset = ONSET_LEAD + (seed >> 8) % FFT_SIZE;
+    makeSamples(samples, onset, samplingFrequency);
+    filterBank.design(_ledBands, NO_OF_LED_BANDS, samplingFrequency); //clears the states
+
+    uint32_t end = 0;
+    for (; end + blockSize <= samples.size(); ) {
+      filterBank.process(&samples[end], blockSize, ADC_OFFSET);
+      end += blockSize;
+      filterBank.getLevels(levels, FILTER_BANK_GAIN);
+      if(end > onset && levels[TONE_BAND] >= threshold){
+        break;
+      }
+    }
+    latencies.push_back((end - onset) * 1000.0f / samplingFrequency);
+  }
+  return summarize(latencies);
+}
+
+//CPU time (ms) the FFT engine takes per second of audio, with the LED view alone or with every view
+static double measureFftCpu(bool allViews){
+  Analyzer analyzer(&_memory, NO_OF_LED_BANDS, _ledBands);
+  if(allViews){
+    analyzer.addBandView("web", _webBands, NO_OF_WEB_BANDS);
+    analyzer.addBandView("lighting", _lightingBands, NO_OF_LIGHTING_BANDS);
+  }
+  uint32_t samplingFrequency = analyzer.getSamplingFrequency();
+  uint32_t noOfFrames = CPU_SECONDS * samplingFrequency / FFT_SIZE;
+  std::vector<AudioSample> samples(FFT_SIZE * 16);
+  makeSamples(samples, 0, samplingFrequency);
+  float bands[MAX_VIEW_BANDS];
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t f = 0; f < noOfFrames; f++) {
+    analyzer.loadSamples(&samples[(f % 16) * FFT_SIZE]);
+    analyzer.convertToBands(bands);
+  }
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / CPU_SECONDS;
+}
+
+//CPU time (ms) the filter bank engine takes per second of audio, with the LED view alone or with every view
+static double measureFilterBankCpu(bool allViews, uint16_t blockSize, uint32_t samplingFrequency){
+  FilterBank filterBanks[3];
+  const unsigned short* bandTables[3] = {_ledBands, _webBands, _lightingBands};
+  const uint8_t noOfBands[3] = {NO_OF_LED_BANDS, NO_OF_WEB_BANDS, NO_OF_LIGHTING_BANDS};
+  uint8_t noOfViews = allViews ? 3 : 1;
+  for (uint8_t v = 0; v < noOfViews; v++) {
+    filterBanks[v].begin(_filterMemory[v], MAX_VIEW_BANDS);
+    filterBanks[v].design(bandTables[v], noOfBands[v], samplingFrequency);
+  }
+  std::vector<AudioSample> samples(samplingFrequency);
+  makeSamples(samples, 0, samplingFrequency);
+  float levels[MAX_VIEW_BANDS];
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint16_t s = 0; s < CPU_SECONDS; s++) {
+    for (uint32_t i = 0; i + blockSize <= samples.size(); i += blockSize) {
+      for (uint8_t v = 0; v < noOfViews; v++) {
+        filterBanks[v].process(&samples[i], blockSize, ADC_OFFSET);
+        filterBanks[v].getLevels(levels, FILTER_BANK_GAIN);
+      }
+    }
+  }
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / CPU_SECONDS;
+}
+
+void benchFilterBank(){
+  uint32_t samplingFrequency = Analyzer(&_memory, NO_OF_LED_BANDS, _ledBands).getSamplingFrequency();
+  uint8_t allBands = NO_OF_LED_BANDS + NO_OF_WEB_BANDS + NO_OF_LIGHTING_BANDS;
+
+  printf("%-32s%12s%12s%14s%14s\n", "engine", "median", "longest", "CPU LED view", "CPU all views");
+  Latency latency = measureFftLatency();
+  printf("FFT, %-27u%9.1f ms%9.1f ms%8.2f ms/s%8.2f ms/s\n", FFT_SIZE, latency.median, latency.longest, measureFftCpu(false), measureFftCpu(true));
+
+  for (uint16_t blockSize : _blockSizes) {
+    latency = measureFilterBankLatency(blockSize, samplingFrequency);
+    printf("filter bank, %-19u%9.1f ms%9.1f ms%8.2f ms/s%8.2f ms/s\n", blockSize, latency.median, latency.longest,
+      measureFilterBankCpu(false, blockSize, samplingFrequency), measureFilterBankCpu(true, blockSize, samplingFrequency));
+  }
+  printf("(latency: %u Hz tone to -6 dB of its steady level over %u onsets; CPU: per second of audio, %u bands with every view)\n", TONE_FREQ, ONSETS, allBands);
+}
@@ -0,0 +1,56 @@
+//writes frame records through SerialTelemetry at a set frame rate, with lines of text printed between them as the firmware does, and reports
+//how many were sent and dropped. tools/telemetry_loopback_test.py reads them back through a pty and checks them with the decoder.
+#include "Bench.h"
+#include "SerialTelemetry.h"
+#include "SimConfig.h"
+
+#define TELEMETRY_BENCH_BAUD 115200 //SERIAL_BAUD of main.cpp
+#define TELEMETRY_BENCH_TX_BUFFER 1024 //TELEMETRY_TX_BUFFER of main.cpp
+
+//arguments: telemetry <bands> <frames per second> <frames> <frames between text lines (0 for none)>
+bool writeTelemetry(const std::vector<std::string>& arguments){
+  if(arguments.size() != 5){
+    fprintf(stderr, "usage: program --serial <port> -- telemetry <bands> <frames per second> <frames> <frames between text lines>\n");
+    return false;
+  }
+  uint8_t noOfBands = constrain(atoi(arguments[1].c_str()), 1, TELEMETRY_MAX_BANDS);
+  uint32_t framesPerSecond = max(atoi(arguments[2].c_str()), 1);
+  uint32_t noOfFrames = atoi(arguments[3].c_str());
+  uint32_t textEvery = atoi(arguments[4].c_str());
+
+  Serial.setTxBufferSize(TELEMETRY_BENCH_TX_BUFFER);
+  Serial.begin(TELEMETRY_BENCH_BAUD);
+  SerialTelemetry* telemetry = new SerialTelemetry(&Serial);
+
+  float levels[TELEMETRY_MAX_BANDS];
+  uint8_t peaks[TELEMETRY_MAX_BANDS];
+  uint32_t stageMicros[NUM_LATENCY_STAGES];
+  uint32_t textLines = 0;
+  int64_t start = esp_timer_get_time();
+
+  for (uint32_t f = 0; f < noOfFrames; f++) {
+    int64_t wait = start + (int64_t)f * 1000000 / framesPerSecond - esp_timer_get_time();
+    if(wait > 0){
+      delayMicroseconds(wait);
+    }
+
+    //levels and peaks that sweep over the bands, so the records hold 0 bytes for the COBS framing to remove
+    for (uint8_t b = 0; b < noOfBands; b++) {
+      levels[b] = ((f + b * 7) % 64) / 63.0f;
+      peaks[b] = (f / 4 + b) % 10;
+    }
+    for (uint8_t s = 0; s < NUM_LATENCY_STAGES; s++) {
+      stageMicros[s] = 1000 * s + f % 1000;
+    }
+    telemetry->publish(levels, peaks, noOfBands, 10, stageMicros, 250, 0);
+
+    if(textEvery > 0 && f % textEvery == textEvery - 1){
+      Serial.printf("Text line %u between the records\n", (unsigned)textLines++);
+    }
+  }
+
+  printf("TELEMETRY {\"frames\":%u,\"sent\":%u,\"dropped\":%u,\"textLines\":%u}\n", (unsigned)noOfFrames, (unsigned)telemetry->getRecordsSent(),
+    (unsigned)telemetry->getRecordsDropped(), (unsigned)textLines);
+  fflush(stdout);
+  return true;
+}
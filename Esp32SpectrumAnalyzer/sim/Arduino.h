@@ -0,0 +1,87 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+//POSIX stand-in for the parts of the ESP32 Arduino core the firmware uses, so the unmodified sources build and run on Linux (see SimConfig.h)
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_intr_alloc.h"
+#include "WString.h"
+#include "Print.h"
+#include "IPAddress.h"
+#include "HardwareSerial.h"
+#include "Esp.h"
+
+#define ARDUINO_RUNNING_CORE 1 //core setup() and loop() run on
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define sq(x) ((x)*(x))
+#define _min(a,b) ((a)<(b)?(a):(b))
+#define _max(a,b) ((a)>(b)?(a):(b))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+using std::min;
+using std::max;
+using std::isinf;
+using std::isnan;
+
+void setup(); //defined by the sketch
+void loop(); //defined by the sketch
+
+unsigned long millis(); //time since the start (ms)
+unsigned long micros(); //time since the start (us)
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin); //every input reads HIGH (nothing pressed, the pull-ups win)
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+int ets_printf(const char* format, ...); //ROM printf of the ESP32, which does not allocate (writes to stderr)
+
+#endif
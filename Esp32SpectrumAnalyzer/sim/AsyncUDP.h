@@ -0,0 +1,56 @@
+#ifndef AsyncUDP_h
+#define AsyncUDP_h
+
+//AsyncUDP on POSIX sockets. Every listening socket gets a receive thread that calls the packet handler, as the UDP task does on the ESP32.
+//sockets are bound to the station address (--ip) and multicast goes over the loopback interface, so an analyzer and display nodes simulated
+//on the same host stream to each other, each answering clock sync on its own address.
+#include "Arduino.h"
+#include "IPAddress.h"
+#include <functional>
+#include <thread>
+#include <atomic>
+
+class AsyncUDP;
+
+class AsyncUDPPacket {
+  private:
+    AsyncUDP* _udp; //socket the packet arrived on (replies are sent from it)
+    uint8_t* _data; //contents
+    size_t _length; //length of the contents
+    IPAddress _remoteIP; //sender
+    uint16_t _remotePort; //port of the sender
+
+  public:
+    AsyncUDPPacket(AsyncUDP* udp, uint8_t* data, size_t length, IPAddress remoteIP, uint16_t remotePort);
+    uint8_t* data();
+    size_t length();
+    IPAddress remoteIP();
+    uint16_t remotePort();
+    size_t write(const uint8_t* data, size_t length); //replies to the sender
+};
+
+typedef std::function<void(AsyncUDPPacket& packet)> AuPacketHandlerFunction;
+
+class AsyncUDP {
+  private:
+    int _socket; //UDP socket (-1 until used)
+    std::atomic<bool> _listening; //flag to indicate the receive thread runs
+    std::thread _receiver; //receive thread
+    AuPacketHandlerFunction _handler; //called for every packet received
+    bool open(uint32_t address, uint16_t port); //creates the socket and binds it to the address (network order) and port
+    void startReceiving(); //starts the receive thread
+    void receiveThread(); //receives packets until closed
+
+  public:
+    AsyncUDP();
+    ~AsyncUDP();
+    bool listen(uint16_t port);
+    bool listenMulticast(const IPAddress& address, uint16_t port, uint8_t ttl = 1);
+    size_t writeTo(const uint8_t* data, size_t length, const IPAddress& address, uint16_t port);
+    size_t broadcastTo(const uint8_t* data, size_t length, uint16_t port);
+    void onPacket(AuPacketHandlerFunction handler);
+    bool connected();
+    void close();
+};
+
+#endif
@@ -0,0 +1,254 @@
+#ifndef ESPAsyncWebServer_h
+#define ESPAsyncWebServer_h
+
+//ESPAsyncWebServer on a POSIX socket bound to the station address (port 80 is moved to --http-port). As with AsyncTCP, every connection is
+//served by one task ("async_tcp", on CONFIG_ASYNC_TCP_RUNNING_CORE) that runs the middleware and handlers as requests complete and fills
+//responses as the socket takes them, so a slow client never holds up the others. One request per connection (Connection: close).
+#include "Arduino.h"
+#include "IPAddress.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifndef CONFIG_ASYNC_TCP_RUNNING_CORE
+#define CONFIG_ASYNC_TCP_RUNNING_CORE -1
+#endif
+#ifndef CONFIG_ASYNC_TCP_PRIORITY
+#define CONFIG_ASYNC_TCP_PRIORITY 10
+#endif
+
+#define RESPONSE_TRY_AGAIN 0xFFFFFFFF //returned by a filler that has nothing yet
+
+typedef enum {
+  HTTP_GET = 0b00000001,
+  HTTP_POST = 0b00000010,
+  HTTP_DELETE = 0b00000100,
+  HTTP_PUT = 0b00001000,
+  HTTP_PATCH = 0b00010000,
+  HTTP_HEAD = 0b00100000,
+  HTTP_OPTIONS = 0b01000000,
+  HTTP_ANY = 0b01111111,
+} WebRequestMethod;
+
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+struct SimConnection;
+
+class AsyncWebParameter {
+  private:
+    String _name; //name of the parameter
+    String _value; //decoded value
+    bool _isPost; //flag to indicate it came from a form body rather than the query
+
+  public:
+    AsyncWebParameter(const String& name, const String& value, bool isPost);
+    const String& name() const;
+    const String& value() const;
+    size_t size() const;
+    bool isPost() const;
+    bool isFile() const;
+};
+
+class AsyncWebHeader {
+  private:
+    String _name; //name of the header
+    String _value; //value of the header
+
+  public:
+    AsyncWebHeader(const String& name, const String& value);
+    const String& name() const;
+    const String& value() const;
+};
+
+class AsyncClient {
+  private:
+    IPAddress _remoteIP; //address of the client
+    uint16_t _remotePort; //port of the client
+
+  public:
+    AsyncClient(IPAddress remoteIP, uint16_t remotePort);
+    IPAddress remoteIP() const;
+    uint16_t remotePort() const;
+};
+
+typedef std::function<size_t(uint8_t* buffer, size_t maxLen, size_t index)> AwsResponseFiller;
+
+class AsyncWebServerResponse {
+  protected:
+    int _code; //HTTP status code
+    String _contentType; //content type
+    size_t _contentLength; //length of the body (unknown for chunked responses)
+    bool _chunked; //flag to indicate the body is sent chunked
+    std::vector<AsyncWebHeader> _headers; //extra headers
+
+  public:
+    AsyncWebServerResponse(int code, const String& contentType);
+    virtual ~AsyncWebServerResponse();
+    void setCode(int code);
+    int code() const;
+    void setContentType(const String& type);
+    void setContentLength(size_t length);
+    bool addHeader(const char* name, const char* value, bool replaceExisting = true);
+    bool addHeader(const String& name, const String& value, bool replaceExisting = true);
+    std::string buildHead(); //status line and headers
+    virtual size_t fillBody(uint8_t* buffer, size_t maxLen, size_t index) = 0; //writes the next part of the body. Returns 0 once it is complete.
+    bool isChunked() const;
+    size_t getContentLength() const;
+};
+
+class AsyncBasicResponse : public AsyncWebServerResponse {
+  private:
+    std::string _content; //body
+
+  public:
+    AsyncBasicResponse(int code, const String& contentType, const uint8_t* content, size_t length);
+    size_t fillBody(uint8_t* buffer, size_t maxLen, size_t index) override;
+};
+
+class AsyncCallbackResponse : public AsyncWebServerResponse {
+  private:
+    AwsResponseFiller _filler; //writes the body part by part
+
+  public:
+    AsyncCallbackResponse(const String& contentType, size_t length, AwsResponseFiller filler, bool chunked);
+    size_t fillBody(uint8_t* buffer, size_t maxLen, size_t index) override;
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+  private:
+    std::string _content; //everything printed
+
+  public:
+    AsyncResponseStream(const String& contentType, size_t bufferSize);
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    size_t fillBody(uint8_t* buffer, size_t maxLen, size_t index) override;
+};
+
+typedef std::function<void(void)> ArDisconnectHandler;
+
+class AsyncWebServerRequest {
+  friend class AsyncWebServer;
+
+  private:
+    AsyncClient _client; //the connection the request came on
+    WebRequestMethodComposite _method; //method of the request
+    String _url; //path, without the query
+    std::vector<AsyncWebParameter> _params; //query and form parameters
+    std::vector<AsyncWebHeader> _headers; //request headers
+    std::string _body; //body (when it is not a form)
+    AsyncWebServerResponse* _response; //response sent by the handler (nullptr until sent)
+    ArDisconnectHandler _onDisconnect; //called once the connection is closed
+
+  public:
+    void* _tempObject; //free for the handlers
+    AsyncWebServerRequest(IPAddress remoteIP, uint16_t remotePort);
+    ~AsyncWebServerRequest();
+    AsyncClient* client();
+    WebRequestMethodComposite method() const;
+    const char* methodToString() const;
+    const String& url() const;
+    size_t contentLength() const;
+    const std::string& body() const;
+    const String& contentType() const;
+
+    bool hasParam(const char* name, bool post = false, bool file = false) const;
+    bool hasParam(const String& name, bool post = false, bool file = false) const;
+    const AsyncWebParameter* getParam(const char* name, bool post = false, bool file = false) const;
+    const AsyncWebParameter* getParam(const String& name, bool post = false, bool file = false) const;
+    const AsyncWebParameter* getParam(size_t index) const;
+    size_t params() const;
+    const String& arg(const char* name) const;
+    bool hasHeader(const char* name) const;
+    const String& header(const char* name) const;
+    size_t headers() const;
+
+    void onDisconnect(ArDisconnectHandler handler); //replaces the handler set before, as in ESPAsyncWebServer
+    void send(AsyncWebServerResponse* response);
+    void send(int code, const char* contentType = "", const char* content = "");
+    void send(int code, const char* contentType, const String& content);
+    void send(int code, const String& contentType, const String& content);
+    void send(int code, const char* contentType, const uint8_t* content, size_t length);
+    AsyncWebServerResponse* beginResponse(int code, const char* contentType = "", const char* content = "");
+    AsyncWebServerResponse* beginResponse(int code, const char* contentType, const String& content);
+    AsyncWebServerResponse* beginResponse(int code, const String& contentType, const String& content);
+    AsyncWebServerResponse* beginResponse(int code, const char* contentType, const uint8_t* content, size_t length);
+    AsyncWebServerResponse* beginResponse(const char* contentType, size_t length, AwsResponseFiller filler);
+    AsyncWebServerResponse* beginResponse(const String& contentType, size_t length, AwsResponseFiller filler);
+    AsyncWebServerResponse* beginChunkedResponse(const char* contentType, AwsResponseFiller filler);
+    AsyncWebServerResponse* beginChunkedResponse(const String& contentType, AwsResponseFiller filler);
+    AsyncResponseStream* beginResponseStream(const char* contentType, size_t bufferSize = 1460);
+    AsyncResponseStream* beginResponseStream(const String& contentType, size_t bufferSize = 1460);
+
+    AsyncWebServerResponse* takeResponse(); //hands the response over to the server
+    void disconnected(); //calls the disconnect handler
+};
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total)> ArBodyHandlerFunction;
+typedef std::function<bool(AsyncWebServerRequest* request)> ArRequestFilterFunction;
+typedef std::function<void(void)> ArMiddlewareNext;
+typedef std::function<void(AsyncWebServerRequest* request, ArMiddlewareNext next)> ArMiddlewareCallback;
+
+class AsyncMiddleware {
+  public:
+    virtual ~AsyncMiddleware() {}
+    virtual void run(AsyncWebServerRequest* request, ArMiddlewareNext next) = 0;
+};
+
+class AsyncMiddlewareFunction : public AsyncMiddleware {
+  private:
+    ArMiddlewareCallback _callback; //the middleware
+
+  public:
+    AsyncMiddlewareFunction(ArMiddlewareCallback callback);
+    void run(AsyncWebServerRequest* request, ArMiddlewareNext next) override;
+};
+
+class AsyncCallbackWebHandler {
+  friend class AsyncWebServer;
+
+  private:
+    String _uri; //path served ("/x" also serves "/x/...", "/x*" serves every path starting with "/x")
+    WebRequestMethodComposite _method; //methods served
+    ArRequestHandlerFunction _onRequest; //called once the request is complete
+    ArBodyHandlerFunction _onBody; //called with the body in chunks as it arrives, before the middleware and the request handler
+    ArRequestFilterFunction _filter; //the handler only serves requests the filter accepts
+
+  public:
+    AsyncCallbackWebHandler(const String& uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest, ArBodyHandlerFunction onBody);
+    bool canHandle(AsyncWebServerRequest* request) const;
+    AsyncCallbackWebHandler& setFilter(ArRequestFilterFunction filter);
+};
+
+class AsyncWebServer {
+  private:
+    uint16_t _port; //port asked for (80 is moved to --http-port)
+    int _socket; //listening socket (-1 until begin)
+    TaskHandle_t _task; //the async TCP task
+    std::vector<AsyncCallbackWebHandler*> _handlers; //handlers in the order they were added
+    std::vector<AsyncMiddleware*> _middlewares; //middleware run before every handler
+    ArRequestHandlerFunction _notFound; //called when no handler serves the request
+    static void tcpTask(void* pvParameters); //accepts and serves the connections
+    bool readRequest(SimConnection* connection); //parses the request once it is complete. Returns false if the connection has to be dropped.
+    void handleRequest(AsyncWebServerRequest* request); //runs the middleware and the handler
+    void runMiddleware(AsyncWebServerRequest* request, size_t index, AsyncCallbackWebHandler* handler);
+    bool writeResponse(SimConnection* connection); //sends what the socket takes. Returns false once the response is complete.
+
+  public:
+    AsyncWebServer(uint16_t port);
+    ~AsyncWebServer();
+    void begin();
+    void end();
+    AsyncCallbackWebHandler& on(const char* uri, ArRequestHandlerFunction onRequest);
+    AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload = nullptr, ArBodyHandlerFunction onBody = nullptr);
+    void onNotFound(ArRequestHandlerFunction handler);
+    AsyncMiddlewareFunction* addMiddleware(ArMiddlewareCallback callback);
+    void addMiddleware(AsyncMiddleware* middleware);
+};
+
+#endif
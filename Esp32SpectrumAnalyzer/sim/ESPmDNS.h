@@ -0,0 +1,16 @@
+#ifndef ESPmDNS_h
+#define ESPmDNS_h
+
+#include "Arduino.h"
+
+//host names are not announced: the firmware is reached at 127.0.0.1
+class MDNSResponder {
+  public:
+    bool begin(const String& hostName);
+    void end();
+    bool addService(const char* service, const char* protocol, uint16_t port);
+};
+
+extern MDNSResponder MDNS;
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef Esp_h
+#define Esp_h
+
+#include <stdint.h>
+
+#define SIM_HEAP_SIZE 327680 //heap of an ESP32 with WiFi started. The heap figures are this minus what the process has allocated.
+
+class EspClass {
+  public:
+    uint32_t getHeapSize(); //returns SIM_HEAP_SIZE
+    uint32_t getFreeHeap(); //returns SIM_HEAP_SIZE less the bytes allocated by the process
+    uint32_t getMinFreeHeap(); //returns the lowest free heap seen so far
+    uint32_t getMaxAllocHeap(); //returns the free heap (the host heap does not fragment the way the ESP32 heap does)
+    void restart(); //ends the simulation
+};
+
+extern EspClass ESP;
+
+#endif
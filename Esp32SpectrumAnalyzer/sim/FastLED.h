@@ -0,0 +1,53 @@
+#ifndef FastLED_h
+#define FastLED_h
+
+//FastLED with a frame capture sink instead of an LED strip. show() takes as long as sending the frame to WS2812 LEDs would (30 us per LED,
+//unless --no-led-timing) and, with --leds <file>, appends the frame to the capture file:
+//  header: "SIMLEDS1", uint16 number of LEDs
+//  frame: int64 esp_timer time of the show (us), uint8 brightness, then R, G, B of every LED in strip order (before brightness)
+//all little endian. tools/led_capture.py reads it back.
+#include "Arduino.h"
+#include "crgb.h"
+
+typedef enum { RGB = 0012, RBG = 0021, GRB = 0102, GBR = 0120, BRG = 0201, BGR = 0210 } EOrder;
+typedef enum { TypicalSMD5050 = 0xFFB0F0, TypicalLEDStrip = 0xFFB0F0, UncorrectedColor = 0xFFFFFF } LEDColorCorrection;
+enum { WS2811, WS2812, WS2812B, WS2813, SK6812, NEOPIXEL }; //chipsets (all clocked out at the WS2812 rate)
+
+#define WS2812_MICROS_PER_LED 30 //24 bits at 800 kHz
+#define WS2812_RESET_MICROS 50 //latch time after the last bit
+
+class CLEDController {
+  public:
+    CLEDController& setCorrection(LEDColorCorrection correction);
+    CLEDController& setCorrection(CRGB correction);
+};
+
+class CFastLED {
+  private:
+    CLEDController _controller; //the one strip
+    CRGB* _leds; //pixels of the strip
+    int _noOfLeds; //number of pixels
+    uint8_t _brightness; //global brightness
+    uint32_t _maxPowerMilliWatts; //power limit (kept, not applied)
+    void addStrip(CRGB* leds, int noOfLeds); //sets up the strip and the capture file
+
+  public:
+    CFastLED();
+    template<int CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER> CLEDController& addLeds(CRGB* leds, int noOfLeds, int offset = 0){
+      this->addStrip(leds + offset, noOfLeds);
+      return this->_controller;
+    }
+    void setBrightness(uint8_t scale);
+    uint8_t getBrightness();
+    void setMaxPowerInMilliWatts(uint32_t milliWatts);
+    void setMaxPowerInVoltsAndMilliamps(uint8_t volts, uint32_t milliAmps);
+    void clear(bool writeData = false);
+    void show();
+    void show(uint8_t scale);
+    int size();
+    CRGB* leds();
+};
+
+extern CFastLED FastLED;
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef HardwareSerial_h
+#define HardwareSerial_h
+
+#include <stdio.h>
+#include <mutex>
+#include "Print.h"
+
+#define SIM_UART_FIFO 128 //bytes the UART hardware FIFO holds, on top of the TX buffer
+
+//the serial port writes to standard output, or to the file given with --serial (eg. for binary telemetry records, also through a pty).
+//writes go out at once, but availableForWrite() reports the room a UART sending at the baud rate would have left in its TX buffer,
+//so code that only writes when there is room behaves as on the ESP32 when the port is overdriven.
+class HardwareSerial : public Print {
+  private:
+    FILE* _output; //where the port writes to
+    std::mutex _txLock; //guards the TX buffer model (any task can print)
+    unsigned long _baud; //rate the TX buffer drains at (10 bits per byte)
+    size_t _txBufferSize; //TX buffer set with setTxBufferSize (0 if none, as on the ESP32)
+    double _txQueued; //bytes written that the UART would not have sent yet
+    int64_t _txDrainTime; //time (us since boot) _txQueued was last worked out
+    void drain(); //takes the bytes sent since the last call off _txQueued
+
+  public:
+    HardwareSerial();
+    void begin(unsigned long baud);
+    void end();
+    size_t setTxBufferSize(size_t size);
+    size_t setRxBufferSize(size_t size);
+    int available(); //nothing is ever received
+    int read();
+    int peek();
+    int availableForWrite() override; //room left in the TX buffer and the FIFO
+    void flush();
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    operator bool() const;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef IPAddress_h
+#define IPAddress_h
+
+#include <stdint.h>
+#include "WString.h"
+
+//IPv4 address, kept in network order as on the ESP32
+class IPAddress {
+  private:
+    uint8_t _address[4]; //bytes of the address, most significant first
+
+  public:
+    IPAddress(); //0.0.0.0
+    IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth);
+    IPAddress(uint32_t address); //address in network order (as in sockaddr_in)
+    operator uint32_t() const; //address in network order
+    bool operator==(const IPAddress& other) const;
+    bool operator!=(const IPAddress& other) const;
+    uint8_t operator[](int index) const;
+    uint8_t& operator[](int index);
+    bool fromString(const char* address);
+    String toString() const;
+};
+
+#endif
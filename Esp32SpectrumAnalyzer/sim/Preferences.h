@@ -0,0 +1,45 @@
+#ifndef Preferences_h
+#define Preferences_h
+
+//NVS namespaces as files in the directory given with --nvs (one file per namespace, rewritten on every change like an NVS commit)
+#include "Arduino.h"
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+  private:
+    std::string _namespace; //open namespace (empty if none)
+    bool _readOnly; //flag to indicate the namespace was opened read-only
+    std::map<std::string, std::vector<uint8_t>> _entries; //keys and values of the open namespace
+    std::string getPath(); //file the namespace is kept in
+    bool commit(); //writes the namespace back to its file
+    size_t put(const char* key, const void* value, size_t length);
+    size_t get(const char* key, void* value, size_t length);
+
+  public:
+    Preferences();
+    ~Preferences();
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr); //a read-only namespace that was never written cannot be opened, as on the ESP32
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+    size_t getBytesLength(const char* key);
+    size_t putUChar(const char* key, uint8_t value);
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0);
+    size_t putUShort(const char* key, uint16_t value);
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0);
+    size_t putUInt(const char* key, uint32_t value);
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+    size_t putBool(const char* key, bool value);
+    bool getBool(const char* key, bool defaultValue = false);
+    size_t putFloat(const char* key, float value);
+    float getFloat(const char* key, float defaultValue = 0.0f);
+    size_t putString(const char* key, const String& value);
+    String getString(const char* key, const String& defaultValue = String());
+};
+
+#endif
@@ -0,0 +1,437 @@
+#include "Arduino.h"
+#include "SimConfig.h"
+#include <stdarg.h>
+#include <ctype.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <atomic>
+#include <random>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static std::mt19937 s_random(1); //random() (seeded, so runs repeat)
+static std::atomic<uint32_t> s_minFreeHeap(SIM_HEAP_SIZE); //lowest free heap reported
+
+static std::string formatNumber(unsigned long long value, int base){
+  if(base < 2 || base > 36){
+    base = 10;
+  }
+  if(value == 0){
+    return "0";
+  }
+
+  std::string digits;
+  while(value > 0){
+    int digit = value % base;
+    digits.insert(digits.begin(), (char)(digit < 10 ? '0' + digit : 'A' + digit - 10));
+    value /= base;
+  }
+  return digits;
+}
+
+static std::string formatSigned(long long value, int base){
+  if(base == 10 && value < 0){
+    return "-" + formatNumber(0ULL - (unsigned long long)value, base);
+  }
+  return formatNumber((unsigned long long)value, base);
+}
+
+static std::string formatFloat(double value, unsigned int decimalPlaces){
+  if(isnan(value)){
+    return "nan";
+  }
+  if(isinf(value)){
+    return "inf";
+  }
+
+  char text[64];
+  snprintf(text, sizeof(text), "%.*f", decimalPlaces, value);
+  return text;
+}
+
+//String
+
+String::String(){}
+String::String(const char* value) : _buffer(value == nullptr ? "" : value) {}
+String::String(const String& value) : _buffer(value._buffer) {}
+String::String(const std::string& value) : _buffer(value) {}
+String::String(char value) : _buffer(1, value) {}
+String::String(unsigned char value, unsigned char base) : _buffer(formatNumber(value, base)) {}
+String::String(int value, unsigned char base) : _buffer(formatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : _buffer(formatNumber(value, base)) {}
+String::String(long value, unsigned char base) : _buffer(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : _buffer(formatNumber(value, base)) {}
+String::String(long long value, unsigned char base) : _buffer(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : _buffer(formatNumber(value, base)) {}
+String::String(float value, unsigned int decimalPlaces) : _buffer(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces) : _buffer(formatFloat(value, decimalPlaces)) {}
+
+String& String::operator=(const String& value){
+  this->_buffer = value._buffer;
+  return *this;
+}
+
+String& String::operator=(const char* value){
+  this->_buffer = value == nullptr ? "" : value;
+  return *this;
+}
+
+bool String::reserve(unsigned int size){
+  this->_buffer.reserve(size);
+  return true;
+}
+
+unsigned int String::length() const { return this->_buffer.length(); }
+bool String::isEmpty() const { return this->_buffer.empty(); }
+const char* String::c_str() const { return this->_buffer.c_str(); }
+
+bool String::concat(const String& value){ this->_buffer += value._buffer; return true; }
+bool String::concat(const char* value){ if(value == nullptr) return false; this->_buffer += value; return true; }
+bool String::concat(const char* value, unsigned int length){ if(value == nullptr) return false; this->_buffer.append(value, length); return true; }
+bool String::concat(char value){ this->_buffer += value; return true; }
+bool String::concat(int value){ this->_buffer += formatSigned(value, 10); return true; }
+bool String::concat(unsigned int value){ this->_buffer += formatNumber(value, 10); return true; }
+bool String::concat(long value){ this->_buffer += formatSigned(value, 10); return true; }
+bool String::concat(unsigned long value){ this->_buffer += formatNumber(value, 10); return true; }
+bool String::concat(float value){ this->_buffer += formatFloat(value, 2); return true; }
+bool String::concat(double value){ this->_buffer += formatFloat(value, 2); return true; }
+
+bool String::equals(const String& other) const { return this->_buffer == other._buffer; }
+bool String::equals(const char* other) const { return this->_buffer == (other == nullptr ? "" : other); }
+
+bool String::equalsIgnoreCase(const String& other) const {
+  if(this->_buffer.length() != other._buffer.length()){
+    return false;
+  }
+  for(size_t i = 0; i < this->_buffer.length(); i++){
+    if(tolower((unsigned char)this->_buffer[i]) != tolower((unsigned char)other._buffer[i])){
+      return false;
+    }
+  }
+  return true;
+}
+
+bool String::operator<(const String& other) const { return this->_buffer < other._buffer; }
+bool String::startsWith(const String& prefix) const { return this->_buffer.compare(0, prefix._buffer.length(), prefix._buffer) == 0; }
+
+bool String::endsWith(const String& suffix) const {
+  return this->_buffer.length() >= suffix._buffer.length() && this->_buffer.compare(this->_buffer.length() - suffix._buffer.length(), suffix._buffer.length(), suffix._buffer) == 0;
+}
+
+char String::charAt(unsigned int index) const { return index < this->_buffer.length() ? this->_buffer[index] : 0; }
+char String::operator[](unsigned int index) const { return this->charAt(index); }
+char& String::operator[](unsigned int index){ return this->_buffer[index]; }
+
+int String::indexOf(char value, unsigned int from) const {
+  size_t index = this->_buffer.find(value, from);
+  return index == std::string::npos ? -1 : (int)index;
+}
+
+int String::indexOf(const String& value, unsigned int from) const {
+  size_t index = this->_buffer.find(value._buffer, from);
+  return index == std::string::npos ? -1 : (int)index;
+}
+
+int String::lastIndexOf(char value) const {
+  size_t index = this->_buffer.rfind(value);
+  return index == std::string::npos ? -1 : (int)index;
+}
+
+String String::substring(unsigned int from) const {
+  return from >= this->_buffer.length() ? String() : String(this->_buffer.substr(from));
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if(from > to){
+    std::swap(from, to);
+  }
+  return from >= this->_buffer.length() ? String() : String(this->_buffer.substr(from, to - from));
+}
+
+void String::replace(const String& find, const String& replacement){
+  if(find._buffer.empty()){
+    return;
+  }
+  for(size_t index = this->_buffer.find(find._buffer); index != std::string::npos; index = this->_buffer.find(find._buffer, index + replacement._buffer.length())){
+    this->_buffer.replace(index, find._buffer.length(), replacement._buffer);
+  }
+}
+
+void String::remove(unsigned int index, unsigned int count){
+  if(index < this->_buffer.length()){
+    this->_buffer.erase(index, count);
+  }
+}
+
+void String::toLowerCase(){ for(char& c : this->_buffer) c = tolower((unsigned char)c); }
+void String::toUpperCase(){ for(char& c : this->_buffer) c = toupper((unsigned char)c); }
+
+void String::trim(){
+  size_t first = this->_buffer.find_first_not_of(" \t\r\n\f\v");
+  if(first == std::string::npos){
+    this->_buffer.clear();
+    return;
+  }
+  size_t last = this->_buffer.find_last_not_of(" \t\r\n\f\v");
+  this->_buffer = this->_buffer.substr(first, last - first + 1);
+}
+
+long String::toInt() const { return atol(this->_buffer.c_str()); }
+float String::toFloat() const { return (float)atof(this->_buffer.c_str()); }
+double String::toDouble() const { return atof(this->_buffer.c_str()); }
+
+//as in the Arduino core, + appends to the left operand (a temporary), so chains build one string
+StringSumHelper& operator+(const StringSumHelper& left, const String& right){ StringSumHelper& sum = const_cast<StringSumHelper&>(left); sum.concat(right); return sum; }
+StringSumHelper& operator+(const StringSumHelper& left, const char* right){ StringSumHelper& sum = const_cast<StringSumHelper&>(left); sum.concat(right); return sum; }
+StringSumHelper& operator+(const StringSumHelper& left, char right){ StringSumHelper& sum = const_cast<StringSumHelper&>(left); sum.concat(right); return sum; }
+StringSumHelper& operator+(const StringSumHelper& left, int right){ StringSumHelper& sum = const_cast<StringSumHelper&>(left); sum.concat(right); return sum; }
+StringSumHelper& operator+(const StringSumHelper& left, unsigned int right){ StringSumHelper& sum = const_cast<StringSumHelper&>(left); sum.concat(right); return sum; }
+StringSumHelper& operator+(const StringSumHelper& left, long right){ StringSumHelper& sum = const_cast<StringSumHelper&>(left); sum.concat(right); return sum; }
+StringSumHelper& operator+(const StringSumHelper& left, unsigned long right){ StringSumHelper& sum = const_cast<StringSumHelper&>(left); sum.concat(right); return sum; }
+StringSumHelper& operator+(const StringSumHelper& left, float right){ StringSumHelper& sum = const_cast<StringSumHelper&>(left); sum.concat(right); return sum; }
+StringSumHelper& operator+(const StringSumHelper& left, double right){ StringSumHelper& sum = const_cast<StringSumHelper&>(left); sum.concat(right); return sum; }
+
+//Print
+
+size_t Print::write(const uint8_t* buffer, size_t size){
+  size_t written = 0;
+  while(size-- > 0 && this->write(*buffer++) == 1){
+    written++;
+  }
+  return written;
+}
+
+size_t Print::printf(const char* format, ...){
+  char small[128];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(small, sizeof(small), format, args);
+  va_end(args);
+  if(length < 0){
+    return 0;
+  }
+  if((size_t)length < sizeof(small)){
+    return this->write((const uint8_t*)small, length);
+  }
+
+  std::string large(length + 1, '\0');
+  va_start(args, format);
+  vsnprintf(&large[0], large.size(), format, args);
+  va_end(args);
+  return this->write((const uint8_t*)large.data(), length);
+}
+
+size_t Print::print(const String& value){ return this->write((const uint8_t*)value.c_str(), value.length()); }
+size_t Print::print(const char* value){ return this->write(value); }
+size_t Print::print(char value){ return this->write((uint8_t)value); }
+size_t Print::print(unsigned char value, int base){ return this->print(String(formatNumber(value, base))); }
+size_t Print::print(int value, int base){ return this->print(String(formatSigned(value, base))); }
+size_t Print::print(unsigned int value, int base){ return this->print(String(formatNumber(value, base))); }
+size_t Print::print(long value, int base){ return this->print(String(formatSigned(value, base))); }
+size_t Print::print(unsigned long value, int base){ return this->print(String(formatNumber(value, base))); }
+size_t Print::print(long long value, int base){ return this->print(String(formatSigned(value, base))); }
+size_t Print::print(unsigned long long value, int base){ return this->print(String(formatNumber(value, base))); }
+size_t Print::print(double value, int digits){ return this->print(String(formatFloat(value, digits))); }
+size_t Print::println(){ return this->write("\r\n"); }
+
+//HardwareSerial
+
+HardwareSerial::HardwareSerial(){
+  this->_output = stdout;
+  this->_baud = 115200;
+  this->_txBufferSize = 0;
+  this->_txQueued = 0;
+  this->_txDrainTime = 0;
+}
+
+void HardwareSerial::begin(unsigned long baud){
+  this->_baud = baud;
+  if(!g_simConfig.serialOutput.empty() && this->_output == stdout){
+    FILE* output = fopen(g_simConfig.serialOutput.c_str(), "wb");
+    if(output == nullptr){
+      fprintf(stderr, "sim: unable to open %s for the serial port\n", g_simConfig.serialOutput.c_str());
+      return;
+    }
+    setvbuf(output, nullptr, _IONBF, 0); //bytes reach a pty as the UART would send them, and nothing is lost when the simulation ends
+    this->_output = output;
+  }
+}
+
+void HardwareSerial::end(){
+  fflush(this->_output);
+}
+
+//as on the ESP32, a TX buffer must be larger than the FIFO
+size_t HardwareSerial::setTxBufferSize(size_t size){
+  this->_txBufferSize = size > SIM_UART_FIFO ? size : 0;
+  return this->_txBufferSize;
+}
+
+size_t HardwareSerial::setRxBufferSize(size_t size){ return size; }
+int HardwareSerial::available(){ return 0; }
+int HardwareSerial::read(){ return -1; }
+int HardwareSerial::peek(){ return -1; }
+
+int HardwareSerial::availableForWrite(){
+  std::lock_guard<std::mutex> guard(this->_txLock);
+  this->drain();
+  double room = this->_txBufferSize + SIM_UART_FIFO - this->_txQueued;
+  return room > 0 ? (int)room : 0;
+}
+
+void HardwareSerial::flush(){ fflush(this->_output); }
+
+size_t HardwareSerial::write(uint8_t value){
+  return this->write(&value, 1);
+}
+
+//the host never holds up a write, so more than the buffer holds is queued and availableForWrite() stays at 0 until the UART would have caught up
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size){
+  {
+    std::lock_guard<std::mutex> guard(this->_txLock);
+    this->drain();
+    this->_txQueued += size;
+  }
+  return fwrite(buffer, 1, size, this->_output);
+}
+
+void HardwareSerial::drain(){
+  int64_t now = esp_timer_get_time();
+  this->_txQueued -= (now - this->_txDrainTime) * (this->_baud / 10.0) / 1000000.0;
+  this->_txQueued = this->_txQueued > 0 ? this->_txQueued : 0;
+  this->_txDrainTime = now;
+}
+
+HardwareSerial::operator bool() const { return true; }
+
+//EspClass
+
+uint32_t EspClass::getHeapSize(){
+  return SIM_HEAP_SIZE;
+}
+
+uint32_t EspClass::getFreeHeap(){
+  struct mallinfo2 info = mallinfo2();
+  uint32_t free = info.uordblks >= SIM_HEAP_SIZE ? 0 : SIM_HEAP_SIZE - (uint32_t)info.uordblks;
+
+  uint32_t lowest = s_minFreeHeap.load();
+  while(free < lowest && !s_minFreeHeap.compare_exchange_weak(lowest, free)){
+  }
+  return free;
+}
+
+uint32_t EspClass::getMinFreeHeap(){
+  this->getFreeHeap();
+  return s_minFreeHeap.load();
+}
+
+uint32_t EspClass::getMaxAllocHeap(){
+  return this->getFreeHeap();
+}
+
+void EspClass::restart(){
+  simStop();
+}
+
+//IPAddress
+
+IPAddress::IPAddress(){
+  memset(this->_address, 0, sizeof(this->_address));
+}
+
+IPAddress::IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth){
+  this->_address[0] = first;
+  this->_address[1] = second;
+  this->_address[2] = third;
+  this->_address[3] = fourth;
+}
+
+IPAddress::IPAddress(uint32_t address){
+  memcpy(this->_address, &address, sizeof(this->_address));
+}
+
+IPAddress::operator uint32_t() const {
+  uint32_t address;
+  memcpy(&address, this->_address, sizeof(address));
+  return address;
+}
+
+bool IPAddress::operator==(const IPAddress& other) const { return memcmp(this->_address, other._address, sizeof(this->_address)) == 0; }
+bool IPAddress::operator!=(const IPAddress& other) const { return !(*this == other); }
+uint8_t IPAddress::operator[](int index) const { return this->_address[index]; }
+uint8_t& IPAddress::operator[](int index){ return this->_address[index]; }
+
+bool IPAddress::fromString(const char* address){
+  unsigned int parts[4];
+  char extra;
+  if(address == nullptr || sscanf(address, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &extra) != 4){
+    return false;
+  }
+  for(int i = 0; i < 4; i++){
+    if(parts[i] > 255){
+      return false;
+    }
+    this->_address[i] = parts[i];
+  }
+  return true;
+}
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", this->_address[0], this->_address[1], this->_address[2], this->_address[3]);
+  return String(text);
+}
+
+//GPIO: nothing is connected, so every input reads as released (the pull-ups win)
+
+void pinMode(uint8_t pin, uint8_t mode){}
+void digitalWrite(uint8_t pin, uint8_t value){}
+int digitalRead(uint8_t pin){ return pin < 64 && (g_simConfig.lowPins >> pin) & 1 ? LOW : HIGH; }
+
+long map(long x, long inMin, long inMax, long outMin, long outMax){
+  if(inMax == inMin){
+    return outMin;
+  }
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+long random(long max){
+  return max <= 0 ? 0 : (long)(s_random() % (unsigned long)max);
+}
+
+long random(long min, long max){
+  return min >= max ? min : min + random(max - min);
+}
+
+void randomSeed(unsigned long seed){
+  s_random.seed(seed);
+}
+
+//formatted into a buffer on the stack and written in one call, so it works inside the allocator hooks
+int ets_printf(const char* format, ...){
+  char buffer[256];
+  va_list arguments;
+  va_start(arguments, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, arguments);
+  va_end(arguments);
+
+  if(length > 0){
+    ssize_t written = write(STDERR_FILENO, buffer, length < (int)sizeof(buffer) ? length : sizeof(buffer) - 1);
+    (void)written;
+  }
+  return length;
+}
+
+const char* esp_err_to_name(esp_err_t code){
+  switch(code){
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    default: return "UNKNOWN ERROR";
+  }
+}
@@ -0,0 +1,188 @@
+#include "SimAudio.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SWEEP_SECONDS 10.0 //length of one logarithmic sweep from SWEEP_LOW to SWEEP_HIGH
+#define SWEEP_LOW 50.0
+#define SWEEP_HIGH 16000.0
+
+AudioSource g_audioSource;
+
+AudioSource::AudioSource(){
+  this->_fileRate = 0;
+  this->_filePosition = 0;
+  this->_generator = "sweep";
+  this->_sampleRate = 44100;
+  this->_sampleIndex = 0;
+  this->_noise = 0x12345678;
+  this->_gain = 0.5f;
+}
+
+static uint32_t readLittleEndian(const uint8_t* bytes, int length){
+  uint32_t value = 0;
+  for(int i = length - 1; i >= 0; i--){
+    value = (value << 8) | bytes[i];
+  }
+  return value;
+}
+
+//reads a RIFF WAVE file (PCM 8/16/24/32 bit or 32 bit float) and mixes it down to mono
+bool AudioSource::loadWav(const std::string& path){
+  FILE* file = fopen(path.c_str(), "rb");
+  if(file == nullptr){
+    fprintf(stderr, "sim: unable to open %s\n", path.c_str());
+    return false;
+  }
+
+  std::vector<uint8_t> contents;
+  uint8_t chunk[65536];
+  size_t length;
+  while((length = fread(chunk, 1, sizeof(chunk), file)) > 0){
+    contents.insert(contents.end(), chunk, chunk + length);
+  }
+  fclose(file);
+
+  if(contents.size() < 12 || memcmp(&contents[0], "RIFF", 4) != 0 || memcmp(&contents[8], "WAVE", 4) != 0){
+    fprintf(stderr, "sim: %s is not a WAV file\n", path.c_str());
+    return false;
+  }
+
+  uint16_t format = 0, noOfChannels = 0, bitsPerSample = 0;
+  const uint8_t* data = nullptr;
+  size_t dataLength = 0;
+
+  for(size_t position = 12; position + 8 <= contents.size();){
+    uint32_t chunkLength = readLittleEndian(&contents[position + 4], 4);
+    const uint8_t* body = &contents[position + 8];
+    size_t available = contents.size() - position - 8;
+
+    if(memcmp(&contents[position], "fmt ", 4) == 0 && chunkLength >= 16 && available >= 16){
+      format = readLittleEndian(body, 2);
+      noOfChannels = readLittleEndian(body + 2, 2);
+      this->_fileRate = readLittleEndian(body + 4, 4);
+      bitsPerSample = readLittleEndian(body + 14, 2);
+      if(format == 0xFFFE && chunkLength >= 26){
+        format = readLittleEndian(body + 24, 2); //WAVE_FORMAT_EXTENSIBLE: the format is the start of the sub-format GUID
+      }
+    }else if(memcmp(&contents[position], "data", 4) == 0){
+      data = body;
+      dataLength = chunkLength < available ? chunkLength : available;
+    }
+    position += 8 + chunkLength + (chunkLength & 1);
+  }
+
+  bool pcm = format == 1 && (bitsPerSample == 8 || bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32);
+  bool ieeeFloat = format == 3 && bitsPerSample == 32;
+  if(data == nullptr || noOfChannels == 0 || this->_fileRate == 0 || (!pcm && !ieeeFloat)){
+    fprintf(stderr, "sim: %s has no PCM or float audio\n", path.c_str());
+    return false;
+  }
+
+  size_t bytesPerSample = bitsPerSample / 8;
+  size_t noOfFrames = dataLength / (bytesPerSample * noOfChannels);
+  this->_file.resize(noOfFrames);
+
+  for(size_t f = 0; f < noOfFrames; f++){
+    float sum = 0;
+    for(uint16_t c = 0; c < noOfChannels; c++){
+      const uint8_t* sample = data + (f * noOfChannels + c) * bytesPerSample;
+      if(ieeeFloat){
+        float value;
+        memcpy(&value, sample, sizeof(value));
+        sum += value;
+      }else if(bitsPerSample == 8){
+        sum += (sample[0] - 128) / 128.0f; //8 bit PCM is unsigned
+      }else{
+        int32_t value = (int32_t)(readLittleEndian(sample, bytesPerSample) << (32 - bitsPerSample));
+        sum += value / 2147483648.0f;
+      }
+    }
+    this->_file[f] = sum / noOfChannels;
+  }
+
+  return noOfFrames > 0;
+}
+
+bool AudioSource::begin(const std::string& audioFile, const std::string& generator, float gain, uint32_t sampleRate){
+  this->_sampleRate = sampleRate;
+  this->_gain = gain;
+  this->_sampleIndex = 0;
+  this->_filePosition = 0;
+
+  if(!audioFile.empty()){
+    return this->loadWav(audioFile);
+  }
+
+  this->_generator = generator;
+  if(generator.compare(0, 5, "tone:") == 0){
+    this->_generator = "tone";
+    for(const char* next = generator.c_str() + 5; *next != '\0';){
+      char* end;
+      double frequency = strtod(next, &end);
+      if(end == next || frequency <= 0){
+        fprintf(stderr, "sim: bad tone list %s\n", generator.c_str());
+        return false;
+      }
+      this->_tones.push_back((float)frequency);
+      next = *end == ',' ? end + 1 : end;
+    }
+    return !this->_tones.empty();
+  }
+
+  if(generator != "sweep" && generator != "noise" && generator != "silence"){
+    fprintf(stderr, "sim: unknown generator %s\n", generator.c_str());
+    return false;
+  }
+  return true;
+}
+
+float AudioSource::next(){
+  double t = (double)this->_sampleIndex++ / this->_sampleRate;
+  float value = 0;
+
+  if(!this->_file.empty()){
+    //linear interpolation between the two nearest samples of the file
+    size_t index = (size_t)this->_filePosition;
+    double fraction = this->_filePosition - index;
+    float first = this->_file[index];
+    float second = this->_file[(index + 1) % this->_file.size()];
+    value = (float)(first + (second - first) * fraction);
+
+    this->_filePosition += (double)this->_fileRate / this->_sampleRate;
+    if(this->_filePosition >= this->_file.size()){
+      this->_filePosition -= this->_file.size();
+    }
+  }else if(this->_generator == "sweep"){
+    //logarithmic sweep, so every band gets the same time
+    double k = log(SWEEP_HIGH / SWEEP_LOW) / SWEEP_SECONDS;
+    double position = fmod(t, SWEEP_SECONDS);
+    value = (float)sin(2 * M_PI * SWEEP_LOW * (exp(k * position) - 1) / k);
+  }else if(this->_generator == "noise"){
+    this->_noise ^= this->_noise << 13;
+    this->_noise ^= this->_noise >> 17;
+    this->_noise ^= this->_noise << 5;
+    value = (float)((double)this->_noise / 2147483648.0 - 1.0);
+  }else if(this->_generator == "tone"){
+    for(float frequency : this->_tones){
+      value += (float)sin(2 * M_PI * frequency * t);
+    }
+    value /= this->_tones.size();
+  }
+
+  return value * this->_gain;
+}
+
+uint16_t AudioSource::nextRaw(){
+  long raw = lround(2048 + this->next() * 2047);
+  raw = raw < 0 ? 0 : (raw > 4095 ? 4095 : raw);
+  return (uint16_t)raw; //channel 0, so the top nibble stays 0
+}
+
+uint64_t AudioSource::getLength(){
+  if(this->_file.empty() || this->_fileRate == 0){
+    return 0;
+  }
+  return (uint64_t)((double)this->_file.size() * this->_sampleRate / this->_fileRate);
+}
@@ -0,0 +1,33 @@
+#ifndef SimAudio_h
+#define SimAudio_h
+
+//audio source of the simulated ADC: a WAV file (PCM 16 bit or float, mixed down to mono, resampled and looped) or a generator. Every source
+//is deterministic, so two runs with the same arguments feed the analyzer the same samples.
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class AudioSource {
+  private:
+    std::vector<float> _file; //samples of the WAV file at its own rate (empty when a generator is used)
+    uint32_t _fileRate; //sample rate of the WAV file
+    double _filePosition; //position in the file (samples, fractional when resampling)
+    std::string _generator; //generator used when there is no file
+    std::vector<float> _tones; //frequencies of the tone generator (Hz)
+    uint32_t _sampleRate; //rate the ADC samples at
+    uint64_t _sampleIndex; //samples made so far
+    uint32_t _noise; //state of the noise generator (xorshift)
+    float _gain; //amplitude (1 = full ADC range)
+    bool loadWav(const std::string& path);
+
+  public:
+    AudioSource();
+    bool begin(const std::string& audioFile, const std::string& generator, float gain, uint32_t sampleRate);
+    float next(); //next sample (-1..1)
+    uint16_t nextRaw(); //next sample as the I2S ADC delivers it: 12 bits, channel 0 in the top nibble
+    uint64_t getLength(); //samples of the WAV file at the ADC rate (0 for a generator, which does not end)
+};
+
+extern AudioSource g_audioSource;
+
+#endif
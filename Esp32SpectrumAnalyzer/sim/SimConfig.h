@@ -0,0 +1,51 @@
+#ifndef SimConfig_h
+#define SimConfig_h
+
+//Host simulation of the firmware (the native-sim environment in platformio.ini). The firmware sources build unmodified against the headers in
+//this directory, which put the ESP32 core, FreeRTOS, the I2S ADC, WiFi, the web server, NVS and FastLED on top of POSIX:
+//  audio: a WAV file (--audio) or a generator (--generator) feeds the I2S driver, in real time or as fast as the host allows (--fast)
+//  network: the web server and UDP sockets use the loopback interface at the station address (http://127.0.0.1:<--http-port> by default);
+//           an analyzer and display nodes run side by side when each gets its own address (--ip 127.0.0.2, ...)
+//  LEDs: FastLED.show() takes the WS2812 wire time and can write every frame to a capture file (--leds)
+//At the end (after --seconds of audio, or on Ctrl+C) a line starting with SIM_REPORT and holding the run statistics as JSON is printed;
+//tools/sim_benchmark.py compares it against a baseline.
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define SIM_DEFAULT_HTTP_PORT 8080 //port the web server on port 80 is moved to
+#define SIM_MAX_LATENCY_SAMPLES 65536 //latency samples kept for the percentiles
+#define SIM_CORE0_NICE 19 //host priority (nice) of the tasks pinned to core 0, below the frame loop on core 1
+
+struct SimConfig {
+  std::string audioFile; //WAV file played (looped), empty to use the generator
+  std::string generator; //"sweep", "noise", "silence" or "tone:<f1>[,<f2>...]" (Hz)
+  float gain; //amplitude of the source (1 = full ADC range)
+  bool fast; //flag to indicate buffers are made on demand instead of in real time
+  double seconds; //seconds of audio after which the simulation ends (0 = run until stopped)
+  std::string stationAddress; //loopback address of this instance (WiFi.localIP())
+  uint16_t httpPort; //port the web server listens on
+  std::string ledCapture; //file the LED frames are written to (empty for none)
+  bool ledTiming; //flag to indicate show() takes as long as the WS2812 wire time (on by default, except with --fast)
+  std::string nvsDirectory; //directory the NVS namespaces are kept in
+  std::string serialOutput; //file the serial port writes to (empty for stdout)
+  bool pinCores; //flag to indicate tasks are pinned to host CPUs matching their core
+  uint64_t lowPins; //GPIOs that read LOW (bit per pin), as if their buttons were held down
+  std::vector<std::string> programArguments; //arguments after --, for the host programs built on the simulation (batch/)
+};
+
+extern SimConfig g_simConfig;
+
+void simRecordBlock(int64_t completedAt); //called by the I2S driver when a DMA buffer is read (time it was completed, us)
+void simRecordBlockDropped(); //called by the I2S driver when a DMA buffer was overwritten before being read
+void simRecordShow(int64_t shownAt); //called by FastLED.show()
+void simRecordHttpRequest();
+void simRecordUdpSent();
+void simRecordUdpReceived();
+double simAudioSeconds(); //seconds of audio delivered so far
+void simAddAudioSamples(uint32_t samples, uint32_t sampleRate);
+void simStop(); //prints the report and ends the process
+void simCloseLedCapture(); //flushes the LED capture file
+void simRegisterLoopTask(); //makes the calling thread the Arduino loop task
+
+#endif
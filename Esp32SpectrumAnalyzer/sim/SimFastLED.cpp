@@ -0,0 +1,139 @@
+#include "FastLED.h"
+#include "SimConfig.h"
+#include <chrono>
+#include <thread>
+
+CFastLED FastLED;
+
+static FILE* s_capture = nullptr; //capture file (nullptr for none)
+
+uint8_t scale8(uint8_t value, uint8_t scale){
+  return ((uint16_t)value * (1 + (uint16_t)scale)) >> 8;
+}
+
+uint8_t qadd8(uint8_t first, uint8_t second){
+  unsigned int sum = (unsigned int)first + second;
+  return sum > 255 ? 255 : sum;
+}
+
+CRGB blend(const CRGB& first, const CRGB& second, uint8_t amountOfSecond){
+  uint8_t amountOfFirst = 255 - amountOfSecond;
+  return CRGB(qadd8(scale8(first.r, amountOfFirst), scale8(second.r, amountOfSecond)),
+              qadd8(scale8(first.g, amountOfFirst), scale8(second.g, amountOfSecond)),
+              qadd8(scale8(first.b, amountOfFirst), scale8(second.b, amountOfSecond)));
+}
+
+//hue in 8 sections of 32 as in hsv2rgb_rainbow (without its yellow boost), then saturation and value
+CRGB::CRGB(const CHSV& hsv){
+  uint8_t offset = (hsv.h & 0x1F) * 8; //position within the section (0..248)
+  uint8_t third = scale8(offset, 85);
+  uint8_t red, green, blue;
+
+  switch(hsv.h >> 5){
+    case 0: red = 255 - third; green = third; blue = 0; break;
+    case 1: red = 171; green = 85 + third; blue = 0; break;
+    case 2: red = 171 - third * 2; green = 170 + third; blue = 0; break;
+    case 3: red = 0; green = 255 - third; blue = third; break;
+    case 4: red = 0; green = 171 - third * 2; blue = 85 + third * 2; break;
+    case 5: red = third; green = 0; blue = 255 - third; break;
+    case 6: red = 85 + third; green = 0; blue = 171 - third; break;
+    default: red = 170 + third; green = 0; blue = 85 - third; break;
+  }
+
+  uint8_t desaturation = 255 - hsv.s;
+  uint8_t floor = scale8(desaturation, desaturation);
+  this->r = scale8(qadd8(scale8(red, hsv.s), floor), hsv.v);
+  this->g = scale8(qadd8(scale8(green, hsv.s), floor), hsv.v);
+  this->b = scale8(qadd8(scale8(blue, hsv.s), floor), hsv.v);
+}
+
+CRGB& CRGB::nscale8(uint8_t scale){
+  this->r = scale8(this->r, scale);
+  this->g = scale8(this->g, scale);
+  this->b = scale8(this->b, scale);
+  return *this;
+}
+
+CRGB& CRGB::fadeToBlackBy(uint8_t amount){
+  return this->nscale8(255 - amount);
+}
+
+CRGB& CRGB::operator+=(const CRGB& other){
+  this->r = qadd8(this->r, other.r);
+  this->g = qadd8(this->g, other.g);
+  this->b = qadd8(this->b, other.b);
+  return *this;
+}
+
+CLEDController& CLEDController::setCorrection(LEDColorCorrection correction){ return *this; }
+CLEDController& CLEDController::setCorrection(CRGB correction){ return *this; }
+
+CFastLED::CFastLED(){
+  this->_leds = nullptr;
+  this->_noOfLeds = 0;
+  this->_brightness = 255;
+  this->_maxPowerMilliWatts = 0;
+}
+
+void CFastLED::addStrip(CRGB* leds, int noOfLeds){
+  this->_leds = leds;
+  this->_noOfLeds = noOfLeds;
+
+  if(g_simConfig.ledCapture.empty() || s_capture != nullptr){
+    return;
+  }
+
+  s_capture = fopen(g_simConfig.ledCapture.c_str(), "wb");
+  if(s_capture == nullptr){
+    fprintf(stderr, "sim: unable to open %s for the LED capture\n", g_simConfig.ledCapture.c_str());
+    return;
+  }
+
+  uint16_t count = noOfLeds;
+  fwrite("SIMLEDS1", 1, 8, s_capture);
+  fwrite(&count, sizeof(count), 1, s_capture);
+}
+
+void CFastLED::setBrightness(uint8_t scale){ this->_brightness = scale; }
+uint8_t CFastLED::getBrightness(){ return this->_brightness; }
+void CFastLED::setMaxPowerInMilliWatts(uint32_t milliWatts){ this->_maxPowerMilliWatts = milliWatts; }
+void CFastLED::setMaxPowerInVoltsAndMilliamps(uint8_t volts, uint32_t milliAmps){ this->_maxPowerMilliWatts = volts * milliAmps; }
+
+void CFastLED::clear(bool writeData){
+  for(int i = 0; i < this->_noOfLeds; i++){
+    this->_leds[i] = CRGB::Black;
+  }
+  if(writeData){
+    this->show();
+  }
+}
+
+void CFastLED::show(){
+  this->show(this->_brightness);
+}
+
+//sends the frame: it is captured when the data starts going out, and the call returns once the strip has latched it
+void CFastLED::show(uint8_t scale){
+  int64_t start = esp_timer_get_time();
+  simRecordShow(start);
+
+  if(s_capture != nullptr){
+    fwrite(&start, sizeof(start), 1, s_capture);
+    fwrite(&scale, sizeof(scale), 1, s_capture);
+    fwrite(this->_leds, sizeof(CRGB), this->_noOfLeds, s_capture);
+  }
+
+  if(g_simConfig.ledTiming){
+    std::this_thread::sleep_for(std::chrono::microseconds(this->_noOfLeds * WS2812_MICROS_PER_LED + WS2812_RESET_MICROS)); //the RMT sends it, the core is free
+  }
+}
+
+int CFastLED::size(){ return this->_noOfLeds; }
+CRGB* CFastLED::leds(){ return this->_leds; }
+
+//called when the simulation ends
+void simCloseLedCapture(){
+  if(s_capture != nullptr){
+    fflush(s_capture);
+  }
+}
@@ -0,0 +1,254 @@
+#include "driver/i2s.h"
+#include "driver/adc.h"
+#include "SimAudio.h"
+#include "SimConfig.h"
+#include "Arduino.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//state of the one I2S port: the DMA buffers, the events and the buffer being read
+struct SimI2s {
+  bool installed; //flag to indicate the driver is installed
+  bool enabled; //flag to indicate the ADC runs
+  uint32_t sampleRate; //samples per second
+  int bufferCount; //number of DMA buffers
+  int bufferLength; //samples per DMA buffer
+  QueueHandle_t events; //event queue of the firmware (nullptr for none)
+  std::mutex lock; //guards the ring (shared with the DMA thread)
+  std::condition_variable completed; //signalled when the DMA thread completes a buffer
+  std::vector<std::vector<uint16_t>> buffers; //the DMA buffers
+  std::vector<int64_t> completedAt; //time each buffer was completed (us)
+  int first; //index of the oldest completed buffer
+  int filled; //completed buffers waiting to be read
+  std::vector<uint16_t> reading; //buffer being read
+  int64_t readingCompletedAt; //time the buffer being read was completed
+  size_t readPosition; //samples of it read so far
+  std::thread dma; //DMA thread (real time only)
+  bool stopping; //flag to tell the DMA thread to end
+};
+
+static SimI2s s_i2s;
+
+//posts an event the way the driver's interrupt does: when the queue is full the oldest event is dropped to make room
+static void postEvent(i2s_event_type_t type, size_t size){
+  if(s_i2s.events == nullptr){
+    return;
+  }
+
+  i2s_event_t event = {type, size};
+  if(xQueueSend(s_i2s.events, &event, 0) != pdPASS){
+    i2s_event_t dropped;
+    xQueueReceive(s_i2s.events, &dropped, 0);
+    xQueueSend(s_i2s.events, &event, 0);
+  }
+}
+
+static void fillBuffer(std::vector<uint16_t>& buffer){
+  for(uint16_t& sample : buffer){
+    sample = g_audioSource.nextRaw();
+  }
+}
+
+//completes a DMA buffer every bufferLength samples of audio, on the wall clock. When every buffer is waiting to be read, the oldest is overwritten.
+static void dmaThread(){
+  pthread_setname_np(pthread_self(), "i2s_dma");
+  auto period = std::chrono::nanoseconds((int64_t)s_i2s.bufferLength * 1000000000LL / s_i2s.sampleRate);
+  auto next = std::chrono::steady_clock::now() + period;
+  std::vector<uint16_t> buffer(s_i2s.bufferLength);
+
+  while(true){
+    std::this_thread::sleep_until(next);
+    next += period;
+    buffer.resize(s_i2s.bufferLength); //the ring hands back whatever buffer the reader swapped in last, which starts out empty
+    fillBuffer(buffer);
+
+    bool overflow = false;
+    {
+      std::lock_guard<std::mutex> guard(s_i2s.lock);
+      if(s_i2s.stopping){
+        return;
+      }
+      if(!s_i2s.enabled){
+        continue;
+      }
+
+      if(s_i2s.filled == s_i2s.bufferCount){
+        s_i2s.first = (s_i2s.first + 1) % s_i2s.bufferCount;
+        s_i2s.filled--;
+        overflow = true;
+      }
+      int index = (s_i2s.first + s_i2s.filled) % s_i2s.bufferCount;
+      s_i2s.buffers[index].swap(buffer);
+      s_i2s.completedAt[index] = esp_timer_get_time();
+      s_i2s.filled++;
+    }
+    s_i2s.completed.notify_one();
+
+    if(overflow){
+      simRecordBlockDropped();
+      postEvent(I2S_EVENT_RX_Q_OVF, 0);
+    }
+    postEvent(I2S_EVENT_RX_DONE, s_i2s.bufferLength * sizeof(uint16_t));
+  }
+}
+
+//takes the next completed buffer for reading. In real time it waits for the DMA thread; with --fast the buffer is made now unless the caller does not wait.
+static bool nextBuffer(TickType_t ticksToWait){
+  if(g_simConfig.seconds > 0 && simAudioSeconds() >= g_simConfig.seconds){
+    simStop();
+  }
+
+  if(g_simConfig.fast){
+    if(ticksToWait == 0){
+      return false; //nothing is ever waiting: the reader is always caught up
+    }
+    s_i2s.reading.resize(s_i2s.bufferLength);
+    fillBuffer(s_i2s.reading);
+    s_i2s.readingCompletedAt = esp_timer_get_time();
+    postEvent(I2S_EVENT_RX_DONE, s_i2s.bufferLength * sizeof(uint16_t));
+  }else{
+    std::unique_lock<std::mutex> guard(s_i2s.lock);
+    auto ready = []{ return s_i2s.filled > 0; };
+    if(ticksToWait == portMAX_DELAY){
+      s_i2s.completed.wait(guard, ready);
+    }else if(!s_i2s.completed.wait_for(guard, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), ready)){
+      return false;
+    }
+
+    s_i2s.reading.swap(s_i2s.buffers[s_i2s.first]);
+    s_i2s.readingCompletedAt = s_i2s.completedAt[s_i2s.first];
+    s_i2s.first = (s_i2s.first + 1) % s_i2s.bufferCount;
+    s_i2s.filled--;
+  }
+
+  s_i2s.readPosition = 0;
+  simRecordBlock(s_i2s.readingCompletedAt);
+  simAddAudioSamples(s_i2s.bufferLength, s_i2s.sampleRate);
+  return true;
+}
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t* config, int queueSize, void* queue){
+  if(port != I2S_NUM_0 || config == nullptr || config->dma_buf_count < 2 || config->dma_buf_len < 8 || config->bits_per_sample != I2S_BITS_PER_SAMPLE_16BIT){
+    return ESP_ERR_INVALID_ARG;
+  }
+  if(s_i2s.installed){
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  s_i2s.sampleRate = config->sample_rate;
+  s_i2s.bufferCount = config->dma_buf_count;
+  s_i2s.bufferLength = config->dma_buf_len;
+  s_i2s.buffers.assign(s_i2s.bufferCount, std::vector<uint16_t>(s_i2s.bufferLength));
+  s_i2s.completedAt.assign(s_i2s.bufferCount, 0);
+  s_i2s.first = 0;
+  s_i2s.filled = 0;
+  s_i2s.readPosition = 0;
+  s_i2s.reading.clear();
+  s_i2s.events = nullptr;
+  s_i2s.stopping = false;
+
+  if(!g_audioSource.begin(g_simConfig.audioFile, g_simConfig.generator, g_simConfig.gain, s_i2s.sampleRate)){
+    return ESP_FAIL;
+  }
+
+  if(queue != nullptr && queueSize > 0){
+    s_i2s.events = xQueueCreate(queueSize, sizeof(i2s_event_t));
+    *(QueueHandle_t*)queue = s_i2s.events;
+  }
+
+  s_i2s.installed = true;
+  if(!g_simConfig.fast){
+    s_i2s.dma = std::thread(dmaThread);
+  }
+  return ESP_OK;
+}
+
+esp_err_t i2s_driver_uninstall(i2s_port_t port){
+  if(!s_i2s.installed){
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(s_i2s.lock);
+    s_i2s.stopping = true;
+  }
+  if(s_i2s.dma.joinable()){
+    s_i2s.dma.join();
+  }
+  if(s_i2s.events != nullptr){
+    vQueueDelete(s_i2s.events);
+    s_i2s.events = nullptr;
+  }
+  s_i2s.installed = false;
+  return ESP_OK;
+}
+
+esp_err_t i2s_set_adc_mode(adc_unit_t unit, adc1_channel_t channel){
+  return unit == ADC_UNIT_1 && channel == ADC1_CHANNEL_0 ? ESP_OK : ESP_ERR_INVALID_ARG; //the audio source is on channel 0
+}
+
+esp_err_t i2s_adc_enable(i2s_port_t port){
+  if(!s_i2s.installed){
+    return ESP_ERR_INVALID_STATE;
+  }
+  std::lock_guard<std::mutex> guard(s_i2s.lock);
+  s_i2s.enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t i2s_adc_disable(i2s_port_t port){
+  if(!s_i2s.installed){
+    return ESP_ERR_INVALID_STATE;
+  }
+  std::lock_guard<std::mutex> guard(s_i2s.lock);
+  s_i2s.enabled = false;
+  return ESP_OK;
+}
+
+//as the driver does, reads buffer after buffer until the size is read or a buffer does not complete in time
+esp_err_t i2s_read(i2s_port_t port, void* destination, size_t size, size_t* bytesRead, TickType_t ticksToWait){
+  *bytesRead = 0;
+  if(!s_i2s.installed || !s_i2s.enabled){
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  uint8_t* output = (uint8_t*)destination;
+  while(size > 0){
+    if(s_i2s.readPosition >= s_i2s.reading.size()){
+      if(!nextBuffer(ticksToWait)){
+        return ESP_ERR_TIMEOUT;
+      }
+    }
+
+    size_t available = (s_i2s.reading.size() - s_i2s.readPosition) * sizeof(uint16_t);
+    size_t length = size < available ? size : available;
+    memcpy(output, (const uint8_t*)s_i2s.reading.data() + s_i2s.readPosition * sizeof(uint16_t), length);
+    s_i2s.readPosition += (length + 1) / sizeof(uint16_t);
+    output += length;
+    size -= length;
+    *bytesRead += length;
+  }
+  return ESP_OK;
+}
+
+esp_err_t i2s_zero_dma_buffer(i2s_port_t port){
+  std::lock_guard<std::mutex> guard(s_i2s.lock);
+  s_i2s.first = 0;
+  s_i2s.filled = 0;
+  return ESP_OK;
+}
+
+esp_err_t adc1_config_width(adc_bits_width_t width){
+  return ESP_OK;
+}
+
+esp_err_t adc1_config_channel_atten(adc1_channel_t channel, adc_atten_t atten){
+  return channel < ADC1_CHANNEL_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+int adc1_get_raw(adc1_channel_t channel){
+  return g_audioSource.nextRaw();
+}
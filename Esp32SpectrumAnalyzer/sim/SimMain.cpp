@@ -0,0 +1,235 @@
+#include "Arduino.h"
+#include "SimConfig.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SimConfig g_simConfig = {
+  .audioFile = "",
+  .generator = "sweep",
+  .gain = 0.5f,
+  .fast = false,
+  .seconds = 0,
+  .stationAddress = "127.0.0.1",
+  .httpPort = SIM_DEFAULT_HTTP_PORT,
+  .ledCapture = "",
+  .ledTiming = true,
+  .nvsDirectory = ".pio/sim-nvs",
+  .serialOutput = "",
+  .pinCores = false,
+  .lowPins = 0
+};
+
+//statistics of the run, reported by simStop()
+static std::mutex s_statsLock; //guards the statistics below
+static std::vector<int64_t> s_latencies; //capture to show times of the frames that had a new block (us)
+static std::vector<int64_t> s_showIntervals; //times between shows (us)
+static int64_t s_newestBlock = 0; //completion time of the newest block read
+static bool s_blockSinceShow = false; //flag to indicate a block was read since the last show
+static int64_t s_lastShow = 0; //time of the last show
+static uint64_t s_frames = 0; //shows
+static uint64_t s_blocks = 0; //blocks read
+static uint64_t s_blocksDropped = 0; //blocks overwritten before being read
+static uint64_t s_audioSamples = 0; //samples delivered
+static uint32_t s_sampleRate = 0; //rate of the samples delivered
+static std::atomic<uint64_t> s_httpRequests(0);
+static std::atomic<uint64_t> s_udpSent(0);
+static std::atomic<uint64_t> s_udpReceived(0);
+static std::atomic<bool> s_stopping(false);
+
+void simRecordBlock(int64_t completedAt){
+  std::lock_guard<std::mutex> guard(s_statsLock);
+  s_newestBlock = completedAt;
+  s_blockSinceShow = true;
+  s_blocks++;
+}
+
+void simRecordBlockDropped(){
+  std::lock_guard<std::mutex> guard(s_statsLock);
+  s_blocksDropped++;
+}
+
+//the latency of a frame runs from the completion of the newest block it was computed from, so it is only recorded when a block was read since the last show
+void simRecordShow(int64_t shownAt){
+  std::lock_guard<std::mutex> guard(s_statsLock);
+  if(s_blockSinceShow && s_latencies.size() < SIM_MAX_LATENCY_SAMPLES){
+    s_latencies.push_back(shownAt - s_newestBlock);
+  }
+  if(s_frames > 0 && s_showIntervals.size() < SIM_MAX_LATENCY_SAMPLES){
+    s_showIntervals.push_back(shownAt - s_lastShow);
+  }
+  s_blockSinceShow = false;
+  s_lastShow = shownAt;
+  s_frames++;
+}
+
+void simRecordHttpRequest(){ s_httpRequests++; }
+void simRecordUdpSent(){ s_udpSent++; }
+void simRecordUdpReceived(){ s_udpReceived++; }
+
+void simAddAudioSamples(uint32_t samples, uint32_t sampleRate){
+  std::lock_guard<std::mutex> guard(s_statsLock);
+  s_audioSamples += samples;
+  s_sampleRate = sampleRate;
+}
+
+double simAudioSeconds(){
+  std::lock_guard<std::mutex> guard(s_statsLock);
+  return s_sampleRate == 0 ? 0 : (double)s_audioSamples / s_sampleRate;
+}
+
+static int64_t percentile(std::vector<int64_t>& values, double fraction){ //sorts the values in place, so the report does not allocate
+  if(values.empty()){
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  size_t index = (size_t)(fraction * (values.size() - 1) + 0.5);
+  return values[index];
+}
+
+//prints the report as one line of JSON and ends the process. The first caller reports; any other waits for the end.
+void simStop(){
+  if(s_stopping.exchange(true)){
+    while(true){
+      pause();
+    }
+  }
+
+  fflush(stdout);
+  simCloseLedCapture();
+
+  double wallSeconds = esp_timer_get_time() / 1000000.0;
+  double audioSeconds = simAudioSeconds();
+  std::lock_guard<std::mutex> guard(s_statsLock);
+  int64_t maxLatency = s_latencies.empty() ? 0 : *std::max_element(s_latencies.begin(), s_latencies.end());
+
+  printf("\nSIM_REPORT {\"audioSeconds\":%.3f,\"wallSeconds\":%.3f,\"realtimeFactor\":%.3f,\"frames\":%llu,\"framesPerSecond\":%.2f,"
+    "\"latencyUs\":{\"p50\":%lld,\"p99\":%lld,\"max\":%lld},\"showIntervalUs\":{\"p50\":%lld,\"p99\":%lld},"
+    "\"blocks\":%llu,\"blocksDropped\":%llu,\"httpRequests\":%llu,\"udpSent\":%llu,\"udpReceived\":%llu}\n",
+    audioSeconds, wallSeconds, wallSeconds > 0 ? audioSeconds / wallSeconds : 0, (unsigned long long)s_frames,
+    wallSeconds > 0 ? s_frames / wallSeconds : 0,
+    (long long)percentile(s_latencies, 0.5), (long long)percentile(s_latencies, 0.99), (long long)maxLatency,
+    (long long)percentile(s_showIntervals, 0.5), (long long)percentile(s_showIntervals, 0.99),
+    (unsigned long long)s_blocks, (unsigned long long)s_blocksDropped, (unsigned long long)s_httpRequests.load(),
+    (unsigned long long)s_udpSent.load(), (unsigned long long)s_udpReceived.load());
+  fflush(stdout);
+  _exit(0);
+}
+
+static void printUsage(const char* program){
+  fprintf(stderr,
+    "usage: %s [options]\n"
+    "  --audio <file.wav>     play a WAV file (looped) into the ADC\n"
+    "  --generator <name>     sweep (default), noise, silence or tone:<Hz>[,<Hz>...] when there is no --audio\n"
+    "  --gain <0..1>          amplitude of the source (default 0.5)\n"
+    "  --fast                 make each audio buffer when it is read instead of in real time\n"
+    "  --seconds <n>          end after n seconds of audio (of wall time for a display node)\n"
+    "  --ip <address>         loopback address of this instance (default 127.0.0.1), eg. 127.0.0.2 for a display node\n"
+    "  --http-port <port>     port the web server listens on (default %d)\n"
+    "  --leds <file>          write every LED frame to a capture file (see FastLED.h)\n"
+    "  --led-timing           make show() take the WS2812 wire time (default, except with --fast)\n"
+    "  --no-led-timing        return from show() at once\n"
+    "  --nvs <dir>            directory the settings are saved in (default .pio/sim-nvs)\n"
+    "  --serial <file>        write the serial port to a file instead of stdout\n"
+    "  --pin-cores            pin the tasks of core 0 and core 1 to two host CPUs\n"
+    "  --pin-low <gpio>       make digitalRead() of the pin return LOW, as if its button were held (can be repeated)\n"
+    "  -- <arguments>         pass the rest on to the program built on the simulation (batch/)\n",
+    program, SIM_DEFAULT_HTTP_PORT);
+}
+
+static bool parseArguments(int argc, char** argv){
+  int ledTiming = -1; //not given
+  for(int i = 1; i < argc; i++){
+    std::string option = argv[i];
+    bool hasValue = i + 1 < argc;
+
+    if(option == "--audio" && hasValue){
+      g_simConfig.audioFile = argv[++i];
+    }else if(option == "--generator" && hasValue){
+      g_simConfig.generator = argv[++i];
+    }else if(option == "--gain" && hasValue){
+      g_simConfig.gain = atof(argv[++i]);
+    }else if(option == "--fast"){
+      g_simConfig.fast = true;
+    }else if(option == "--seconds" && hasValue){
+      g_simConfig.seconds = atof(argv[++i]);
+    }else if(option == "--ip" && hasValue){
+      g_simConfig.stationAddress = argv[++i];
+    }else if(option == "--http-port" && hasValue){
+      g_simConfig.httpPort = atoi(argv[++i]);
+    }else if(option == "--leds" && hasValue){
+      g_simConfig.ledCapture = argv[++i];
+    }else if(option == "--led-timing"){
+      ledTiming = 1;
+    }else if(option == "--no-led-timing"){
+      ledTiming = 0;
+    }else if(option == "--nvs" && hasValue){
+      g_simConfig.nvsDirectory = argv[++i];
+    }else if(option == "--serial" && hasValue){
+      g_simConfig.serialOutput = argv[++i];
+    }else if(option == "--pin-cores"){
+      g_simConfig.pinCores = true;
+    }else if(option == "--pin-low" && hasValue){
+      g_simConfig.lowPins |= 1ULL << (atoi(argv[++i]) & 63);
+    }else if(option == "--"){
+      g_simConfig.programArguments.assign(argv + i + 1, argv + argc);
+      break;
+    }else{
+      printUsage(argv[0]);
+      return false;
+    }
+  }
+
+  //with --fast the wire time would cap the speed-up, so it is only simulated when asked for
+  g_simConfig.ledTiming = ledTiming < 0 ? !g_simConfig.fast : ledTiming == 1;
+  return true;
+}
+
+//ends the simulation on Ctrl+C, or once --seconds have passed when no audio is captured (display node)
+static void watchThread(sigset_t signals){
+  pthread_setname_np(pthread_self(), "sim_watch");
+  timespec timeout = {0, 100 * 1000000};
+
+  while(true){
+    if(sigtimedwait(&signals, nullptr, &timeout) > 0){
+      simStop();
+    }
+    if(g_simConfig.seconds > 0 && simAudioSeconds() == 0 && esp_timer_get_time() >= g_simConfig.seconds * 1000000){
+      simStop();
+    }
+  }
+}
+
+int main(int argc, char** argv){
+  if(!parseArguments(argc, argv)){
+    return 2;
+  }
+
+  for(size_t next = 0; next != std::string::npos;){
+    next = g_simConfig.nvsDirectory.find('/', next + 1);
+    mkdir(g_simConfig.nvsDirectory.substr(0, next).c_str(), 0755);
+  }
+
+  //the signals are blocked before any thread starts, so they all go to the watch thread
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+  std::thread(watchThread, signals).detach();
+
+  //the statistics are recorded from the frame loop, which must not allocate once it runs (see AllocGuard.h)
+  s_latencies.reserve(SIM_MAX_LATENCY_SAMPLES);
+  s_showIntervals.reserve(SIM_MAX_LATENCY_SAMPLES);
+
+  simRegisterLoopTask();
+  setup();
+  while(true){
+    loop();
+  }
+}
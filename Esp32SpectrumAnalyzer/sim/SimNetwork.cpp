@@ -0,0 +1,226 @@
+#include "AsyncUDP.h"
+#include "WiFi.h"
+#include "WiFiManager.h"
+#include "ESPmDNS.h"
+#include "SimConfig.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define UDP_MAX_PACKET 1500 //largest packet received (one Ethernet frame, as lwIP delivers)
+#define UDP_POLL_MS 100 //how often the receive thread checks whether the socket was closed
+
+WiFiClass WiFi;
+MDNSResponder MDNS;
+
+//AsyncUDPPacket
+
+AsyncUDPPacket::AsyncUDPPacket(AsyncUDP* udp, uint8_t* data, size_t length, IPAddress remoteIP, uint16_t remotePort){
+  this->_udp = udp;
+  this->_data = data;
+  this->_length = length;
+  this->_remoteIP = remoteIP;
+  this->_remotePort = remotePort;
+}
+
+uint8_t* AsyncUDPPacket::data(){ return this->_data; }
+size_t AsyncUDPPacket::length(){ return this->_length; }
+IPAddress AsyncUDPPacket::remoteIP(){ return this->_remoteIP; }
+uint16_t AsyncUDPPacket::remotePort(){ return this->_remotePort; }
+
+size_t AsyncUDPPacket::write(const uint8_t* data, size_t length){
+  return this->_udp->writeTo(data, length, this->_remoteIP, this->_remotePort);
+}
+
+//AsyncUDP
+
+AsyncUDP::AsyncUDP() : _listening(false) {
+  this->_socket = -1;
+}
+
+AsyncUDP::~AsyncUDP(){
+  this->close();
+}
+
+bool AsyncUDP::open(uint32_t address, uint16_t port){
+  this->_socket = socket(AF_INET, SOCK_DGRAM, 0);
+  if(this->_socket < 0){
+    return false;
+  }
+
+  //display nodes on the same host all listen to the multicast port
+  int enable = 1;
+  in_addr loopback = {htonl(INADDR_LOOPBACK)};
+  setsockopt(this->_socket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  setsockopt(this->_socket, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+  setsockopt(this->_socket, IPPROTO_IP, IP_MULTICAST_IF, &loopback, sizeof(loopback));
+
+  sockaddr_in local = {};
+  local.sin_family = AF_INET;
+  local.sin_addr.s_addr = address;
+  local.sin_port = htons(port);
+  if(bind(this->_socket, (sockaddr*)&local, sizeof(local)) != 0){
+    ::close(this->_socket);
+    this->_socket = -1;
+    return false;
+  }
+  return true;
+}
+
+void AsyncUDP::startReceiving(){
+  this->_listening = true;
+  this->_receiver = std::thread(&AsyncUDP::receiveThread, this);
+}
+
+void AsyncUDP::receiveThread(){
+  pthread_setname_np(pthread_self(), "async_udp");
+  uint8_t buffer[UDP_MAX_PACKET];
+
+  while(this->_listening){
+    pollfd descriptor = {this->_socket, POLLIN, 0};
+    if(poll(&descriptor, 1, UDP_POLL_MS) <= 0){
+      continue;
+    }
+
+    sockaddr_in sender = {};
+    socklen_t senderLength = sizeof(sender);
+    ssize_t length = recvfrom(this->_socket, buffer, sizeof(buffer), 0, (sockaddr*)&sender, &senderLength);
+    if(length < 0){
+      continue;
+    }
+
+    simRecordUdpReceived();
+    if(this->_handler){
+      AsyncUDPPacket packet(this, buffer, length, IPAddress((uint32_t)sender.sin_addr.s_addr), ntohs(sender.sin_port));
+      this->_handler(packet);
+    }
+  }
+}
+
+bool AsyncUDP::listen(uint16_t port){
+  this->close();
+  if(!this->open((uint32_t)WiFi.localIP(), port)){
+    return false;
+  }
+  this->startReceiving();
+  return true;
+}
+
+//bound to any address, as a socket bound to the station address would not get the group's packets
+bool AsyncUDP::listenMulticast(const IPAddress& address, uint16_t port, uint8_t ttl){
+  this->close();
+  if(!this->open(htonl(INADDR_ANY), port)){
+    return false;
+  }
+
+  ip_mreq group = {};
+  group.imr_multiaddr.s_addr = (uint32_t)address;
+  group.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+  if(setsockopt(this->_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &group, sizeof(group)) != 0){
+    this->close();
+    return false;
+  }
+  setsockopt(this->_socket, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+  this->startReceiving();
+  return true;
+}
+
+size_t AsyncUDP::writeTo(const uint8_t* data, size_t length, const IPAddress& address, uint16_t port){
+  if(this->_socket < 0 && !this->open((uint32_t)WiFi.localIP(), 0)){
+    return 0;
+  }
+
+  sockaddr_in destination = {};
+  destination.sin_family = AF_INET;
+  destination.sin_addr.s_addr = (uint32_t)address;
+  destination.sin_port = htons(port);
+  ssize_t sent = sendto(this->_socket, data, length, 0, (sockaddr*)&destination, sizeof(destination));
+  if(sent < 0){
+    return 0;
+  }
+
+  simRecordUdpSent();
+  return sent;
+}
+
+size_t AsyncUDP::broadcastTo(const uint8_t* data, size_t length, uint16_t port){
+  return this->writeTo(data, length, IPAddress(255, 255, 255, 255), port);
+}
+
+void AsyncUDP::onPacket(AuPacketHandlerFunction handler){
+  this->_handler = handler;
+}
+
+bool AsyncUDP::connected(){
+  return this->_socket >= 0;
+}
+
+void AsyncUDP::close(){
+  this->_listening = false;
+  if(this->_receiver.joinable() && this->_receiver.get_id() != std::this_thread::get_id()){
+    this->_receiver.join();
+  }
+  if(this->_socket >= 0){
+    ::close(this->_socket);
+    this->_socket = -1;
+  }
+}
+
+//WiFiClass
+
+WiFiClass::WiFiClass(){
+  this->_connected = false;
+}
+
+void WiFiClass::simConnect(){ this->_connected = true; }
+wl_status_t WiFiClass::status(){ return this->_connected ? WL_CONNECTED : WL_DISCONNECTED; }
+bool WiFiClass::isConnected(){ return this->_connected; }
+bool WiFiClass::mode(wifi_mode_t mode){ return true; }
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp){
+  this->_connected = false;
+  return true;
+}
+
+bool WiFiClass::setSleep(bool enabled){ return true; }
+IPAddress WiFiClass::localIP(){
+  IPAddress address;
+  address.fromString(g_simConfig.stationAddress.c_str());
+  return address;
+}
+String WiFiClass::SSID(){ return String("simulation"); }
+int8_t WiFiClass::RSSI(){ return -40; }
+
+//WiFiManager
+
+bool WiFiManager::autoConnect(const char* apName, const char* apPassword){
+  WiFi.simConnect();
+  return true;
+}
+
+void WiFiManager::resetSettings(){}
+void WiFiManager::setConfigPortalBlocking(bool blocking){}
+void WiFiManager::setConfigPortalTimeout(unsigned long seconds){}
+void WiFiManager::setConnectTimeout(unsigned long seconds){}
+
+bool WiFiManager::startConfigPortal(const char* apName, const char* apPassword){
+  return this->autoConnect(apName, apPassword);
+}
+
+bool WiFiManager::process(){
+  return false;
+}
+
+//MDNSResponder
+
+bool MDNSResponder::begin(const String& hostName){
+  return true;
+}
+
+void MDNSResponder::end(){}
+
+bool MDNSResponder::addService(const char* service, const char* protocol, uint16_t port){
+  return true;
+}
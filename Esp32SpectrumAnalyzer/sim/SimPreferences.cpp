@@ -0,0 +1,169 @@
+#include "Preferences.h"
+#include "SimConfig.h"
+#include <sys/stat.h>
+
+//file of a namespace: records of [uint8 key length][key][uint32 value length][value]
+
+Preferences::Preferences(){
+  this->_readOnly = false;
+}
+
+Preferences::~Preferences(){
+  this->end();
+}
+
+std::string Preferences::getPath(){
+  return g_simConfig.nvsDirectory + "/" + this->_namespace + ".nvs";
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel){
+  this->end();
+  if(name == nullptr || strlen(name) > 15){
+    return false; //NVS namespace names have at most 15 characters
+  }
+
+  this->_namespace = name;
+  this->_readOnly = readOnly;
+
+  FILE* file = fopen(this->getPath().c_str(), "rb");
+  if(file == nullptr){
+    if(readOnly){
+      this->_namespace.clear();
+      return false;
+    }
+    return true;
+  }
+
+  uint8_t keyLength;
+  while(fread(&keyLength, 1, 1, file) == 1){
+    std::string key(keyLength, '\0');
+    uint32_t valueLength;
+    if(fread(&key[0], 1, keyLength, file) != keyLength || fread(&valueLength, sizeof(valueLength), 1, file) != 1){
+      break;
+    }
+
+    std::vector<uint8_t> value(valueLength);
+    if(fread(value.data(), 1, valueLength, file) != valueLength){
+      break;
+    }
+    this->_entries[key] = value;
+  }
+  fclose(file);
+  return true;
+}
+
+void Preferences::end(){
+  this->_namespace.clear();
+  this->_entries.clear();
+}
+
+bool Preferences::commit(){
+  mkdir(g_simConfig.nvsDirectory.c_str(), 0755);
+
+  std::string path = this->getPath();
+  std::string temporary = path + ".tmp";
+  FILE* file = fopen(temporary.c_str(), "wb");
+  if(file == nullptr){
+    return false;
+  }
+
+  bool written = true;
+  for(const auto& entry : this->_entries){
+    uint8_t keyLength = entry.first.length();
+    uint32_t valueLength = entry.second.size();
+    written = written && fwrite(&keyLength, 1, 1, file) == 1 && fwrite(entry.first.data(), 1, keyLength, file) == keyLength &&
+      fwrite(&valueLength, sizeof(valueLength), 1, file) == 1 && fwrite(entry.second.data(), 1, valueLength, file) == valueLength;
+  }
+  written = fclose(file) == 0 && written;
+
+  //replaced in one step, so a crash leaves either the old or the new namespace, as NVS does
+  return written && rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+size_t Preferences::put(const char* key, const void* value, size_t length){
+  if(this->_namespace.empty() || this->_readOnly || key == nullptr || strlen(key) > 15){
+    return 0;
+  }
+
+  std::vector<uint8_t>& entry = this->_entries[key];
+  entry.assign((const uint8_t*)value, (const uint8_t*)value + length);
+  return this->commit() ? length : 0;
+}
+
+size_t Preferences::get(const char* key, void* value, size_t length){
+  if(this->_namespace.empty() || key == nullptr){
+    return 0;
+  }
+
+  auto entry = this->_entries.find(key);
+  if(entry == this->_entries.end() || entry->second.size() != length){
+    return 0;
+  }
+  memcpy(value, entry->second.data(), length);
+  return length;
+}
+
+bool Preferences::clear(){
+  if(this->_namespace.empty() || this->_readOnly){
+    return false;
+  }
+  this->_entries.clear();
+  return this->commit();
+}
+
+bool Preferences::remove(const char* key){
+  if(this->_namespace.empty() || this->_readOnly || this->_entries.erase(key) == 0){
+    return false;
+  }
+  return this->commit();
+}
+
+bool Preferences::isKey(const char* key){
+  return !this->_namespace.empty() && this->_entries.count(key) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length){
+  return this->put(key, value, length);
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength){
+  size_t length = this->getBytesLength(key);
+  if(length == 0 || length > maxLength){
+    return 0;
+  }
+  return this->get(key, buffer, length);
+}
+
+size_t Preferences::getBytesLength(const char* key){
+  if(this->_namespace.empty()){
+    return 0;
+  }
+  auto entry = this->_entries.find(key);
+  return entry == this->_entries.end() ? 0 : entry->second.size();
+}
+
+size_t Preferences::putUChar(const char* key, uint8_t value){ return this->put(key, &value, sizeof(value)); }
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue){ uint8_t value = defaultValue; this->get(key, &value, sizeof(value)); return value; }
+size_t Preferences::putUShort(const char* key, uint16_t value){ return this->put(key, &value, sizeof(value)); }
+uint16_t Preferences::getUShort(const char* key, uint16_t defaultValue){ uint16_t value = defaultValue; this->get(key, &value, sizeof(value)); return value; }
+size_t Preferences::putUInt(const char* key, uint32_t value){ return this->put(key, &value, sizeof(value)); }
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue){ uint32_t value = defaultValue; this->get(key, &value, sizeof(value)); return value; }
+size_t Preferences::putBool(const char* key, bool value){ uint8_t stored = value; return this->put(key, &stored, sizeof(stored)); }
+bool Preferences::getBool(const char* key, bool defaultValue){ uint8_t value = defaultValue; this->get(key, &value, sizeof(value)); return value != 0; }
+size_t Preferences::putFloat(const char* key, float value){ return this->put(key, &value, sizeof(value)); }
+float Preferences::getFloat(const char* key, float defaultValue){ float value = defaultValue; this->get(key, &value, sizeof(value)); return value; }
+
+size_t Preferences::putString(const char* key, const String& value){
+  return this->put(key, value.c_str(), value.length() + 1) > 0 ? value.length() : 0;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue){
+  size_t length = this->getBytesLength(key);
+  if(length == 0){
+    return defaultValue;
+  }
+
+  std::string value(length, '\0');
+  this->get(key, &value[0], length);
+  return String(value.c_str());
+}
@@ -0,0 +1,391 @@
+#include "Arduino.h"
+#include "SimConfig.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
+
+//a task: a detached thread with the notification count FreeRTOS keeps per task
+struct SimTask {
+  std::string name; //name (also given to the thread, as far as it fits)
+  UBaseType_t priority; //priority (kept, not enforced)
+  BaseType_t core; //core the task is pinned to (tskNO_AFFINITY for none)
+  TaskFunction_t function; //body of the task
+  void* parameters; //argument of the body
+  std::mutex lock; //guards the notification count
+  std::condition_variable notified; //signalled when the count goes up
+  uint32_t notifications; //notification count
+};
+
+//a queue: a ring of items, or only a count for semaphores (item size 0)
+struct SimQueue {
+  std::mutex lock; //guards the ring
+  std::condition_variable notEmpty; //signalled when an item is added
+  std::condition_variable notFull; //signalled when an item is removed
+  UBaseType_t length; //capacity (items)
+  UBaseType_t itemSize; //bytes per item
+  std::vector<uint8_t> items; //the ring
+  UBaseType_t head; //index of the oldest item
+  UBaseType_t count; //number of items waiting
+};
+
+struct SimTaskExit {}; //thrown by vTaskDelete(NULL) to end the thread of the calling task
+
+static const std::chrono::steady_clock::time_point s_start = std::chrono::steady_clock::now(); //time 0 of millis(), micros() and esp_timer
+static thread_local SimTask* t_currentTask = nullptr; //task of the calling thread
+
+//waits on a condition until the predicate holds or the ticks run out. Returns false on timeout.
+template<typename Predicate> static bool waitTicks(std::condition_variable& condition, std::unique_lock<std::mutex>& guard, TickType_t ticks, Predicate predicate){
+  if(ticks == portMAX_DELAY){
+    condition.wait(guard, predicate);
+    return true;
+  }
+  return condition.wait_for(guard, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), predicate);
+}
+
+static void applyAffinity(BaseType_t core){
+  if(!g_simConfig.pinCores || core == tskNO_AFFINITY){
+    return;
+  }
+
+  long noOfCpus = sysconf(_SC_NPROCESSORS_ONLN);
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(core % (noOfCpus > 0 ? noOfCpus : 1), &cpus);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
+//on the board the tasks of core 0 (the network, the web server and the streamer) cannot take time from the frame loop on core 1. A host
+//with fewer CPUs shares them, so those tasks get a lower host priority, which does not need privileges.
+static void applyCorePriority(BaseType_t core){
+  if(core == 0){
+    setpriority(PRIO_PROCESS, syscall(SYS_gettid), SIM_CORE0_NICE);
+  }
+}
+
+static void runTask(SimTask* task){
+  t_currentTask = task;
+  pthread_setname_np(pthread_self(), task->name.substr(0, 15).c_str());
+  applyAffinity(task->core);
+  applyCorePriority(task->core);
+
+  try{
+    task->function(task->parameters);
+  }catch(const SimTaskExit&){
+  }
+}
+
+//registers the calling thread (the main thread) as the Arduino loop task
+void simRegisterLoopTask(){
+  SimTask* task = new SimTask();
+  task->name = "loopTask";
+  task->priority = 1;
+  task->core = ARDUINO_RUNNING_CORE;
+  task->function = nullptr;
+  task->parameters = nullptr;
+  task->notifications = 0;
+  t_currentTask = task;
+  applyAffinity(task->core);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth, void* parameters, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core){
+  SimTask* task = new SimTask();
+  task->name = name == nullptr ? "" : name;
+  task->priority = priority;
+  task->core = core;
+  task->function = function;
+  task->parameters = parameters;
+  task->notifications = 0;
+
+  if(handle != nullptr){
+    *handle = task; //set before the task runs, as the firmware may notify it right away
+  }
+
+  std::thread(runTask, task).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth, void* parameters, UBaseType_t priority, TaskHandle_t* handle){
+  return xTaskCreatePinnedToCore(function, name, stackDepth, parameters, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task){
+  if(task == nullptr || task == t_currentTask){
+    throw SimTaskExit();
+  }
+  fprintf(stderr, "sim: vTaskDelete of another task is not supported\n");
+}
+
+void vTaskDelay(TickType_t ticks){
+  if(ticks == 0){
+    sched_yield();
+    return;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+TickType_t xTaskGetTickCount(){
+  return (TickType_t)millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(){
+  return t_currentTask;
+}
+
+const char* pcTaskGetName(TaskHandle_t task){
+  task = task == nullptr ? t_currentTask : task;
+  return task == nullptr ? "" : task->name.c_str();
+}
+
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority){
+  task = task == nullptr ? t_currentTask : task;
+  if(task != nullptr){
+    task->priority = priority;
+  }
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task){
+  task = task == nullptr ? t_currentTask : task;
+  return task == nullptr ? 0 : task->priority;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait){
+  SimTask* task = t_currentTask;
+  if(task == nullptr){
+    return 0;
+  }
+
+  std::unique_lock<std::mutex> guard(task->lock);
+  waitTicks(task->notified, guard, ticksToWait, [task]{ return task->notifications > 0; });
+
+  uint32_t count = task->notifications;
+  if(count > 0){
+    task->notifications = clearCountOnExit ? 0 : count - 1;
+  }
+  return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task){
+  if(task == nullptr){
+    return pdFAIL;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(task->lock);
+    task->notifications++;
+  }
+  task->notified.notify_one();
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken){
+  xTaskNotifyGive(task);
+  if(higherPriorityTaskWoken != nullptr){
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+}
+
+BaseType_t xPortGetCoreID(){
+  return t_currentTask == nullptr || t_currentTask->core == tskNO_AFFINITY ? 0 : t_currentTask->core;
+}
+
+//recursive spinlock. The host may preempt the owner (an ESP32 core never is inside a critical section), so waiters yield instead of burning their slice.
+void vPortEnterCritical(portMUX_TYPE* mux){
+  uint32_t self = (uint32_t)syscall(SYS_gettid);
+
+  if(__atomic_load_n(&mux->owner, __ATOMIC_ACQUIRE) == self){
+    mux->count++;
+    return;
+  }
+
+  uint32_t expected = 0;
+  while(!__atomic_compare_exchange_n(&mux->owner, &expected, self, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)){
+    expected = 0;
+    sched_yield();
+  }
+  mux->count = 1;
+}
+
+void vPortExitCritical(portMUX_TYPE* mux){
+  if(--mux->count == 0){
+    __atomic_store_n(&mux->owner, 0, __ATOMIC_RELEASE);
+  }
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize){
+  SimQueue* queue = new SimQueue();
+  queue->length = length;
+  queue->itemSize = itemSize;
+  queue->items.resize((size_t)length * itemSize);
+  queue->head = 0;
+  queue->count = 0;
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue){
+  delete queue;
+}
+
+//adds an item with the lock held (the caller checked there is room)
+static void pushItem(SimQueue* queue, const void* item, bool toFront){
+  UBaseType_t index;
+  if(toFront){
+    queue->head = (queue->head + queue->length - 1) % queue->length;
+    index = queue->head;
+  }else{
+    index = (queue->head + queue->count) % queue->length;
+  }
+
+  if(queue->itemSize > 0 && item != nullptr){
+    memcpy(&queue->items[(size_t)index * queue->itemSize], item, queue->itemSize);
+  }
+  queue->count++;
+}
+
+static BaseType_t sendItem(QueueHandle_t queue, const void* item, TickType_t ticksToWait, bool toFront){
+  std::unique_lock<std::mutex> guard(queue->lock);
+  if(!waitTicks(queue->notFull, guard, ticksToWait, [queue]{ return queue->count < queue->length; })){
+    return errQUEUE_FULL;
+  }
+
+  pushItem(queue, item, toFront);
+  guard.unlock();
+  queue->notEmpty.notify_one();
+  return pdPASS;
+}
+
+static BaseType_t receiveItem(QueueHandle_t queue, void* item, TickType_t ticksToWait, bool remove){
+  std::unique_lock<std::mutex> guard(queue->lock);
+  if(!waitTicks(queue->notEmpty, guard, ticksToWait, [queue]{ return queue->count > 0; })){
+    return errQUEUE_EMPTY;
+  }
+
+  if(queue->itemSize > 0 && item != nullptr){
+    memcpy(item, &queue->items[(size_t)queue->head * queue->itemSize], queue->itemSize);
+  }
+  if(!remove){
+    return pdPASS;
+  }
+
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+  guard.unlock();
+  queue->notFull.notify_one();
+  return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait){
+  return sendItem(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticksToWait){
+  return sendItem(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticksToWait){
+  return sendItem(queue, item, ticksToWait, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken){
+  if(higherPriorityTaskWoken != nullptr){
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return sendItem(queue, item, 0, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item){
+  {
+    std::lock_guard<std::mutex> guard(queue->lock);
+    queue->head = 0;
+    queue->count = 0;
+    pushItem(queue, item, false);
+  }
+  queue->notEmpty.notify_one();
+  return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait){
+  return receiveItem(queue, item, ticksToWait, true);
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t queue, void* item, BaseType_t* higherPriorityTaskWoken){
+  if(higherPriorityTaskWoken != nullptr){
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return receiveItem(queue, item, 0, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticksToWait){
+  return receiveItem(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue){
+  {
+    std::lock_guard<std::mutex> guard(queue->lock);
+    queue->head = 0;
+    queue->count = 0;
+  }
+  queue->notFull.notify_all();
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue){
+  std::lock_guard<std::mutex> guard(queue->lock);
+  return queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue){
+  std::lock_guard<std::mutex> guard(queue->lock);
+  return queue->length - queue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(){
+  SemaphoreHandle_t semaphore = xQueueCreate(1, 0);
+  xSemaphoreGive(semaphore);
+  return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(){
+  return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount){
+  SemaphoreHandle_t semaphore = xQueueCreate(maxCount, 0);
+  for(UBaseType_t i = 0; i < initialCount; i++){
+    xSemaphoreGive(semaphore);
+  }
+  return semaphore;
+}
+
+int64_t esp_timer_get_time(){
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+unsigned long millis(){
+  return (unsigned long)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros(){
+  return (unsigned long)esp_timer_get_time();
+}
+
+void delay(uint32_t ms){
+  vTaskDelay(ms / portTICK_PERIOD_MS);
+}
+
+//busy waits like the ROM delay does
+void delayMicroseconds(uint32_t us){
+  int64_t end = esp_timer_get_time() + us;
+  while(esp_timer_get_time() < end){
+  }
+}
+
+void yield(){
+  sched_yield();
+}
@@ -0,0 +1,725 @@
+#include "ESPAsyncWebServer.h"
+#include "SimConfig.h"
+#include "WiFi.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define SIM_MAX_CONNECTIONS 16 //open connections at a time (the lwIP default); further clients wait in the listen backlog
+#define SIM_MAX_HEAD 8192 //longest request line and headers accepted
+#define SIM_MAX_BODY 65536 //longest request body accepted
+#define SIM_FILL_SIZE 4096 //most body bytes asked of a response at a time
+#define SIM_BODY_CHUNK 1436 //body bytes handed to onBody at a time (a TCP segment, as ESPAsyncWebServer hands them over)
+#define SIM_POLL_MS 10 //how often fillers that returned RESPONSE_TRY_AGAIN are asked again
+#define SIM_IDLE_POLL_MS 1000 //how long the task sleeps without socket events otherwise (only to notice end()), so an idle server does not wake up
+
+//a client connection: the request being received, then the response being sent
+struct SimConnection {
+  int socket; //connected socket
+  IPAddress remoteIP; //address of the client
+  uint16_t remotePort; //port of the client
+  std::string input; //bytes received and not parsed yet
+  AsyncWebServerRequest* request; //the request (nullptr until it is complete)
+  AsyncWebServerResponse* response; //its response (nullptr until it is complete)
+  bool headOnly; //flag to indicate the body is not sent (HEAD)
+  bool headSent; //flag to indicate the status line and headers were queued
+  bool bodyDone; //flag to indicate the whole body was queued
+  bool fillerWaiting; //flag to indicate the filler had nothing yet (asked again after SIM_POLL_MS)
+  size_t bodyIndex; //body bytes queued so far
+  std::string output; //bytes queued and not sent yet
+};
+
+static const char* statusText(int code){
+  switch(code){
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+static std::string urlDecode(const std::string& text){
+  std::string decoded;
+  for(size_t i = 0; i < text.length(); i++){
+    if(text[i] == '+'){
+      decoded += ' ';
+    }else if(text[i] == '%' && i + 2 < text.length() && isxdigit((unsigned char)text[i + 1]) && isxdigit((unsigned char)text[i + 2])){
+      decoded += (char)strtol(text.substr(i + 1, 2).c_str(), nullptr, 16);
+      i += 2;
+    }else{
+      decoded += text[i];
+    }
+  }
+  return decoded;
+}
+
+//AsyncWebParameter, AsyncWebHeader, AsyncClient
+
+AsyncWebParameter::AsyncWebParameter(const String& name, const String& value, bool isPost) : _name(name), _value(value), _isPost(isPost) {}
+const String& AsyncWebParameter::name() const { return this->_name; }
+const String& AsyncWebParameter::value() const { return this->_value; }
+size_t AsyncWebParameter::size() const { return this->_value.length(); }
+bool AsyncWebParameter::isPost() const { return this->_isPost; }
+bool AsyncWebParameter::isFile() const { return false; }
+
+AsyncWebHeader::AsyncWebHeader(const String& name, const String& value) : _name(name), _value(value) {}
+const String& AsyncWebHeader::name() const { return this->_name; }
+const String& AsyncWebHeader::value() const { return this->_value; }
+
+AsyncClient::AsyncClient(IPAddress remoteIP, uint16_t remotePort) : _remoteIP(remoteIP), _remotePort(remotePort) {}
+IPAddress AsyncClient::remoteIP() const { return this->_remoteIP; }
+uint16_t AsyncClient::remotePort() const { return this->_remotePort; }
+
+//responses
+
+AsyncWebServerResponse::AsyncWebServerResponse(int code, const String& contentType) : _contentType(contentType) {
+  this->_code = code;
+  this->_contentLength = 0;
+  this->_chunked = false;
+}
+
+AsyncWebServerResponse::~AsyncWebServerResponse(){}
+void AsyncWebServerResponse::setCode(int code){ this->_code = code; }
+int AsyncWebServerResponse::code() const { return this->_code; }
+void AsyncWebServerResponse::setContentType(const String& type){ this->_contentType = type; }
+void AsyncWebServerResponse::setContentLength(size_t length){ this->_contentLength = length; }
+bool AsyncWebServerResponse::isChunked() const { return this->_chunked; }
+size_t AsyncWebServerResponse::getContentLength() const { return this->_contentLength; }
+
+bool AsyncWebServerResponse::addHeader(const char* name, const char* value, bool replaceExisting){
+  return this->addHeader(String(name), String(value), replaceExisting);
+}
+
+bool AsyncWebServerResponse::addHeader(const String& name, const String& value, bool replaceExisting){
+  for(AsyncWebHeader& header : this->_headers){
+    if(header.name().equalsIgnoreCase(name)){
+      if(!replaceExisting){
+        return false;
+      }
+      header = AsyncWebHeader(name, value);
+      return true;
+    }
+  }
+  this->_headers.push_back(AsyncWebHeader(name, value));
+  return true;
+}
+
+std::string AsyncWebServerResponse::buildHead(){
+  std::string head = "HTTP/1.1 " + std::to_string(this->_code) + " " + statusText(this->_code) + "\r\n";
+  if(this->_contentType.length() > 0){
+    head += std::string("Content-Type: ") + this->_contentType.c_str() + "\r\n";
+  }
+  if(this->_chunked){
+    head += "Transfer-Encoding: chunked\r\n";
+  }else{
+    head += "Content-Length: " + std::to_string(this->_contentLength) + "\r\n";
+  }
+  head += "Connection: close\r\n";
+  for(const AsyncWebHeader& header : this->_headers){
+    head += std::string(header.name().c_str()) + ": " + header.value().c_str() + "\r\n";
+  }
+  return head + "\r\n";
+}
+
+AsyncBasicResponse::AsyncBasicResponse(int code, const String& contentType, const uint8_t* content, size_t length) : AsyncWebServerResponse(code, contentType) {
+  this->_content.assign((const char*)content, length);
+  this->_contentLength = length;
+}
+
+size_t AsyncBasicResponse::fillBody(uint8_t* buffer, size_t maxLen, size_t index){
+  size_t length = index >= this->_content.size() ? 0 : std::min(maxLen, this->_content.size() - index);
+  memcpy(buffer, this->_content.data() + index, length);
+  return length;
+}
+
+AsyncCallbackResponse::AsyncCallbackResponse(const String& contentType, size_t length, AwsResponseFiller filler, bool chunked) : AsyncWebServerResponse(200, contentType) {
+  this->_filler = filler;
+  this->_contentLength = length;
+  this->_chunked = chunked;
+}
+
+size_t AsyncCallbackResponse::fillBody(uint8_t* buffer, size_t maxLen, size_t index){
+  if(!this->_chunked){
+    if(index >= this->_contentLength){
+      return 0;
+    }
+    maxLen = std::min(maxLen, this->_contentLength - index);
+  }
+  return this->_filler ? this->_filler(buffer, maxLen, index) : 0;
+}
+
+AsyncResponseStream::AsyncResponseStream(const String& contentType, size_t bufferSize) : AsyncWebServerResponse(200, contentType) {
+  this->_content.reserve(bufferSize);
+}
+
+size_t AsyncResponseStream::write(uint8_t value){
+  this->_content += (char)value;
+  this->_contentLength = this->_content.size();
+  return 1;
+}
+
+size_t AsyncResponseStream::write(const uint8_t* buffer, size_t size){
+  this->_content.append((const char*)buffer, size);
+  this->_contentLength = this->_content.size();
+  return size;
+}
+
+size_t AsyncResponseStream::fillBody(uint8_t* buffer, size_t maxLen, size_t index){
+  size_t length = index >= this->_content.size() ? 0 : std::min(maxLen, this->_content.size() - index);
+  memcpy(buffer, this->_content.data() + index, length);
+  return length;
+}
+
+//AsyncWebServerRequest
+
+AsyncWebServerRequest::AsyncWebServerRequest(IPAddress remoteIP, uint16_t remotePort) : _client(remoteIP, remotePort) {
+  this->_method = HTTP_GET;
+  this->_response = nullptr;
+  this->_tempObject = nullptr;
+}
+
+AsyncWebServerRequest::~AsyncWebServerRequest(){
+  delete this->_response;
+  free(this->_tempObject);
+}
+
+AsyncClient* AsyncWebServerRequest::client(){ return &this->_client; }
+WebRequestMethodComposite AsyncWebServerRequest::method() const { return this->_method; }
+const String& AsyncWebServerRequest::url() const { return this->_url; }
+size_t AsyncWebServerRequest::contentLength() const { return this->_body.size(); }
+const std::string& AsyncWebServerRequest::body() const { return this->_body; }
+const String& AsyncWebServerRequest::contentType() const { return this->header("Content-Type"); }
+
+const char* AsyncWebServerRequest::methodToString() const {
+  switch(this->_method){
+    case HTTP_GET: return "GET";
+    case HTTP_POST: return "POST";
+    case HTTP_DELETE: return "DELETE";
+    case HTTP_PUT: return "PUT";
+    case HTTP_PATCH: return "PATCH";
+    case HTTP_HEAD: return "HEAD";
+    case HTTP_OPTIONS: return "OPTIONS";
+    default: return "UNKNOWN";
+  }
+}
+
+//as in ESPAsyncWebServer, query parameters are found with post = false and form parameters with post = true
+bool AsyncWebServerRequest::hasParam(const char* name, bool post, bool file) const { return this->getParam(name, post, file) != nullptr; }
+bool AsyncWebServerRequest::hasParam(const String& name, bool post, bool file) const { return this->getParam(name.c_str(), post, file) != nullptr; }
+const AsyncWebParameter* AsyncWebServerRequest::getParam(const String& name, bool post, bool file) const { return this->getParam(name.c_str(), post, file); }
+
+const AsyncWebParameter* AsyncWebServerRequest::getParam(const char* name, bool post, bool file) const {
+  for(const AsyncWebParameter& param : this->_params){
+    if(param.name() == name && param.isPost() == post && param.isFile() == file){
+      return &param;
+    }
+  }
+  return nullptr;
+}
+
+const AsyncWebParameter* AsyncWebServerRequest::getParam(size_t index) const {
+  return index < this->_params.size() ? &this->_params[index] : nullptr;
+}
+
+size_t AsyncWebServerRequest::params() const { return this->_params.size(); }
+
+const String& AsyncWebServerRequest::arg(const char* name) const {
+  static const String empty;
+  for(const AsyncWebParameter& param : this->_params){
+    if(param.name() == name){
+      return param.value();
+    }
+  }
+  return empty;
+}
+
+bool AsyncWebServerRequest::hasHeader(const char* name) const {
+  for(const AsyncWebHeader& header : this->_headers){
+    if(header.name().equalsIgnoreCase(name)){
+      return true;
+    }
+  }
+  return false;
+}
+
+const String& AsyncWebServerRequest::header(const char* name) const {
+  static const String empty;
+  for(const AsyncWebHeader& header : this->_headers){
+    if(header.name().equalsIgnoreCase(name)){
+      return header.value();
+    }
+  }
+  return empty;
+}
+
+size_t AsyncWebServerRequest::headers() const { return this->_headers.size(); }
+
+void AsyncWebServerRequest::onDisconnect(ArDisconnectHandler handler){
+  this->_onDisconnect = handler;
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response){
+  if(this->_response != nullptr){
+    delete response; //a response was sent already
+    return;
+  }
+  this->_response = response;
+}
+
+void AsyncWebServerRequest::send(int code, const char* contentType, const char* content){ this->send(this->beginResponse(code, contentType, content)); }
+void AsyncWebServerRequest::send(int code, const char* contentType, const String& content){ this->send(this->beginResponse(code, contentType, content)); }
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content){ this->send(this->beginResponse(code, contentType, content)); }
+void AsyncWebServerRequest::send(int code, const char* contentType, const uint8_t* content, size_t length){ this->send(this->beginResponse(code, contentType, content, length)); }
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* contentType, const char* content){
+  content = content == nullptr ? "" : content;
+  return new AsyncBasicResponse(code, contentType, (const uint8_t*)content, strlen(content));
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* contentType, const String& content){
+  return new AsyncBasicResponse(code, contentType, (const uint8_t*)content.c_str(), content.length());
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType, const String& content){
+  return new AsyncBasicResponse(code, contentType, (const uint8_t*)content.c_str(), content.length());
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* contentType, const uint8_t* content, size_t length){
+  return new AsyncBasicResponse(code, contentType, content, length);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(const char* contentType, size_t length, AwsResponseFiller filler){
+  return new AsyncCallbackResponse(contentType, length, filler, false);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(const String& contentType, size_t length, AwsResponseFiller filler){
+  return new AsyncCallbackResponse(contentType, length, filler, false);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginChunkedResponse(const char* contentType, AwsResponseFiller filler){
+  return new AsyncCallbackResponse(contentType, 0, filler, true);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginChunkedResponse(const String& contentType, AwsResponseFiller filler){
+  return new AsyncCallbackResponse(contentType, 0, filler, true);
+}
+
+AsyncResponseStream* AsyncWebServerRequest::beginResponseStream(const char* contentType, size_t bufferSize){
+  return new AsyncResponseStream(contentType, bufferSize);
+}
+
+AsyncResponseStream* AsyncWebServerRequest::beginResponseStream(const String& contentType, size_t bufferSize){
+  return new AsyncResponseStream(contentType, bufferSize);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::takeResponse(){
+  AsyncWebServerResponse* response = this->_response;
+  this->_response = nullptr;
+  return response;
+}
+
+void AsyncWebServerRequest::disconnected(){
+  if(this->_onDisconnect){
+    this->_onDisconnect();
+  }
+}
+
+//handlers and middleware
+
+AsyncMiddlewareFunction::AsyncMiddlewareFunction(ArMiddlewareCallback callback) : _callback(callback) {}
+
+void AsyncMiddlewareFunction::run(AsyncWebServerRequest* request, ArMiddlewareNext next){
+  this->_callback(request, next);
+}
+
+AsyncCallbackWebHandler::AsyncCallbackWebHandler(const String& uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest, ArBodyHandlerFunction onBody) : _uri(uri) {
+  this->_method = method;
+  this->_onRequest = onRequest;
+  this->_onBody = onBody;
+}
+
+bool AsyncCallbackWebHandler::canHandle(AsyncWebServerRequest* request) const {
+  if(!(this->_method & request->method()) || (this->_filter && !this->_filter(request))){
+    return false;
+  }
+
+  const String& url = request->url();
+  if(this->_uri.length() == 0 || url == this->_uri){
+    return true;
+  }
+  if(this->_uri.endsWith("*")){
+    return url.startsWith(this->_uri.substring(0, this->_uri.length() - 1));
+  }
+  return url.startsWith(this->_uri + "/");
+}
+
+AsyncCallbackWebHandler& AsyncCallbackWebHandler::setFilter(ArRequestFilterFunction filter){
+  this->_filter = filter;
+  return *this;
+}
+
+//AsyncWebServer
+
+AsyncWebServer::AsyncWebServer(uint16_t port){
+  this->_port = port;
+  this->_socket = -1;
+  this->_task = nullptr;
+}
+
+AsyncWebServer::~AsyncWebServer(){
+  this->end();
+  for(AsyncCallbackWebHandler* handler : this->_handlers){
+    delete handler;
+  }
+  for(AsyncMiddleware* middleware : this->_middlewares){
+    delete middleware;
+  }
+}
+
+void AsyncWebServer::begin(){
+  if(this->_socket >= 0){
+    return;
+  }
+
+  uint16_t port = this->_port == 80 ? g_simConfig.httpPort : this->_port;
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  int enable = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = (uint32_t)WiFi.localIP();
+  address.sin_port = htons(port);
+  if(bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || ::listen(listener, 64) != 0){
+    fprintf(stderr, "sim: unable to listen on port %u: %s\n", port, strerror(errno));
+    ::close(listener);
+    return;
+  }
+
+  fcntl(listener, F_SETFL, O_NONBLOCK);
+  this->_socket = listener;
+  fprintf(stderr, "sim: web server at http://%s:%u\n", g_simConfig.stationAddress.c_str(), port);
+  xTaskCreatePinnedToCore(tcpTask, "async_tcp", 16384, this, CONFIG_ASYNC_TCP_PRIORITY, &this->_task, CONFIG_ASYNC_TCP_RUNNING_CORE);
+}
+
+void AsyncWebServer::end(){
+  if(this->_socket >= 0){
+    ::close(this->_socket);
+    this->_socket = -1; //the task stops accepting and ends with the connections it has
+  }
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, ArRequestHandlerFunction onRequest){
+  return this->on(uri, HTTP_ANY, onRequest);
+}
+
+AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody){
+  AsyncCallbackWebHandler* handler = new AsyncCallbackWebHandler(uri, method, onRequest, onBody);
+  this->_handlers.push_back(handler);
+  return *handler;
+}
+
+void AsyncWebServer::onNotFound(ArRequestHandlerFunction handler){
+  this->_notFound = handler;
+}
+
+AsyncMiddlewareFunction* AsyncWebServer::addMiddleware(ArMiddlewareCallback callback){
+  AsyncMiddlewareFunction* middleware = new AsyncMiddlewareFunction(callback);
+  this->_middlewares.push_back(middleware);
+  return middleware;
+}
+
+void AsyncWebServer::addMiddleware(AsyncMiddleware* middleware){
+  this->_middlewares.push_back(middleware);
+}
+
+//runs the middleware from the given one on, then the handler (or the not found handler)
+void AsyncWebServer::runMiddleware(AsyncWebServerRequest* request, size_t index, AsyncCallbackWebHandler* handler){
+  if(index < this->_middlewares.size()){
+    this->_middlewares[index]->run(request, [this, request, index, handler](){ this->runMiddleware(request, index + 1, handler); });
+    return;
+  }
+
+  if(handler == nullptr){
+    if(this->_notFound){
+      this->_notFound(request);
+    }else{
+      request->send(404);
+    }
+    return;
+  }
+
+  if(handler->_onRequest){
+    handler->_onRequest(request);
+  }
+}
+
+void AsyncWebServer::handleRequest(AsyncWebServerRequest* request){
+  simRecordHttpRequest();
+
+  AsyncCallbackWebHandler* handler = nullptr;
+  for(AsyncCallbackWebHandler* candidate : this->_handlers){
+    if(candidate->canHandle(request)){
+      handler = candidate;
+      break;
+    }
+  }
+  //as in ESPAsyncWebServer, the body is handed to onBody in chunks while it arrives, before the middleware runs. Form bodies are parsed
+  //into parameters instead.
+  if(handler != nullptr && handler->_onBody && !request->contentType().startsWith("application/x-www-form-urlencoded")){
+    for(size_t index = 0; index < request->_body.size(); index += SIM_BODY_CHUNK){
+      size_t length = std::min((size_t)SIM_BODY_CHUNK, request->_body.size() - index);
+      handler->_onBody(request, (uint8_t*)&request->_body[index], length, index, request->_body.size());
+    }
+  }
+  this->runMiddleware(request, 0, handler);
+}
+
+static void parseParams(const std::string& text, bool isPost, std::vector<AsyncWebParameter>& params){
+  size_t start = 0;
+  while(start < text.length()){
+    size_t end = text.find('&', start);
+    end = end == std::string::npos ? text.length() : end;
+    std::string pair = text.substr(start, end - start);
+    if(!pair.empty()){
+      size_t equals = pair.find('=');
+      std::string name = urlDecode(pair.substr(0, equals));
+      std::string value = equals == std::string::npos ? "" : urlDecode(pair.substr(equals + 1));
+      params.push_back(AsyncWebParameter(String(name), String(value), isPost));
+    }
+    start = end + 1;
+  }
+}
+
+bool AsyncWebServer::readRequest(SimConnection* connection){
+  size_t headEnd = connection->input.find("\r\n\r\n");
+  if(headEnd == std::string::npos){
+    return connection->input.size() <= SIM_MAX_HEAD;
+  }
+
+  AsyncWebServerRequest* request = new AsyncWebServerRequest(connection->remoteIP, connection->remotePort);
+  std::string head = connection->input.substr(0, headEnd);
+  size_t lineEnd = head.find("\r\n");
+  std::string requestLine = head.substr(0, lineEnd);
+
+  //headers
+  for(size_t start = lineEnd == std::string::npos ? head.length() : lineEnd + 2; start < head.length();){
+    size_t end = head.find("\r\n", start);
+    end = end == std::string::npos ? head.length() : end;
+    std::string line = head.substr(start, end - start);
+    size_t colon = line.find(':');
+    if(colon != std::string::npos){
+      size_t valueStart = line.find_first_not_of(' ', colon + 1);
+      request->_headers.push_back(AsyncWebHeader(String(line.substr(0, colon)), String(valueStart == std::string::npos ? "" : line.substr(valueStart))));
+    }
+    start = end + 2;
+  }
+
+  //body
+  size_t contentLength = request->hasHeader("Content-Length") ? strtoul(request->header("Content-Length").c_str(), nullptr, 10) : 0;
+  if(contentLength > SIM_MAX_BODY){
+    delete request;
+    return false;
+  }
+  if(connection->input.size() < headEnd + 4 + contentLength){
+    delete request;
+    return true; //wait for the rest of the body
+  }
+  request->_body = connection->input.substr(headEnd + 4, contentLength);
+  connection->input.clear();
+
+  //request line: method, path and query
+  size_t firstSpace = requestLine.find(' ');
+  size_t secondSpace = requestLine.find(' ', firstSpace + 1);
+  if(firstSpace == std::string::npos || secondSpace == std::string::npos){
+    delete request;
+    return false;
+  }
+
+  std::string method = requestLine.substr(0, firstSpace);
+  std::string target = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+  const char* methods[] = {"GET", "POST", "DELETE", "PUT", "PATCH", "HEAD", "OPTIONS"};
+  request->_method = 0;
+  for(int i = 0; i < 7; i++){
+    if(method == methods[i]){
+      request->_method = 1 << i;
+    }
+  }
+
+  size_t question = target.find('?');
+  request->_url = String(urlDecode(target.substr(0, question)));
+  if(question != std::string::npos){
+    parseParams(target.substr(question + 1), false, request->_params);
+  }
+  if(request->header("Content-Type").startsWith("application/x-www-form-urlencoded")){
+    parseParams(request->_body, true, request->_params);
+  }
+
+  connection->request = request;
+  connection->headOnly = request->_method == HTTP_HEAD;
+  if(request->_method == 0){
+    request->send(405);
+  }else{
+    this->handleRequest(request);
+  }
+
+  connection->response = request->takeResponse();
+  if(connection->response == nullptr){
+    connection->response = new AsyncBasicResponse(500, "text/plain", (const uint8_t*)"no response", 11); //the handler did not respond
+  }
+  return true;
+}
+
+bool AsyncWebServer::writeResponse(SimConnection* connection){
+  AsyncWebServerResponse* response = connection->response;
+
+  if(!connection->headSent){
+    connection->output = response->buildHead();
+    connection->headSent = true;
+    connection->bodyDone = connection->headOnly;
+  }
+
+  //ask the response for more of the body once what was queued is out
+  if(connection->output.empty() && !connection->bodyDone){
+    uint8_t buffer[SIM_FILL_SIZE];
+    size_t length = response->fillBody(buffer, sizeof(buffer), connection->bodyIndex);
+
+    connection->fillerWaiting = length == RESPONSE_TRY_AGAIN;
+    if(connection->fillerWaiting){
+      return true;
+    }
+    if(length > sizeof(buffer)){
+      length = 0; //a broken filler ends the response
+    }
+
+    if(response->isChunked()){
+      char size[16];
+      snprintf(size, sizeof(size), "%zx\r\n", length);
+      connection->output = std::string(size) + std::string((const char*)buffer, length) + "\r\n";
+    }else{
+      connection->output.assign((const char*)buffer, length);
+    }
+    connection->bodyIndex += length;
+    connection->bodyDone = length == 0 || (!response->isChunked() && connection->bodyIndex >= response->getContentLength());
+  }
+
+  while(!connection->output.empty()){
+    ssize_t sent = send(connection->socket, connection->output.data(), connection->output.size(), MSG_NOSIGNAL);
+    if(sent < 0){
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    connection->output.erase(0, sent);
+  }
+  return !connection->bodyDone;
+}
+
+//the AsyncTCP task: accepts connections, reads the requests, runs the handlers and sends the responses as the sockets take them
+void AsyncWebServer::tcpTask(void* pvParameters){
+  AsyncWebServer* server = (AsyncWebServer*)pvParameters;
+  std::vector<SimConnection*> connections;
+  std::vector<pollfd> descriptors;
+
+  while(server->_socket >= 0 || !connections.empty()){
+    descriptors.clear();
+    int timeout = SIM_IDLE_POLL_MS;
+    if(server->_socket >= 0 && connections.size() < SIM_MAX_CONNECTIONS){
+      descriptors.push_back({server->_socket, POLLIN, 0});
+    }
+    for(SimConnection* connection : connections){
+      short events = connection->response == nullptr ? POLLIN : (connection->fillerWaiting ? 0 : POLLOUT);
+      descriptors.push_back({connection->socket, events, 0});
+      if(connection->fillerWaiting){
+        timeout = SIM_POLL_MS;
+      }
+    }
+
+    poll(descriptors.data(), descriptors.size(), timeout);
+    size_t first = descriptors.size() - connections.size();
+
+    //serve the connections (before accepting, so the descriptors still line up with them)
+    for(size_t i = 0; i < connections.size(); i++){
+      SimConnection* connection = connections[i];
+      short events = descriptors[first + i].revents;
+      bool open = true;
+
+      if(connection->response == nullptr){
+        if(events & (POLLIN | POLLHUP | POLLERR)){
+          char buffer[4096];
+          ssize_t length = recv(connection->socket, buffer, sizeof(buffer), 0);
+          if(length > 0){
+            connection->input.append(buffer, length);
+            open = server->readRequest(connection);
+          }else{
+            open = length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+          }
+        }
+      }else if(events & (POLLHUP | POLLERR)){
+        open = false; //the client went away
+      }
+
+      //a filler that had nothing is asked again after the poll times out, so responses are written whether or not the socket signalled
+      if(open && connection->response != nullptr){
+        open = server->writeResponse(connection);
+      }
+
+      if(!open){
+        shutdown(connection->socket, SHUT_WR);
+        ::close(connection->socket);
+        if(connection->request != nullptr){
+          connection->request->disconnected();
+        }
+        delete connection->request;
+        delete connection->response;
+        delete connection;
+        connections.erase(connections.begin() + i);
+        descriptors.erase(descriptors.begin() + first + i);
+        i--;
+      }
+    }
+
+    if(first > 0 && (descriptors[0].revents & POLLIN)){
+      sockaddr_in address = {};
+      socklen_t addressLength = sizeof(address);
+      int client = accept(server->_socket, (sockaddr*)&address, &addressLength);
+      if(client >= 0){
+        int enable = 1;
+        fcntl(client, F_SETFL, O_NONBLOCK);
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        SimConnection* connection = new SimConnection();
+        connection->socket = client;
+        connection->remoteIP = IPAddress((uint32_t)address.sin_addr.s_addr);
+        connection->remotePort = ntohs(address.sin_port);
+        connection->request = nullptr;
+        connection->response = nullptr;
+        connection->headOnly = false;
+        connection->headSent = false;
+        connection->bodyDone = false;
+        connection->fillerWaiting = false;
+        connection->bodyIndex = 0;
+        connections.push_back(connection);
+      }
+    }
+  }
+
+  vTaskDelete(NULL);
+}
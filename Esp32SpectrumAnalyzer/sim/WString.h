@@ -0,0 +1,94 @@
+#ifndef WString_h
+#define WString_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+//Arduino String on std::string (the subset the firmware and its libraries use)
+class String {
+  private:
+    std::string _buffer; //contents
+
+  public:
+    String();
+    String(const char* value);
+    String(const String& value);
+    String(const std::string& value);
+    explicit String(char value);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimalPlaces = 2);
+    explicit String(double value, unsigned int decimalPlaces = 2);
+
+    String& operator=(const String& value);
+    String& operator=(const char* value); //nullptr leaves the string empty
+    bool reserve(unsigned int size);
+    unsigned int length() const;
+    bool isEmpty() const;
+    const char* c_str() const;
+
+    bool concat(const String& value);
+    bool concat(const char* value);
+    bool concat(const char* value, unsigned int length);
+    bool concat(char value);
+    bool concat(int value);
+    bool concat(unsigned int value);
+    bool concat(long value);
+    bool concat(unsigned long value);
+    bool concat(float value);
+    bool concat(double value);
+    template<typename T> String& operator+=(const T& value){ this->concat(value); return *this; }
+
+    bool equals(const String& other) const;
+    bool equals(const char* other) const;
+    bool equalsIgnoreCase(const String& other) const;
+    bool operator==(const String& other) const { return this->equals(other); }
+    bool operator==(const char* other) const { return this->equals(other); }
+    bool operator!=(const String& other) const { return !this->equals(other); }
+    bool operator!=(const char* other) const { return !this->equals(other); }
+    bool operator<(const String& other) const;
+    bool startsWith(const String& prefix) const;
+    bool endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const;
+    char operator[](unsigned int index) const;
+    char& operator[](unsigned int index);
+    int indexOf(char value, unsigned int from = 0) const;
+    int indexOf(const String& value, unsigned int from = 0) const;
+    int lastIndexOf(char value) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+    void replace(const String& find, const String& replacement);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+};
+
+//result of +, so chains like a + b + c append to one string (ArduinoJson also knows the type)
+class StringSumHelper : public String {
+  public:
+    StringSumHelper(const String& value) : String(value) {}
+    StringSumHelper(const char* value) : String(value) {}
+};
+
+StringSumHelper& operator+(const StringSumHelper& left, const String& right);
+StringSumHelper& operator+(const StringSumHelper& left, const char* right);
+StringSumHelper& operator+(const StringSumHelper& left, char right);
+StringSumHelper& operator+(const StringSumHelper& left, int right);
+StringSumHelper& operator+(const StringSumHelper& left, unsigned int right);
+StringSumHelper& operator+(const StringSumHelper& left, long right);
+StringSumHelper& operator+(const StringSumHelper& left, unsigned long right);
+StringSumHelper& operator+(const StringSumHelper& left, float right);
+StringSumHelper& operator+(const StringSumHelper& left, double right);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef WiFi_h
+#define WiFi_h
+
+//the simulated network is the loopback interface of the host: it is always connected and the station address is the one given with --ip
+#include "Arduino.h"
+#include "IPAddress.h"
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3,
+} wifi_mode_t;
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+class WiFiClass {
+  private:
+    volatile bool _connected; //set once WiFiManager connected
+
+  public:
+    WiFiClass();
+    void simConnect(); //called by WiFiManager::autoConnect
+    wl_status_t status();
+    bool isConnected();
+    bool mode(wifi_mode_t mode);
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    bool setSleep(bool enabled);
+    IPAddress localIP();
+    String SSID();
+    int8_t RSSI();
+};
+
+extern WiFiClass WiFi;
+
+#endif
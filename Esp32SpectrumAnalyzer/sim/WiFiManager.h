@@ -0,0 +1,18 @@
+#ifndef WiFiManager_h
+#define WiFiManager_h
+
+#include "WiFi.h"
+
+//connects to the simulated network right away, so the config portal is never needed
+class WiFiManager {
+  public:
+    bool autoConnect(const char* apName = nullptr, const char* apPassword = nullptr);
+    void resetSettings();
+    void setConfigPortalBlocking(bool blocking);
+    void setConfigPortalTimeout(unsigned long seconds);
+    void setConnectTimeout(unsigned long seconds);
+    bool startConfigPortal(const char* apName = nullptr, const char* apPassword = nullptr);
+    bool process();
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef crgb_h
+#define crgb_h
+
+#include <stdint.h>
+
+struct CHSV {
+  uint8_t h; //hue
+  uint8_t s; //saturation
+  uint8_t v; //value
+  CHSV() : h(0), s(0), v(0) {}
+  CHSV(uint8_t hue, uint8_t saturation, uint8_t value) : h(hue), s(saturation), v(value) {}
+};
+
+//RGB pixel, 3 bytes like the FastLED one (pixel arrays are stored and loaded as they are)
+struct CRGB {
+  uint8_t r; //red
+  uint8_t g; //green
+  uint8_t b; //blue
+
+  typedef enum {
+    Black = 0x000000,
+    Blue = 0x0000FF,
+    Green = 0x008000,
+    Red = 0xFF0000,
+    White = 0xFFFFFF,
+    Yellow = 0xFFFF00,
+    Orange = 0xFFA500,
+    Purple = 0x800080,
+    Cyan = 0x00FFFF,
+    Magenta = 0xFF00FF,
+  } HTMLColorCode;
+
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+  CRGB(uint32_t colorCode) : r((colorCode >> 16) & 0xFF), g((colorCode >> 8) & 0xFF), b(colorCode & 0xFF) {}
+  CRGB(HTMLColorCode colorCode) : CRGB((uint32_t)colorCode) {}
+  CRGB(const CHSV& hsv); //rainbow hue mapping, like hsv2rgb_rainbow
+
+  uint8_t& operator[](uint8_t index) { return index == 0 ? r : (index == 1 ? g : b); }
+  bool operator==(const CRGB& other) const { return r == other.r && g == other.g && b == other.b; }
+  bool operator!=(const CRGB& other) const { return !(*this == other); }
+  CRGB& nscale8(uint8_t scale);
+  CRGB& fadeToBlackBy(uint8_t amount);
+  CRGB& operator+=(const CRGB& other);
+};
+
+uint8_t scale8(uint8_t value, uint8_t scale);
+uint8_t qadd8(uint8_t first, uint8_t second);
+CRGB blend(const CRGB& first, const CRGB& second, uint8_t amountOfSecond);
+
+#endif
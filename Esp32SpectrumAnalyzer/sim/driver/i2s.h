@@ -0,0 +1,106 @@
+#ifndef i2s_h
+#define i2s_h
+
+//legacy I2S driver in built-in ADC mode. The samples come from the audio source of the simulation (a WAV file or a generator, see SimConfig.h):
+//in real time a DMA thread completes a buffer every dma_buf_len samples and posts the same events as the driver (including RX queue overflows
+//when the reader falls behind); with --fast a buffer is made whenever one is read, so the firmware runs as fast as the host allows.
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "driver/adc.h"
+
+typedef enum {
+  I2S_NUM_0 = 0,
+  I2S_NUM_1 = 1,
+  I2S_NUM_MAX,
+} i2s_port_t;
+
+typedef enum {
+  I2S_MODE_MASTER = (0x1 << 0),
+  I2S_MODE_SLAVE = (0x1 << 1),
+  I2S_MODE_TX = (0x1 << 2),
+  I2S_MODE_RX = (0x1 << 3),
+  I2S_MODE_DAC_BUILT_IN = (0x1 << 4),
+  I2S_MODE_ADC_BUILT_IN = (0x1 << 5),
+  I2S_MODE_PDM = (0x1 << 6),
+} i2s_mode_t;
+
+typedef enum {
+  I2S_BITS_PER_SAMPLE_8BIT = 8,
+  I2S_BITS_PER_SAMPLE_16BIT = 16,
+  I2S_BITS_PER_SAMPLE_24BIT = 24,
+  I2S_BITS_PER_SAMPLE_32BIT = 32,
+} i2s_bits_per_sample_t;
+
+typedef enum {
+  I2S_CHANNEL_FMT_RIGHT_LEFT,
+  I2S_CHANNEL_FMT_ALL_RIGHT,
+  I2S_CHANNEL_FMT_ALL_LEFT,
+  I2S_CHANNEL_FMT_ONLY_RIGHT,
+  I2S_CHANNEL_FMT_ONLY_LEFT,
+} i2s_channel_fmt_t;
+
+typedef enum {
+  I2S_COMM_FORMAT_STAND_I2S = 0x01,
+  I2S_COMM_FORMAT_STAND_MSB = 0x03,
+  I2S_COMM_FORMAT_STAND_PCM_SHORT = 0x04,
+  I2S_COMM_FORMAT_STAND_PCM_LONG = 0x0C,
+} i2s_comm_format_t;
+
+typedef enum {
+  I2S_MCLK_MULTIPLE_DEFAULT = 0,
+  I2S_MCLK_MULTIPLE_128 = 128,
+  I2S_MCLK_MULTIPLE_256 = 256,
+  I2S_MCLK_MULTIPLE_384 = 384,
+} i2s_mclk_multiple_t;
+
+typedef enum {
+  I2S_BITS_PER_CHAN_DEFAULT = 0,
+  I2S_BITS_PER_CHAN_8BIT = 8,
+  I2S_BITS_PER_CHAN_16BIT = 16,
+  I2S_BITS_PER_CHAN_24BIT = 24,
+  I2S_BITS_PER_CHAN_32BIT = 32,
+} i2s_bits_per_chan_t;
+
+typedef struct {
+  i2s_mode_t mode;
+  uint32_t sample_rate;
+  i2s_bits_per_sample_t bits_per_sample;
+  i2s_channel_fmt_t channel_format;
+  i2s_comm_format_t communication_format;
+  int intr_alloc_flags;
+  int dma_buf_count;
+  int dma_buf_len;
+  bool use_apll;
+  bool tx_desc_auto_clear;
+  int fixed_mclk;
+  i2s_mclk_multiple_t mclk_multiple;
+  i2s_bits_per_chan_t bits_per_chan;
+} i2s_config_t;
+
+typedef enum {
+  I2S_EVENT_DMA_ERROR,
+  I2S_EVENT_TX_DONE,
+  I2S_EVENT_RX_DONE,
+  I2S_EVENT_TX_Q_OVF,
+  I2S_EVENT_RX_Q_OVF,
+  I2S_EVENT_MAX,
+} i2s_event_type_t;
+
+typedef struct {
+  i2s_event_type_t type;
+  size_t size;
+} i2s_event_t;
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t* config, int queueSize, void* queue); //queue: QueueHandle_t* the events are posted to (or NULL)
+esp_err_t i2s_driver_uninstall(i2s_port_t port);
+esp_err_t i2s_set_adc_mode(adc_unit_t unit, adc1_channel_t channel);
+esp_err_t i2s_adc_enable(i2s_port_t port);
+esp_err_t i2s_adc_disable(i2s_port_t port);
+esp_err_t i2s_read(i2s_port_t port, void* destination, size_t size, size_t* bytesRead, TickType_t ticksToWait);
+esp_err_t i2s_zero_dma_buffer(i2s_port_t port);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef esp_intr_alloc_h
+#define esp_intr_alloc_h
+
+#define ESP_INTR_FLAG_LEVEL1 (1<<1)
+#define ESP_INTR_FLAG_LEVEL2 (1<<2)
+#define ESP_INTR_FLAG_LEVEL3 (1<<3)
+#define ESP_INTR_FLAG_IRAM (1<<10)
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef FreeRTOS_h
+#define FreeRTOS_h
+
+//FreeRTOS on POSIX threads: a task is a thread, queues and semaphores are a mutex and condition variable, ticks are milliseconds.
+//priorities are kept but not enforced (the host scheduler decides), and core affinity is only applied with --pin-cores.
+#include <stdint.h>
+#include <stddef.h>
+
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 25
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY (TickType_t)0xffffffffUL
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define errQUEUE_EMPTY 0
+#define errQUEUE_FULL 0
+
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define tskIDLE_PRIORITY 0
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+
+//ESP32 critical sections are recursive spinlocks shared between the cores. Here they are spinlocks shared between threads.
+typedef struct {
+  volatile uint32_t owner; //id of the thread holding the lock (0 if free)
+  volatile uint32_t count; //nesting depth of the owner
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+#define taskENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux) vPortExitCritical(mux)
+
+BaseType_t xPortGetCoreID(); //core the calling task is pinned to
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef semphr_h
+#define semphr_h
+
+#include "queue.h"
+
+//as in FreeRTOS, a semaphore is a queue of items without data: taking receives one, giving sends one
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(); //created given
+SemaphoreHandle_t xSemaphoreCreateBinary(); //created taken
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount);
+
+#define xSemaphoreTake(semaphore, ticksToWait) xQueueReceive((semaphore), NULL, (ticksToWait))
+#define xSemaphoreGive(semaphore) xQueueSend((semaphore), NULL, 0)
+#define xSemaphoreGiveFromISR(semaphore, woken) xQueueSendFromISR((semaphore), NULL, (woken))
+#define vSemaphoreDelete(semaphore) vQueueDelete(semaphore)
+
+#endif
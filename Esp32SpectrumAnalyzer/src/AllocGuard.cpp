@@ -0,0 +1,123 @@
+#include "AllocGuard.h"
+
+TaskHandle_t AllocGuard::_tasks[MAX_WATCHED_TASKS] = {};
+const char* AllocGuard::_taskNames[MAX_WATCHED_TASKS] = {};
+std::atomic<uint32_t> AllocGuard::_allocations[MAX_WATCHED_TASKS] = {};
+std::atomic<bool> AllocGuard::_armed[MAX_WATCHED_TASKS] = {};
+std::atomic<uint8_t> AllocGuard::_noOfTasks(0);
+
+bool AllocGuard::isEnabled(){
+#ifdef ALLOC_GUARD
+  return true;
+#else
+  return false;
+#endif
+}
+
+//tasks are added during boot, by the tasks themselves, so the table is only appended to and never locked
+void AllocGuard::watchTask(const char* name){
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  if(findTask(task) >= 0){
+    return;
+  }
+
+  static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+  portENTER_CRITICAL(&mux); //two tasks can start being watched at the same time
+  uint8_t index = _noOfTasks.load();
+  if(index < MAX_WATCHED_TASKS){
+    _tasks[index] = task;
+    _taskNames[index] = name;
+    _noOfTasks.store(index + 1);
+  }
+  portEXIT_CRITICAL(&mux);
+}
+
+void AllocGuard::armTask(){
+  int index = findTask(xTaskGetCurrentTaskHandle());
+  if(index >= 0){
+    _armed[index].store(true);
+  }
+}
+
+void AllocGuard::disarmTask(){
+  int index = findTask(xTaskGetCurrentTaskHandle());
+  if(index >= 0){
+    _armed[index].store(false);
+  }
+}
+
+uint8_t AllocGuard::getNoOfTasks(){
+  return _noOfTasks.load();
+}
+
+const char* AllocGuard::getTaskName(uint8_t index){
+  return _taskNames[index];
+}
+
+uint32_t AllocGuard::getAllocations(uint8_t index){
+  return _allocations[index].load();
+}
+
+void AllocGuard::recordAllocation(size_t size, void* caller){
+  int index = findTask(xTaskGetCurrentTaskHandle());
+  if(index < 0){
+    return;
+  }
+
+  _allocations[index]++;
+  if(_armed[index].exchange(false)){ //disarmed first, in case reporting it allocates
+    ets_printf("AllocGuard: task \"%s\" allocated %u bytes after its warm-up (called from %p)\n", _taskNames[index], (unsigned)size, caller);
+    abort();
+  }
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+int AllocGuard::findTask(TaskHandle_t task){
+  uint8_t noOfTasks = _noOfTasks.load();
+  for (uint8_t i = 0; i < noOfTasks; i++) {
+    if(_tasks[i] == task){
+      return i;
+    }
+  }
+  return -1;
+}
+
+
+#ifdef ALLOC_GUARD
+//the allocator hooks. --wrap makes every call to malloc, calloc and realloc in the firmware and the libraries linked into it come here,
+//and __real_* reach the allocator itself. operator new is replaced as well, for the C++ runtimes that are not linked statically.
+extern "C" {
+  void* __real_malloc(size_t size);
+  void* __real_calloc(size_t count, size_t size);
+  void* __real_realloc(void* pointer, size_t size);
+
+  void* __wrap_malloc(size_t size){
+    AllocGuard::recordAllocation(size, __builtin_return_address(0));
+    return __real_malloc(size);
+  }
+
+  void* __wrap_calloc(size_t count, size_t size){
+    AllocGuard::recordAllocation(count * size, __builtin_return_address(0));
+    return __real_calloc(count, size);
+  }
+
+  void* __wrap_realloc(void* pointer, size_t size){
+    AllocGuard::recordAllocation(size, __builtin_return_address(0));
+    return __real_realloc(pointer, size);
+  }
+}
+
+void* operator new(size_t size){
+  AllocGuard::recordAllocation(size, __builtin_return_address(0));
+  void* pointer = __real_malloc(size);
+  if(pointer == nullptr){
+    abort(); //out of memory, as the default operator new does without exceptions
+  }
+  return pointer;
+}
+
+void* operator new[](size_t size){
+  return operator new(size);
+}
+#endif
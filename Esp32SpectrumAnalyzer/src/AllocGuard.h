@@ -0,0 +1,32 @@
+#ifndef AllocGuard_h
+#define AllocGuard_h
+
+#include "Common.h"
+
+#define MAX_WATCHED_TASKS 6 //tasks whose heap allocations can be counted
+
+//counts the heap allocations of the watched tasks, so a task that must not allocate once it has warmed up (the frame loop) is caught,
+//and the ones that should allocate little (the web tasks) can be followed at /metrics. An allocation by an armed task aborts with the
+//task, the size and the caller. Only active in builds with -D ALLOC_GUARD, which also wrap the allocator at link time
+//(-Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc, see the alloc-guard environments in platformio.ini); otherwise nothing is counted.
+class AllocGuard {
+  private:
+    static TaskHandle_t _tasks[MAX_WATCHED_TASKS]; //watched tasks
+    static const char* _taskNames[MAX_WATCHED_TASKS]; //names they are reported under
+    static std::atomic<uint32_t> _allocations[MAX_WATCHED_TASKS]; //allocations counted for each task
+    static std::atomic<bool> _armed[MAX_WATCHED_TASKS]; //flag to indicate an allocation by the task aborts
+    static std::atomic<uint8_t> _noOfTasks; //tasks in the table (an entry is complete before it is counted here)
+    static int findTask(TaskHandle_t task); //index of the task in the table, -1 if it is not watched
+
+  public:
+    static bool isEnabled(); //true if the allocator is hooked (ALLOC_GUARD build)
+    static void watchTask(const char* name); //counts the allocations of the calling task from now on. Calling it again does nothing.
+    static void armTask(); //ends the warm-up of the calling task: any allocation by it from now on aborts
+    static void disarmTask(); //lets the calling task allocate again (eg. to save a setting before it restarts the device)
+    static uint8_t getNoOfTasks(); //returns the number of watched tasks
+    static const char* getTaskName(uint8_t index); //returns the name of a watched task
+    static uint32_t getAllocations(uint8_t index); //returns the allocations counted for a watched task
+    static void recordAllocation(size_t size, void* caller); //called by the allocator hooks (must not allocate)
+};
+
+#endif
@@ -1,27 +1,46 @@
 #include "Analyzer.h"
 #include "Common.h"
 
-Analyzer::Analyzer(uint8_t numberOfBands, unsigned short* bandTable){
-    this->_noOfBands =  numberOfBands;
+Analyzer::Analyzer(AnalyzerMemory* memory, uint8_t numberOfBands, unsigned short* bandTable){
     this->_samplingFrequency = 44100; //44.1kHz
-    this->_sampleSize = 1024; //number of audio samples to read (must be power of 2)  
+    this->_sampleSize = FFT_SIZE; //number of audio samples to read (must be power of 2)  
+    this->_engine = ENGINE_FFT;
+    this->_blockSize = FFT_SIZE;
+    this->_dmaBufferCount = 2;
     this->_noiseThreshold = 1000;
     this->_offset = (uint16_t)ADC1_CHANNEL_0 * 0x1000 + 0xFFF;;
-    this->_vReal = new double[this->_sampleSize] {0};
-    this->_vImag = new double[this->_sampleSize] {0};
-    this->_samples = new int16_t[this->_sampleSize] {0};
-    this->_freqBands = nullptr;
-    this->_bandTable = new unsigned short[this->_noOfBands] {0};
-    
-    for (unsigned short i = 0; i < this->_noOfBands; i++)
-    {
-        _bandTable[i] = bandTable[i];
-    }
+    this->_memory = memory;
+    this->_vReal = memory->vReal;
+    this->_vImag = memory->vImag;
+    this->_samples = memory->samples;
+    this->_noOfViews = 0;
+    this->_fftMicros = 0;
+
+    //the first view is the one displayed on the LED matrix. Its levels go to the array passed to convertToBands.
+    this->addView("leds", bandTable, numberOfBands, nullptr);
 
-    this->_fft = new arduinoFFT(this->_vReal, this->_vImag, this->_sampleSize, this->_samplingFrequency);
+    this->_fft = arduinoFFT(this->_vReal, this->_vImag, this->_sampleSize, this->_samplingFrequency);
+    this->_captureTime = 0;
+    this->_latencyTracer = nullptr;
+    this->_audioSnapshot = nullptr;
+    this->_metrics = nullptr;
+    this->_i2sEventQueue = nullptr;
     
 }
 
+//shorter blocks are read into more DMA buffers, so the samples are buffered for as long as with FFT_SIZE blocks
+void Analyzer::setEngine(AnalysisEngine engine, uint16_t blockSize){
+    this->_engine = engine;
+    this->_blockSize = blockSize;
+    this->_dmaBufferCount = (2 * FFT_SIZE) / this->_blockSize; //2048 samples (about 46 ms) whatever the block size
+
+    if(engine == ENGINE_FILTER_BANK){
+      for (uint8_t v = 0; v < this->_noOfViews; v++) {
+        this->designFilterBank(&this->_views[v]);
+      }
+    }
+}
+
 bool Analyzer::setupAdc(){
     esp_err_t err;
     
@@ -33,8 +52,8 @@ bool Analyzer::setupAdc(){
       .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT, // although the SEL config should be left, it seems to transmit on right
       .communication_format = I2S_COMM_FORMAT_STAND_I2S,
       .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,     // Interrupt level 1
-      .dma_buf_count = 2,                           // number of buffers
-      .dma_buf_len = _sampleSize,                     // samples per buffer
+      .dma_buf_count = _dmaBufferCount,             // number of buffers
+      .dma_buf_len = _blockSize,                      // samples per buffer
       .use_apll = false,
       .tx_desc_auto_clear = false,
       .fixed_mclk = 0
@@ -47,8 +66,8 @@ bool Analyzer::setupAdc(){
       return false;
     }
 
-    //install I2S driver
-    err = i2s_driver_install(I2S_NUM_0, &i2s_config,  0, NULL);  
+    //install I2S driver, with an event queue to learn about dropped blocks
+    err = i2s_driver_install(I2S_NUM_0, &i2s_config, I2S_EVENT_QUEUE_SIZE + this->_dmaBufferCount, &this->_i2sEventQueue);  
     if (err != ESP_OK) {
       Serial.printf("i2s_driver_install failed with error code: %d\n", err);
       return false;
@@ -77,67 +96,358 @@ bool Analyzer::setupAdc(){
   
 
 void Analyzer::readAudioSamples(){
-    size_t bytesToRead = 1024 * sizeof(int16_t);
+    int64_t readStart = esp_timer_get_time();
+    uint16_t noOfSamples = this->readBlock(portMAX_DELAY);
+
+    if(this->_latencyTracer != nullptr){
+      this->_latencyTracer->record(STAGE_READ_WAIT, this->_captureTime - readStart);
+    }
+
+    if(this->_engine == ENGINE_FILTER_BANK){
+      this->_fftMicros = 0;
+      for (uint8_t v = 0; v < this->_noOfViews; v++) {
+        this->swapPendingMap(&this->_views[v]); //band table changes take effect here, before the first block of the frame is filtered
+        this->_views[v].costMicros = 0;
+      }
+      this->filterBlock(noOfSamples);
+
+      //catch up with the blocks that queued up while the previous frame was displayed, so the levels include the most recent samples
+      //and the DMA buffers do not overflow however short the blocks are
+      for (uint16_t b = 1; b < this->_dmaBufferCount; b++) {
+        noOfSamples = this->readBlock(0);
+        if(noOfSamples == 0){
+          break;
+        }
+        this->filterBlock(noOfSamples);
+      }
+    }else{
+      this->loadFftInput();
+    }
+
+    if(this->_metrics != nullptr){
+      this->checkI2sEvents();
+    }
+
+    // Serial.println();
+}
+
+
+void Analyzer::convertToBands(float* freqBands){
+    if(this->_views[0].levels == nullptr){
+        this->_views[0].levels = freqBands;
+    }
+
+    //the filter bank ran as the samples were read, so the levels are the envelopes of the filters
+    if(this->_engine == ENGINE_FILTER_BANK){
+        for (uint8_t v = 0; v < this->_noOfViews; v++) {
+            this->_views[v].filterBank.getLevels(this->_views[v].levels, FILTER_BANK_GAIN);
+        }
+
+        if(this->_metrics != nullptr){
+          this->_metrics->recordAnalysis(this->_fftMicros);
+        }
+        if(this->_latencyTracer != nullptr){
+          this->_latencyTracer->record(STAGE_ANALYSIS, esp_timer_get_time() - this->_captureTime);
+        }
+        return;
+    }
+
+    //Compute FFT using ArduinoFFT library (once per frame, whatever the number of views)
+    int64_t fftStart = esp_timer_get_time();
+    this->_fft.Windowing(FFT_WIN_TYP_HAMMING, FFT_FORWARD);
+    this->_fft.Compute(FFT_FORWARD);
+    this->_fft.ComplexToMagnitude();
+    this->_fftMicros = esp_timer_get_time() - fftStart;
+
+    //put into the frequency bands of every view
+    for (uint8_t v = 0; v < this->_noOfViews; v++) {
+        this->swapPendingMap(&this->_views[v]); //band table changes take effect here, between frames
+        int64_t viewStart = esp_timer_get_time();
+        this->putIntoFrequencyBands(&this->_views[v]);
+        this->_views[v].costMicros = esp_timer_get_time() - viewStart;
+    }
+
+    if(this->_metrics != nullptr){
+      this->_metrics->recordAnalysis(esp_timer_get_time() - fftStart);
+    }
+
+    if(this->_latencyTracer != nullptr){
+      this->_latencyTracer->record(STAGE_ANALYSIS, esp_timer_get_time() - this->_captureTime);
+    }
+}
+
+//for offline analysis (batch/): the block is analysed by convertToBands exactly as one read from the ADC
+void Analyzer::loadSamples(const AudioSample* samples){
+    memcpy(this->_samples, samples, this->_sampleSize * sizeof(AudioSample));
+    this->loadFftInput();
+}
+
+uint8_t Analyzer::addBandView(const char* name, unsigned short* bandTable, uint8_t noOfBands){
+    return this->addView(name, bandTable, noOfBands, this->_memory->levels[this->_noOfViews]);
+}
+
+uint8_t Analyzer::getNoOfViews(){
+    return this->_noOfViews;
+}
+
+BandView* Analyzer::getView(uint8_t index){
+    return &this->_views[index];
+}
+
+uint32_t Analyzer::getFftMicros(){
+    return this->_fftMicros;
+}
+
+AnalysisEngine Analyzer::getEngine(){
+    return this->_engine;
+}
+
+uint16_t Analyzer::getBlockSize(){
+    return this->_blockSize;
+}
+
+//called from the web server: the spare mapping is only ever touched here while no swap is pending, and only read by the audio loop after it has been swapped in.
+bool Analyzer::setBandTable(uint8_t viewIndex, unsigned short* bandTable, uint8_t noOfBands){
+    BandView* view = &this->_views[viewIndex];
+
+    if(noOfBands == 0 || noOfBands > view->maxBands || view->mapPending.load(std::memory_order_acquire)){
+        return false;
+    }
+
+    //band frequencies must be ascending and below the Nyquist frequency
+    for (uint8_t b = 0; b < noOfBands; b++) {
+        if((b > 0 && bandTable[b] <= bandTable[b-1]) || bandTable[b] > this->_samplingFrequency / 2){
+            return false;
+        }
+    }
+
+    //nothing to do if the band table does not change
+    BandMap* activeMap = &view->maps[view->activeMap];
+    if(activeMap->noOfBands == noOfBands && memcmp(activeMap->bandTable, bandTable, noOfBands * sizeof(unsigned short)) == 0){
+        return true;
+    }
+
+    this->prepareMap(&view->maps[1 - view->activeMap], bandTable, noOfBands);
+    view->mapPending.store(true, std::memory_order_release);
+
+    return true;
+}
+
+uint8_t Analyzer::getBandTable(uint8_t viewIndex, unsigned short* bandTable){
+    BandView* view = &this->_views[viewIndex];
+    BandMap* map = &view->maps[view->mapPending.load(std::memory_order_acquire) ? 1 - view->activeMap : view->activeMap]; //report a pending change as if already applied
+
+    memcpy(bandTable, map->bandTable, map->noOfBands * sizeof(unsigned short));
+    return map->noOfBands;
+}
+
+uint8_t Analyzer::getMaxBands(uint8_t viewIndex){
+    return this->_views[viewIndex].maxBands;
+}
+
+//octave and third octave presets are spaced logarithmically down from PRESET_MAX_FREQ. Towards the bottom, bands are kept at least one FFT bin wide.
+uint8_t Analyzer::makeBandTable(BandLayout layout, uint8_t noOfBands, unsigned short* bandTable){
+    float binWidth = (float)this->_samplingFrequency / this->_sampleSize;
+
+    for (uint8_t b = 0; b < noOfBands; b++) {
+        float freq;
+
+        if(layout == LAYOUT_LINEAR){
+            freq = ((float)PRESET_MAX_FREQ * (b + 1)) / noOfBands;
+        }else{
+            float bandsPerOctave = layout == LAYOUT_OCTAVE ? 1.0f : 3.0f;
+            freq = PRESET_MAX_FREQ / powf(2.0f, (noOfBands - 1 - b) / bandsPerOctave);
+        }
+
+        float minFreq = b == 0 ? binWidth * 2 : bandTable[b-1] + binWidth; //the first two bins are skipped
+        bandTable[b] = (unsigned short)max(freq, minFreq);
+    }
+
+    return noOfBands;
+}
+
+int64_t Analyzer::getCaptureTime(){
+    return this->_captureTime;
+}
+
+void Analyzer::setLatencyTracer(LatencyTracer* latencyTracer){
+    this->_latencyTracer = latencyTracer;
+    this->_latencyTracer->setBufferMicros((1000000LL * this->_blockSize) / this->_samplingFrequency); //time to fill one block
+}
+  
+void Analyzer::setAudioSnapshot(AudioSnapshot* audioSnapshot){
+    this->_audioSnapshot = audioSnapshot;
+}
+
+uint32_t Analyzer::getSamplingFrequency(){
+    return this->_samplingFrequency;
+}
+
+void Analyzer::setMetrics(Metrics* metrics){
+    this->_metrics = metrics;
+}
+
+
+//PRIVATE MEMBERS DEFINITION:
+uint8_t Analyzer::addView(const char* name, unsigned short* bandTable, uint8_t noOfBands, float* levels){
+    if(this->_noOfViews >= MAX_BAND_VIEWS){
+        Serial.printf("No room for band view %s\n", name);
+        return NO_BAND;
+    }
+
+    if(noOfBands > MAX_VIEW_BANDS){
+        Serial.printf("Band view %s has more than %d bands\n", name, MAX_VIEW_BANDS);
+        return NO_BAND;
+    }
+
+    BandView* view = &this->_views[this->_noOfViews];
+    view->name = name;
+    view->maxBands = noOfBands;
+    view->levels = levels;
+    view->costMicros = 0;
+
+    //both mappings live in the static buffers, so changing the band table later does not allocate
+    for (uint8_t m = 0; m < 2; m++) {
+        view->maps[m].noOfBands = 0;
+        view->maps[m].bandTable = this->_memory->bandTables[this->_noOfViews][m];
+        view->maps[m].binBands = this->_memory->binBands[this->_noOfViews][m];
+    }
+
+    view->activeMap = 0;
+    view->mapPending.store(false);
+    this->prepareMap(&view->maps[0], bandTable, noOfBands);
+
+    view->filterBank.begin(this->_memory->filterBanks[this->_noOfViews], noOfBands);
+    if(this->_engine == ENGINE_FILTER_BANK){
+        this->designFilterBank(view);
+    }
+
+    return this->_noOfViews++;
+}
+
+//in FFT, based on the sampling frequency and the number of samples, there will be a fixed number of frequency components (aka bins resolution)
+//for 1024 audio samples at a sampling frequency of 44100 Hz, there will be 513 samples from 0 Hz to 220500 Hz (formula: no.of bins = (no.of samples/2) + 1)
+//the band a bin belongs to only depends on the band table, so it is worked out once here instead of searching the band table for every bin of every frame.
+void Analyzer::prepareMap(BandMap* map, unsigned short* bandTable, uint8_t noOfBands){
+    map->noOfBands = noOfBands;
+    memcpy(map->bandTable, bandTable, noOfBands * sizeof(unsigned short));
+
+    for (unsigned short i = 0; i < this->_sampleSize / 2; i++) {
+        int freq =  i * (this->_samplingFrequency / this->_sampleSize); //find the frequency bin at this index position 
+        map->binBands[i] = NO_BAND;
+
+        //if the current bin frequency is in the range of the value provided in the band table, the bin belongs to that band. 
+        for (uint8_t b = 0; b < noOfBands; b++)
+        {
+            int startFreq = b == 0 ? 0 : bandTable[b-1];
+            int endFreq = bandTable[b];
+
+            if(freq > startFreq && freq <= endFreq){
+                map->binBands[i] = b;
+                break;
+            }
+        }
+    }
+}
+
+//i2s_read returns as soon as the DMA completes the block, so this is the closest we get to a DMA completion timestamp.
+//if the block was already waiting (the loop is falling behind), the samples are older than this.
+uint16_t Analyzer::readBlock(TickType_t ticksToWait){
+    size_t bytesToRead = this->_blockSize * sizeof(AudioSample);
     size_t bytesRead = 0;
+    AudioSample* block = this->_samples;
 
-    i2s_read(I2S_NUM_0, _samples, bytesToRead, &bytesRead, portMAX_DELAY); 
+    //FFT frames that overlap: the window slides on by a block, so the newer samples move to the front and the block is read in behind them
+    if(this->_engine == ENGINE_FFT && this->_blockSize < this->_sampleSize){
+      block = this->_samples + this->_sampleSize - this->_blockSize;
+      memmove(this->_samples, this->_samples + this->_blockSize, (this->_sampleSize - this->_blockSize) * sizeof(AudioSample));
+    }
+
+    esp_err_t err = i2s_read(I2S_NUM_0, block, bytesToRead, &bytesRead, ticksToWait); 
+    if(ticksToWait == 0 && bytesRead == 0){
+      return 0; //no block waiting
+    }
+
+    this->_captureTime = esp_timer_get_time();
+
+    if(this->_metrics != nullptr){
+      if(err != ESP_OK && ticksToWait != 0){
+        this->_metrics->countReadError();
+      }else if(bytesRead < bytesToRead){
+        this->_metrics->countShortRead();
+      }
+    }
+
+    //side tap for audio snapshots: at most a copy of the block, never a wait
+    if(this->_audioSnapshot != nullptr){
+      this->_audioSnapshot->tap(block);
+    }
 
+    return bytesRead / sizeof(AudioSample);
+}
+
+void Analyzer::loadFftInput(){
     //calculate the offset and save bytes to vReal Array
     for (uint16_t i = 0; i < _sampleSize; i++) {
       _vReal[i] = _offset - _samples[i]; //real part of the complex numbers returned
       _vImag[i] = 0.0; //We do not need imaginary part
+    }
+}
 
-    //   double normalizedValue = ((_samples[i] / 4095.0f) * 2.0f) - 1.0f;
-    //   _vReal[i] = normalizedValue; //real part of the complex numbers returned
-    //   _vImag[i] = 0.0; //We do not need imaginary part
+void Analyzer::filterBlock(uint16_t noOfSamples){
+    for (uint8_t v = 0; v < this->_noOfViews; v++) {
+        int64_t filterStart = esp_timer_get_time();
+        this->_views[v].filterBank.process(this->_samples, noOfSamples, this->_offset);
+        uint32_t filterMicros = esp_timer_get_time() - filterStart;
 
-        // Serial.print(normalizedValue);
-        // Serial.print(", ");
+        this->_views[v].costMicros += filterMicros;
+        this->_fftMicros += filterMicros;
+    }
+}
 
-    }   
+//the driver posts an event for every block it receives, and an overflow event when the audio loop has not read the queued blocks in time (the oldest block is then lost)
+void Analyzer::checkI2sEvents(){
+    i2s_event_t event;
 
-    // Serial.println();
+    while (this->_i2sEventQueue != nullptr && xQueueReceive(this->_i2sEventQueue, &event, 0) == pdTRUE) {
+      if(event.type == I2S_EVENT_RX_Q_OVF){
+        this->_metrics->countI2sOverflow();
+      }else if(event.type == I2S_EVENT_DMA_ERROR){
+        this->_metrics->countI2sDmaError();
+      }
+    }
 }
 
+//swaps in the spare mapping of the view if one is ready (called by the audio loop between frames)
+void Analyzer::swapPendingMap(BandView* view){
+    if(view->mapPending.load(std::memory_order_acquire)){
+        view->activeMap = 1 - view->activeMap;
+        view->mapPending.store(false, std::memory_order_release);
 
-void Analyzer::convertToBands(float* freqBands){
-    if(this->_freqBands == nullptr){
-        this->_freqBands = freqBands;
+        if(this->_engine == ENGINE_FILTER_BANK){
+            this->designFilterBank(view);
+        }
     }
+}
 
-    //Compute FFT using ArduinoFFT library and put into frequency bands
-    _fft->Windowing(FFT_WIN_TYP_HAMMING, FFT_FORWARD);
-    _fft->Compute(FFT_FORWARD);
-    _fft->ComplexToMagnitude();
-    this->putIntoFrequencyBands();
-
+void Analyzer::designFilterBank(BandView* view){
+    BandMap* map = &view->maps[view->activeMap];
+    view->filterBank.design(map->bandTable, map->noOfBands, this->_samplingFrequency);
 }
-  
 
-//PRIVATE MEMBERS DEFINITION:
-void Analyzer::putIntoFrequencyBands(){
-    for (unsigned short i = 0; i < this->_noOfBands; i++) {
-        this->_freqBands[i] = 0;
+//loop over half of samples (only first half is usable) and add the magnitude of every bin to the band it belongs to.
+void Analyzer::putIntoFrequencyBands(BandView* view){
+    uint8_t* binBands = view->maps[view->activeMap].binBands;
+
+    for (unsigned short i = 0; i < view->maxBands; i++) { //bands beyond the current number of bands stay at 0
+        view->levels[i] = 0;
     }
     
-    //in FFT, based on the sampling frequency and the number of samples, there will be a fixed number of frequency components (aka bins resolution)
-    //for 1024 audio samples at a sampling frequency of 44100 Hz, there will be 513 samples from 0 Hz to 220500 Hz (formula: no.of bins = (no.of samples/2) + 1)
-    //loop over half of samples (only first half is usable), find the frequency components in the samples, match to the band table, and add the matching frequencies into frequency bands array.
     for (unsigned short i = 2; i < this->_sampleSize / 2; i++) {
-        if (this->_vReal[i] > _noiseThreshold) { //try to ignore any static noise component in the audio.
-            int freq =  i * (this->_samplingFrequency / this->_sampleSize); //find the frequency bin at this index position 
-     
-            //loop over the bands. If the current bin frequency is in the range of the value provided in the band table, add the corresponding real number to the frequency band. 
-            for (unsigned short b = 0; b < this->_noOfBands; b++)
-            {
-                int startFreq = b == 0 ? 0 : _bandTable[b-1];
-                int endFreq = _bandTable[b];
-
-                if(freq > startFreq && freq <= endFreq){
-                    this->_freqBands[b] += this->_vReal[i];
-                }
-
-            }            
+        uint8_t band = binBands[i];
+
+        if (band != NO_BAND && this->_vReal[i] > _noiseThreshold) { //try to ignore any static noise component in the audio.
+            view->levels[band] += this->_vReal[i];
         }
     }
 }
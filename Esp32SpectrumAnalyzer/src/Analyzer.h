@@ -2,6 +2,10 @@
 #define Analyzer_h
 
 #include "Common.h"
+#include "LatencyTracer.h"
+#include "AudioSnapshot.h"
+#include "Metrics.h"
+#include "FilterBank.h"
 
 // #include <Arduino.h>
 // #include <driver/i2s.h>
@@ -10,26 +14,127 @@
 
 // #define twoPi 6.28318531
 
+#define I2S_EVENT_QUEUE_SIZE 8 //events the I2S driver can queue between two reads (a few per block)
+#define MAX_BAND_VIEWS 4 //maximum number of band views computed from the FFT
+#define NO_BAND 0xFF //marks FFT bins that belong to no band
+
+#define PRESET_MAX_FREQ 16000 //upper frequency of the highest band of the band table presets
+
+#define FFT_SIZE 1024 //number of audio samples per FFT (power of 2, at most 1024 as it is also the I2S DMA buffer length)
+#define MAX_VIEW_BANDS 64 //maximum number of bands of a band view
+#define DSP_ALIGNMENT 16 //alignment of the buffers the DSP loops run over
+#define ANALYZER_RAM_BUDGET (32 * 1024) //internal DRAM the analyzer buffers may take up
+#define MIN_BLOCK_SIZE 32 //fewest samples read per block (filter bank engine)
+#define FILTER_BANK_GAIN 530.0f //scales the envelopes to the band levels the FFT engine gives for the same sine, so the attenuation factor means the same with both engines
+
+typedef int16_t AudioSample; //type of the samples read from the I2S ADC
+
+//engines that turn the audio samples into band levels
+enum AnalysisEngine{
+  ENGINE_FFT, //FFT of every FFT_SIZE samples, bins summed into the bands
+  ENGINE_FILTER_BANK //band-pass filter and envelope follower per band, run over every block of samples as it arrives
+};
+
+//layouts of the band table presets
+enum BandLayout{
+  LAYOUT_OCTAVE,
+  LAYOUT_THIRD_OCTAVE,
+  LAYOUT_LINEAR
+};
+
+//mapping of the FFT bins onto a set of frequency bands
+struct BandMap{
+  uint8_t noOfBands; //number of bands
+  unsigned short* bandTable; //upper frequency of each band in Hz
+  uint8_t* binBands; //band each FFT bin belongs to (NO_BAND if none), worked out once from the band table
+};
+
+//projection of the FFT spectrum onto a set of frequency bands
+struct BandView{
+  const char* name; //name of the view
+  uint8_t maxBands; //maximum number of bands (size of the levels array)
+  BandMap maps[2]; //the active mapping and a spare one, so a new mapping can be prepared without touching the one in use
+  uint8_t activeMap; //index of the mapping in use
+  std::atomic<bool> mapPending; //set once the spare mapping is ready to be swapped in at the next frame
+  float* levels; //band levels of the current frame
+  FilterBank filterBank; //band-pass filters of the active mapping (filter bank engine)
+  uint32_t costMicros; //time it took to project the current frame onto the bands
+};
+
+//every buffer the analyzer works on, sized at compile time so it can be placed statically in internal DRAM instead of on the heap
+template<uint16_t FftSize, uint8_t MaxViewBands, typename SampleT>
+struct AnalyzerBuffers{
+  static_assert(FftSize >= 64 && (FftSize & (FftSize - 1)) == 0, "FFT size must be a power of 2 of at least 64");
+  static_assert(FftSize <= 1024, "FFT size must fit into one I2S DMA buffer (1024 samples)");
+  static_assert(FftSize / 2 <= 0xFFFF, "FFT bins are indexed with unsigned short");
+  static_assert(MaxViewBands > 0 && MaxViewBands < NO_BAND, "band indexes must fit into a byte and not clash with NO_BAND");
+
+  alignas(DSP_ALIGNMENT) double vReal[FftSize]; //real part of the FFT complex numbers
+  alignas(DSP_ALIGNMENT) double vImag[FftSize]; //imaginary part of the FFT complex numbers
+  alignas(DSP_ALIGNMENT) SampleT samples[FftSize]; //audio samples from the I2S ADC
+  alignas(DSP_ALIGNMENT) uint8_t binBands[MAX_BAND_VIEWS][2][FftSize / 2]; //band each FFT bin belongs to, for both mappings of every view
+  unsigned short bandTables[MAX_BAND_VIEWS][2][MaxViewBands]; //band tables of both mappings of every view
+  float levels[MAX_BAND_VIEWS][MaxViewBands]; //band levels of the additional views (the first view writes to the array passed to convertToBands)
+  alignas(DSP_ALIGNMENT) float filterBanks[MAX_BAND_VIEWS][FILTER_BANK_ARRAYS * MaxViewBands]; //coefficients and states of the band-pass filters of every view (filter bank engine)
+};
+
+typedef AnalyzerBuffers<FFT_SIZE, MAX_VIEW_BANDS, AudioSample> AnalyzerMemory;
+static_assert(sizeof(AnalyzerMemory) <= ANALYZER_RAM_BUDGET, "analyzer buffers exceed ANALYZER_RAM_BUDGET");
+
 class Analyzer{
     private:
-        uint8_t _noOfBands; //number of bands to divide the frequency spectrum into
         uint32_t _samplingFrequency; //audio sampling frequency  
         int _sampleSize; //number of samples to take
+        AnalysisEngine _engine; //engine that turns the samples into band levels
+        uint16_t _blockSize; //number of samples read per block (FFT size with the FFT engine)
+        uint16_t _dmaBufferCount; //number of I2S DMA buffers of one block each
         int _noiseThreshold; //noise cutoff (mostly towards upper bands).
         uint16_t _offset; //offset for the ADC
         double* _vReal; //array to hold real part of the FFT complex numbers
         double* _vImag; //array to hold imaginary part of the FFT complex numbers
-        float* _freqBands; //array to hold the frequency band levels
-        int16_t* _samples; //array to hold the audio samples from I2S ADC
-        unsigned short* _bandTable; //array to hold band frequencies in Hz
-        arduinoFFT* _fft; //Arduino FFT library object
-        void putIntoFrequencyBands(); //puts the FFT results into frequency bands
+        AudioSample* _samples; //array to hold the audio samples from I2S ADC
+        AnalyzerMemory* _memory; //statically allocated buffers of the analyzer
+        BandView _views[MAX_BAND_VIEWS]; //band views computed from the FFT. The first one is displayed on the LED matrix.
+        uint8_t _noOfViews; //number of band views
+        uint32_t _fftMicros; //time it took to compute the FFT (or run the filter bank) of the current frame
+        arduinoFFT _fft; //Arduino FFT library object
+        int64_t _captureTime; //time (us since boot) the DMA completed the current block of samples
+        LatencyTracer* _latencyTracer; //records the latency of the capture and analysis stages (optional)
+        AudioSnapshot* _audioSnapshot; //copies raw blocks for download when triggered (optional)
+        Metrics* _metrics; //counts short reads, read errors and I2S overflows (optional)
+        QueueHandle_t _i2sEventQueue; //events posted by the I2S driver (eg. RX queue overflow)
+        uint16_t readBlock(TickType_t ticksToWait); //reads the next block of samples, waiting up to ticksToWait for it. Returns the number of samples read.
+        void loadFftInput(); //copies the samples into the FFT input, less the ADC offset (FFT engine)
+        void filterBlock(uint16_t noOfSamples); //runs the samples read through the filter banks of every view (filter bank engine)
+        void checkI2sEvents(); //counts the overflows and DMA errors the I2S driver reported since the last block
+        uint8_t addView(const char* name, unsigned short* bandTable, uint8_t noOfBands, float* levels); //adds a band view writing its levels to the given array
+        void prepareMap(BandMap* map, unsigned short* bandTable, uint8_t noOfBands); //copies the band table into the mapping and works out the band each FFT bin belongs to
+        void swapPendingMap(BandView* view); //swaps in the spare mapping of the view if one is ready
+        void designFilterBank(BandView* view); //works out the band-pass filters of the active mapping of the view (filter bank engine)
+        void putIntoFrequencyBands(BandView* view); //puts the FFT results into the frequency bands of a view
 
     public:
-        Analyzer(uint8_t numberOfBands, unsigned short* bandTable); //constructor
+        Analyzer(AnalyzerMemory* memory, uint8_t numberOfBands, unsigned short* bandTable); //constructor. memory should be a static (zero initialized) object, so it lives in internal DRAM.
+        void setEngine(AnalysisEngine engine, uint16_t blockSize); //selects the analysis engine and the number of samples read per block (power of 2 from MIN_BLOCK_SIZE to FFT_SIZE). With the FFT engine, a block shorter than FFT_SIZE makes the FFT frames overlap, one per block. Call before setupAdc.
         bool setupAdc(); //setup the ADC and I2S for audio sampling
-        void readAudioSamples(); //read audio samples from the ADC through I2S 
-        void convertToBands(float* freqBins);  //convert the audio samples to frequency bands
+        void readAudioSamples(); //read audio samples from the ADC through I2S (with the filter bank engine, every block waiting is read and filtered)
+        void convertToBands(float* freqBins);  //convert the audio samples to frequency bands (of every view; the first view goes into freqBins)
+        void loadSamples(const AudioSample* samples); //takes FFT_SIZE samples as the I2S ADC delivers them instead of reading a block (FFT engine)
+        uint8_t addBandView(const char* name, unsigned short* bandTable, uint8_t noOfBands); //adds a band view computed from the same FFT. Returns its index.
+        uint8_t getNoOfViews(); //returns the number of band views
+        BandView* getView(uint8_t index); //returns a band view
+        uint32_t getFftMicros(); //returns the time it took to compute the FFT (or run the filter bank) of the current frame
+        AnalysisEngine getEngine(); //returns the analysis engine
+        uint16_t getBlockSize(); //returns the number of samples read per block
+        bool setBandTable(uint8_t viewIndex, unsigned short* bandTable, uint8_t noOfBands); //prepares a new band table for a view (on the calling thread), which the audio loop swaps in at the next frame. Returns false if invalid or a change is still pending.
+        uint8_t getBandTable(uint8_t viewIndex, unsigned short* bandTable); //copies the band table of a view and returns its number of bands
+        uint8_t getMaxBands(uint8_t viewIndex); //returns the maximum number of bands of a view
+        uint8_t makeBandTable(BandLayout layout, uint8_t noOfBands, unsigned short* bandTable); //fills in a band table preset. Returns the number of bands.
+        int64_t getCaptureTime(); //returns the time (us since boot) the DMA completed the current block of samples
+        void setLatencyTracer(LatencyTracer* latencyTracer); //sets the tracer to record the capture and analysis latency in
+        void setAudioSnapshot(AudioSnapshot* audioSnapshot); //sets the tap that copies raw blocks for download
+        uint32_t getSamplingFrequency(); //returns the audio sampling frequency
+        void setMetrics(Metrics* metrics); //sets the metrics to count the capture problems in
 
 };
 
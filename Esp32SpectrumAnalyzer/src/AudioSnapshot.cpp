@@ -0,0 +1,177 @@
+#include "AudioSnapshot.h"
+
+AudioSnapshot::AudioSnapshot(uint16_t blockSize, uint16_t noOfBlocks, uint32_t sampleRate, uint8_t triggerPin){
+    this->_blockSize = blockSize;
+    this->_noOfBlocks = max(noOfBlocks, (uint16_t)1);
+    this->_sampleRate = sampleRate;
+    this->_triggerPin = triggerPin;
+    this->_triggerPressed = false;
+    this->_blocks = new int16_t[this->_noOfBlocks * this->_blockSize]; //allocated once, so taking a snapshot never allocates
+    this->_blocksCaptured = 0;
+    this->_state.store(SNAPSHOT_IDLE);
+    this->_tapMicros = 0;
+    this->_maxTapMicros = 0;
+
+    if(this->_triggerPin != NO_TRIGGER_PIN){
+      pinMode(this->_triggerPin, INPUT_PULLUP);
+    }
+}
+
+void AudioSnapshot::tap(const int16_t* samples){
+    this->pollTrigger();
+
+    if((this->_state.load(std::memory_order_acquire) & SNAPSHOT_STATE_MASK) != SNAPSHOT_CAPTURING){
+      return;
+    }
+
+    int64_t tapStart = esp_timer_get_time();
+    if(this->_blocksCaptured == this->_noOfBlocks){
+      this->_blocksCaptured = 0; //armed again since the last snapshot
+    }
+    memcpy(&this->_blocks[this->_blocksCaptured * this->_blockSize], samples, this->_blockSize * sizeof(int16_t));
+    this->_blocksCaptured++;
+
+    if(this->_blocksCaptured == this->_noOfBlocks){
+      this->_state.store(SNAPSHOT_READY, std::memory_order_release); //no download starts while capturing, so there are none to keep
+    }
+
+    this->_tapMicros = esp_timer_get_time() - tapStart;
+    if(this->_tapMicros > this->_maxTapMicros){
+      this->_maxTapMicros = this->_tapMicros;
+    }
+}
+
+//called from the audio loop (button) and the async TCP task (/snapshot). The state only changes to capturing if there is no download
+//in progress at that very moment, as a download can start at any time from the async TCP task.
+bool AudioSnapshot::arm(){
+    uint16_t state = this->_state.load(std::memory_order_acquire);
+    do {
+      if(state >= SNAPSHOT_DOWNLOAD){
+        return false;
+      }
+      if(state == SNAPSHOT_CAPTURING){
+        return true; //already on it
+      }
+    } while(!this->_state.compare_exchange_weak(state, SNAPSHOT_CAPTURING, std::memory_order_acq_rel, std::memory_order_acquire));
+    Serial.println("Audio snapshot armed");
+
+    return true;
+}
+
+SnapshotState AudioSnapshot::getState(){
+    return (SnapshotState)(this->_state.load() & SNAPSHOT_STATE_MASK);
+}
+
+uint16_t AudioSnapshot::getBlocksCaptured(){
+    switch(this->getState()){
+      case SNAPSHOT_IDLE:
+        return 0;
+      case SNAPSHOT_READY:
+        return this->_noOfBlocks;
+      default:
+        return this->_blocksCaptured % this->_noOfBlocks; //the count of the last snapshot until the first block is copied
+    }
+}
+
+uint16_t AudioSnapshot::getNoOfBlocks(){
+    return this->_noOfBlocks;
+}
+
+uint32_t AudioSnapshot::getSampleRate(){
+    return this->_sampleRate;
+}
+
+uint32_t AudioSnapshot::getTapMicros(){
+    return this->_tapMicros;
+}
+
+uint32_t AudioSnapshot::getMaxTapMicros(){
+    return this->_maxTapMicros;
+}
+
+bool AudioSnapshot::startDownload(){
+    uint16_t state = this->_state.load(std::memory_order_acquire);
+    do {
+      if((state & SNAPSHOT_STATE_MASK) != SNAPSHOT_READY || state / SNAPSHOT_DOWNLOAD == SNAPSHOT_MAX_DOWNLOADS){
+        return false;
+      }
+    } while(!this->_state.compare_exchange_weak(state, state + SNAPSHOT_DOWNLOAD, std::memory_order_acq_rel, std::memory_order_acquire));
+
+    return true;
+}
+
+void AudioSnapshot::endDownload(){
+    this->_state.fetch_sub(SNAPSHOT_DOWNLOAD, std::memory_order_release);
+}
+
+size_t AudioSnapshot::getWavLength(){
+    return WAV_HEADER_SIZE + (this->_noOfBlocks * this->_blockSize * sizeof(int16_t));
+}
+
+//called from the async TCP task for every part of the response, with index the position in the file. Parts may start or end half way through a sample.
+size_t AudioSnapshot::readWav(uint8_t* buffer, size_t maxLen, size_t index){
+    size_t length = min(maxLen, this->getWavLength() - index);
+    size_t copied = 0;
+
+    //header
+    if(index < WAV_HEADER_SIZE){
+      uint8_t header[WAV_HEADER_SIZE];
+      writeWavHeader(header, this->getWavLength() - WAV_HEADER_SIZE, this->_sampleRate);
+      copied = min(length, WAV_HEADER_SIZE - index);
+      memcpy(buffer, &header[index], copied);
+    }
+
+    //samples, converted to little endian 16 bit PCM on the way out
+    while (copied < length) {
+      size_t position = index + copied - WAV_HEADER_SIZE;
+      int16_t pcm = toPcm(this->_blocks[position / 2]);
+      buffer[copied++] = (position % 2 == 0) ? (pcm & 0xFF) : ((uint16_t)pcm >> 8);
+    }
+
+    return copied;
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+//the button is polled once per block (about every 23 ms), which also debounces it
+void AudioSnapshot::pollTrigger(){
+    if(this->_triggerPin == NO_TRIGGER_PIN){
+      return;
+    }
+
+    bool pressed = digitalRead(this->_triggerPin) == LOW;
+    if(pressed && !this->_triggerPressed){
+      this->arm();
+    }
+
+    this->_triggerPressed = pressed;
+}
+
+//the ADC puts its channel number in the top 4 bits of each sample and the 12 bit reading in the rest
+int16_t AudioSnapshot::toPcm(int16_t sample){
+    return (int16_t)(((sample & 0x0FFF) - 2048) * 16);
+}
+
+void AudioSnapshot::writeWavHeader(uint8_t* header, uint32_t dataSize, uint32_t sampleRate){
+    uint32_t riffSize = dataSize + WAV_HEADER_SIZE - 8;
+    uint32_t fmtSize = 16;
+    uint16_t format = 1; //PCM
+    uint16_t channels = 1;
+    uint32_t byteRate = sampleRate * sizeof(int16_t);
+    uint16_t blockAlign = sizeof(int16_t);
+    uint16_t bitsPerSample = 16;
+
+    //the ESP32 is little endian like the WAV format, so the fields can be copied as they are
+    memcpy(&header[0], "RIFF", 4);
+    memcpy(&header[4], &riffSize, 4);
+    memcpy(&header[8], "WAVEfmt ", 8);
+    memcpy(&header[16], &fmtSize, 4);
+    memcpy(&header[20], &format, 2);
+    memcpy(&header[22], &channels, 2);
+    memcpy(&header[24], &sampleRate, 4);
+    memcpy(&header[28], &byteRate, 4);
+    memcpy(&header[32], &blockAlign, 2);
+    memcpy(&header[34], &bitsPerSample, 2);
+    memcpy(&header[36], "data", 4);
+    memcpy(&header[40], &dataSize, 4);
+}
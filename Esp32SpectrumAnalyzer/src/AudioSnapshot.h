@@ -0,0 +1,54 @@
+#ifndef AudioSnapshot_h
+#define AudioSnapshot_h
+
+#include "Common.h"
+
+#define NO_TRIGGER_PIN 0xFF //no button to trigger a snapshot
+#define WAV_HEADER_SIZE 44 //size of the header of a PCM WAV file
+#define SNAPSHOT_STATE_MASK 0xFF //SnapshotState, in the low byte of _state
+#define SNAPSHOT_DOWNLOAD 0x100 //one download in progress, counted in the high byte of _state
+#define SNAPSHOT_MAX_DOWNLOADS 0xFF //downloads the high byte of _state can count
+
+//state of the snapshot
+enum SnapshotState{
+  SNAPSHOT_IDLE, //nothing captured yet
+  SNAPSHOT_CAPTURING, //copying the blocks read by the audio loop
+  SNAPSHOT_READY //a complete snapshot is ready for download
+};
+
+//side tap on the capture path that copies the next few raw I2S blocks into a preallocated buffer when triggered,
+//so the actual input signal can be downloaded as a WAV file. The audio loop only ever copies a block; it never waits on a download.
+class AudioSnapshot {
+  private:
+    uint16_t _blockSize; //number of samples in a block
+    uint16_t _noOfBlocks; //number of blocks in a snapshot
+    uint32_t _sampleRate; //sampling frequency of the samples
+    uint8_t _triggerPin; //button that triggers a snapshot (active low), or NO_TRIGGER_PIN
+    bool _triggerPressed; //state of the button when last polled
+    int16_t* _blocks; //the raw samples of the snapshot
+    uint16_t _blocksCaptured; //number of blocks copied so far (only written by the audio loop while capturing)
+    std::atomic<uint16_t> _state; //SnapshotState and the number of downloads in progress, changed together so a snapshot is never armed while
+                                  //it is being downloaded
+    volatile uint32_t _tapMicros; //time it took to copy the last block
+    volatile uint32_t _maxTapMicros; //longest time it took to copy a block
+    void pollTrigger(); //arms the snapshot when the button is pressed
+    static int16_t toPcm(int16_t sample); //converts a raw I2S ADC sample to 16 bit PCM
+    static void writeWavHeader(uint8_t* header, uint32_t dataSize, uint32_t sampleRate); //fills in the header of a mono 16 bit PCM WAV file
+
+  public:
+    AudioSnapshot(uint16_t blockSize, uint16_t noOfBlocks, uint32_t sampleRate, uint8_t triggerPin); //constructor. Takes noOfBlocks x blockSize x 2 bytes.
+    void tap(const int16_t* samples); //called by the audio loop for every block read. Copies the block if a snapshot is being captured.
+    bool arm(); //starts capturing the next blocks. Returns false if a snapshot is being downloaded.
+    SnapshotState getState(); //returns the state of the snapshot
+    uint16_t getBlocksCaptured(); //returns the number of blocks captured
+    uint16_t getNoOfBlocks(); //returns the number of blocks in a snapshot
+    uint32_t getSampleRate(); //returns the sampling frequency
+    uint32_t getTapMicros(); //returns the time it took to copy the last block
+    uint32_t getMaxTapMicros(); //returns the longest time it took to copy a block
+    bool startDownload(); //marks a download as started. Returns false if no complete snapshot is ready.
+    void endDownload(); //marks a download as finished (or aborted)
+    size_t getWavLength(); //returns the size of the WAV file
+    size_t readWav(uint8_t* buffer, size_t maxLen, size_t index); //converts the bytes of the WAV file starting at index. Returns the number of bytes written.
+};
+
+#endif
@@ -0,0 +1,213 @@
+#include "ClockSync.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void writeUint64(uint8_t* buffer, uint64_t value){
+    for (uint8_t i = 0; i < 8; i++) {
+      buffer[i] = value >> (i * 8);
+    }
+}
+
+static uint64_t readUint64(const uint8_t* buffer){
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+      value |= (uint64_t)buffer[i] << (i * 8);
+    }
+    return value;
+}
+
+static void writeHeader(uint8_t* buffer, uint8_t type, uint16_t sequence){
+    buffer[0] = CLOCK_SYNC_MAGIC & 0xFF;
+    buffer[1] = (CLOCK_SYNC_MAGIC >> 8) & 0xFF;
+    buffer[2] = (CLOCK_SYNC_MAGIC >> 16) & 0xFF;
+    buffer[3] = (CLOCK_SYNC_MAGIC >> 24) & 0xFF;
+    buffer[4] = CLOCK_SYNC_VERSION;
+    buffer[5] = type;
+    buffer[6] = sequence;
+    buffer[7] = sequence >> 8;
+}
+
+//true if data is a packet of the given type
+static bool checkHeader(const uint8_t* data, size_t length, uint8_t type){
+    return length == CLOCK_SYNC_PACKET_SIZE
+      && (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24)) == CLOCK_SYNC_MAGIC
+      && data[4] == CLOCK_SYNC_VERSION && data[5] == type;
+}
+
+
+ClockSync::ClockSync(){
+    this->_sequence = 0;
+    this->reset();
+}
+
+void ClockSync::reset(){
+    this->_noOfSamples = 0;
+    this->_nextSample = 0;
+    this->_requestTime = 0;
+    this->_referenceLocal = 0;
+    this->_referenceOffset = 0;
+    this->_drift = 0.0;
+    this->_roundTrip = 0;
+    this->_residual = 0;
+    this->_synced = false;
+}
+
+size_t ClockSync::makeRequest(uint8_t* buffer, int64_t now){
+    memset(buffer, 0, CLOCK_SYNC_PACKET_SIZE);
+    writeHeader(buffer, CLOCK_SYNC_REQUEST, ++this->_sequence);
+    writeUint64(buffer + 8, now);
+
+    this->_requestTime = now; //a response to an earlier request is ignored from now on
+    return CLOCK_SYNC_PACKET_SIZE;
+}
+
+bool ClockSync::handleResponse(const uint8_t* data, size_t length, int64_t now){
+    if(!checkHeader(data, length, CLOCK_SYNC_RESPONSE) || this->_requestTime == 0){
+      return false;
+    }
+
+    uint16_t sequence = data[6] | (data[7] << 8);
+    int64_t t1 = readUint64(data + 8);
+    int64_t t2 = readUint64(data + 16);
+    int64_t t3 = readUint64(data + 24);
+
+    if(sequence != this->_sequence || t1 != this->_requestTime){
+      return false;
+    }
+    this->_requestTime = 0;
+
+    ClockSample sample;
+    sample.localTime = t1 + (now - t1) / 2;
+    sample.offset = ((t2 - t1) + (t3 - now)) / 2;
+    sample.roundTrip = (now - t1) - (t3 - t2);
+    if(sample.roundTrip < 0){
+      return false; //the server took longer than the whole exchange: not a valid response
+    }
+
+    //a jump much larger than the round trip can explain means the server clock started over (eg. the server restarted)
+    if(this->_synced && sample.roundTrip < CLOCK_SYNC_STEP_US && llabs(sample.offset - this->getOffset(sample.localTime)) > CLOCK_SYNC_STEP_US){
+      this->reset();
+    }
+
+    this->_samples[this->_nextSample] = sample;
+    this->_nextSample = (this->_nextSample + 1) % CLOCK_SYNC_SAMPLES;
+    if(this->_noOfSamples < CLOCK_SYNC_SAMPLES){
+      this->_noOfSamples++;
+    }
+
+    if(this->_noOfSamples >= CLOCK_SYNC_MIN_SAMPLES){
+      this->fit();
+      this->_synced = true;
+    }
+
+    return true;
+}
+
+size_t ClockSync::makeResponse(const uint8_t* request, size_t length, int64_t receiveTime, int64_t sendTime, uint8_t* buffer){
+    if(!checkHeader(request, length, CLOCK_SYNC_REQUEST)){
+      return 0;
+    }
+
+    memcpy(buffer, request, CLOCK_SYNC_PACKET_SIZE); //keeps the sequence number and t1
+    buffer[5] = CLOCK_SYNC_RESPONSE;
+    writeUint64(buffer + 16, receiveTime);
+    writeUint64(buffer + 24, sendTime);
+
+    return CLOCK_SYNC_PACKET_SIZE;
+}
+
+bool ClockSync::isSynced(){
+    return this->_synced;
+}
+
+int64_t ClockSync::toServer(int64_t localTime){
+    return localTime + this->getOffset(localTime);
+}
+
+int64_t ClockSync::toLocal(int64_t serverTime){
+    //the offset hardly changes over the difference between the two clocks, so one correction is enough
+    int64_t localTime = serverTime - this->_referenceOffset;
+    return serverTime - this->getOffset(localTime);
+}
+
+int64_t ClockSync::getOffset(int64_t localTime){
+    return this->_referenceOffset + (int64_t)llround(this->_drift * (double)(localTime - this->_referenceLocal));
+}
+
+float ClockSync::getDriftPpm(){
+    return this->_drift * 1e6;
+}
+
+uint32_t ClockSync::getRoundTrip(){
+    return this->_roundTrip;
+}
+
+uint32_t ClockSync::getResidual(){
+    return this->_residual;
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+void ClockSync::fit(){
+    if(this->_noOfSamples == 0){
+      return;
+    }
+
+    //order the exchanges by round trip (insertion sort, there are only a few)
+    uint8_t order[CLOCK_SYNC_SAMPLES] = {};
+    for (uint8_t i = 0; i < this->_noOfSamples; i++) {
+      uint8_t j = i;
+      while(j > 0 && this->_samples[order[j-1]].roundTrip > this->_samples[i].roundTrip){
+        order[j] = order[j-1];
+        j--;
+      }
+      order[j] = i;
+    }
+
+    uint8_t noOfFitted = (this->_noOfSamples + 1) / 2;
+    if(noOfFitted < CLOCK_SYNC_MIN_SAMPLES){
+      noOfFitted = this->_noOfSamples < CLOCK_SYNC_MIN_SAMPLES ? this->_noOfSamples : CLOCK_SYNC_MIN_SAMPLES;
+    }
+
+    //work relative to the first exchange fitted, so the doubles only hold small numbers
+    const ClockSample* base = &this->_samples[order[0]];
+    double meanX = 0.0, meanY = 0.0;
+    int64_t minX = INT64_MAX, maxX = INT64_MIN;
+    for (uint8_t i = 0; i < noOfFitted; i++) {
+      const ClockSample* sample = &this->_samples[order[i]];
+      meanX += (double)(sample->localTime - base->localTime);
+      meanY += (double)(sample->offset - base->offset);
+      minX = sample->localTime < minX ? sample->localTime : minX;
+      maxX = sample->localTime > maxX ? sample->localTime : maxX;
+    }
+    meanX /= noOfFitted;
+    meanY /= noOfFitted;
+
+    double sumXY = 0.0, sumXX = 0.0;
+    for (uint8_t i = 0; i < noOfFitted; i++) {
+      const ClockSample* sample = &this->_samples[order[i]];
+      double x = (double)(sample->localTime - base->localTime) - meanX;
+      double y = (double)(sample->offset - base->offset) - meanY;
+      sumXY += x * y;
+      sumXX += x * x;
+    }
+
+    //the drift is only estimated once the exchanges span long enough, until then the last estimate is kept
+    if(maxX - minX >= CLOCK_SYNC_MIN_DRIFT_SPAN_US && sumXX > 0.0){
+      double maxDrift = CLOCK_SYNC_MAX_DRIFT_PPM / 1e6;
+      this->_drift = fmax(-maxDrift, fmin(maxDrift, sumXY / sumXX));
+    }
+
+    this->_referenceLocal = base->localTime + (int64_t)llround(meanX);
+    this->_referenceOffset = base->offset + (int64_t)llround(meanY);
+    this->_roundTrip = base->roundTrip;
+
+    double sumSquares = 0.0;
+    for (uint8_t i = 0; i < noOfFitted; i++) {
+      const ClockSample* sample = &this->_samples[order[i]];
+      double deviation = (double)(sample->offset - this->getOffset(sample->localTime));
+      sumSquares += deviation * deviation;
+    }
+    this->_residual = sqrt(sumSquares / noOfFitted);
+}
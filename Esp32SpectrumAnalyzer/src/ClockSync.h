@@ -0,0 +1,68 @@
+#ifndef ClockSync_h
+#define ClockSync_h
+
+//only standard headers, so the clock sync also builds on a PC (eg. for tools and tests)
+#include <stdint.h>
+#include <stddef.h>
+
+#define CLOCK_SYNC_MAGIC 0x53444153 //"SADS"
+#define CLOCK_SYNC_VERSION 1
+#define CLOCK_SYNC_PORT 4211 //UDP port the server answers on
+#define CLOCK_SYNC_PACKET_SIZE 32 //requests are as long as responses, so both take the same time on the air
+#define CLOCK_SYNC_REQUEST 1
+#define CLOCK_SYNC_RESPONSE 2
+#define CLOCK_SYNC_SAMPLES 64 //exchanges the estimate is fitted over (32 s at one exchange every 500 ms)
+#define CLOCK_SYNC_MIN_SAMPLES 4 //exchanges needed before the clock counts as synced
+#define CLOCK_SYNC_MIN_DRIFT_SPAN_US 2000000 //exchanges must span this long before the drift is estimated
+#define CLOCK_SYNC_MAX_DRIFT_PPM 500.0 //drift estimates beyond this are clamped (crystals are within 50 ppm)
+#define CLOCK_SYNC_STEP_US 100000 //an offset this far from the estimate means the server restarted: the estimate starts over
+
+/*
+Packet (all fields little endian):
+  uint32 magic, uint8 version, uint8 type (1 request, 2 response), uint16 sequence,
+  int64 t1 (client clock when the request was sent), int64 t2 (server clock when the request arrived), int64 t3 (server clock when the response was sent)
+The client stamps t4 when the response arrives. As in NTP:
+  round trip = (t4 - t1) - (t3 - t2), offset = ((t2 - t1) + (t3 - t4)) / 2
+*/
+
+//one request/response exchange
+struct ClockSample{
+  int64_t localTime; //client clock halfway through the exchange
+  int64_t offset; //server clock minus client clock
+  int64_t roundTrip; //time on the network, without the time the server took to respond
+};
+
+//estimates the offset and drift of a server clock from request/response exchanges over UDP (NTP/PTP style), so clients can act on server times.
+//the exchanges with the shortest round trips are the least disturbed by queueing, so the offset is fitted over the faster half of the recent ones:
+//a straight line over local time, whose slope is the drift. Not thread safe: requests and responses must be handled by the same task.
+class ClockSync {
+  private:
+    ClockSample _samples[CLOCK_SYNC_SAMPLES]; //most recent exchanges (ring buffer)
+    uint8_t _noOfSamples; //number of exchanges in the ring buffer
+    uint8_t _nextSample; //slot of the next exchange
+    uint16_t _sequence; //sequence number of the last request
+    int64_t _requestTime; //client clock when the last request was sent (0 if it was answered)
+    int64_t _referenceLocal; //client clock the estimate refers to
+    int64_t _referenceOffset; //offset at _referenceLocal
+    double _drift; //change of the offset per us of client clock
+    uint32_t _roundTrip; //shortest round trip of the exchanges fitted
+    uint32_t _residual; //RMS deviation of the exchanges fitted from the estimate (us)
+    bool _synced; //flag to indicate enough exchanges were made
+    void fit(); //fits the offset and drift over the faster half of the exchanges
+
+  public:
+    ClockSync(); //constructor
+    void reset(); //forgets every exchange
+    size_t makeRequest(uint8_t* buffer, int64_t now); //writes a request stamped with the client clock (now) into buffer (CLOCK_SYNC_PACKET_SIZE bytes). Returns its length.
+    bool handleResponse(const uint8_t* data, size_t length, int64_t now); //adds the exchange of a response (now: client clock when it arrived). Returns false if it does not answer the last request.
+    static size_t makeResponse(const uint8_t* request, size_t length, int64_t receiveTime, int64_t sendTime, uint8_t* buffer); //server side: answers a request (times on the server clock). Returns 0 if it is not a request.
+    bool isSynced(); //returns true once enough exchanges were made
+    int64_t toServer(int64_t localTime); //converts a client time to server time
+    int64_t toLocal(int64_t serverTime); //converts a server time to client time
+    int64_t getOffset(int64_t localTime); //returns the server clock minus the client clock at the given client time
+    float getDriftPpm(); //returns how much faster the server clock runs, in ppm
+    uint32_t getRoundTrip(); //returns the shortest round trip of the exchanges fitted (us)
+    uint32_t getResidual(); //returns the RMS deviation of the exchanges fitted from the estimate (us)
+};
+
+#endif
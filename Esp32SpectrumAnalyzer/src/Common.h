@@ -2,11 +2,14 @@
 #define Common_h
 
 #include <stdint.h>
+#include <atomic>
 #include "Arduino.h"
 #include "WiFi.h"
 #include "ESPmDNS.h"
+#include "AsyncUDP.h"
 #include "crgb.h"
-#include <WebServer.h>
+#include <ESPAsyncWebServer.h> //v3.7.2
+#include <Preferences.h>
 #include <driver/i2s.h>
 #include <driver/adc.h>
 #include <FastLED.h> //v3.9.13
@@ -0,0 +1,116 @@
+#include "ConfigStore.h"
+
+ConfigStore::ConfigStore(unsigned short noOfLEDs, uint8_t maxBands){
+    this->_noOfLEDs = noOfLEDs;
+    this->_maxBands = maxBands;
+    this->_blobSize = sizeof(ConfigHeader) + sizeof(DisplayConfig) + (noOfLEDs * sizeof(CRGB)) + (maxBands * sizeof(unsigned short));
+    this->_blob = new uint8_t[this->_blobSize] {0};
+}
+
+bool ConfigStore::load(DisplayConfig* config, CRGB* ledColors, unsigned short* bandTable){
+    if(!_prefs.begin("sad", true)){ //read-only. Fails if nothing has been saved yet.
+      return false;
+    }
+
+    size_t length = _prefs.getBytesLength("config");
+    bool loaded = length == this->_blobSize && _prefs.getBytes("config", this->_blob, this->_blobSize) == this->_blobSize;
+    _prefs.end();
+
+    if(!loaded){
+      Serial.println("No stored config found, using defaults");
+      return false;
+    }
+
+    //validate the whole blob before touching the arguments, so a bad blob never leaves the settings half applied
+    ConfigHeader* header = (ConfigHeader*)this->_blob;
+    uint8_t* payload = this->_blob + sizeof(ConfigHeader);
+    size_t payloadSize = this->_blobSize - sizeof(ConfigHeader);
+
+    if(header->magic != CONFIG_MAGIC || header->version != CONFIG_VERSION || header->noOfLEDs != this->_noOfLEDs){
+      Serial.printf("Stored config version %u does not match, using defaults\n", header->version);
+      return false;
+    }
+
+    if(header->crc != this->crc32(payload, payloadSize)){
+      Serial.println("Stored config is corrupt, using defaults");
+      return false;
+    }
+
+    memcpy(config, payload, sizeof(DisplayConfig));
+    memcpy(ledColors, payload + sizeof(DisplayConfig), this->_noOfLEDs * sizeof(CRGB));
+    memcpy(bandTable, payload + sizeof(DisplayConfig) + (this->_noOfLEDs * sizeof(CRGB)), this->_maxBands * sizeof(unsigned short));
+
+    return true;
+}
+
+bool ConfigStore::save(const DisplayConfig* config, const CRGB* ledColors, const unsigned short* bandTable){
+    ConfigHeader* header = (ConfigHeader*)this->_blob;
+    uint8_t* payload = this->_blob + sizeof(ConfigHeader);
+    size_t payloadSize = this->_blobSize - sizeof(ConfigHeader);
+
+    memcpy(payload, config, sizeof(DisplayConfig));
+    memcpy(payload + sizeof(DisplayConfig), ledColors, this->_noOfLEDs * sizeof(CRGB));
+    memcpy(payload + sizeof(DisplayConfig) + (this->_noOfLEDs * sizeof(CRGB)), bandTable, this->_maxBands * sizeof(unsigned short));
+
+    header->magic = CONFIG_MAGIC;
+    header->version = CONFIG_VERSION;
+    header->noOfLEDs = this->_noOfLEDs;
+    header->crc = this->crc32(payload, payloadSize);
+
+    if(!_prefs.begin("sad", false)){
+      Serial.println("Unable to open config storage");
+      return false;
+    }
+
+    bool saved = _prefs.putBytes("config", this->_blob, this->_blobSize) == this->_blobSize;
+    _prefs.end();
+
+    if(!saved){
+      Serial.println("Unable to save config");
+    }
+
+    return saved;
+}
+
+RunMode ConfigStore::loadRunMode(){
+    if(!_prefs.begin("sad", true)){
+      return RUN_MODE_NORMAL;
+    }
+
+    uint8_t mode = _prefs.getUChar("runMode", RUN_MODE_NORMAL);
+    _prefs.end();
+
+    return mode == RUN_MODE_DSP ? RUN_MODE_DSP : RUN_MODE_NORMAL;
+}
+
+bool ConfigStore::saveRunMode(RunMode mode){
+    if(!_prefs.begin("sad", false)){
+      Serial.println("Unable to open config storage");
+      return false;
+    }
+
+    bool saved = _prefs.putUChar("runMode", mode) == 1;
+    _prefs.end();
+
+    if(!saved){
+      Serial.println("Unable to save run mode");
+    }
+
+    return saved;
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+//bitwise CRC-32 (IEEE). The blob is small and only checked at boot and when saving, so no lookup table is needed.
+uint32_t ConfigStore::crc32(const uint8_t* data, size_t length){
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t i = 0; i < length; i++) {
+      crc ^= data[i];
+      for (uint8_t bit = 0; bit < 8; bit++) {
+        crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+      }
+    }
+
+    return ~crc;
+}
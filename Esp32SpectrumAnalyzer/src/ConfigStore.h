@@ -0,0 +1,53 @@
+#ifndef ConfigStore_h
+#define ConfigStore_h
+
+#include "Common.h"
+
+#define CONFIG_MAGIC 0x43444153 //"SADC"
+#define CONFIG_VERSION 2 //bump whenever the layout of DisplayConfig changes; blobs of other versions are ignored
+
+//what the device runs as. Stored apart from the settings, so changing it does not touch them.
+enum RunMode{
+  RUN_MODE_NORMAL, //WiFi, web portal and streaming on core 0, audio and LEDs on core 1
+  RUN_MODE_DSP //dedicated DSP mode: no network, capture and analysis on core 0, LEDs on core 1
+};
+
+//display settings that can be changed via web portal (pixel colors and band table are stored separately)
+struct DisplayConfig{
+  uint16_t peakDelay;
+  uint16_t peakSpeed;
+  float speedFilter;
+  float attenuationFactor;
+  uint8_t brightness;
+  uint8_t peakR;
+  uint8_t peakG;
+  uint8_t peakB;
+  uint8_t noOfBands; //number of bands in the band table (0 if none stored)
+};
+
+//header stored in front of the settings and pixel colors
+struct ConfigHeader{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t noOfLEDs;
+  uint32_t crc; //CRC-32 of everything after the header
+};
+
+class ConfigStore {
+  private:
+    Preferences _prefs; //NVS storage
+    unsigned short _noOfLEDs; //number of LEDs whose colors are stored
+    uint8_t _maxBands; //maximum number of bands in the stored band table
+    size_t _blobSize; //size of the stored blob in bytes
+    uint8_t* _blob; //buffer for loading/saving the blob (allocated once)
+    uint32_t crc32(const uint8_t* data, size_t length); //calculates the CRC-32 of the data
+    
+  public:
+    ConfigStore(unsigned short noOfLEDs, uint8_t maxBands); //constructor
+    bool load(DisplayConfig* config, CRGB* ledColors, unsigned short* bandTable); //loads the stored config. Returns false (leaving the arguments untouched) if missing, corrupt or of another version.
+    bool save(const DisplayConfig* config, const CRGB* ledColors, const unsigned short* bandTable); //saves the config to flash
+    RunMode loadRunMode(); //returns the stored run mode (RUN_MODE_NORMAL if none)
+    bool saveRunMode(RunMode mode); //stores the run mode taken at the next boot
+};
+
+#endif
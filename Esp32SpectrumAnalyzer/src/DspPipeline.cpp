@@ -0,0 +1,95 @@
+#include "DspPipeline.h"
+
+DspPipeline::DspPipeline(Analyzer* analyzer, Metrics* metrics, uint8_t exitPin, uint32_t warmupFrames){
+    this->_analyzer = analyzer;
+    this->_metrics = metrics;
+    this->_warmupFrames = warmupFrames;
+    this->_mailbox = xQueueCreate(1, sizeof(DspFrame));
+    this->_analysisTask = nullptr;
+    this->_analysedFrame = {};
+    this->_framesAnalysed = 0;
+    this->_framesAtLastReport = 0;
+    this->_lastReportTime = 0;
+    this->_exitPin = exitPin;
+    this->_exitPressedMillis = 0;
+
+    if(this->_exitPin != NO_EXIT_PIN){
+      pinMode(this->_exitPin, INPUT_PULLUP);
+    }
+}
+
+void DspPipeline::begin(UBaseType_t priority){
+    this->_lastReportTime = esp_timer_get_time();
+    xTaskCreatePinnedToCore(this->analysisThread, "DspTask", DSP_TASK_STACK, this, priority, &this->_analysisTask, 0);
+    Serial.printf("Dedicated DSP mode: analysis on core 0, %u samples per FFT every %u samples\n", FFT_SIZE, this->_analyzer->getBlockSize());
+}
+
+int64_t DspPipeline::receiveFrame(DspFrame* frame){
+    xQueueReceive(this->_mailbox, frame, portMAX_DELAY);
+    return frame->captureTime;
+}
+
+//the analysis is reported against the time a block takes to arrive, which is all the time it has on core 0 before the DMA buffers fill up.
+//formatted into a buffer on the stack, as printf allocates for long lines and the render loop is armed against allocations by then.
+void DspPipeline::report(Print& out){
+    int64_t now = esp_timer_get_time();
+    if(now - this->_lastReportTime < DSP_REPORT_SECONDS * 1000000LL){
+      return;
+    }
+
+    uint32_t framesAnalysed = this->_framesAnalysed;
+    uint32_t analysedPerSecond = (uint64_t)(framesAnalysed - this->_framesAtLastReport) * 1000000 / (now - this->_lastReportTime);
+    uint32_t blockMicros = (uint64_t)this->_analyzer->getBlockSize() * 1000000 / this->_analyzer->getSamplingFrequency();
+    uint32_t analysisMicros = this->_metrics->getAnalysisMicros();
+    this->_framesAtLastReport = framesAnalysed;
+    this->_lastReportTime = now;
+
+    char line[DSP_REPORT_BYTES];
+    int length = snprintf(line, sizeof(line), "DSP: %u fps shown, %u analysed (FFT %u, hop %u), analysis %u us (%u%% of a block), render %u us, %u dropped, %u I2S overflows\n",
+      (unsigned)this->_metrics->getFramesPerSecond(), (unsigned)analysedPerSecond, FFT_SIZE, this->_analyzer->getBlockSize(), (unsigned)analysisMicros,
+      (unsigned)(analysisMicros * 100 / blockMicros), (unsigned)this->_metrics->getRenderMicros(), (unsigned)this->_metrics->getFramesDropped(),
+      (unsigned)this->_metrics->getI2sOverflows());
+    out.write((const uint8_t*)line, min(length, (int)sizeof(line) - 1));
+}
+
+//the button is polled once per frame, which also debounces it
+bool DspPipeline::exitRequested(){
+    if(this->_exitPin == NO_EXIT_PIN){
+      return false;
+    }
+
+    if(digitalRead(this->_exitPin) != LOW){
+      this->_exitPressedMillis = 0;
+      return false;
+    }
+
+    if(this->_exitPressedMillis == 0){
+      this->_exitPressedMillis = max(millis(), 1UL); //0 means not pressed
+    }
+    return millis() - this->_exitPressedMillis >= DSP_EXIT_HOLD_MS;
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+//captures and analyses every block. The render loop is given the newest frame only, so a slow frame on the LEDs never holds up the capture.
+void DspPipeline::analysisThread(void* pvParameters){
+    DspPipeline* pipeline = (DspPipeline*)pvParameters;
+    uint32_t warmupFrames = pipeline->_warmupFrames;
+    AllocGuard::watchTask("DspTask");
+
+    while(true){
+      pipeline->_analyzer->readAudioSamples();
+      pipeline->_analyzer->convertToBands(pipeline->_analysedFrame.bands);
+      pipeline->_analysedFrame.captureTime = pipeline->_analyzer->getCaptureTime();
+
+      if(uxQueueMessagesWaiting(pipeline->_mailbox) > 0){
+        pipeline->_metrics->countFrameDropped();
+      }
+      xQueueOverwrite(pipeline->_mailbox, &pipeline->_analysedFrame);
+      pipeline->_framesAnalysed++;
+
+      if(warmupFrames > 0 && --warmupFrames == 0){
+        AllocGuard::armTask();
+      }
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef DspPipeline_h
+#define DspPipeline_h
+
+#include "Analyzer.h"
+#include "AllocGuard.h"
+
+#define DSP_TASK_STACK 8192 //stack of the analysis task (bytes)
+#define DSP_REPORT_SECONDS 10 //interval of the performance report written to the serial port
+#define DSP_EXIT_HOLD_MS 3000 //time the exit button has to be held to leave dedicated DSP mode
+#define DSP_REPORT_BYTES 192 //longest report line
+#define NO_EXIT_PIN 0xFF //no button to leave dedicated DSP mode
+
+//a frame handed over from the analysis task to the render loop
+struct DspFrame{
+  float bands[MAX_VIEW_BANDS]; //band levels of the first view, as convertToBands gives them
+  int64_t captureTime; //time (us since boot) the samples of the frame were captured
+};
+
+//dedicated DSP mode: with the network off, core 0 is free for the audio. A task pinned to it captures and analyses every block, and hands
+//the bands over to the render loop on core 1 through a mailbox of one frame. The analysis never waits for the LEDs: a frame that is not
+//taken before the next one is ready is replaced, and counted as dropped.
+class DspPipeline {
+  private:
+    Analyzer* _analyzer;
+    Metrics* _metrics; //analysis and render times, dropped frames
+    uint32_t _warmupFrames; //frames the analysis task runs before it is armed against allocations
+    QueueHandle_t _mailbox; //the frame waiting for the render loop (queue of one, overwritten)
+    TaskHandle_t _analysisTask; //task handle of the analysis task
+    DspFrame _analysedFrame; //frame being analysed (analysis task only)
+    volatile uint32_t _framesAnalysed; //frames the analysis task has handed over
+    uint32_t _framesAtLastReport; //frames analysed when the last report was written
+    int64_t _lastReportTime; //time (us since boot) the last report was written
+    uint8_t _exitPin; //button that leaves dedicated DSP mode when held (active low), or NO_EXIT_PIN
+    unsigned long _exitPressedMillis; //time the exit button was pressed (0 if it is not)
+    static void analysisThread(void* pvParameters); //analysis task function
+
+  public:
+    DspPipeline(Analyzer* analyzer, Metrics* metrics, uint8_t exitPin, uint32_t warmupFrames); //constructor. Call after the ADC is set up.
+    void begin(UBaseType_t priority); //starts the analysis task on core 0
+    int64_t receiveFrame(DspFrame* frame); //waits for the next analysed frame. Returns the time its samples were captured.
+    void report(Print& out); //writes the performance report every DSP_REPORT_SECONDS (call from the render loop)
+    bool exitRequested(); //true once the exit button has been held for DSP_EXIT_HOLD_MS
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "FilterBank.h"
+#include <math.h>
+#include <string.h>
+
+FilterBank::FilterBank(){
+    this->_b0 = nullptr;
+    this->_a1 = nullptr;
+    this->_a2 = nullptr;
+    this->_y1 = nullptr;
+    this->_y2 = nullptr;
+    this->_envelope = nullptr;
+    this->_maxBands = 0;
+    this->_noOfBands = 0;
+    this->_x1 = 0.0f;
+    this->_x2 = 0.0f;
+    this->_release = 0.0f;
+}
+
+void FilterBank::begin(float* memory, uint8_t maxBands){
+    this->_maxBands = maxBands;
+    this->_b0 = memory;
+    this->_a1 = memory + maxBands;
+    this->_a2 = memory + maxBands * 2;
+    this->_y1 = memory + maxBands * 3;
+    this->_y2 = memory + maxBands * 4;
+    this->_envelope = memory + maxBands * 5;
+    memset(memory, 0, FILTER_BANK_ARRAYS * maxBands * sizeof(float));
+}
+
+//band b spans from the band below it up to bandTable[b] (the first band spans one octave). Its filter is centred on the geometric mean
+//of the band edges and is as wide as the band (RBJ audio EQ cookbook band-pass).
+void FilterBank::design(const unsigned short* bandTable, uint8_t noOfBands, uint32_t samplingFrequency){
+    this->_noOfBands = noOfBands < this->_maxBands ? noOfBands : this->_maxBands;
+
+    for (uint8_t b = 0; b < this->_noOfBands; b++) {
+      float upperFreq = bandTable[b] > 0 ? bandTable[b] : 1; //a band table may start at 0 Hz
+      float lowerFreq = b == 0 ? upperFreq / 2 : bandTable[b-1];
+      float octaves = fmaxf(log2f(upperFreq / lowerFreq), FILTER_BANK_MIN_OCTAVES);
+
+      float w0 = 2.0f * (float)M_PI * sqrtf(lowerFreq * upperFreq) / samplingFrequency;
+      float alpha = sinf(w0) * sinhf(logf(2.0f) / 2.0f * octaves * w0 / sinf(w0));
+      float a0 = 1.0f + alpha;
+
+      this->_b0[b] = alpha / a0;
+      this->_a1[b] = -2.0f * cosf(w0) / a0;
+      this->_a2[b] = (1.0f - alpha) / a0;
+    }
+
+    memset(this->_y1, 0, this->_maxBands * sizeof(float));
+    memset(this->_y2, 0, this->_maxBands * sizeof(float));
+    memset(this->_envelope, 0, this->_maxBands * sizeof(float));
+    this->_release = expf(-1000.0f / (FILTER_BANK_RELEASE_MS * samplingFrequency));
+}
+
+//runs one input sample (already differenced: x - x2) through the filter of every band. Every array is read and written at the same index only
+//and there are no branches (the envelope follower is a select), so the loop can be vectorized where the target has SIMD. The arrays are
+//parameters so __restrict tells the compiler they do not overlap.
+static inline void filterSample(const float* __restrict b0, const float* __restrict a1, const float* __restrict a2, float* __restrict y1, float* __restrict y2,
+                                float* __restrict envelope, uint8_t noOfBands, float d, float release){
+    for (uint8_t b = 0; b < noOfBands; b++) {
+      float y = b0[b] * d - a1[b] * y1[b] - a2[b] * y2[b];
+      y2[b] = y1[b];
+      y1[b] = y;
+      float peak = fabsf(y);
+      float decayed = envelope[b] * release;
+      envelope[b] = peak > decayed ? peak : decayed; //a select rather than fmaxf, whose NaN handling keeps GCC from vectorizing the loop
+    }
+}
+
+//the outer loop runs over the samples of the block, the inner one over the bands
+void FilterBank::process(const int16_t* samples, uint16_t count, uint16_t offset){
+    float x1 = this->_x1;
+    float x2 = this->_x2;
+
+    for (uint16_t i = 0; i < count; i++) {
+      float x = (float)(offset - samples[i]);
+      float d = x - x2; //b0 * x + b2 * x2 with b2 = -b0
+      x2 = x1;
+      x1 = x;
+
+      filterSample(this->_b0, this->_a1, this->_a2, this->_y1, this->_y2, this->_envelope, this->_noOfBands, d, this->_release);
+    }
+
+    this->_x1 = x1;
+    this->_x2 = x2;
+}
+
+void FilterBank::getLevels(float* levels, float gain){
+    for (uint8_t b = 0; b < this->_maxBands; b++) {
+      levels[b] = b < this->_noOfBands ? this->_envelope[b] * gain : 0.0f;
+    }
+}
+
+uint8_t FilterBank::getNoOfBands(){
+    return this->_noOfBands;
+}
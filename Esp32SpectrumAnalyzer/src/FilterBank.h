@@ -0,0 +1,38 @@
+#ifndef FilterBank_h
+#define FilterBank_h
+
+//only standard headers, so the filter bank also builds on a PC (eg. for benchmarks)
+#include <stdint.h>
+
+#define FILTER_BANK_ARRAYS 6 //arrays per filter bank: b0, a1, a2, y1, y2 and envelope of every band
+#define FILTER_BANK_MIN_OCTAVES 0.1f //narrowest band-pass filter (narrower ones ring for too long)
+#define FILTER_BANK_RELEASE_MS 20.0f //time for an envelope to fall to 1/e of its peak once its band goes quiet
+
+//one band-pass biquad per band, run sample by sample with a peak envelope follower on each, like the chip of a graphic equalizer display.
+//the coefficients and states are kept in separate arrays over the bands (structure of arrays), so the loop over the bands of a sample
+//has no dependencies between its iterations and can be vectorized. The filters are band-passes with 0 dB peak gain (b1 = 0, b2 = -b0),
+//so the input history is shared by all of them.
+class FilterBank {
+  private:
+    float* _b0; //feed forward coefficient of every band (b2 = -b0)
+    float* _a1; //first feedback coefficient of every band
+    float* _a2; //second feedback coefficient of every band
+    float* _y1; //last output of every band
+    float* _y2; //output before the last one of every band
+    float* _envelope; //peak envelope of the output of every band
+    uint8_t _maxBands; //maximum number of bands (length of the arrays)
+    uint8_t _noOfBands; //number of bands
+    float _x1; //last input sample
+    float _x2; //input sample before the last one
+    float _release; //factor the envelopes fall by per sample
+
+  public:
+    FilterBank(); //constructor
+    void begin(float* memory, uint8_t maxBands); //sets the memory to keep the coefficients and states in (FILTER_BANK_ARRAYS x maxBands floats)
+    void design(const unsigned short* bandTable, uint8_t noOfBands, uint32_t samplingFrequency); //works out a band-pass filter for every band of the band table and clears the states
+    void process(const int16_t* samples, uint16_t count, uint16_t offset); //runs a block of raw ADC samples (offset - sample) through every filter
+    void getLevels(float* levels, float gain); //writes the envelope of every band times gain (bands beyond the current number of bands are 0)
+    uint8_t getNoOfBands(); //returns the number of bands
+};
+
+#endif
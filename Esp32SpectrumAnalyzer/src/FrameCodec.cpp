@@ -0,0 +1,231 @@
+#include "FrameCodec.h"
+#include <string.h>
+
+#define TOKEN_UNCHANGED 0x00 //run of unchanged values, low 7 bits are the run length - 1
+#define TOKEN_DELTA 0x80 //single value changed by a small amount, low 6 bits are the change + 32
+#define TOKEN_LITERAL 0xC0 //run of new values, low 6 bits are the run length - 1
+#define MAX_UNCHANGED_RUN 128
+#define MAX_LITERAL_RUN 64
+#define DELTA_BIAS 32
+
+static void writeUint32(uint8_t* buffer, uint32_t value){
+    buffer[0] = value;
+    buffer[1] = value >> 8;
+    buffer[2] = value >> 16;
+    buffer[3] = value >> 24;
+}
+
+static uint32_t readUint32(const uint8_t* buffer){
+    return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+//true if the change from previous to value fits in a delta token
+static bool isSmallChange(uint8_t previous, uint8_t value){
+    int change = (int)value - previous;
+    return change >= -DELTA_BIAS && change < DELTA_BIAS;
+}
+
+
+FrameEncoder::FrameEncoder(uint16_t keyframeInterval){
+    this->_previousBands = 0;
+    this->_previousRows = 0;
+    this->_hasPrevious = false;
+    this->_sequence = 0;
+    this->_keyframeInterval = keyframeInterval;
+    this->_framesSinceKeyframe = 0;
+}
+
+size_t FrameEncoder::encode(const uint8_t* levels, const uint8_t* peaks, uint8_t noOfBands, uint8_t noOfRows, uint32_t timestamp, uint32_t presentation, uint8_t* buffer, size_t size){
+    if(noOfBands > FRAME_MAX_BANDS || size < FRAME_HEADER_SIZE + (size_t)(noOfBands * 2)){
+      return 0;
+    }
+
+    uint16_t count = noOfBands * 2;
+    uint8_t values[FRAME_MAX_BANDS * 2];
+    memcpy(values, levels, noOfBands);
+    memcpy(values + noOfBands, peaks, noOfBands);
+
+    bool keyframe = !this->_hasPrevious || noOfBands != this->_previousBands || noOfRows != this->_previousRows || this->_framesSinceKeyframe + 1 >= this->_keyframeInterval;
+    size_t length = keyframe ? 0 : this->encodeDelta(values, count, buffer + FRAME_HEADER_SIZE);
+
+    if(length == 0){
+      //keyframe (also when the changes take more room than the values)
+      keyframe = true;
+      memcpy(buffer + FRAME_HEADER_SIZE, values, count);
+      length = count;
+      this->_framesSinceKeyframe = 0;
+    }else{
+      this->_framesSinceKeyframe++;
+    }
+
+    writeUint32(buffer, FRAME_MAGIC);
+    buffer[4] = FRAME_VERSION;
+    buffer[5] = noOfBands;
+    buffer[6] = noOfRows;
+    buffer[7] = keyframe ? FRAME_FLAG_KEYFRAME : 0;
+    writeUint32(buffer + 8, this->_sequence++);
+    writeUint32(buffer + 12, timestamp);
+    writeUint32(buffer + 16, presentation);
+
+    memcpy(this->_previous, values, count);
+    this->_previousBands = noOfBands;
+    this->_previousRows = noOfRows;
+    this->_hasPrevious = true;
+
+    return FRAME_HEADER_SIZE + length;
+}
+
+void FrameEncoder::requestKeyframe(){
+    this->_hasPrevious = false;
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+size_t FrameEncoder::encodeDelta(const uint8_t* values, uint16_t count, uint8_t* buffer){
+    size_t length = 0;
+    uint16_t i = 0;
+
+    while(i < count){
+      //stop as soon as the delta is no smaller than a keyframe, so it never writes past the room of a keyframe
+      if(length >= count){
+        return 0;
+      }
+
+      if(values[i] == this->_previous[i]){
+        uint16_t run = 1;
+        while(i + run < count && run < MAX_UNCHANGED_RUN && values[i + run] == this->_previous[i + run]){
+          run++;
+        }
+        buffer[length++] = TOKEN_UNCHANGED | (run - 1);
+        i += run;
+      }else if(isSmallChange(this->_previous[i], values[i])){
+        buffer[length++] = TOKEN_DELTA | (values[i] - this->_previous[i] + DELTA_BIAS);
+        i++;
+      }else{
+        //large changes are sent as they are, in runs
+        uint16_t run = 1;
+        while(i + run < count && run < MAX_LITERAL_RUN && !isSmallChange(this->_previous[i + run], values[i + run])){
+          run++;
+        }
+        if(length + 1 + run >= count){
+          return 0;
+        }
+        buffer[length++] = TOKEN_LITERAL | (run - 1);
+        memcpy(buffer + length, values + i, run);
+        length += run;
+        i += run;
+      }
+    }
+
+    return length < count ? length : 0;
+}
+
+
+FrameDecoder::FrameDecoder(){
+    this->reset();
+}
+
+FrameDecodeResult FrameDecoder::decode(const uint8_t* data, size_t length){
+    FrameHeader header;
+
+    if(!readHeader(data, length, &header)){
+      return FRAME_INVALID;
+    }
+
+    const uint8_t* payload = data + header.headerSize;
+    size_t payloadLength = length - header.headerSize;
+    uint16_t count = header.noOfBands * 2;
+    uint8_t values[FRAME_MAX_BANDS * 2];
+
+    if(header.flags & FRAME_FLAG_KEYFRAME){
+      if(payloadLength != count){
+        return FRAME_INVALID;
+      }
+      memcpy(values, payload, count);
+    }else{
+      if(!this->_hasFrame || header.sequence != this->_frame.sequence + 1 || header.noOfBands != this->_frame.noOfBands || header.noOfRows != this->_frame.noOfRows){
+        return FRAME_MISSING_BASE;
+      }
+
+      memcpy(values, this->_frame.levels, header.noOfBands);
+      memcpy(values + header.noOfBands, this->_frame.peaks, header.noOfBands);
+
+      //apply the tokens to a copy, so an invalid frame leaves the last frame as it was
+      size_t position = 0;
+      uint16_t i = 0;
+      while(position < payloadLength){
+        uint8_t token = payload[position++];
+
+        if((token & 0x80) == TOKEN_UNCHANGED){
+          i += (token & 0x7F) + 1;
+        }else if((token & 0xC0) == TOKEN_DELTA){
+          if(i >= count){
+            return FRAME_INVALID;
+          }
+          values[i] += (token & 0x3F) - DELTA_BIAS;
+          i++;
+        }else{
+          uint8_t run = (token & 0x3F) + 1;
+          if(i + run > count || position + run > payloadLength){
+            return FRAME_INVALID;
+          }
+          memcpy(values + i, payload + position, run);
+          position += run;
+          i += run;
+        }
+      }
+
+      if(i != count){
+        return FRAME_INVALID; //the tokens must cover every value exactly
+      }
+    }
+
+    this->_frame.sequence = header.sequence;
+    this->_frame.timestamp = header.timestamp;
+    this->_frame.presentation = header.presentation;
+    this->_frame.noOfBands = header.noOfBands;
+    this->_frame.noOfRows = header.noOfRows;
+    memcpy(this->_frame.levels, values, header.noOfBands);
+    memcpy(this->_frame.peaks, values + header.noOfBands, header.noOfBands);
+    this->_hasFrame = true;
+
+    return FRAME_DECODED;
+}
+
+const SpectrumFrame& FrameDecoder::getFrame(){
+    return this->_frame;
+}
+
+void FrameDecoder::reset(){
+    memset(&this->_frame, 0, sizeof(this->_frame));
+    this->_hasFrame = false;
+}
+
+bool FrameDecoder::readHeader(const uint8_t* data, size_t length, FrameHeader* header){
+    if(length < FRAME_V2_HEADER_SIZE || length > FRAME_MAX_SIZE || readUint32(data) != FRAME_MAGIC){
+      return false;
+    }
+
+    header->version = data[4];
+    header->noOfBands = data[5];
+    header->noOfRows = data[6];
+    header->flags = data[7];
+    header->sequence = readUint32(data + 8);
+    header->timestamp = readUint32(data + 12);
+    header->presentation = 0;
+    header->headerSize = FRAME_V2_HEADER_SIZE;
+
+    if(header->version == 1){
+      header->flags = FRAME_FLAG_KEYFRAME; //version 1 frames always carry all values (the byte was reserved)
+    }else if(header->version == FRAME_VERSION){
+      if(length < FRAME_HEADER_SIZE){
+        return false;
+      }
+      header->presentation = readUint32(data + 16);
+      header->headerSize = FRAME_HEADER_SIZE;
+    }else if(header->version != 2){
+      return false;
+    }
+
+    return header->noOfBands <= FRAME_MAX_BANDS;
+}
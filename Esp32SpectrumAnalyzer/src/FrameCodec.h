@@ -0,0 +1,87 @@
+#ifndef FrameCodec_h
+#define FrameCodec_h
+
+//only standard headers, so the codec also builds on a PC (eg. for tools and tests)
+#include <stdint.h>
+#include <stddef.h>
+
+#define FRAME_MAGIC 0x46444153 //"SADF"
+#define FRAME_VERSION 3 //version 2 frames (no presentation time) and version 1 frames (no deltas either, flags byte reserved) are still accepted
+#define FRAME_MAX_BANDS 64 //maximum number of bands a frame can carry
+#define FRAME_HEADER_SIZE 20 //magic, version, noOfBands, noOfRows, flags, sequence, timestamp, presentation
+#define FRAME_V2_HEADER_SIZE 16 //header of version 1 and 2 frames (without the presentation time)
+#define FRAME_MAX_SIZE (FRAME_HEADER_SIZE + (FRAME_MAX_BANDS * 2)) //a frame is never larger than a keyframe with the maximum number of bands
+
+#define FRAME_FLAG_KEYFRAME 0x01 //the frame carries all values. Otherwise it carries the changes since the frame with the previous sequence number.
+
+/*
+Encoded frame (all fields little endian):
+  uint32 magic, uint8 version, uint8 noOfBands, uint8 noOfRows, uint8 flags, uint32 sequence, uint32 timestamp (ms),
+  uint32 presentation (us, low 32 bits of the sender's clock, 0 if not set)
+  keyframe: noOfBands band levels (0-255) followed by noOfBands peak rows
+  delta frame: tokens covering the same 2 x noOfBands values, each value compared to the previous frame
+    0x00-0x7F: 1-128 values unchanged
+    0x80-0xBF: 1 value changed by -32 to +31 (token - 0xA0)
+    0xC0-0xFF: 1-64 values replaced by the bytes that follow
+*/
+
+//decoded frame
+struct SpectrumFrame{
+  uint32_t sequence;
+  uint32_t timestamp;
+  uint32_t presentation; //time the frame is to be shown at (us, low 32 bits of the sender's clock), 0 if not set
+  uint8_t noOfBands;
+  uint8_t noOfRows; //number of rows of the sending matrix (peak rows are relative to it)
+  uint8_t levels[FRAME_MAX_BANDS]; //band levels (0-255)
+  uint8_t peaks[FRAME_MAX_BANDS]; //peak rows
+};
+
+//header of an encoded frame
+struct FrameHeader{
+  uint8_t version;
+  uint8_t noOfBands;
+  uint8_t noOfRows;
+  uint8_t flags;
+  uint32_t sequence;
+  uint32_t timestamp;
+  uint32_t presentation; //0 in version 1 and 2 frames
+  uint8_t headerSize; //length of the header (the payload follows it)
+};
+
+enum FrameDecodeResult{
+  FRAME_DECODED, //the frame was decoded
+  FRAME_INVALID, //the data is not a valid frame
+  FRAME_MISSING_BASE //delta frame, but the frame before it was not decoded. Frames can be decoded again from the next keyframe.
+};
+
+class FrameEncoder {
+  private:
+    uint8_t _previous[FRAME_MAX_BANDS * 2]; //levels and peaks of the last frame encoded, the base of the next delta frame
+    uint8_t _previousBands; //number of bands of the last frame encoded
+    uint8_t _previousRows; //number of rows of the last frame encoded
+    bool _hasPrevious; //flag to indicate _previous holds a frame
+    uint32_t _sequence; //sequence number of the next frame
+    uint16_t _keyframeInterval; //a keyframe is sent at least every this many frames
+    uint16_t _framesSinceKeyframe; //number of delta frames since the last keyframe
+    size_t encodeDelta(const uint8_t* values, uint16_t count, uint8_t* buffer); //writes the delta tokens. Returns their length, or 0 if they are not smaller than the values themselves.
+
+  public:
+    FrameEncoder(uint16_t keyframeInterval); //constructor
+    size_t encode(const uint8_t* levels, const uint8_t* peaks, uint8_t noOfBands, uint8_t noOfRows, uint32_t timestamp, uint32_t presentation, uint8_t* buffer, size_t size); //encodes a frame into buffer without allocating. Returns its length, or 0 if it does not fit.
+    void requestKeyframe(); //makes the next frame a keyframe (eg. after a frame could not be sent)
+};
+
+class FrameDecoder {
+  private:
+    SpectrumFrame _frame; //last frame decoded, the base of the next delta frame
+    bool _hasFrame; //flag to indicate _frame holds a frame
+
+  public:
+    FrameDecoder(); //constructor
+    FrameDecodeResult decode(const uint8_t* data, size_t length); //decodes a frame. Frames must be passed in sequence order.
+    const SpectrumFrame& getFrame(); //returns the last frame decoded
+    void reset(); //forgets the last frame, so decoding starts again at the next keyframe
+    static bool readHeader(const uint8_t* data, size_t length, FrameHeader* header); //reads and checks the header of a frame
+};
+
+#endif
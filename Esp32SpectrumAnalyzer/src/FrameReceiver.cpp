@@ -0,0 +1,393 @@
+#include "FrameReceiver.h"
+
+#define SENDER_TIMEOUT_MS 1000 //if no frames arrive for this long, the sender is considered gone (or restarted)
+#define CONCEAL_DECAY 0.85f //factor the held levels are multiplied with for every further missing frame
+
+FrameReceiver::FrameReceiver(IPAddress address, uint16_t port, unsigned short playoutDelay, uint8_t firstBand){
+    this->_address = address;
+    this->_port = port;
+    this->_listening = false;
+    this->_lock = portMUX_INITIALIZER_UNLOCKED;
+    this->_lastSyncMillis = 0;
+    this->_syncResponseTime = 0;
+    this->_syncResponsePending = false;
+    this->_firstBand = firstBand;
+
+    for (unsigned short i = 0; i < JITTER_BUFFER_SLOTS; i++) {
+      this->_frames[i].filled = false;
+    }
+
+    this->_newestSequence = 0;
+    this->_newestTimestamp = 0;
+    this->_newestPresentation = 0;
+    this->_lastPacketMillis = 0;
+    this->_clockOffset = 0;
+    this->_windowMinOffset = 0;
+    this->_windowPackets = 0;
+    this->_frameInterval = 1000.0f * 1024 / 44100; //the sender's frame interval until measured
+    this->_playoutDelay = playoutDelay;
+    this->_holdFrames = 3;
+    this->_playing = false;
+    this->_nextSequence = 0;
+    this->_nextTimestamp = 0;
+    this->_nextPresentation = 0;
+    this->_showTime = 0;
+    this->_missedFrames = 0;
+    this->_lastLevels = new float[FRAME_MAX_BANDS] {0};
+    this->_framesReceived = 0;
+    this->_framesLate = 0;
+    this->_framesConcealed = 0;
+    this->_framesUndecodable = 0;
+    this->_clockSynced = false;
+    this->_clockDriftPpm = 0.0f;
+    this->_clockRoundTrip = 0;
+    this->_clockResidual = 0;
+    this->_lastShowError = 0;
+    this->_maxShowError = 0;
+    this->_windowMaxShowError = 0;
+    this->_showErrorFrames = 0;
+    this->_meanShowError = 0.0f;
+}
+
+bool FrameReceiver::receiveFrame(float* levels, unsigned short noOfBands){
+    if(!this->_listening){
+      //frames can only be received once the network is up
+      if(WiFi.status() != WL_CONNECTED){
+        vTaskDelay(100 / portTICK_PERIOD_MS);
+        return false;
+      }
+
+      this->_listening = this->_udp.listenMulticast(this->_address, this->_port);
+      if(!this->_listening){
+        Serial.println("Unable to listen for frames");
+        vTaskDelay(1000 / portTICK_PERIOD_MS);
+        return false;
+      }
+
+      this->_udp.onPacket([this](AsyncUDPPacket& packet){ this->onPacket(packet); });
+      Serial.printf("Listening for frames on %s:%u\n", this->_address.toString().c_str(), this->_port);
+
+      if(this->_syncUdp.listen(CLOCK_SYNC_PORT)){
+        this->_syncUdp.onPacket([this](AsyncUDPPacket& packet){ this->onSyncPacket(packet); });
+      }else{
+        Serial.println("Unable to listen for clock sync responses");
+      }
+    }
+
+    this->syncClock();
+
+    unsigned long lastPacketMillis = this->_lastPacketMillis; //read before millis(), so it can never be ahead of it
+
+    if(!this->_playing){
+      if(this->_framesReceived == 0 || millis() - lastPacketMillis > SENDER_TIMEOUT_MS){
+        vTaskDelay(10 / portTICK_PERIOD_MS); //nothing to play yet
+        return false;
+      }
+
+      this->resync();
+    }
+
+    //sender gone: blank the display and wait for it to come back
+    if(millis() - lastPacketMillis > SENDER_TIMEOUT_MS){
+      this->_playing = false;
+      this->_showTime = 0;
+      for (unsigned short i = 0; i < noOfBands; i++) {
+        levels[i] = this->_lastLevels[i] = 0.0f;
+      }
+      return true;
+    }
+
+    //wait for the show time of the next frame. Frames are held back until the presentation time the sender stamped them with (or by the playout
+    //delay until the clock is synced), which gives late packets time to arrive. The last part of the wait is left to the LED matrix.
+    int64_t showTime = this->getPlayoutTime();
+    int64_t wait = showTime - esp_timer_get_time();
+
+    if(wait > 100000){
+      vTaskDelay(100 / portTICK_PERIOD_MS); //stay responsive, the caller comes back for the frame
+      return false;
+    }else if(wait > SHOW_SPIN_US){
+      vTaskDelay((wait - SHOW_SPIN_US) / 1000 / portTICK_PERIOD_MS);
+    }
+    this->_showTime = showTime;
+
+    BufferedFrame frame;
+    bool found = false;
+
+    portENTER_CRITICAL(&this->_lock);
+    BufferedFrame* slot = &this->_frames[this->_nextSequence & (JITTER_BUFFER_SLOTS - 1)];
+    if(slot->filled && slot->sequence == this->_nextSequence){
+      frame = *slot;
+      slot->filled = false;
+      found = true;
+    }
+    this->_nextSequence++;
+    bool fellBehind = (int32_t)(this->_newestSequence - this->_nextSequence) >= JITTER_BUFFER_SLOTS / 2;
+    portEXIT_CRITICAL(&this->_lock);
+
+    FrameDecodeResult result = FRAME_INVALID;
+    if(found){
+      result = this->_decoder.decode(frame.data, frame.length);
+      if(result == FRAME_MISSING_BASE){
+        this->_framesUndecodable++;
+      }
+    }
+
+    if(result == FRAME_DECODED){
+      const SpectrumFrame& decoded = this->_decoder.getFrame();
+      this->_missedFrames = 0;
+      this->_nextTimestamp = decoded.timestamp + this->_frameInterval;
+      this->_nextPresentation = decoded.presentation != 0 && this->_clockSync.isSynced() ? this->unwrapPresentation(decoded.presentation) + (int64_t)(this->_frameInterval * 1000) : 0;
+
+      for (unsigned short i = 0; i < noOfBands && i < FRAME_MAX_BANDS; i++) {
+        unsigned short band = this->_firstBand + i;
+        this->_lastLevels[i] = band < decoded.noOfBands ? decoded.levels[band] / 255.0f : 0.0f;
+      }
+    }else{
+      //conceal the lost frame: hold the last one for a few frames, then let it decay
+      this->_framesConcealed++;
+      this->_missedFrames++;
+      this->_nextTimestamp += this->_frameInterval;
+      if(this->_nextPresentation != 0){
+        this->_nextPresentation += (int64_t)(this->_frameInterval * 1000);
+      }
+
+      if(this->_missedFrames > this->_holdFrames){
+        for (unsigned short i = 0; i < noOfBands && i < FRAME_MAX_BANDS; i++) {
+          this->_lastLevels[i] *= CONCEAL_DECAY;
+        }
+      }
+    }
+
+    for (unsigned short i = 0; i < noOfBands; i++) {
+      levels[i] = i < FRAME_MAX_BANDS ? this->_lastLevels[i] : 0.0f;
+    }
+
+    //if playout fell too far behind the newest frame (eg. after a long stall), jump ahead
+    if(fellBehind){
+      this->resync();
+    }
+
+    return true;
+}
+
+uint32_t FrameReceiver::getFramesReceived(){
+    return this->_framesReceived;
+}
+
+uint32_t FrameReceiver::getFramesLate(){
+    return this->_framesLate;
+}
+
+uint32_t FrameReceiver::getFramesConcealed(){
+    return this->_framesConcealed;
+}
+
+uint32_t FrameReceiver::getFramesUndecodable(){
+    return this->_framesUndecodable;
+}
+
+int64_t FrameReceiver::getShowTime(){
+    return this->_showTime;
+}
+
+//called by the display loop right after the LEDs started to show the frame
+void FrameReceiver::recordShowError(int32_t micros){
+    uint32_t error = abs(micros);
+
+    this->_lastShowError = micros;
+    this->_meanShowError = (this->_meanShowError * 0.99f) + (error * 0.01f);
+
+    if(error > this->_windowMaxShowError){
+      this->_windowMaxShowError = error;
+    }
+    if(++this->_showErrorFrames >= SHOW_ERROR_WINDOW){
+      this->_maxShowError = this->_windowMaxShowError;
+      this->_windowMaxShowError = 0;
+      this->_showErrorFrames = 0;
+    }
+}
+
+bool FrameReceiver::isClockSynced(){
+    return this->_clockSynced;
+}
+
+float FrameReceiver::getClockDriftPpm(){
+    return this->_clockDriftPpm;
+}
+
+uint32_t FrameReceiver::getClockRoundTrip(){
+    return this->_clockRoundTrip;
+}
+
+uint32_t FrameReceiver::getClockResidual(){
+    return this->_clockResidual;
+}
+
+int32_t FrameReceiver::getLastShowError(){
+    return this->_lastShowError;
+}
+
+uint32_t FrameReceiver::getMaxShowError(){
+    return this->_maxShowError;
+}
+
+uint32_t FrameReceiver::getMeanShowError(){
+    return this->_meanShowError;
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+//runs on the UDP task for every packet received
+void FrameReceiver::onPacket(AsyncUDPPacket& packet){
+    FrameHeader frame;
+
+    //only the header is checked here, the rest is checked when the frame is decoded
+    if(!FrameDecoder::readHeader(packet.data(), packet.length(), &frame)){
+      return;
+    }
+
+    unsigned long now = millis();
+    long offset = (long)now - (long)frame.timestamp;
+    IPAddress sender = packet.remoteIP();
+
+    portENTER_CRITICAL(&this->_lock);
+    this->_senderAddress = sender;
+
+    if(this->_framesReceived == 0 || now - this->_lastPacketMillis > SENDER_TIMEOUT_MS){
+      //first frame, or the sender has restarted: start over
+      this->_newestSequence = frame.sequence;
+      this->_newestTimestamp = frame.timestamp;
+      this->_newestPresentation = frame.presentation;
+      this->_clockOffset = offset;
+      this->_windowPackets = 0;
+      this->_playing = false;
+    }
+
+    //the packets with the smallest delay are the best estimate of the clock offset. The window lets the estimate follow clock drift.
+    if(this->_windowPackets == 0 || offset < this->_windowMinOffset){
+      this->_windowMinOffset = offset;
+    }
+    if(offset < this->_clockOffset){
+      this->_clockOffset = offset;
+    }
+    if(++this->_windowPackets >= 128){
+      this->_clockOffset = this->_windowMinOffset;
+      this->_windowPackets = 0;
+    }
+
+    if((int32_t)(frame.sequence - this->_newestSequence) > 0){
+      if(frame.sequence == this->_newestSequence + 1 && frame.timestamp > this->_newestTimestamp){
+        this->_frameInterval = (this->_frameInterval * 0.9f) + ((frame.timestamp - this->_newestTimestamp) * 0.1f);
+      }
+      this->_newestSequence = frame.sequence;
+      this->_newestTimestamp = frame.timestamp;
+      this->_newestPresentation = frame.presentation;
+    }
+
+    if(this->_playing && (int32_t)(frame.sequence - this->_nextSequence) < 0){
+      this->_framesLate++; //its playout time has passed
+    }else{
+      BufferedFrame* slot = &this->_frames[frame.sequence & (JITTER_BUFFER_SLOTS - 1)];
+      if(!slot->filled || (int32_t)(frame.sequence - slot->sequence) > 0){ //reordered frames land in their own slot
+        slot->filled = true;
+        slot->sequence = frame.sequence;
+        slot->timestamp = frame.timestamp;
+        slot->presentation = frame.presentation;
+        slot->length = packet.length();
+        memcpy(slot->data, packet.data(), packet.length());
+      }
+    }
+
+    this->_framesReceived++;
+    this->_lastPacketMillis = now;
+
+    portEXIT_CRITICAL(&this->_lock);
+}
+
+//runs on the UDP task: stamps the response and leaves the rest to the display loop, which owns the clock estimate
+void FrameReceiver::onSyncPacket(AsyncUDPPacket& packet){
+    int64_t now = esp_timer_get_time();
+
+    if(packet.length() != CLOCK_SYNC_PACKET_SIZE){
+      return;
+    }
+
+    portENTER_CRITICAL(&this->_lock);
+    memcpy(this->_syncResponse, packet.data(), CLOCK_SYNC_PACKET_SIZE);
+    this->_syncResponseTime = now;
+    this->_syncResponsePending = true;
+    portEXIT_CRITICAL(&this->_lock);
+}
+
+//the requests go to wherever the frames come from, more often until the clock is synced
+void FrameReceiver::syncClock(){
+    if(this->_syncResponsePending){
+      uint8_t response[CLOCK_SYNC_PACKET_SIZE];
+
+      portENTER_CRITICAL(&this->_lock);
+      memcpy(response, this->_syncResponse, CLOCK_SYNC_PACKET_SIZE);
+      int64_t responseTime = this->_syncResponseTime;
+      this->_syncResponsePending = false;
+      portEXIT_CRITICAL(&this->_lock);
+
+      if(this->_clockSync.handleResponse(response, sizeof(response), responseTime)){
+        this->_clockSynced = this->_clockSync.isSynced();
+        this->_clockDriftPpm = this->_clockSync.getDriftPpm();
+        this->_clockRoundTrip = this->_clockSync.getRoundTrip();
+        this->_clockResidual = this->_clockSync.getResidual();
+      }
+    }
+
+    unsigned long interval = this->_clockSync.isSynced() ? CLOCK_SYNC_INTERVAL_MS : CLOCK_SYNC_FAST_INTERVAL_MS;
+    if(this->_framesReceived == 0 || millis() - this->_lastSyncMillis < interval){
+      return;
+    }
+
+    portENTER_CRITICAL(&this->_lock);
+    IPAddress sender = this->_senderAddress;
+    portEXIT_CRITICAL(&this->_lock);
+
+    uint8_t request[CLOCK_SYNC_PACKET_SIZE];
+    size_t length = this->_clockSync.makeRequest(request, esp_timer_get_time());
+    this->_syncUdp.writeTo(request, length, sender, CLOCK_SYNC_PORT);
+    this->_lastSyncMillis = millis();
+}
+
+//with a synced clock, the presentation time of the frame itself if it is there, otherwise the one expected from the frame before.
+//without one, the sender time of the frame plus the playout delay.
+int64_t FrameReceiver::getPlayoutTime(){
+    if(this->_clockSync.isSynced() && this->_nextPresentation != 0){
+      uint32_t presentation = 0;
+
+      portENTER_CRITICAL(&this->_lock);
+      BufferedFrame* slot = &this->_frames[this->_nextSequence & (JITTER_BUFFER_SLOTS - 1)];
+      if(slot->filled && slot->sequence == this->_nextSequence){
+        presentation = slot->presentation;
+      }
+      portEXIT_CRITICAL(&this->_lock);
+
+      return this->_clockSync.toLocal(presentation != 0 ? this->unwrapPresentation(presentation) : this->_nextPresentation);
+    }
+
+    long playoutMillis = (long)this->_nextTimestamp + this->_clockOffset + this->_playoutDelay;
+    return esp_timer_get_time() + (int64_t)(playoutMillis - (long)millis()) * 1000;
+}
+
+//presentation times only carry the low 32 bits (they wrap every 71 minutes): the full time is the one nearest to the sender's clock now
+int64_t FrameReceiver::unwrapPresentation(uint32_t presentation){
+    int64_t senderNow = this->_clockSync.toServer(esp_timer_get_time());
+    return senderNow + (int32_t)(presentation - (uint32_t)senderNow);
+}
+
+//restarts playout from the newest frame received
+void FrameReceiver::resync(){
+    portENTER_CRITICAL(&this->_lock);
+    this->_nextSequence = this->_newestSequence;
+    this->_nextTimestamp = this->_newestTimestamp;
+    uint32_t presentation = this->_newestPresentation;
+    this->_playing = true;
+    portEXIT_CRITICAL(&this->_lock);
+
+    this->_nextPresentation = presentation != 0 && this->_clockSync.isSynced() ? this->unwrapPresentation(presentation) : 0;
+    this->_missedFrames = 0;
+}
@@ -0,0 +1,96 @@
+#ifndef FrameReceiver_h
+#define FrameReceiver_h
+
+#include "Common.h"
+#include "FrameCodec.h"
+#include "ClockSync.h"
+
+#define JITTER_BUFFER_SLOTS 16 //number of frames the jitter buffer can hold (must be a power of 2)
+#define CLOCK_SYNC_INTERVAL_MS 500 //time between clock sync requests to the sender
+#define CLOCK_SYNC_FAST_INTERVAL_MS 100 //time between clock sync requests until the clock is synced
+#define SHOW_SPIN_US 2000 //the end of the wait for the show time is spun away on the timer, as a task delay is only accurate to a tick
+#define SHOW_ERROR_WINDOW 256 //frames the largest show error is reported over
+
+//frame waiting in the jitter buffer
+struct BufferedFrame{
+  bool filled;
+  uint32_t sequence;
+  uint32_t timestamp;
+  uint32_t presentation; //time the frame is to be shown (us, low 32 bits of the sender's clock), 0 if not set
+  uint8_t length; //length of the encoded frame
+  uint8_t data[FRAME_MAX_SIZE]; //encoded frame. Frames are decoded at their playout time, when they are taken in sequence order.
+};
+
+class FrameReceiver {
+  private:
+    IPAddress _address; //multicast group the frames are sent to
+    uint16_t _port; //UDP port the frames are sent to
+    AsyncUDP _udp; //UDP socket
+    AsyncUDP _syncUdp; //UDP socket for the clock sync exchanges with the sender
+    ClockSync _clockSync; //estimate of the sender's clock (only used by the display loop)
+    IPAddress _senderAddress; //address the frames come from, where the clock sync requests go
+    unsigned long _lastSyncMillis; //time the last clock sync request was sent
+    uint8_t _syncResponse[CLOCK_SYNC_PACKET_SIZE]; //clock sync response handed over from the UDP task to the display loop
+    int64_t _syncResponseTime; //time (us since boot) the response arrived
+    volatile bool _syncResponsePending; //flag to indicate a response is waiting for the display loop
+    uint8_t _firstBand; //first band of the streamed frames this node displays (each node of an LED wall shows a slice)
+    bool _listening; //flag to indicate the socket is listening
+    portMUX_TYPE _lock; //protects the jitter buffer (written by the UDP task, read by the display loop)
+    BufferedFrame _frames[JITTER_BUFFER_SLOTS]; //jitter buffer, indexed by sequence number
+    FrameDecoder _decoder; //decodes the frames in playout order (used by the display loop)
+    uint32_t _newestSequence; //highest sequence number received
+    uint32_t _newestTimestamp; //sender time of the newest frame received
+    uint32_t _newestPresentation; //presentation time of the newest frame received (0 if not set)
+    volatile unsigned long _lastPacketMillis; //time the last packet arrived
+    long _clockOffset; //local time minus sender time, estimated from the fastest packets
+    long _windowMinOffset; //smallest offset seen in the current estimation window
+    unsigned short _windowPackets; //number of packets in the current estimation window
+    float _frameInterval; //average time between frames in ms (sender clock)
+    unsigned short _playoutDelay; //time frames are held back to absorb network jitter, in ms
+    unsigned short _holdFrames; //number of missing frames during which the last frame is held before it decays
+    volatile bool _playing; //flag to indicate playout has started
+    uint32_t _nextSequence; //sequence number of the next frame to display
+    uint32_t _nextTimestamp; //sender time of the next frame to display
+    int64_t _nextPresentation; //presentation time of the next frame to display on the sender's clock (0 if unknown)
+    int64_t _showTime; //time (us since boot) the frame returned last is to be shown
+    unsigned short _missedFrames; //number of consecutive missing frames
+    float* _lastLevels; //levels of the last displayed frame, used to conceal lost frames
+    volatile uint32_t _framesReceived; //number of frames received
+    volatile uint32_t _framesLate; //number of frames that arrived after their playout time
+    volatile uint32_t _framesConcealed; //number of frames that were missing at their playout time
+    volatile uint32_t _framesUndecodable; //number of frames that changed a frame that was lost, concealed until the next keyframe
+    volatile bool _clockSynced; //flag to indicate the clock is synced to the sender's
+    volatile float _clockDriftPpm; //how much faster the sender's clock runs
+    volatile uint32_t _clockRoundTrip; //shortest round trip of the clock sync exchanges (us)
+    volatile uint32_t _clockResidual; //RMS deviation of the clock sync exchanges from the estimate (us)
+    volatile int32_t _lastShowError; //how much later than its show time the last frame was shown (us)
+    volatile uint32_t _maxShowError; //largest show error over the last SHOW_ERROR_WINDOW frames (us)
+    uint32_t _windowMaxShowError; //largest show error in the current window
+    unsigned short _showErrorFrames; //number of frames in the current window
+    volatile float _meanShowError; //running mean of the show error (us)
+    void onPacket(AsyncUDPPacket& packet); //stores a received packet in the jitter buffer
+    void onSyncPacket(AsyncUDPPacket& packet); //hands a clock sync response over to the display loop
+    void syncClock(); //handles the clock sync response waiting, if any, and sends the next request when due
+    int64_t getPlayoutTime(); //returns the time (us since boot) the next frame is to be shown
+    int64_t unwrapPresentation(uint32_t presentation); //returns the full sender time of a presentation time (synced clock only)
+    void resync(); //restarts playout from the newest frame received
+
+  public:
+    FrameReceiver(IPAddress address, uint16_t port, unsigned short playoutDelay, uint8_t firstBand); //constructor. The node displays the bands from firstBand on.
+    bool receiveFrame(float* levels, unsigned short noOfBands); //waits until shortly before the show time of the next frame and returns its levels (0.0 - 1.0). Returns false if there is nothing to display.
+    int64_t getShowTime(); //returns the time (us since boot) the frame returned last is to be shown
+    void recordShowError(int32_t micros); //records how much later than its show time the frame was shown
+    uint32_t getFramesReceived(); //returns the number of frames received
+    uint32_t getFramesLate(); //returns the number of frames that arrived too late
+    uint32_t getFramesConcealed(); //returns the number of frames that had to be concealed
+    uint32_t getFramesUndecodable(); //returns the number of frames that could not be decoded because the frame before them was lost
+    bool isClockSynced(); //returns true once the clock is synced to the sender's
+    float getClockDriftPpm(); //returns how much faster the sender's clock runs, in ppm
+    uint32_t getClockRoundTrip(); //returns the shortest round trip of the clock sync exchanges (us)
+    uint32_t getClockResidual(); //returns the RMS deviation of the clock sync exchanges from the estimate (us)
+    int32_t getLastShowError(); //returns how much later than its show time the last frame was shown (us)
+    uint32_t getMaxShowError(); //returns the largest show error over the last SHOW_ERROR_WINDOW frames (us)
+    uint32_t getMeanShowError(); //returns the mean show error (us)
+};
+
+#endif
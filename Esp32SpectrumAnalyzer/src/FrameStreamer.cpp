@@ -0,0 +1,130 @@
+#include "FrameStreamer.h"
+
+FrameStreamer::FrameStreamer(IPAddress address, uint16_t port, unsigned short presentationDelay) : _encoder(KEYFRAME_INTERVAL){
+    this->_address = address;
+    this->_port = port;
+    this->_presentationDelay = presentationDelay * 1000;
+    this->_queue = nullptr;
+    this->_senderTask = nullptr;
+    this->_bytesSent = 0;
+    this->_packetsSent = 0;
+    this->_sendErrors = 0;
+    this->_framesDropped = 0;
+    this->_packetsPerSecond = 0;
+    this->_syncRequests = 0;
+}
+
+void FrameStreamer::begin(){
+    if(this->_queue != nullptr){
+      return;
+    }
+
+    this->_queue = xQueueCreate(1, sizeof(SpectrumFrame));
+
+    //sending runs on core 0 next to the network stack, at a lower priority than the web server
+    xTaskCreatePinnedToCore(this->senderThread, "FrameStreamerTask", 4096, this, 2, &_senderTask, 0);
+
+    Serial.printf("Streaming frames to %s:%u\n", this->_address.toString().c_str(), this->_port);
+
+    //this board's clock is the time base of the display nodes: they stamp requests with their clock and show the frames at the presentation time converted to it
+    if(this->_syncUdp.listen(CLOCK_SYNC_PORT)){
+      this->_syncUdp.onPacket([this](AsyncUDPPacket& packet){ this->onSyncPacket(packet); });
+    }else{
+      Serial.println("Unable to listen for clock sync requests");
+    }
+}
+
+//called from the audio loop: quantizes the frame and hands it over to the sender task without waiting. Encoding is left to the sender task.
+void FrameStreamer::publish(const float* levels, const uint8_t* peaks, uint8_t noOfBands, uint8_t noOfRows){
+    if(this->_queue == nullptr){
+      return; //not started yet
+    }
+
+    SpectrumFrame frame;
+    noOfBands = min(noOfBands, (uint8_t)FRAME_MAX_BANDS);
+
+    frame.timestamp = millis();
+    frame.presentation = esp_timer_get_time() + this->_presentationDelay; //low 32 bits, the display nodes work out the rest from their synced clock
+    frame.noOfBands = noOfBands;
+    frame.noOfRows = noOfRows;
+
+    for (uint8_t i = 0; i < noOfBands; i++) {
+      frame.levels[i] = constrain(levels[i], 0.0f, 1.0f) * 255;
+      frame.peaks[i] = peaks[i];
+    }
+
+    //if the previous frame has not been sent yet, replace it: the newest frame is the only one worth sending
+    if(uxQueueMessagesWaiting(this->_queue) > 0){
+      this->_framesDropped++;
+    }
+
+    xQueueOverwrite(this->_queue, &frame);
+}
+
+uint32_t FrameStreamer::getPacketsSent(){
+    return this->_packetsSent;
+}
+
+uint32_t FrameStreamer::getSendErrors(){
+    return this->_sendErrors;
+}
+
+uint32_t FrameStreamer::getFramesDropped(){
+    return this->_framesDropped;
+}
+
+uint32_t FrameStreamer::getPacketsPerSecond(){
+    return this->_packetsPerSecond;
+}
+
+uint32_t FrameStreamer::getBytesSent(){
+    return this->_bytesSent;
+}
+
+uint32_t FrameStreamer::getSyncRequests(){
+    return this->_syncRequests;
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+void FrameStreamer::senderThread(void* pvParameters){
+    FrameStreamer* streamer = (FrameStreamer*)pvParameters;
+    SpectrumFrame frame;
+    uint8_t packet[FRAME_MAX_SIZE];
+    uint32_t packetsAtLastSecond = 0;
+    unsigned long lastSecondMillis = millis();
+
+    while(true){
+      if(xQueueReceive(streamer->_queue, &frame, 1000 / portTICK_PERIOD_MS) == pdTRUE){
+        //frames are encoded here rather than in publish, so a frame replaced in the mailbox never becomes the base of a delta frame
+        size_t length = streamer->_encoder.encode(frame.levels, frame.peaks, frame.noOfBands, frame.noOfRows, frame.timestamp, frame.presentation, packet, sizeof(packet));
+
+        if(streamer->_udp.writeTo(packet, length, streamer->_address, streamer->_port) == length){
+          streamer->_packetsSent++;
+          streamer->_bytesSent += length;
+        }else{
+          streamer->_sendErrors++;
+          streamer->_encoder.requestKeyframe(); //the receivers cannot decode the frames that change this one
+        }
+      }
+
+      unsigned long now = millis();
+      if(now - lastSecondMillis >= 1000){
+        streamer->_packetsPerSecond = streamer->_packetsSent - packetsAtLastSecond;
+        packetsAtLastSecond = streamer->_packetsSent;
+        lastSecondMillis = now;
+      }
+    }
+}
+
+//runs on the UDP task. Both times are taken as close to the network as this task gets; whatever the stack adds before and after
+//is the same for every display node, so it shifts all of them alike and does not show up as skew between them.
+void FrameStreamer::onSyncPacket(AsyncUDPPacket& packet){
+    int64_t receiveTime = esp_timer_get_time();
+    uint8_t response[CLOCK_SYNC_PACKET_SIZE];
+
+    if(ClockSync::makeResponse(packet.data(), packet.length(), receiveTime, esp_timer_get_time(), response) > 0){
+      packet.write(response, sizeof(response));
+      this->_syncRequests++;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef FrameStreamer_h
+#define FrameStreamer_h
+
+#include "Common.h"
+#include "FrameCodec.h"
+#include "ClockSync.h"
+
+#define KEYFRAME_INTERVAL 16 //a frame carrying all values is sent at least this often, so display nodes recover quickly from lost packets
+
+class FrameStreamer {
+  private:
+    IPAddress _address; //multicast group or unicast address the frames are sent to
+    uint16_t _port; //UDP port the frames are sent to
+    AsyncUDP _udp; //UDP socket
+    AsyncUDP _syncUdp; //UDP socket answering the clock sync requests of the display nodes
+    uint32_t _presentationDelay; //time from publishing a frame to showing it on the display nodes, in us
+    QueueHandle_t _queue; //single slot mailbox between the audio loop and the sender task
+    TaskHandle_t _senderTask; //task handler for the sender
+    FrameEncoder _encoder; //encodes the frames as keyframes or changes since the frame sent before (used by the sender task)
+    volatile uint32_t _bytesSent; //number of bytes sent
+    volatile uint32_t _packetsSent; //number of packets sent
+    volatile uint32_t _sendErrors; //number of packets that failed to send
+    volatile uint32_t _framesDropped; //number of frames replaced before the sender got to them
+    volatile uint32_t _packetsPerSecond; //packets sent during the last second
+    volatile uint32_t _syncRequests; //clock sync requests answered
+    static void senderThread(void* pvParameters); //sender thread function
+    void onSyncPacket(AsyncUDPPacket& packet); //answers a clock sync request
+
+  public:
+    FrameStreamer(IPAddress address, uint16_t port, unsigned short presentationDelay); //constructor. Frames are stamped to be shown presentationDelay ms after they are published.
+    void begin(); //starts sending (once the network is up)
+    void publish(const float* levels, const uint8_t* peaks, uint8_t noOfBands, uint8_t noOfRows); //queues a frame for sending. Never blocks.
+    uint32_t getPacketsSent(); //returns the number of packets sent
+    uint32_t getSendErrors(); //returns the number of packets that failed to send
+    uint32_t getFramesDropped(); //returns the number of frames dropped
+    uint32_t getPacketsPerSecond(); //returns the number of packets sent during the last second
+    uint32_t getBytesSent(); //returns the number of bytes sent
+    uint32_t getSyncRequests(); //returns the number of clock sync requests answered
+};
+
+#endif
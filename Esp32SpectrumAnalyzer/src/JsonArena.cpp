@@ -0,0 +1,95 @@
+#include "JsonArena.h"
+
+#define BLOCK_HEADER JSON_ARENA_ALIGNMENT //each block is preceded by its size, padded to the alignment
+#define ALIGNED(bytes) (((bytes) + JSON_ARENA_ALIGNMENT - 1) & ~(size_t)(JSON_ARENA_ALIGNMENT - 1))
+
+JsonArena::JsonArena(size_t size){
+    this->_size = ALIGNED(size);
+    this->_buffer = new uint8_t[this->_size];
+    this->_used = 0;
+    this->_lastBlock = this->_size;
+    this->_liveBlocks = 0;
+    this->_highWater = 0;
+    this->_failures = 0;
+}
+
+void* JsonArena::allocate(size_t size){
+    if(this->_size - this->_used < BLOCK_HEADER + ALIGNED(size)){
+      this->_failures++;
+      return nullptr;
+    }
+
+    this->_liveBlocks++;
+    return this->place(this->_used, size);
+}
+
+void JsonArena::deallocate(void* pointer){
+    if(pointer == nullptr){
+      return;
+    }
+
+    size_t offset = (uint8_t*)pointer - this->_buffer - BLOCK_HEADER;
+    this->_liveBlocks--;
+
+    if(this->_liveBlocks == 0){
+      this->_used = 0; //every document is gone: start over
+      this->_lastBlock = this->_size;
+    }else if(offset == this->_lastBlock){
+      this->_used = offset; //the most recent block is given back; the space of the older ones is only reused once they are all freed
+      this->_lastBlock = this->_size;
+    }
+}
+
+void* JsonArena::reallocate(void* pointer, size_t newSize){
+    if(pointer == nullptr){
+      return this->allocate(newSize);
+    }
+
+    size_t offset = (uint8_t*)pointer - this->_buffer - BLOCK_HEADER;
+    size_t oldSize = *(uint32_t*)(this->_buffer + offset);
+
+    //the most recent block grows or shrinks where it is
+    if(offset == this->_lastBlock){
+      if(this->_size - offset < BLOCK_HEADER + ALIGNED(newSize)){
+        this->_failures++;
+        return nullptr; //the block is left as it was, as realloc does
+      }
+      return this->place(offset, newSize);
+    }
+
+    if(ALIGNED(newSize) <= ALIGNED(oldSize)){
+      return pointer; //an older block only shrinks where it is (the rest is reused when the arena starts over)
+    }
+
+    void* moved = this->allocate(newSize);
+    if(moved != nullptr){
+      memcpy(moved, pointer, oldSize < newSize ? oldSize : newSize);
+      this->deallocate(pointer);
+    }
+    return moved;
+}
+
+size_t JsonArena::getSize(){
+    return this->_size;
+}
+
+size_t JsonArena::getHighWater(){
+    return this->_highWater;
+}
+
+uint32_t JsonArena::getFailures(){
+    return this->_failures;
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+void* JsonArena::place(size_t offset, size_t size){
+    *(uint32_t*)(this->_buffer + offset) = size;
+    this->_lastBlock = offset;
+    this->_used = offset + BLOCK_HEADER + ALIGNED(size);
+
+    if(this->_used > this->_highWater){
+      this->_highWater = this->_used;
+    }
+    return this->_buffer + offset + BLOCK_HEADER;
+}
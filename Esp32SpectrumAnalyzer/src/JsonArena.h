@@ -0,0 +1,35 @@
+#ifndef JsonArena_h
+#define JsonArena_h
+
+#include "Common.h"
+
+#define JSON_ARENA_ALIGNMENT 8 //blocks are aligned for any type ArduinoJson stores
+#define JSON_SLOT_BYTES (2 * sizeof(void*)) //size of a variant slot of ArduinoJson 7 (8 bytes on the ESP32), to size arenas with
+
+//fixed arena the JSON documents of one task are allocated from (JsonDocument doc(arena)), so building and parsing them never touches the heap
+//after boot and cannot fragment it. Blocks are handed out from the start of the arena onwards; the most recent block can grow and shrink in place
+//(ArduinoJson grows its strings and pools that way) and the arena starts over once every block is freed, which is when the documents are gone.
+//When it is full, allocations fail and ArduinoJson reports the document as overflowed (or NoMemory when parsing).
+//Not thread safe: each task uses its own arena.
+class JsonArena : public ArduinoJson::Allocator {
+  private:
+    uint8_t* _buffer; //the arena, allocated once
+    size_t _size; //bytes in the arena
+    size_t _used; //bytes handed out from the start of the arena, headers included
+    size_t _lastBlock; //offset of the header of the most recent block still in use (_size for none)
+    uint16_t _liveBlocks; //blocks handed out and not yet freed
+    volatile size_t _highWater; //most bytes in use at the same time
+    volatile uint32_t _failures; //allocations refused because the arena was full
+    void* place(size_t offset, size_t size); //writes the header of a block of size bytes at offset and marks the bytes used
+
+  public:
+    JsonArena(size_t size); //constructor
+    void* allocate(size_t size) override;
+    void deallocate(void* pointer) override;
+    void* reallocate(void* pointer, size_t newSize) override;
+    size_t getSize(); //returns the size of the arena
+    size_t getHighWater(); //returns the most bytes in use at the same time
+    uint32_t getFailures(); //returns the allocations refused because the arena was full
+};
+
+#endif
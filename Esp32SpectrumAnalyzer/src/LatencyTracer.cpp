@@ -0,0 +1,68 @@
+#include "LatencyTracer.h"
+#include <algorithm>
+
+LatencyTracer::LatencyTracer(){
+    for (unsigned short s = 0; s < NUM_LATENCY_STAGES; s++) {
+      this->_next[s] = 0;
+      this->_count[s] = 0;
+    }
+
+    this->_bufferMicros = 0;
+}
+
+void LatencyTracer::record(LatencyStage stage, uint32_t micros){
+    this->_samples[stage][this->_next[stage]] = micros;
+    this->_next[stage] = (this->_next[stage] + 1) % LATENCY_SAMPLES;
+
+    if(this->_count[stage] < LATENCY_SAMPLES){
+      this->_count[stage]++;
+    }
+}
+
+void LatencyTracer::setBufferMicros(uint32_t micros){
+    this->_bufferMicros = micros;
+}
+
+uint32_t LatencyTracer::getBufferMicros(){
+    return this->_bufferMicros;
+}
+
+uint32_t LatencyTracer::getLast(LatencyStage stage){
+    if(this->_count[stage] == 0){
+      return 0;
+    }
+
+    return this->_samples[stage][(this->_next[stage] + LATENCY_SAMPLES - 1) % LATENCY_SAMPLES];
+}
+
+//the measurements are copied before sorting, so the audio loop can keep recording. A measurement overwritten during the copy only shifts the result slightly.
+LatencyStats LatencyTracer::getStats(LatencyStage stage){
+    LatencyStats stats = {};
+    uint16_t count = this->_count[stage];
+
+    if(count == 0){
+      return stats;
+    }
+
+    memcpy(this->_sorted, this->_samples[stage], count * sizeof(uint32_t));
+    std::sort(this->_sorted, this->_sorted + count);
+
+    stats.count = count;
+    stats.p50 = this->_sorted[(count * 50) / 100];
+    stats.p95 = this->_sorted[(count * 95) / 100];
+    stats.p99 = this->_sorted[(count * 99) / 100];
+    stats.max = this->_sorted[count - 1];
+
+    return stats;
+}
+
+const char* LatencyTracer::getStageName(LatencyStage stage){
+    switch(stage){
+      case STAGE_READ_WAIT: return "readWait";
+      case STAGE_ANALYSIS: return "analysis";
+      case STAGE_RENDER: return "render";
+      case STAGE_SHOW: return "show";
+      case STAGE_TOTAL: return "total";
+      default: return "unknown";
+    }
+}
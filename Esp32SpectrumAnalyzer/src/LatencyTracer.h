@@ -0,0 +1,45 @@
+#ifndef LatencyTracer_h
+#define LatencyTracer_h
+
+#include "Common.h"
+
+#define LATENCY_SAMPLES 256 //number of recent measurements kept per stage
+
+//stages of the audio to LED pipeline
+enum LatencyStage{
+  STAGE_READ_WAIT, //time spent waiting in i2s_read for the DMA to complete a block (close to 0 means blocks are queuing up)
+  STAGE_ANALYSIS, //DMA completion until the frequency bands are ready (FFT)
+  STAGE_RENDER, //bands ready until the LED buffer is filled
+  STAGE_SHOW, //sending the LED buffer to the strip (FastLED.show)
+  STAGE_TOTAL, //first sample of the block captured until the LEDs show it
+  NUM_LATENCY_STAGES
+};
+
+//latency distribution of a stage in microseconds
+struct LatencyStats{
+  uint16_t count;
+  uint32_t p50;
+  uint32_t p95;
+  uint32_t p99;
+  uint32_t max;
+};
+
+class LatencyTracer {
+  private:
+    uint32_t _samples[NUM_LATENCY_STAGES][LATENCY_SAMPLES]; //ring of recent measurements per stage (written by the audio loop)
+    uint16_t _next[NUM_LATENCY_STAGES]; //position of the next measurement in the ring
+    volatile uint16_t _count[NUM_LATENCY_STAGES]; //number of measurements in the ring
+    uint32_t _sorted[LATENCY_SAMPLES]; //scratch buffer for calculating the percentiles (used by the web server thread)
+    uint32_t _bufferMicros; //time it takes to fill one DMA block
+
+  public:
+    LatencyTracer(); //constructor
+    void record(LatencyStage stage, uint32_t micros); //records a measurement. Cheap enough to call every frame.
+    void setBufferMicros(uint32_t micros); //sets the time it takes to fill one DMA block
+    uint32_t getBufferMicros(); //returns the time it takes to fill one DMA block
+    uint32_t getLast(LatencyStage stage); //returns the most recent measurement of a stage
+    LatencyStats getStats(LatencyStage stage); //calculates the latency distribution of the recent measurements of a stage
+    static const char* getStageName(LatencyStage stage); //returns the name of a stage
+};
+
+#endif
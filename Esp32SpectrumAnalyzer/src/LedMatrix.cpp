@@ -4,6 +4,30 @@
 #define LED_PIN 18 //GPIO pin the LED strip is connected to (no way in FastLED to make it a variable).
 CRGB* LedMatrix::_LEDs = nullptr;
 
+//combines a layer with what is below it
+static inline CRGB blendLayer(const CRGB& below, const CRGB& layer, BlendMode mode){
+    switch(mode){
+      case BLEND_ADD:
+        return CRGB(qadd8(below.r, layer.r), qadd8(below.g, layer.g), qadd8(below.b, layer.b));
+      case BLEND_LIGHTEN:
+        return CRGB(max(below.r, layer.r), max(below.g, layer.g), max(below.b, layer.b));
+      default:
+        return layer;
+    }
+}
+
+//color of the background layer of a LED: previous is what the LED showed in the last frame, glow its entry in the glow palette
+static inline CRGB backgroundColor(BackgroundEffect effect, uint8_t level, const CRGB& previous, const CRGB& glow){
+    switch(effect){
+      case BACKGROUND_GLOW:
+        return glow;
+      case BACKGROUND_TRAILS:
+        return CRGB(scale8(previous.r, level), scale8(previous.g, level), scale8(previous.b, level));
+      default:
+        return CRGB::Black;
+    }
+}
+
 LedMatrix::LedMatrix(unsigned short numberOfRows, unsigned short numberOfCols){
     Serial.println("LED Matrix initializing...");
     
@@ -13,12 +37,24 @@ LedMatrix::LedMatrix(unsigned short numberOfRows, unsigned short numberOfCols){
     this->_maxCurrentDraw = 5000; 
     this->_brightness = 20; //default brightness value.  Can be changed via web portal. 
     
-    this->_colPeaks = new ColPeak[this->_noOfCols] {}; 
+    this->_peakRows = new unsigned short[this->_noOfCols] {0};
+    this->_peakMoveTimes = new uint32_t[this->_noOfCols] {0};
+    this->_peakWaits = new uint32_t[this->_noOfCols] {0};
+    this->_drawnPeakRows = new unsigned short[this->_noOfCols] {0};
     this->_peakColor = CRGB(255, 255, 255); //default peak LED color.  Can be changed via web portal.
     this->_maxPeakFallingWait = 1500; //default value.  Can be changed via web portal.
     this->_peakFallingIntervalIncrement = 25; //dfault value. Can be changed via web portal.
+    this->_backgroundEffect = BACKGROUND_NONE;
+    this->_backgroundLevel = 0;
+    this->_barBlend = BLEND_REPLACE;
+    this->_peakBlend = BLEND_REPLACE;
+    this->_demoColor = CRGB::Black;
+    this->_demoDuration = 1000; //the sweep takes the same time regardless of the matrix size
+    this->_demoStartMillis = 0;
+    this->_demoActive = false;
 
     this->_ledColors = new CRGB[this->_noOfLEDs]; //array for storing the color of the LEDs.  Can be changed via web portal.
+    this->_glowColors = new CRGB[this->_noOfLEDs];
     this->_LEDs = new CRGB[this->_noOfLEDs]; //FastLED array (should be static)
     this->setupLedDefaultColors(); //sets up the default colors for the LEDs
     
@@ -37,20 +73,31 @@ void LedMatrix::clearMatrix(){
 }
 
 
-void LedMatrix::updateLEDs(){
+//the last part of the wait for the show time is spun out here, as a task delay is only accurate to a tick
+int64_t LedMatrix::updateLEDs(int64_t showTime){
+    if(this->_demoActive){
+        this->drawDemo();
+    }
+
     FastLED.setBrightness(this->_brightness);
+
+    int64_t now = esp_timer_get_time();
+    while(now < showTime){
+        now = esp_timer_get_time();
+    }
     FastLED.show();  
+
+    return now;
 }
 
-void LedMatrix::doDemo(CRGB color){
-    for(unsigned short i=0; i< this->_noOfLEDs; i++){
-        this->_LEDs[i] = color;
-        this->updateLEDs();
-        delay(10);
-    }        
-    
-    delay(50);
-    this->clearMatrix();
+void LedMatrix::startDemo(CRGB color){
+    this->_demoColor = color;
+    this->_demoStartMillis = millis();
+    this->_demoActive = true; //set last, the render path picks it up with the next frame
+}
+
+unsigned short LedMatrix::getPeakRow(unsigned short col){
+    return this->_peakRows[col];
 }
 
 unsigned short LedMatrix::getNoOfRows(){
@@ -89,6 +136,7 @@ void LedMatrix::setLEDColors(CRGB* value){
     this->_ledColors[i].r = value[i].r;
     this->_ledColors[i].g = value[i].g;
     this->_ledColors[i].b = value[i].b;
+    this->updateGlowColor(i);
   }
     
 }
@@ -97,6 +145,7 @@ void LedMatrix::setPixelColor(unsigned short index, CRGB value){
   this->_ledColors[index].r = value.r;
   this->_ledColors[index].g = value.g;
   this->_ledColors[index].b = value.b;
+  this->updateGlowColor(index);
 }
 
 
@@ -116,72 +165,113 @@ void LedMatrix::setPeakFallingIntervalIncrement(unsigned short value){
   this->_peakFallingIntervalIncrement = value;
 }
 
-void LedMatrix::setLEDColPeak(unsigned short col, unsigned short value){
-    unsigned short topRowIndex = this->_noOfRows - 1; 
+void LedMatrix::setBackground(BackgroundEffect effect, uint8_t level){
+  this->_backgroundEffect = effect;
+  this->_backgroundLevel = level;
 
-    if(value > this->_colPeaks[col].row){//set new peaks if current value is greater than previously stored peak.
-      this->_colPeaks[col].row = value; //set peak at one above the actual value.
+  for (unsigned short i = 0; i < this->_noOfLEDs; i++) {
+    this->updateGlowColor(i);
+  }
+}
 
-        if(this->_colPeaks[col].row > topRowIndex){ //dont let it overflow the top row index
-          this->_colPeaks[col].row = topRowIndex;
-        }
+void LedMatrix::setBlendModes(BlendMode bar, BlendMode peak){
+  this->_barBlend = bar;
+  this->_peakBlend = peak;
+}
 
-        this->_colPeaks[col].curMillis = this->_colPeaks[col].prevMillis = millis(); //reset the time interval for the peak falling.
-        this->_colPeaks[col].curWait = this->_maxPeakFallingWait; //reset peak falling interval to max value.
-    }
+void LedMatrix::renderFrame(const unsigned short* values, int64_t frameTime, float frameScale){
+    this->updatePeaks(values, (uint32_t)frameTime, frameScale);
 
-    //set LEDs
-    if(this->_colPeaks[col].row > 0) //if value (x) not at bottom, set peak color of the row
-    {
-        _LEDs[ xyToIndex(col, this->_colPeaks[col].row)]  = this->_peakColor;
+    for (unsigned short col = 0; col < this->_noOfCols; col++) {
+      this->renderColumn(col, values[col], this->_drawnPeakRows[col]);
     }
-    else {//for all other rows, set to black. 
-        _LEDs[ xyToIndex(col, this->_colPeaks[col].row)]  = CRGB::Black;
+}
+
+
+
+//PRIVATE MEMBER DEFINITIONS
+//the peak of a column rises with the bar at once, is held for _maxPeakFallingWait, then falls a row at a time, the wait between rows shortening
+//by _peakFallingIntervalIncrement per reference frame. All columns are moved by the one frame time, in a loop over the state arrays with
+//selects instead of branches. A peak is drawn at the row it had before it falls.
+void LedMatrix::updatePeaks(const unsigned short* values, uint32_t frameTime, float frameScale){
+    unsigned short topRowIndex = this->_noOfRows - 1;
+    uint32_t maxWait = this->_maxPeakFallingWait * 1000;
+    uint32_t minWait = this->_peakFallingIntervalIncrement * 1000;
+    uint32_t shortening = minWait * frameScale;
+
+    for (unsigned short col = 0; col < this->_noOfCols; col++) {
+      bool rises = values[col] > this->_peakRows[col];
+      unsigned short row = rises ? min(values[col], topRowIndex) : this->_peakRows[col]; //dont let it overflow the top row index
+      uint32_t moveTime = rises ? frameTime : this->_peakMoveTimes[col];
+      uint32_t wait = rises ? maxWait : this->_peakWaits[col];
+      this->_drawnPeakRows[col] = row;
+
+      uint32_t elapsed = frameTime - moveTime; //unsigned difference, so it still holds when the clock wraps around
+      uint32_t falls = min(elapsed / max(wait, (uint32_t)1), (uint32_t)row); //more than one row when a frame is longer than the wait
+      this->_peakRows[col] = row - falls;
+      this->_peakMoveTimes[col] = moveTime + falls * wait; //the rest of the time carries over, so the fall keeps its pace at any frame rate
+      this->_peakWaits[col] = wait >= minWait + shortening ? wait - shortening : minWait;
     }
-    
-    //logic for the peaks to fall down
-    this->_colPeaks[col].curMillis = millis(); //update current time
-    
-    if (this->_colPeaks[col].curMillis - this->_colPeaks[col].prevMillis >= this->_colPeaks[col].curWait){
-      if(this->_colPeaks[col].row > 0){
-        this->_colPeaks[col].row -= 1; //deduct one row (creates fall down effect)
-        this->_colPeaks[col].prevMillis = this->_colPeaks[col].curMillis;
+}
+
+//a column is contiguous in the strip (see xyToIndex), so the layers are composed in one pass through consecutive memory: the part of the column
+//under the bar, then the part above it, so no LED is tested for the layers it has. The peak is blended over the result.
+void LedMatrix::renderColumn(unsigned short col, unsigned short value, unsigned short peakRow){
+    unsigned short noOfLitRows = value < this->_noOfRows ? value : this->_noOfRows;
+    unsigned short first = xyToIndex(col, 0);
+
+    CRGB* leds = &_LEDs[first];
+    const CRGB* barColors = &this->_ledColors[first];
+    const CRGB* glowColors = &this->_glowColors[first];
+    BackgroundEffect effect = this->_backgroundEffect;
+    uint8_t level = this->_backgroundLevel;
+
+    if(this->_barBlend == BLEND_REPLACE){
+      for (unsigned short y = 0; y < noOfLitRows; y++) {
+        leds[y] = barColors[y]; //the background is covered, so it is not computed
+      }
+    }else{
+      for (unsigned short y = 0; y < noOfLitRows; y++) {
+        leds[y] = blendLayer(backgroundColor(effect, level, leds[y], glowColors[y]), barColors[y], this->_barBlend);
       }
     }
 
-    this->_colPeaks[col].curWait -= this->_peakFallingIntervalIncrement;
+    for (unsigned short y = noOfLitRows; y < this->_noOfRows; y++) {
+      leds[y] = backgroundColor(effect, level, leds[y], glowColors[y]);
+    }
 
-    if(this->_colPeaks[col].curWait < this->_peakFallingIntervalIncrement){
-      this->_colPeaks[col].curWait = this->_peakFallingIntervalIncrement;
+    if(peakRow > 0){ //a peak at the bottom row is not drawn
+      leds[peakRow] = blendLayer(leds[peakRow], this->_peakColor, this->_peakBlend);
     }
+}
 
-  }
-  
+void LedMatrix::updateGlowColor(unsigned short index){
+    this->_glowColors[index] = this->_ledColors[index];
+    this->_glowColors[index].nscale8(this->_backgroundLevel);
+}
 
-  void LedMatrix::setLEDColumn(unsigned short col, unsigned short value){
-    unsigned short topRowIndex = this->_noOfRows - 1;
-  
-    for (unsigned short y=0; y<=topRowIndex; y++) //iterate all rows in the column (vertically from bottom to top)
-    {    
-      if(y > value-1) 
-      {
-        _LEDs[ xyToIndex(col, y)] = CRGB::Black;  
-      }else
-      {
-        _LEDs[ xyToIndex(col, y)]  = this->_ledColors[xyToIndex(col, y)]; 
-      }
-    }
-  }
+void LedMatrix::drawDemo(){
+    unsigned long elapsed = millis() - this->_demoStartMillis;
 
+    if(elapsed >= this->_demoDuration){
+      this->_demoActive = false;
+      return;
+    }
 
+    //light the LEDs one by one, proportional to the time elapsed since the sweep started
+    unsigned short noOfLitLEDs = (elapsed * this->_noOfLEDs) / this->_demoDuration;
+    for(unsigned short i=0; i < noOfLitLEDs; i++){
+      this->_LEDs[i] = this->_demoColor;
+    }
+}
 
-//PRIVATE MEMBER DEFINITIONS
 void LedMatrix::setupLedDefaultColors(){
     for (unsigned short x=0; x < this->_noOfCols; x++) {
       for (unsigned short y=0; y < this->_noOfRows; y++) {
             uint16_t hue = map(y, 0, this->_noOfRows, 100, 1);
             CRGB clr = CHSV(hue, 255, 255);
             this->_ledColors[xyToIndex(x, y)]  = clr; 
+            this->updateGlowColor(xyToIndex(x, y));
       }
     }
   }
@@ -3,13 +3,21 @@
 
 #include "Common.h"
 
-//structure for storing the state of the peak pixels
-struct ColPeak{
-    unsigned short col;
-    unsigned short row;
-    unsigned short curWait;
-    unsigned long curMillis;
-    unsigned long prevMillis;
+#define REFERENCE_FRAME_MICROS 23220 //the animation, smoothing and AGC steps are per frame of the FFT engine (1024 samples at 44.1 kHz). Other frame lengths take proportional steps.
+#define MAX_FRAME_SCALE 4.0f //longest frame (relative to REFERENCE_FRAME_MICROS) the steps are scaled for, so a stall does not empty the display in one step
+
+//how a layer is combined with the layers below it
+enum BlendMode{
+    BLEND_REPLACE, //the layer covers what is below it
+    BLEND_ADD, //the colors are added (saturating at full brightness)
+    BLEND_LIGHTEN //the brighter of the two, per color channel
+};
+
+//layer drawn behind the bars
+enum BackgroundEffect{
+    BACKGROUND_NONE, //black
+    BACKGROUND_GLOW, //the bar colors, dimmed to the background level, so the unlit part of the bars still shows
+    BACKGROUND_TRAILS //the previous frame, faded to the background level, so falling bars leave trails
 };
 
 class LedMatrix {
@@ -20,21 +28,39 @@ class LedMatrix {
       unsigned short _noOfCols; //number of columns in the matrix
       unsigned short _noOfLEDs; //number of LEDs in the matrix
       CRGB* _ledColors; //array for storing the color of the LEDs.  Can be changed via web portal.
+      CRGB* _glowColors; //_ledColors dimmed to the background level (palette of the glow background, kept up to date with _ledColors)
       static CRGB* _LEDs; //FastLED array (should be static)
-      ColPeak* _colPeaks; //array for storing the current position of peak pixels for each band
+      unsigned short* _peakRows; //row of the peak pixel of each column (the peak state is kept as one array per field, so a frame updates it in tight loops)
+      uint32_t* _peakMoveTimes; //frame time the peak of each column last rose or fell (us, wraps around)
+      uint32_t* _peakWaits; //time the peak of each column waits before falling the next row (us)
+      unsigned short* _drawnPeakRows; //row each peak is drawn at in the frame being rendered (before it falls)
       CRGB _peakColor; //color of the peak pixels.  Can be changed via web portal.
-      unsigned short _maxPeakFallingWait; //determines the max peak fall down interval.  Can be changed via web portal.
-      unsigned short _peakFallingIntervalIncrement; //determines peak fall down acceleration.  Can be changed via web portal.
+      unsigned short _maxPeakFallingWait; //time a peak is held before it starts falling (ms).  Can be changed via web portal.
+      unsigned short _peakFallingIntervalIncrement; //determines peak fall down acceleration: the wait between rows is shortened by this much per reference frame (ms).  Can be changed via web portal.
+      BackgroundEffect _backgroundEffect; //layer drawn behind the bars
+      uint8_t _backgroundLevel; //brightness of the glow, or the part of the previous frame kept by the trails (0-255)
+      BlendMode _barBlend; //how the bars are combined with the background
+      BlendMode _peakBlend; //how the peak pixels are combined with the bars and the background
+      CRGB _demoColor; //color of the demo sweep
+      unsigned short _demoDuration; //duration of the demo sweep in ms
+      volatile unsigned long _demoStartMillis; //time the demo sweep was started
+      volatile bool _demoActive; //flag to indicate the demo sweep is being drawn
+      void drawDemo(); //draws the demo sweep over the current frame
       void setupLedDefaultColors(); //sets up the default colors for the LEDs
+      void updateGlowColor(unsigned short index); //recomputes the glow palette entry of a LED
+      void updatePeaks(const unsigned short* values, uint32_t frameTime, float frameScale); //moves the peaks of all columns for the new values
+      void renderColumn(unsigned short col, unsigned short value, unsigned short peakRow); //draws the background, the bar of value rows and the peak of the column, in one pass over its LEDs
       unsigned short xyToIndex(unsigned short x, unsigned short y); //converts x,y coordinates to LED index
   
     public:
       LedMatrix(unsigned short numberOfRows, unsigned short numberOfCols); //constructor
       void clearMatrix(); //clears the LED matrix
-      void updateLEDs(); //updates the LED matrix
-      void doDemo(CRGB color); //runs a demo on the LED matrix
-      void setLEDColPeak(unsigned short col, unsigned short value); //sets the peak pixels for the column
-      void setLEDColumn(unsigned short col, unsigned short value); //sets the LED column 
+      int64_t updateLEDs(int64_t showTime = 0); //updates the LED matrix, not before showTime (esp_timer us, 0 for now). Returns the time the update started
+      void startDemo(CRGB color); //starts a demo sweep, drawn over the next frames without blocking
+      void renderFrame(const unsigned short* values, int64_t frameTime, float frameScale); //moves the peaks and draws the columns with values[col] rows lit. frameTime is the frame clock (us) and frameScale the time since the previous frame relative to REFERENCE_FRAME_MICROS
+      void setBackground(BackgroundEffect effect, uint8_t level); //sets the layer drawn behind the bars and its level (0-255)
+      void setBlendModes(BlendMode bar, BlendMode peak); //sets how the bars and the peaks are combined with the layers below them
+      unsigned short getPeakRow(unsigned short col); //returns the row of the peak pixel for the column
       unsigned short getNoOfRows(); //returns the number of rows in the matrix
       unsigned short getNoOfCols(); //returns the number of columns in the matrix
       unsigned short getBrightness(); //returns the FastLED brightness
@@ -1,12 +1,49 @@
 #include "LedServer.h"
 #include "WebPage.h"
 
-WebServer* LedServer::_server = nullptr;    
+#define CONFIG_SAVE_DELAY_MS 2000 //settings are saved once no further changes have come in for this long
+#define CONFIG_LOCK_WAIT_MS 50 //longest time the /config handler waits for the response to be rebuilt
+#define CONFIG_READER_POLL_MS 10 //how often the web server thread looks again for a /config buffer no response is sending
+#define CONFIG_READER_WAIT_MS 200 //longest time the web server thread waits for such a buffer before it leaves the rebuild for its next wake
+
+AsyncWebServer* LedServer::_server = nullptr;    
 WifiConnection* LedServer::_wifiConn = nullptr;
 LedMatrix* LedServer::_ledMatrix = nullptr;
-bool LedServer::_clientsPaused = false; 
+ConfigStore* LedServer::_configStore = nullptr;
+TaskHandle_t LedServer::_webServerTask = nullptr;
+volatile bool LedServer::_configChanged = false;
+volatile bool LedServer::_configStale = false;
+RequestGuard* LedServer::_requestGuard = nullptr;
+char* LedServer::_deployPayload = nullptr;
+AsyncWebServerRequest* LedServer::_deployWriter = nullptr;
+size_t LedServer::_deployLength = 0;
+std::atomic<uint8_t> LedServer::_deployState(DEPLOY_IDLE);
+volatile bool LedServer::_deployFailed = false;
+uint32_t LedServer::_deploySequence = 0;
+volatile uint32_t LedServer::_deployQueued = 0;
+volatile uint32_t LedServer::_deployApplied = 0;
+volatile bool LedServer::_dspModeRequested = false;
+SemaphoreHandle_t LedServer::_configLock = nullptr;
+char* LedServer::_configJson[2] = {nullptr, nullptr};
+size_t LedServer::_configLength[2] = {0, 0};
+uint8_t LedServer::_configReaders[2] = {0, 0};
+uint8_t LedServer::_configCurrent = 0;
+size_t LedServer::_configCapacity = 0;
+JsonArena* LedServer::_handlerArena = nullptr;
+JsonArena* LedServer::_workerArena = nullptr;
+FrameStreamer* LedServer::_frameStreamer = nullptr;
+FrameReceiver* LedServer::_frameReceiver = nullptr;
+LatencyTracer* LedServer::_latencyTracer = nullptr;
+Analyzer* LedServer::_analyzer = nullptr;
+SerialTelemetry* LedServer::_serialTelemetry = nullptr;
+SpectrumHistory* LedServer::_spectrumHistory = nullptr;
+AudioSnapshot* LedServer::_audioSnapshot = nullptr;
+Metrics* LedServer::_metrics = nullptr;
+unsigned short* LedServer::_bandTable = nullptr;
+unsigned short* LedServer::_storedBandTable = nullptr;
+size_t LedServer::_maxPayloadLength = 0;
 float LedServer::_speedFilter = 0.08; //default; can be updated via web portal.
-float LedServer::_attenuationFactor = 100000.0f; //default value; can be changed from the portal.
+float LedServer::_attenuationFactor = 100000.0f; //default value (lowest AGC reference level); can be changed from the portal.
 
 
 //public member definitions
@@ -16,221 +53,890 @@ LedServer::LedServer(LedServerArgs args){
   this->_ledMatrix = args.ledMatrix;
   this->_wifiConn = args.wifiConnection;
   this->_server = args.webServer;
+  this->_configStore = args.configStore;
+  this->_frameStreamer = args.frameStreamer;
+  this->_frameReceiver = args.frameReceiver;
+  this->_latencyTracer = args.latencyTracer;
+  this->_analyzer = args.analyzer;
+  this->_serialTelemetry = args.serialTelemetry;
+  this->_spectrumHistory = args.spectrumHistory;
+  this->_audioSnapshot = args.audioSnapshot;
+  this->_metrics = args.metrics;
+  this->_captureTime = 0;
+  this->_bandsReadyTime = 0;
+  this->_frameTime = 0;
+  this->_frameScale = 1.0f;
+  this->_showTime = 0;
   this->_noOfBands = this->_ledMatrix->getNoOfCols();
   this->_noOfLevels = this->_ledMatrix->getNoOfRows();
+  this->_quantizer = new LevelQuantizer(this->_noOfLevels);
   this->_freqBandsOld = new float[this->_noOfBands] {0};
   this->_freqBands = nullptr;
+  this->_peakRows = new uint8_t[this->_noOfBands] {0};
+  this->_columnValues = new unsigned short[this->_noOfBands] {0};
+  this->_bandTable = new unsigned short[this->_noOfBands] {0}; //the number of bands can be changed up to the number of columns
+  this->_storedBandTable = new unsigned short[this->_noOfBands] {0};
+  this->_firstFrameShown = false;
+  this->_maxPayloadLength = 512 + (this->_noOfBands * this->_noOfLevels * 64); //fixed settings plus a generous size per pixel entry
+
+  //restore the settings saved from the web portal before the first frame is displayed
+  this->loadConfig();
 
-  //start second thread pinned to ESP32 CPU Core 0 for running web server 
+  //dedicated DSP mode: no web portal, so none of its buffers and no thread. Core 0 is left to the audio analysis.
   this->_webServerTask = nullptr;
-  xTaskCreatePinnedToCore(this->webServerThread, "WebServerTask", 10000, NULL, 4, &_webServerTask, 0); 
+  if(this->_server == nullptr){
+    Serial.println("Web server disabled (dedicated DSP mode)");
+    return;
+  }
+
+  this->_requestGuard = new RequestGuard();
+  this->_deployPayload = new char[this->_maxPayloadLength + 1]; //allocated once, so a deploy never needs heap while it is handed over
+  this->_configLock = xSemaphoreCreateMutex();
+  unsigned short noOfLeds = this->_noOfBands * this->_noOfLevels;
+  this->_handlerArena = new JsonArena(HANDLER_ARENA_SLOTS * JSON_SLOT_BYTES);
+  this->_workerArena = new JsonArena((WORKER_ARENA_SLOTS + noOfLeds * WORKER_ARENA_SLOTS_PER_PIXEL) * JSON_SLOT_BYTES);
+  this->_configCapacity = CONFIG_JSON_BASE_BYTES + noOfLeds * CONFIG_JSON_BYTES_PER_PIXEL;
+  this->_configJson[0] = new char[this->_configCapacity]; //two buffers allocated once, so a response can be rebuilt while the last one is still being sent
+  this->_configJson[1] = new char[this->_configCapacity];
+  this->_metrics->setJsonArenas(this->_handlerArena, this->_workerArena);
+
+  //start second thread pinned to ESP32 CPU Core 0 for running web server. The requests themselves are served by the async TCP task, also on core 0.
+  xTaskCreatePinnedToCore(this->webServerThread, "WebServerTask", 10000, NULL, args.workerPriority, &_webServerTask, 0); 
 }
 
 //update the clients (eg. LED matrix) with the frequency bands
-void LedServer::updateClients(float* freqBins){
+void LedServer::updateClients(float* freqBins, int64_t captureTime){
   if(this->_freqBands == nullptr){
     this->_freqBands = freqBins;
   }
 
-  if(this->_clientsPaused)
-    return;
-  
-  this->attenuateBands();
+  this->_captureTime = captureTime;
+  this->_showTime = 0;
+  this->_bandsReadyTime = esp_timer_get_time();
+  this->advanceFrameClock(this->_bandsReadyTime);
+  this->_metrics->recordFrame(this->_bandsReadyTime);
+
+  this->quantizeBands();
   this->smoothenSpeed();
   this->sendToLEDMatrix();
-}
-
+  this->sendToStream();
+  this->sendToTelemetry();
+  this->sendToHistory();
 
-//PRIVATE MEMBER DEFINITIONS
-void LedServer::pauseClients(){
-  _clientsPaused = true;
-  _ledMatrix->clearMatrix();
+  this->_metrics->recordRender(esp_timer_get_time() - this->_bandsReadyTime);
 }
 
-void LedServer::resumeClients(){
-  _ledMatrix->clearMatrix();
-  _clientsPaused = false;
+//update the clients with levels that are already scaled and smoothed (0.0 - 1.0), eg. received from another analyzer
+void LedServer::displayLevels(float* levels, int64_t showTime){
+  this->_freqBands = levels;
+  this->_captureTime = 0; //captured by another device, so latency cannot be traced here
+  this->_showTime = showTime;
+  this->advanceFrameClock(showTime != 0 ? showTime : esp_timer_get_time()); //the frames are shown at their presentation times, so the animation follows those
+  this->_metrics->recordFrame(esp_timer_get_time());
+  this->sendToLEDMatrix();
+  this->sendToHistory();
 }
 
-//frequency levels are usuallly in the 100K range.  We need to attenuate them signficantly to be able to display them on the LED matrix.
-void LedServer::attenuateBands(){
-  float highestBand = 0.0f;
-  
-  //find the highest magnitude of all bands
-  for (int i = 0; i < this->_noOfBands; i++) {
-      if (this->_freqBands[i] > highestBand) {
-          highestBand = this->_freqBands[i];
-      }
-  }
 
-  //if highest band is more than attenuation factor, take that.  Otherwise, take the attentuation factor
-  // float attentuationFactor = max(highestBand, this->_attenuationFactor); 
-  float attentuationFactor = max(highestBand, this->_attenuationFactor); 
+//PRIVATE MEMBER DEFINITIONS
+//frequency levels are usuallly in the 100K range.  They are mapped onto the rows on a dB scale, relative to an AGC reference that follows the loudness of the program.
+//the attenuation factor set from the portal is the lowest the reference can go, so quiet passages and noise are not amplified to full scale.
+void LedServer::quantizeBands(){
+  this->_quantizer->setFloor(this->_attenuationFactor);
+  this->_quantizer->update(this->_freqBands, this->_noOfBands, this->_frameScale);
+
+  //levels are kept as a fraction of the rows (0.0 - 1.0), so the smoothing and the streamed frames do not depend on the number of rows
+  for (unsigned short i = 0; i < this->_noOfBands; i++) {
+    this->_freqBands[i] = (float)this->_quantizer->quantize(this->_freqBands[i]) / this->_noOfLevels;
+  }
+}
 
-  //for all bands, divide the bands with attenuation factor, to make the frequency values 
-  for (int i = 0; i < this->_noOfBands; i++) {
-    this->_freqBands[i] /= attentuationFactor;
-  }  
+//the frame time is taken once per frame; the steps of the animation (bar decay, peak fall, AGC) are scaled by the time since the previous frame,
+//so the display moves at the same speed whatever the frame rate
+void LedServer::advanceFrameClock(int64_t frameTime){
+  this->_frameScale = this->_frameTime > 0 ? min((float)(frameTime - this->_frameTime) / REFERENCE_FRAME_MICROS, MAX_FRAME_SCALE) : 1.0f;
+  this->_frameScale = max(this->_frameScale, 0.0f); //presentation times of a display node can go back when its clock is corrected
+  this->_frameTime = frameTime;
 }
 
-//smoothen the speed of the transition of levels in the bands
+//smoothen the speed of the transition of levels in the bands. A level rises at once and falls by _speedFilter per reference frame.
+//max() of the new level and the decayed old one does both, so the loop has no branches.
 void LedServer::smoothenSpeed(){
-  float freqBandsNew[this->_noOfBands] = {0};
+  float decay = this->_speedFilter * this->_frameScale;
 
-  //smooth out the data
   for (unsigned short i = 0; i < this->_noOfBands; i++) {
-    freqBandsNew[i] = this->_freqBands[i];
-    
-    if (freqBandsNew[i] < this->_freqBandsOld[i]) {
-      this->_freqBands[i] = max(this->_freqBandsOld[i] - this->_speedFilter, freqBandsNew[i]);
-    }else if (freqBandsNew[i] > this->_freqBandsOld[i]) {
-      this->_freqBands[i] = freqBandsNew[i];
-    }        
-
-    this->_freqBandsOld[i] = this->_freqBands[i];
+    float level = max(this->_freqBands[i], this->_freqBandsOld[i] - decay);
+    this->_freqBands[i] = level;
+    this->_freqBandsOld[i] = level;
   } 
 }
 
 //send the LED levels to LED matrix
 void LedServer::sendToLEDMatrix() {
-  //map the frequency values to integers to be compatible with the LED display 
+  //turn the levels back into rows (rounded, as the smoothing leaves them between rows)
   for (unsigned short col = 0; col < this->_noOfBands; col++) {
-    unsigned short level = this->_freqBands[col] * 100;
-    unsigned short value = map(level, 0, 100, 0, this->_noOfLevels);
-    
-    _ledMatrix->setLEDColumn(col, value);   
-    _ledMatrix->setLEDColPeak(col, value);            
+    this->_columnValues[col] = this->_freqBands[col] * this->_noOfLevels + 0.5f;
   }
+  _ledMatrix->renderFrame(this->_columnValues, this->_frameTime, this->_frameScale);
 
-  _ledMatrix->updateLEDs();
+  int64_t renderedTime = esp_timer_get_time();
+  int64_t showStart = _ledMatrix->updateLEDs(this->_showTime);
+
+  if(this->_frameReceiver != nullptr && this->_showTime != 0){
+    this->_frameReceiver->recordShowError(showStart - this->_showTime);
+  }
+
+  if(this->_latencyTracer != nullptr && this->_captureTime != 0){
+    int64_t shownTime = esp_timer_get_time();
+    this->_latencyTracer->record(STAGE_RENDER, renderedTime - this->_bandsReadyTime);
+    this->_latencyTracer->record(STAGE_SHOW, shownTime - renderedTime);
+    this->_latencyTracer->record(STAGE_TOTAL, shownTime - this->_captureTime + this->_latencyTracer->getBufferMicros()); //the first sample of the block was captured one block duration before the DMA completed
+  }
+
+  if(!this->_firstFrameShown){
+    this->_firstFrameShown = true;
+    Serial.printf("First frame displayed %lu ms after boot\n", millis());
+  }
+}
+
+//send the frame to remote display nodes
+void LedServer::sendToStream(){
+  if(this->_frameStreamer == nullptr)
+    return;
+
+  for (unsigned short col = 0; col < this->_noOfBands; col++) {
+    this->_peakRows[col] = _ledMatrix->getPeakRow(col);
+  }
+
+  this->_frameStreamer->publish(this->_freqBands, this->_peakRows, this->_noOfBands, this->_noOfLevels);
+}
+
+//write the frame and its timings to the serial port
+void LedServer::sendToTelemetry(){
+  if(this->_serialTelemetry == nullptr)
+    return;
+
+  uint32_t stageMicros[NUM_LATENCY_STAGES] = {0};
+  for (unsigned short s = 0; s < NUM_LATENCY_STAGES && this->_latencyTracer != nullptr; s++) {
+    stageMicros[s] = this->_latencyTracer->getLast((LatencyStage)s);
+  }
+
+  for (unsigned short col = 0; col < this->_noOfBands; col++) {
+    this->_peakRows[col] = _ledMatrix->getPeakRow(col);
+  }
+
+  this->_serialTelemetry->publish(this->_freqBands, this->_peakRows, this->_noOfBands, this->_noOfLevels, stageMicros,
+    this->_analyzer != nullptr ? this->_analyzer->getFftMicros() : 0,
+    this->_frameStreamer != nullptr ? this->_frameStreamer->getFramesDropped() : 0);
+}
+
+//add the frame to the history
+void LedServer::sendToHistory(){
+  if(this->_spectrumHistory == nullptr)
+    return;
+
+  this->_spectrumHistory->record(this->_freqBands);
 }
 
 //web server thread function
 void LedServer::webServerThread(void* pvParameters) {    
+  AllocGuard::watchTask("WebServerTask");
+
+  //the audio loop is already running on the other core, so connecting to WiFi here does not hold up the display
   if(_wifiConn->setupWifiConnection()){ 
-    //if successfully connected to wifi, give visual indication
-    pauseClients(); //pause any audio displays
-    _ledMatrix->doDemo(CRGB::White);
-    resumeClients(); 
+    //if successfully connected to wifi, give visual indication drawn over the audio display
+    _ledMatrix->startDemo(CRGB::White);
+  }
+
+  if(_frameStreamer != nullptr){
+    _frameStreamer->begin(); //start streaming frames now that the network is up
   }
 
+  buildConfigJson();
   setupWebServerRoutes(); //set up web server handlers
-  _server->begin(); //begin web server
+  _server->begin(); //begin web server. Requests are served from the async TCP task as they arrive, so there is nothing to poll here.
 
   Serial.printf("Web Server started on core %u\n", xPortGetCoreID());
 
+  unsigned long lastChangeMillis = 0;
+
   while(true) {
+    //deploys and housekeeping only, so wake up rarely (or when a deploy arrives). This thread runs at a low priority, so the work a deploy
+    //takes in proportion to the number of LEDs never holds up the web server.
+    ulTaskNotifyTake(pdTRUE, (_configStale ? CONFIG_READER_WAIT_MS : _configChanged ? CONFIG_SAVE_DELAY_MS : 1000) / portTICK_PERIOD_MS);
     _wifiConn->process();  //process wifi requests
-    _server->handleClient(); //process web requests
-    vTaskDelay(10 / portTICK_PERIOD_MS);  //Give time to other tasks (10 ms) and avoid watchdog trigger errors.
+
+    if(_configStale){
+      buildConfigJson(); //the last rebuild found both buffers still being sent
+    }
+
+    if(applyDeploy()){
+      _configChanged = true;
+      lastChangeMillis = millis();
+    }
+
+    if(_dspModeRequested){
+      restartInDspMode(); //does not return
+    }
+
+    //coalesce changes (eg. while a slider is being dragged) into a single flash write: save once no further changes have arrived within the save delay.
+    if(_configChanged && millis() - lastChangeMillis >= CONFIG_SAVE_DELAY_MS){
+      _configChanged = false;
+      saveConfig();
+    }
+  }
+}
+
+//save the settings and restart in dedicated DSP mode. Settings changed within the save delay are saved now, as they would be lost otherwise.
+void LedServer::restartInDspMode(){
+  if(_configChanged){
+    _configChanged = false;
+    saveConfig();
+  }
+
+  if(!_configStore->saveRunMode(RUN_MODE_DSP)){
+    _dspModeRequested = false;
+    return;
   }
+
+  Serial.println("Restarting in dedicated DSP mode");
+  vTaskDelay(DSP_MODE_RESTART_DELAY_MS / portTICK_PERIOD_MS); //the response is sent by the async TCP task meanwhile
+  ESP.restart();
+}
+
+//load the saved settings
+void LedServer::loadConfig(){
+  DisplayConfig config;
+
+  //the LED colors are only overwritten once the stored config has been validated
+  if(_configStore->load(&config, _ledMatrix->getLEDColors(), _storedBandTable)){
+    _ledMatrix->setMaxPeakFallingWait(config.peakDelay);
+    _ledMatrix->setPeakFallingIntervalIncrement(config.peakSpeed);
+    _speedFilter = config.speedFilter;
+    _attenuationFactor = config.attenuationFactor;
+    _ledMatrix->setBrightness(config.brightness);
+    _ledMatrix->setPeakColor(CRGB(config.peakR, config.peakG, config.peakB));
+
+    if(_analyzer != nullptr && config.noOfBands > 0){
+      _analyzer->setBandTable(0, _storedBandTable, config.noOfBands); //swapped in by the audio loop with the first frame
+    }
+
+    Serial.println("Saved config loaded");
+  }
+}
+
+//save the current settings
+void LedServer::saveConfig(){
+  DisplayConfig config = {};
+  CRGB peakColor = _ledMatrix->getPeakColor();
+
+  config.peakDelay = _ledMatrix->getMaxPeakFallingWait();
+  config.peakSpeed = _ledMatrix->getPeakFallingIntervalIncrement();
+  config.speedFilter = _speedFilter;
+  config.attenuationFactor = _attenuationFactor;
+  config.brightness = _ledMatrix->getBrightness();
+  config.peakR = peakColor.r;
+  config.peakG = peakColor.g;
+  config.peakB = peakColor.b;
+  config.noOfBands = _analyzer != nullptr ? _analyzer->getBandTable(0, _storedBandTable) : 0;
+
+  if(_configStore->save(&config, _ledMatrix->getLEDColors(), _storedBandTable)){
+    Serial.println("Config saved");
+  }
+}
+
+//change the band table from a deploy request: either a preset ("bandPreset": {"type": "octave"|"thirdOctave"|"linear", "count": n})
+//or the upper frequency of each band ("bands": [...]). The new mapping is prepared here, on the web server side, and swapped in by the audio loop between frames.
+bool LedServer::deployBands(JsonDocument& doc){
+  if(_analyzer == nullptr)
+    return true; //no bands to change (display node)
+
+  uint8_t maxBands = _analyzer->getMaxBands(0);
+  uint8_t noOfBands = 0;
+
+  if(doc["bandPreset"].is<JsonObject>()){
+    const char* type = doc["bandPreset"]["type"].as<const char*>(); //points into the document, so no copy is made
+    uint8_t count = doc["bandPreset"]["count"].as<uint8_t>();
+    BandLayout layout;
+
+    if(type == nullptr){
+      return false;
+    }else if(strcmp(type, "octave") == 0){
+      layout = LAYOUT_OCTAVE;
+    }else if(strcmp(type, "thirdOctave") == 0){
+      layout = LAYOUT_THIRD_OCTAVE;
+    }else if(strcmp(type, "linear") == 0){
+      layout = LAYOUT_LINEAR;
+    }else{
+      return false;
+    }
+
+    if(count == 0 || count > maxBands){
+      count = maxBands;
+    }
+
+    noOfBands = _analyzer->makeBandTable(layout, count, _bandTable);
+  }else if(doc["bands"].is<JsonArray>()){
+    JsonArray bands = doc["bands"].as<JsonArray>();
+
+    if(bands.size() > maxBands){
+      return false;
+    }
+
+    for (JsonVariant band : bands) {
+      _bandTable[noOfBands++] = band.as<unsigned short>();
+    }
+  }else{
+    return true; //band table not part of the request
+  }
+
+  return _analyzer->setBandTable(0, _bandTable, noOfBands);
+}
+
+//free the deploy buffer if the request was copying its body into it (called when its connection closes)
+void LedServer::abandonDeploy(AsyncWebServerRequest* request){
+  if(_deployWriter == request){
+    _deployWriter = nullptr;
+    _deployState.store(DEPLOY_IDLE);
+  }
+}
+
+//take the deploy buffer for writing a payload. A deploy waiting for the web server thread is replaced by the newer one; one that is
+//already being applied cannot be.
+bool LedServer::claimDeploy(){
+  uint8_t expected = DEPLOY_IDLE;
+  if(_deployState.compare_exchange_strong(expected, DEPLOY_WRITING)){
+    return true;
+  }
+  expected = DEPLOY_QUEUED;
+  return _deployState.compare_exchange_strong(expected, DEPLOY_WRITING);
+}
+
+//hand the _deployLength bytes written to the deploy buffer over to the web server thread, and reply with the sequence number of the deploy.
+//The payload is only parsed by the web server thread, so the outcome is reported at /config against the sequence number.
+void LedServer::queueDeploy(AsyncWebServerRequest* request){
+  _deployPayload[_deployLength] = '\0';
+  _deployQueued = ++_deploySequence;
+  _deployState.store(DEPLOY_QUEUED);
+  xTaskNotifyGive(_webServerTask);
+
+  char json[40];
+  snprintf(json, sizeof(json), "{\"result\":\"queued\",\"deploy\":%u}", (unsigned)_deployQueued);
+  sendWithCors(request, 202, json);
+}
+
+//refuse a deploy while the buffer is taken by another one, or one is being applied
+void LedServer::sendDeployBusy(AsyncWebServerRequest* request){
+  AsyncWebServerResponse* response = request->beginResponse(503, "application/json", "{\"result\":\"fail\"}");
+  response->addHeader("Retry-After", WEB_RETRY_AFTER_SECONDS);
+  addCorsHeaders(response);
+  request->send(response);
+}
+
+//apply the deploy waiting for the web server thread, if any
+bool LedServer::applyDeploy(){
+  uint8_t expected = DEPLOY_QUEUED;
+  if(!_deployState.compare_exchange_strong(expected, DEPLOY_APPLYING)){
+    return false;
+  }
+
+  _deployApplied = _deployQueued; //no newer deploy can be queued while this one is applied
+  JsonDocument doc(_workerArena);
+  DeserializationError err = deserializeJson(doc, (const char*)_deployPayload);
+
+  if(err){
+    Serial.print(F("deserializeJson() returned "));
+    Serial.println(err.f_str());
+    _deployFailed = true;
+    buildConfigJson(); //reports the failed deploy
+    _deployState.store(DEPLOY_IDLE);
+    return false;
+  }
+
+  //set peak delay and speed
+  _ledMatrix->setMaxPeakFallingWait(doc["peakDelay"]);
+  _ledMatrix->setPeakFallingIntervalIncrement(doc["peakSpeed"]);
+  _speedFilter = doc["speedFilter"];
+  _attenuationFactor = doc["atten"];
+  _ledMatrix->setBrightness(doc["brightness"]);
+
+
+  //set peak color
+  uint8_t r = doc["peak"]["r"];
+  uint8_t g = doc["peak"]["g"];
+  uint8_t b = doc["peak"]["b"];
+  _ledMatrix->setPeakColor(CRGB(r, g, b));
+
+  JsonArray pixels = doc["pixels"].as<JsonArray>();
+  unsigned short noOfLeds = _ledMatrix->getNoOfCols() * _ledMatrix->getNoOfRows();
+  for (unsigned short i=0; i < noOfLeds; i++) {
+    r = pixels[i]["r"];
+    g = pixels[i]["g"];
+    b = pixels[i]["b"];
+    _ledMatrix->setPixelColor(i, CRGB(r, g, b));
+  }    
+
+  //set band table
+  _deployFailed = !deployBands(doc);
+  if(_deployFailed){
+    Serial.println("Invalid band table");
+  }
+
+  //the settings have changed, so /config has to be rebuilt before it is served again
+  buildConfigJson();
+  _deployState.store(DEPLOY_IDLE);
+  return true;
+}
+
+//build the /config response from the current settings
+void LedServer::buildConfigJson(){
+  JsonDocument doc(_workerArena);
+  
+  doc["noOfCols"] = _ledMatrix->getNoOfCols();
+  doc["noOfRows"] = _ledMatrix->getNoOfRows();    
+  doc["peakDelay"] = _ledMatrix->getMaxPeakFallingWait();
+  doc["peakSpeed"] = _ledMatrix->getPeakFallingIntervalIncrement();      
+  doc["speedFilter"] = _speedFilter;  
+  doc["atten"] = _attenuationFactor;  
+  doc["brightness"] = _ledMatrix->getBrightness();  
+  doc["deploy"] = _deployApplied; //a deploy that was replaced before it was applied is never reported, the newer one is
+  doc["lastDeploy"] = _deployFailed ? "fail" : "success";
+
+  //get band table
+  if(_analyzer != nullptr){
+    doc["maxBands"] = _analyzer->getMaxBands(0);
+    JsonArray bands = doc["bands"].to<JsonArray>();
+    uint8_t noOfBands = _analyzer->getBandTable(0, _bandTable);
+    for (uint8_t i = 0; i < noOfBands; i++) {
+      bands.add(_bandTable[i]);
+    }
+  }
+  
+  //get peak color
+  CRGB peakColor = _ledMatrix->getPeakColor();
+  doc["peak"]["r"] = peakColor.r;
+  doc["peak"]["g"] = peakColor.g;
+  doc["peak"]["b"] = peakColor.b;
+  
+  JsonArray pixels = doc["pixels"].to<JsonArray>();
+  unsigned short noOfLeds = _ledMatrix->getNoOfCols() * _ledMatrix->getNoOfRows();
+  CRGB* ledColors = _ledMatrix->getLEDColors();
+  for (unsigned short i=0; i < noOfLeds; i++) {
+    pixels[i]["r"] = ledColors[i].r;
+    pixels[i]["g"] = ledColors[i].g;
+    pixels[i]["b"] = ledColors[i].b;
+  }    
+
+  if(doc.overflowed()){
+    Serial.println("The settings do not fit in the JSON arena, /config is not updated");
+    return;
+  }
+
+  if(measureJson(doc) >= _configCapacity){
+    Serial.println("The settings do not fit in the /config buffer, /config is not updated");
+    return;
+  }
+
+  //write into a buffer no response is sending, the spare one if it is free. Only if both are still being sent is there a wait, and clients
+  //that stop reading must not hold up deploys: after a while the current response is kept and rebuilt on a later wake.
+  _configStale = false;
+  xSemaphoreTake(_configLock, portMAX_DELAY);
+  for (uint16_t waited = 0; _configReaders[0] > 0 && _configReaders[1] > 0; waited += CONFIG_READER_POLL_MS) {
+    if(waited >= CONFIG_READER_WAIT_MS){
+      _configStale = true;
+      xSemaphoreGive(_configLock);
+      return;
+    }
+    xSemaphoreGive(_configLock);
+    vTaskDelay(CONFIG_READER_POLL_MS / portTICK_PERIOD_MS);
+    xSemaphoreTake(_configLock, portMAX_DELAY);
+  }
+
+  uint8_t buffer = _configReaders[1 - _configCurrent] == 0 ? 1 - _configCurrent : _configCurrent;
+  _configLength[buffer] = serializeJson(doc, _configJson[buffer], _configCapacity);
+  _configCurrent = buffer;
+  xSemaphoreGive(_configLock);
 }
 
 //add CORS headers to the web server response
-void LedServer::addCorsHeaders(){
-  _server->sendHeader("Access-Control-Allow-Origin", "*"); // Allow all origins
-  _server->sendHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-  _server->sendHeader("Access-Control-Allow-Headers", "Content-Type");
+void LedServer::addCorsHeaders(AsyncWebServerResponse* response){
+  response->addHeader("Access-Control-Allow-Origin", "*"); // Allow all origins
+  response->addHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+  response->addHeader("Access-Control-Allow-Headers", "Content-Type");
+}
+
+//respond with a JSON result and the CORS headers, so browsers can read refusals as well
+void LedServer::sendWithCors(AsyncWebServerRequest* request, int code, const char* json){
+  AsyncWebServerResponse* response = request->beginResponse(code, "application/json", json);
+  addCorsHeaders(response);
+  request->send(response);
+}
+
+//respond to a CORS preflight request
+void LedServer::sendCorsPreflight(AsyncWebServerRequest* request){
+  AsyncWebServerResponse* response = request->beginResponse(200, "text/plain", "CORS Allowed!");
+  addCorsHeaders(response);
+  request->send(response);
+}
+
+//respond with a JSON document. A document that ran out of arena is incomplete, so it is not sent.
+void LedServer::sendJson(AsyncWebServerRequest* request, JsonDocument& doc){
+  if(doc.overflowed()){
+    AsyncWebServerResponse* response = request->beginResponse(500, "application/json", "{\"result\":\"fail\"}");
+    addCorsHeaders(response);
+    request->send(response);
+    return;
+  }
+
+  AsyncResponseStream* response = request->beginResponseStream("application/json");
+  serializeJson(doc, *response);
+  addCorsHeaders(response);
+  request->send(response);
 }
 
 //set up web server route handlers
 void LedServer::setupWebServerRoutes(){
-  //set up home page route
-  _server->on("/", []() {   
-    _server->send_P(200, "text/html", g_webPage);
+  //count every request, whichever handler serves it, and only serve it within the connection and rate limits and the handler budget
+  _server->addMiddleware([](AsyncWebServerRequest* request, ArMiddlewareNext next){
+    AllocGuard::watchTask("async_tcp"); //the handlers run in the async TCP task, which is only known once it serves a request
+    _metrics->countWebRequest();
+
+    uint32_t route = RequestGuard::routeOf(request->method(), request->url().c_str());
+    RequestVerdict verdict = _requestGuard->admit(request->client()->remoteIP(), route, millis());
+    if(verdict != REQUEST_ADMITTED){
+      char retryAfter[12];
+      strcpy(retryAfter, WEB_RETRY_AFTER_SECONDS);
+      if(verdict == REQUEST_RATE_LIMITED){
+        _metrics->countWebRateLimited();
+      }else if(verdict == REQUEST_BUSY){
+        _metrics->countWebBusy();
+      }else{
+        _metrics->countWebShed();
+        snprintf(retryAfter, sizeof(retryAfter), "%u", (unsigned)_requestGuard->getRetryAfter(route, millis()));
+      }
+
+      AsyncWebServerResponse* response = request->beginResponse(verdict == REQUEST_RATE_LIMITED ? 429 : 503, "application/json", "{\"result\":\"fail\"}");
+      response->addHeader("Retry-After", retryAfter);
+      addCorsHeaders(response);
+      request->send(response);
+      return;
+    }
+
+    request->onDisconnect([request](){
+      _requestGuard->release(); //handlers that set their own disconnect callback replace this one, so they have to release the request as well
+      abandonDeploy(request);
+    });
+
+    int64_t start = esp_timer_get_time();
+    next();
+    uint32_t handlerMicros = esp_timer_get_time() - start;
+    _metrics->recordWebHandler(handlerMicros);
+    _requestGuard->recordCost(route, handlerMicros, millis()); //a route that keeps going over budget is shed
+  });
+
+  //set up home page route. The page is stored gzip compressed and sent as it is; browsers that already have it get a 304.
+  _server->on("/", [](AsyncWebServerRequest* request) {   
+    AsyncWebServerResponse* response;
+
+    if(request->hasHeader("If-None-Match") && request->header("If-None-Match") == WEB_PAGE_ETAG){
+      response = request->beginResponse(304);
+    }else{
+      response = request->beginResponse(200, "text/html", g_webPage, g_webPageLength);
+      response->addHeader("Content-Encoding", "gzip");
+    }
+
+    response->addHeader("ETag", WEB_PAGE_ETAG);
+    response->addHeader("Cache-Control", "no-cache"); //cached, but checked against the ETag on every visit, so a firmware update shows the new page right away
+    request->send(response);
   });
 
   //config API request preflight
-  _server->on("/config", HTTP_OPTIONS, [](){
-    addCorsHeaders();
-    _server->send(200, "text/plain", "CORS Allowed!");
-  });
-
-  //config API request handler 
-  _server->on("/config", []() {   
-    JsonDocument doc;
-    
-    doc["noOfCols"] = _ledMatrix->getNoOfCols();
-    doc["noOfRows"] = _ledMatrix->getNoOfRows();    
-    doc["peakDelay"] = _ledMatrix->getMaxPeakFallingWait();
-    doc["peakSpeed"] = _ledMatrix->getPeakFallingIntervalIncrement();      
-    doc["speedFilter"] = _speedFilter;  
-    doc["atten"] = _attenuationFactor;  
-    doc["brightness"] = _ledMatrix->getBrightness();  
-    
-    //get peak color
-    CRGB peakColor = _ledMatrix->getPeakColor();
-    doc["peak"]["r"] = peakColor.r;
-    doc["peak"]["g"] = peakColor.g;
-    doc["peak"]["b"] = peakColor.b;
-    
-    JsonArray pixels = doc["pixels"].to<JsonArray>();
-    unsigned short noOfLeds = _ledMatrix->getNoOfCols() * _ledMatrix->getNoOfRows();
-    CRGB* ledColors = _ledMatrix->getLEDColors();
-    for (unsigned short i=0; i < noOfLeds; i++) {
-      pixels[i]["r"] = ledColors[i].r;
-      pixels[i]["g"] = ledColors[i].g;
-      pixels[i]["b"] = ledColors[i].b;
-    }    
-
-    String response;
-    serializeJson(doc, response);
-    addCorsHeaders();
-    _server->send(200, "application/json", response);
+  _server->on("/config", HTTP_OPTIONS, [](AsyncWebServerRequest* request){
+    sendCorsPreflight(request);
   });
 
-  //In my tests, _server.enableCORS did not work, so adding preflight manually to enable CORS.
-  _server->on("/deploy", HTTP_OPTIONS, [](){
-    addCorsHeaders();
-    _server->send(200, "text/plain", "CORS Allowed!");
+  //config API request handler. The response is built by the web server thread whenever the settings change, so serving it is only a copy
+  //from its buffer as the response goes out. The buffer is held until the client is gone, so it is never rebuilt under a response.
+  _server->on("/config", [](AsyncWebServerRequest* request) {   
+    uint8_t deployState = _deployState.load();
+    AsyncWebServerResponse* response = nullptr;
+
+    if(deployState == DEPLOY_IDLE && xSemaphoreTake(_configLock, CONFIG_LOCK_WAIT_MS / portTICK_PERIOD_MS) == pdTRUE){
+      uint8_t buffer = _configCurrent;
+      _configReaders[buffer]++;
+      size_t length = _configLength[buffer];
+      xSemaphoreGive(_configLock);
+
+      request->onDisconnect([buffer](){
+        xSemaphoreTake(_configLock, portMAX_DELAY);
+        _configReaders[buffer]--; //the buffer can be rebuilt once the client is gone
+        xSemaphoreGive(_configLock);
+        if(_configStale){
+          xTaskNotifyGive(_webServerTask); //rebuild it now rather than on the next wake
+        }
+        _requestGuard->release(); //replaces the callback set by the middleware
+      });
+
+      response = request->beginResponse("application/json", length, [buffer, length](uint8_t* out, size_t maxLen, size_t index) -> size_t {
+        size_t chunk = min(maxLen, length - index);
+        memcpy(out, _configJson[buffer] + index, chunk);
+        return chunk;
+      });
+    }else{
+      response = request->beginResponse(503, "application/json", "{\"result\":\"pending\"}"); //a deploy is being applied, the settings are about to change
+      response->addHeader("Retry-After", WEB_RETRY_AFTER_SECONDS);
+    }
+
+    addCorsHeaders(response);
+    request->send(response);
+  });
+
+  //metrics in the Prometheus text exposition format
+  _server->on("/metrics", HTTP_GET, [](AsyncWebServerRequest* request){
+    AsyncResponseStream* response = request->beginResponseStream("text/plain; version=0.0.4");
+    _metrics->writePrometheus(*response);
+    request->send(response);
   });
 
-  //API request handler to deploy config changes 
-  _server->on("/deploy", HTTP_POST, [](){
-    JsonDocument doc;
-    String payload = _server->arg("data");
+  //frame stream statistics
+  _server->on("/stream", HTTP_GET, [](AsyncWebServerRequest* request){
+    JsonDocument doc(_handlerArena);
+
+    doc["enabled"] = _frameStreamer != nullptr;
+    if(_frameStreamer != nullptr){
+      doc["sent"] = _frameStreamer->getPacketsSent();
+      doc["errors"] = _frameStreamer->getSendErrors();
+      doc["dropped"] = _frameStreamer->getFramesDropped();
+      doc["packetsPerSecond"] = _frameStreamer->getPacketsPerSecond();
+      doc["bytes"] = _frameStreamer->getBytesSent();
+      doc["syncRequests"] = _frameStreamer->getSyncRequests();
+    }
+
+    if(_serialTelemetry != nullptr){
+      doc["telemetrySent"] = _serialTelemetry->getRecordsSent();
+      doc["telemetryDropped"] = _serialTelemetry->getRecordsDropped();
+    }
+
+    if(_frameReceiver != nullptr){
+      doc["received"] = _frameReceiver->getFramesReceived();
+      doc["late"] = _frameReceiver->getFramesLate();
+      doc["concealed"] = _frameReceiver->getFramesConcealed();
+      doc["undecodable"] = _frameReceiver->getFramesUndecodable();
+      doc["clockSynced"] = _frameReceiver->isClockSynced();
+      doc["clockDriftPpm"] = _frameReceiver->getClockDriftPpm();
+      doc["clockRoundTripUs"] = _frameReceiver->getClockRoundTrip();
+      doc["clockResidualUs"] = _frameReceiver->getClockResidual();
+      doc["showErrorUs"] = _frameReceiver->getLastShowError();
+      doc["showErrorMaxUs"] = _frameReceiver->getMaxShowError();
+      doc["showErrorMeanUs"] = _frameReceiver->getMeanShowError();
+    }
 
-    DeserializationError err = deserializeJson(doc, payload);
+    sendJson(request, doc);
+  });
 
-    if(err){
-      Serial.print(F("deserializeJson() returned "));
-      Serial.println(err.f_str());
-      _server->send(200, "application/json", "{\"result\":\"fail\"}");
+  //latency of the audio to LED pipeline stages (us)
+  _server->on("/latency", HTTP_GET, [](AsyncWebServerRequest* request){
+    JsonDocument doc(_handlerArena);
+
+    doc["enabled"] = _latencyTracer != nullptr;
+    if(_latencyTracer != nullptr){
+      doc["buffer"] = _latencyTracer->getBufferMicros();
+
+      for (unsigned short s = 0; s < NUM_LATENCY_STAGES; s++) {
+        LatencyStats stats = _latencyTracer->getStats((LatencyStage)s);
+        JsonObject stage = doc[LatencyTracer::getStageName((LatencyStage)s)].to<JsonObject>();
+        stage["count"] = stats.count;
+        stage["p50"] = stats.p50;
+        stage["p95"] = stats.p95;
+        stage["p99"] = stats.p99;
+        stage["max"] = stats.max;
+      }
+    }
+
+    sendJson(request, doc);
+  });
+
+  //band views computed from the FFT, with their current levels and the cost of computing them (us)
+  _server->on("/views", HTTP_GET, [](AsyncWebServerRequest* request){
+    JsonDocument doc(_handlerArena);
+
+    doc["enabled"] = _analyzer != nullptr;
+    if(_analyzer != nullptr){
+      doc["engine"] = _analyzer->getEngine() == ENGINE_FILTER_BANK ? "filterbank" : "fft";
+      doc["blockSize"] = _analyzer->getBlockSize();
+      doc["fftMicros"] = _analyzer->getFftMicros();
+      JsonArray views = doc["views"].to<JsonArray>();
+
+      for (uint8_t v = 0; v < _analyzer->getNoOfViews(); v++) {
+        BandView* view = _analyzer->getView(v);
+        JsonObject obj = views.add<JsonObject>();
+        obj["name"] = view->name;
+        obj["costMicros"] = view->costMicros;
+
+        JsonArray levels = obj["levels"].to<JsonArray>();
+        for (uint8_t b = 0; b < view->maps[view->activeMap].noOfBands; b++) {
+          levels.add(view->levels != nullptr ? view->levels[b] : 0.0f);
+        }
+      }
+    }
+
+    sendJson(request, doc);
+  });
+
+  //the most recent frames as a binary download (see SpectrumHistory.h for the format), streamed straight from the ring while the audio loop keeps writing
+  _server->on("/history", HTTP_GET, [](AsyncWebServerRequest* request){
+    if(_spectrumHistory == nullptr){
+      request->send(404, "application/json", "{\"result\":\"fail\"}");
       return;
     }
 
-    //set peak delay and speed
-    _ledMatrix->setMaxPeakFallingWait(doc["peakDelay"]);
-    _ledMatrix->setPeakFallingIntervalIncrement(doc["peakSpeed"]);
-    _speedFilter = doc["speedFilter"];
-    _attenuationFactor = doc["atten"];
-    _ledMatrix->setBrightness(doc["brightness"]);
+    HistoryDownload download = _spectrumHistory->startDownload();
+    AsyncWebServerResponse* response = request->beginResponse("application/octet-stream", _spectrumHistory->getDownloadLength(download), 
+      [download](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+        return _spectrumHistory->readDownload(download, buffer, maxLen, index);
+      });
+    response->addHeader("Content-Disposition", "attachment; filename=\"history.bin\"");
+    addCorsHeaders(response);
+    request->send(response);
+  });
 
+  //raw audio snapshot as a WAV file, converted from the snapshot buffer part by part as the response goes out
+  _server->on("/snapshot.wav", HTTP_GET, [](AsyncWebServerRequest* request){
+    if(_audioSnapshot == nullptr || !_audioSnapshot->startDownload()){
+      request->send(409, "application/json", "{\"result\":\"fail\"}"); //no complete snapshot yet
+      return;
+    }
 
-    //set peak color
-    uint8_t r = doc["peak"]["r"];
-    uint8_t g = doc["peak"]["g"];
-    uint8_t b = doc["peak"]["b"];
-    _ledMatrix->setPeakColor(CRGB(r, g, b));
+    request->onDisconnect([](){
+      _audioSnapshot->endDownload(); //the snapshot can be taken again once the client is gone
+      _requestGuard->release(); //replaces the callback set by the middleware
+    });
+
+    AsyncWebServerResponse* response = request->beginResponse("audio/wav", _audioSnapshot->getWavLength(), 
+      [](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        return _audioSnapshot->readWav(buffer, maxLen, index);
+      });
+    response->addHeader("Content-Disposition", "attachment; filename=\"snapshot.wav\"");
+    addCorsHeaders(response);
+    request->send(response);
+  });
 
-    JsonArray pixels = doc["pixels"].as<JsonArray>();
-    unsigned short noOfLeds = _ledMatrix->getNoOfCols() * _ledMatrix->getNoOfRows();
-    for (unsigned short i=0; i < noOfLeds; i++) {
-      r = pixels[i]["r"];
-      g = pixels[i]["g"];
-      b = pixels[i]["b"];
-      _ledMatrix->setPixelColor(i, CRGB(r, g, b));
-    }    
+  //audio snapshot state and the cost of the capture tap (us per block)
+  _server->on("/snapshot", HTTP_GET, [](AsyncWebServerRequest* request){
+    JsonDocument doc(_handlerArena);
+
+    doc["enabled"] = _audioSnapshot != nullptr;
+    if(_audioSnapshot != nullptr){
+      const char* states[] = {"idle", "capturing", "ready"};
+      doc["state"] = states[_audioSnapshot->getState()];
+      doc["blocksCaptured"] = _audioSnapshot->getBlocksCaptured();
+      doc["noOfBlocks"] = _audioSnapshot->getNoOfBlocks();
+      doc["sampleRate"] = _audioSnapshot->getSampleRate();
+      doc["tapMicros"] = _audioSnapshot->getTapMicros();
+      doc["maxTapMicros"] = _audioSnapshot->getMaxTapMicros();
+    }
 
-    addCorsHeaders();
-    _server->send(200, "application/json", "{\"result\":\"success\"}");
+    sendJson(request, doc);
+  });
 
-  });  
-}
+  _server->on("/snapshot", HTTP_OPTIONS, [](AsyncWebServerRequest* request){
+    sendCorsPreflight(request);
+  });
+
+  //trigger an audio snapshot of the next blocks
+  _server->on("/snapshot", HTTP_POST, [](AsyncWebServerRequest* request){
+    bool armed = _audioSnapshot != nullptr && _audioSnapshot->arm();
+
+    AsyncWebServerResponse* response = request->beginResponse(armed ? 200 : 409, "application/json", armed ? "{\"result\":\"success\"}" : "{\"result\":\"fail\"}");
+    addCorsHeaders(response);
+    request->send(response);
+  });
 
+  _server->on("/dspmode", HTTP_OPTIONS, [](AsyncWebServerRequest* request){
+    sendCorsPreflight(request);
+  });
 
+  //restart in dedicated DSP mode (no WiFi, analysis on core 0). The web server thread saves the mode and restarts, once this response is out.
+  _server->on("/dspmode", HTTP_POST, [](AsyncWebServerRequest* request){
+    _dspModeRequested = true;
+    xTaskNotifyGive(_webServerTask);
 
+    AsyncWebServerResponse* response = request->beginResponse(202, "application/json", "{\"result\":\"success\"}");
+    addCorsHeaders(response);
+    request->send(response);
+  });
 
+  //In my tests, _server.enableCORS did not work, so adding preflight manually to enable CORS.
+  _server->on("/deploy", HTTP_OPTIONS, [](AsyncWebServerRequest* request){
+    sendCorsPreflight(request);
+  });
 
-  
-  
\ No newline at end of file
+  //API request handler to deploy config changes. The JSON payload is the request body, which is copied chunk by chunk straight into the
+  //deploy buffer as it arrives (onBody runs before the middleware and the request handler), so the server never holds a body of its own.
+  //A body longer than _maxPayloadLength is refused on its length before any of it is copied. The payload is parsed and applied by the web
+  //server thread, so the reply is only "queued" with a sequence number. /config reports the last deploy finished and whether it applied.
+  _server->on("/deploy", HTTP_POST, [](AsyncWebServerRequest* request){
+    //clients of the first portal send the payload in the "data" parameter (query string or form body). The server has already parsed it,
+    //so it is copied into the deploy buffer here.
+    const AsyncWebParameter* param = request->hasParam("data") ? request->getParam("data") : request->getParam("data", true);
+    if(param != nullptr){
+      const String& payload = param->value();
+      if(payload.length() > _maxPayloadLength){
+        sendWithCors(request, 413, "{\"result\":\"fail\"}");
+        return;
+      }
+      if(!claimDeploy()){
+        sendDeployBusy(request);
+        return;
+      }
+
+      memcpy(_deployPayload, payload.c_str(), payload.length());
+      _deployLength = payload.length();
+      queueDeploy(request);
+      return;
+    }
+
+    if(request->contentLength() == 0){
+      sendWithCors(request, 400, "{\"result\":\"fail\"}");
+      return;
+    }
+    if(request->contentLength() > _maxPayloadLength){
+      sendWithCors(request, 413, "{\"result\":\"fail\"}");
+      return;
+    }
+    if(!request->contentType().startsWith("application/json")){
+      sendWithCors(request, 415, "{\"result\":\"fail\"}"); //a body that is neither JSON nor a form with a "data" field
+      return;
+    }
+
+    //the buffer was taken by another deploy, or one is being applied
+    if(_deployWriter != request || _deployLength != request->contentLength()){
+      sendDeployBusy(request);
+      return;
+    }
+
+    _deployWriter = nullptr;
+    queueDeploy(request);
+  }, nullptr, [](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total){
+    if(index == 0){
+      if(total > _maxPayloadLength){
+        return; //refused by the request handler
+      }
+
+      if(!claimDeploy()){
+        return;
+      }
+      _deployWriter = request;
+      _deployLength = 0;
+      request->onDisconnect([request](){
+        abandonDeploy(request); //the connection closed before the request handler ran (the middleware replaces this callback)
+      });
+    }
+
+    if(_deployWriter != request || index + len > _maxPayloadLength){
+      return;
+    }
+    memcpy(_deployPayload + index, data, len);
+    _deployLength = index + len;
+  });  
+}
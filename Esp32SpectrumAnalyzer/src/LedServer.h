@@ -3,39 +3,133 @@
 
 #include "LedMatrix.h"
 #include "WifiConnection.h"
+#include "ConfigStore.h"
+#include "FrameStreamer.h"
+#include "FrameReceiver.h"
+#include "LatencyTracer.h"
+#include "Analyzer.h"
+#include "LevelQuantizer.h"
+#include "SerialTelemetry.h"
+#include "SpectrumHistory.h"
+#include "RequestGuard.h"
+#include "JsonArena.h"
+#include "AllocGuard.h"
+
+//the JSON documents of the web side are built in fixed arenas, so serving and deploying never allocates from the heap (see JsonArena.h)
+#define HANDLER_ARENA_SLOTS 512 //web handler responses (4 KB on the ESP32)
+#define WORKER_ARENA_SLOTS 512 //deploys and /config, in addition to the slots per pixel
+#define WORKER_ARENA_SLOTS_PER_PIXEL 12 //a pixel is an object of 3 members (7 slots), with room for the pools being resized
+#define CONFIG_JSON_BASE_BYTES 768 //the /config buffers are allocated for the largest response at boot: the settings and the band table,
+#define CONFIG_JSON_BYTES_PER_PIXEL 26 //and {"r":255,"g":255,"b":255}, per pixel
+#define DSP_MODE_RESTART_DELAY_MS 500 //time the /dspmode response is given to reach the browser before the restart
+
 
 //structure for passing arguments to the LedServer constructor
 struct LedServerArgs{
-  WifiConnection* wifiConnection;
-  WebServer* webServer;
+  WifiConnection* wifiConnection; //optional (nullptr in dedicated DSP mode)
+  AsyncWebServer* webServer; //optional (nullptr in dedicated DSP mode, which has no web portal)
   LedMatrix* ledMatrix;
+  ConfigStore* configStore;
+  FrameStreamer* frameStreamer; //optional (nullptr if frames are not streamed)
+  FrameReceiver* frameReceiver; //optional (only in display node mode)
+  LatencyTracer* latencyTracer; //optional (nullptr if latency is not traced)
+  Analyzer* analyzer; //optional (nullptr in display node mode)
+  SerialTelemetry* serialTelemetry; //optional (nullptr if no telemetry is written to the serial port)
+  SpectrumHistory* spectrumHistory; //optional (nullptr if no history is kept)
+  AudioSnapshot* audioSnapshot; //optional (nullptr if audio snapshots are not taken)
+  Metrics* metrics; //counters and gauges served at /metrics
+  UBaseType_t workerPriority; //priority of the web server thread, which applies deploys, saves the settings and looks after WiFi
+};
+
+//state of the deploy handed over from the /deploy handler to the web server thread
+enum DeployState{
+  DEPLOY_IDLE,
+  DEPLOY_WRITING, //the body of a /deploy request is being copied
+  DEPLOY_QUEUED, //a payload is waiting for the web server thread. A newer one replaces it.
+  DEPLOY_APPLYING //the web server thread is applying the payload
 };
 
 class LedServer {
   private:
-    TaskHandle_t _webServerTask; //task handler for webserver 
+    static TaskHandle_t _webServerTask; //task handler for webserver 
     static WifiConnection* _wifiConn; 
-    static WebServer* _server;
+    static AsyncWebServer* _server;
     static LedMatrix* _ledMatrix;    
+    static ConfigStore* _configStore; //persists the settings changed via web portal
+    static volatile bool _configChanged; //flag to indicate the settings need to be saved
+    static volatile bool _configStale; //flag to indicate the /config response could not be rebuilt and is out of date
+    static RequestGuard* _requestGuard; //limits the number of requests served at the same time and the request rate per client
+    static char* _deployPayload; //payload of the deploy handed over to the web server thread
+    static AsyncWebServerRequest* _deployWriter; //request whose body is being copied into _deployPayload (nullptr if none)
+    static size_t _deployLength; //bytes of the body copied so far
+    static std::atomic<uint8_t> _deployState; //DeployState
+    static volatile bool _deployFailed; //flag to indicate the last deploy could not be applied
+    static uint32_t _deploySequence; //sequence number of the last deploy queued (async TCP task only)
+    static volatile uint32_t _deployQueued; //sequence number of the deploy in _deployPayload
+    static volatile uint32_t _deployApplied; //sequence number of the last deploy the web server thread finished, reported at /config with its outcome
+    static volatile bool _dspModeRequested; //flag to indicate the device is to restart in dedicated DSP mode
+    static SemaphoreHandle_t _configLock; //protects the /config buffers, their lengths and readers, and _configCurrent
+    static char* _configJson[2]; //the /config response, built by the web server thread whenever the settings change, into a buffer no response is sending
+    static size_t _configLength[2]; //length of the response in each buffer
+    static uint8_t _configReaders[2]; //responses still sending each buffer
+    static uint8_t _configCurrent; //buffer holding the current response
+    static size_t _configCapacity; //size of each buffer
+    static JsonArena* _handlerArena; //JSON documents of the web handlers (async TCP task)
+    static JsonArena* _workerArena; //JSON documents of the web server thread (deploys and /config)
+    static FrameStreamer* _frameStreamer; //sends the displayed frames to remote display nodes
+    static FrameReceiver* _frameReceiver; //receives the frames displayed in display node mode
+    uint8_t* _peakRows; //array to hold the peak rows of the frame being streamed
+    static LatencyTracer* _latencyTracer; //records the latency of the render stages
+    static Analyzer* _analyzer; //analyzer providing the band views
+    static SerialTelemetry* _serialTelemetry; //writes a binary record of every frame to the serial port
+    static SpectrumHistory* _spectrumHistory; //keeps the most recent frames for download
+    static AudioSnapshot* _audioSnapshot; //raw audio captured for download
+    static Metrics* _metrics; //counters and gauges served at /metrics
+    static unsigned short* _bandTable; //band table being read/changed by the web handlers
+    static unsigned short* _storedBandTable; //band table being loaded/saved
+    int64_t _captureTime; //time (us since boot) the samples of the current frame were captured (0 if unknown)
+    int64_t _bandsReadyTime; //time (us since boot) the frequency bands of the current frame were handed over
+    int64_t _frameTime; //frame clock: the one time (us since boot) all the animation of the current frame is driven by
+    float _frameScale; //time since the previous frame relative to REFERENCE_FRAME_MICROS
+    unsigned short* _columnValues; //rows lit in each column of the frame being displayed
+    int64_t _showTime; //time the LEDs are to show the current frame (esp_timer us, 0 for as soon as possible)
+    LevelQuantizer* _quantizer; //maps the frequency band magnitudes onto the rows (dB scale with AGC)
     float* _freqBandsOld; //array to hold the previous frequency band levels
     float* _freqBands; //array to hold the frequency band levels
     static float _speedFilter; //factor used to smoothen the speed of the bands.  Can be changed via web portal.
-    static float _attenuationFactor; //factor used to attenuate/amplify the bands signal.  Can be changed via web portal.
+    static float _attenuationFactor; //lowest AGC reference level, so quiet signals are not amplified to full scale.  Can be changed via web portal.
     unsigned short _noOfBands; //number of bands
     unsigned short _noOfLevels; //number of levels 
-    static bool _clientsPaused; //flag to pause/resume the clients (eg. LED matrix)
-    void attenuateBands(); //attenuate the bands
+    bool _firstFrameShown; //flag to indicate the first frame has been displayed
+    static size_t _maxPayloadLength; //upper bound for the size of a request payload (bounds per-request memory)
+    void advanceFrameClock(int64_t frameTime); //move the frame clock to the current frame
+    void quantizeBands(); //map the bands onto the rows (dB scale with AGC)
     void smoothenSpeed(); //smoothen the speed of the transition of levels in the bands
     void sendToLEDMatrix(); //send the LED levels to LED matrix
+    void sendToStream(); //send the frame to remote display nodes
+    void sendToTelemetry(); //write the frame and its timings to the serial port
+    void sendToHistory(); //add the frame to the history
     static void webServerThread(void* pvParameters); //web server thread function
-    static void addCorsHeaders(); //add CORS headers to the web server response
+    static void addCorsHeaders(AsyncWebServerResponse* response); //add CORS headers to the web server response
+    static void sendCorsPreflight(AsyncWebServerRequest* request); //respond to a CORS preflight request
+    static void sendWithCors(AsyncWebServerRequest* request, int code, const char* json); //respond with a JSON result and the CORS headers
+    static void sendJson(AsyncWebServerRequest* request, JsonDocument& doc); //respond with a JSON document (500 if it did not fit in its arena)
     static void setupWebServerRoutes(); //set up web server routes
-    static void pauseClients(); //pause the clients (eg. LED matrix)
-    static void resumeClients(); //resume the clients (eg. LED matrix)
+    static void loadConfig(); //load the saved settings
+    static void saveConfig(); //save the current settings
+    static bool deployBands(JsonDocument& doc); //change the band table from a deploy request (preset or band frequencies)
+    static bool claimDeploy(); //take the deploy buffer for writing a payload. Returns false if a deploy is being written or applied.
+    static void queueDeploy(AsyncWebServerRequest* request); //hand the payload in the deploy buffer over to the web server thread and reply
+    static void sendDeployBusy(AsyncWebServerRequest* request); //refuse a deploy with 503 and Retry-After
+    static void abandonDeploy(AsyncWebServerRequest* request); //free the deploy buffer if the request was copying its body into it
+    static bool applyDeploy(); //apply the deploy waiting for the web server thread, if any. Returns true if one was applied.
+    static void buildConfigJson(); //build the /config response from the current settings
+    static void restartInDspMode(); //save the settings and restart in dedicated DSP mode
 
   public:
     LedServer(LedServerArgs args);
-    void updateClients(float* freqBins); //update the clients (eg. LED matrix) with the frequency bands
+    void updateClients(float* freqBins, int64_t captureTime); //update the clients (eg. LED matrix) with the frequency bands captured at the given time (us since boot)
+    void displayLevels(float* levels, int64_t showTime = 0); //update the clients with levels that are already scaled and smoothed (0.0 - 1.0), eg. received from another analyzer, showing them at showTime (esp_timer us, 0 for now)
 };
 
 
@@ -0,0 +1,66 @@
+#include "LevelQuantizer.h"
+
+LevelQuantizer::LevelQuantizer(uint8_t noOfRows){
+    this->_noOfRows = noOfRows;
+    this->_rowRatios = new float[noOfRows];
+    this->_rowThresholds = new uint32_t[noOfRows] {0};
+
+    //the rows are spread evenly over the dB range: the top row lights up one step below the reference, the bottom row at the bottom of the range
+    for (uint8_t r = 0; r < noOfRows; r++) {
+      float rowDb = -LEVEL_DB_RANGE * (noOfRows - r) / noOfRows;
+      this->_rowRatios[r] = powf(10.0f, rowDb / 20.0f);
+    }
+
+    this->_floorDb = 100.0f; //100000, the former default attenuation factor
+    this->_referenceDb = this->_floorDb;
+}
+
+void LevelQuantizer::update(float* bands, uint8_t noOfBands, float frameScale){
+    float highestBand = 0.0f;
+
+    //find the highest magnitude of all bands
+    for (uint8_t i = 0; i < noOfBands; i++) {
+      if (bands[i] > highestBand) {
+        highestBand = bands[i];
+      }
+    }
+
+    //fast attack, slow release, never below the floor. Shorter frames take proportionally smaller steps, so the AGC keeps its timing at any frame rate.
+    float highestDb = highestBand > 0.0f ? 20.0f * log10f(highestBand) : this->_floorDb;
+    if(highestDb > this->_referenceDb){
+      float attack = frameScale == 1.0f ? AGC_ATTACK : 1.0f - powf(1.0f - AGC_ATTACK, frameScale);
+      this->_referenceDb += (highestDb - this->_referenceDb) * attack;
+    }else{
+      this->_referenceDb -= AGC_RELEASE_DB * frameScale;
+    }
+
+    if(this->_referenceDb < this->_floorDb){
+      this->_referenceDb = this->_floorDb;
+    }
+
+    //work out the row thresholds for this frame. They are at least 1, so a band of 0 (digital silence) lights no row even with a low floor.
+    float reference = this->getReference();
+    for (uint8_t r = 0; r < this->_noOfRows; r++) {
+      uint32_t threshold = reference * this->_rowRatios[r];
+      this->_rowThresholds[r] = threshold > 0 ? threshold : 1;
+    }
+}
+
+uint8_t LevelQuantizer::quantize(float band){
+    uint32_t magnitude = band <= 0.0f ? 0 : (band < (float)UINT32_MAX ? (uint32_t)band : UINT32_MAX);
+    uint8_t rows = 0;
+
+    while (rows < this->_noOfRows && magnitude >= this->_rowThresholds[rows]) {
+      rows++;
+    }
+
+    return rows;
+}
+
+void LevelQuantizer::setFloor(float floor){
+    this->_floorDb = 20.0f * log10f(max(floor, 1.0f));
+}
+
+float LevelQuantizer::getReference(){
+    return powf(10.0f, this->_referenceDb / 20.0f);
+}
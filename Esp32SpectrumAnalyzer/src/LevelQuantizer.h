@@ -0,0 +1,28 @@
+#ifndef LevelQuantizer_h
+#define LevelQuantizer_h
+
+#include "Common.h"
+
+#define LEVEL_DB_RANGE 40.0f //dynamic range shown on the matrix: the bottom row lights up this far below the AGC reference
+#define AGC_ATTACK 0.6f //fraction of the gap to a louder frame the AGC reference closes per frame (fast attack)
+#define AGC_RELEASE_DB 0.15f //dB the AGC reference falls per frame while the frames are quieter (slow release, about 6 dB/s)
+
+//maps band magnitudes onto matrix rows on a dB scale, with an automatic gain control following the loudness of the program.
+//the AGC and the row thresholds are updated once per frame; each band is then quantized with integer comparisons only.
+class LevelQuantizer {
+  private:
+    uint8_t _noOfRows; //number of rows in the matrix
+    float* _rowRatios; //threshold of each row relative to the AGC reference (worked out once)
+    uint32_t* _rowThresholds; //magnitude a band needs to light up each row in the current frame (ascending)
+    float _referenceDb; //AGC reference level in dB: the level of the top row
+    float _floorDb; //lowest AGC reference level in dB, so silence and noise are not amplified to full scale
+
+  public:
+    LevelQuantizer(uint8_t noOfRows); //constructor
+    void update(float* bands, uint8_t noOfBands, float frameScale); //updates the AGC with the loudest band of the frame and works out the row thresholds. frameScale is the length of the frame relative to an FFT frame.
+    uint8_t quantize(float band); //returns the number of rows a band magnitude lights up
+    void setFloor(float floor); //sets the lowest AGC reference level (band magnitude)
+    float getReference(); //returns the AGC reference level (band magnitude)
+};
+
+#endif
@@ -0,0 +1,224 @@
+#include "Metrics.h"
+
+const uint32_t Metrics::_jitterBounds[JITTER_BUCKETS - 1] = {250, 500, 1000, 1500, 2000, 2500, 3000, 4000, 5000, 7500, 10000};
+
+Metrics::Metrics(){
+    this->_i2sShortReads = 0;
+    this->_i2sReadErrors = 0;
+    this->_i2sOverflows = 0;
+    this->_i2sDmaErrors = 0;
+    this->_framesProcessed = 0;
+    this->_framesPerSecond = 0;
+    this->_webRequests = 0;
+    this->_webRateLimited = 0;
+    this->_webBusy = 0;
+    this->_webOverBudget = 0;
+    this->_webShed = 0;
+    this->_webMaxHandlerMicros = 0;
+    this->_jitterSum = 0;
+    this->_lastFrameTime = 0;
+    this->_secondStartTime = 0;
+    this->_framesAtSecondStart = 0;
+    this->_meanInterval = 0;
+    this->_meanAnalysisMicros = 0;
+    this->_meanRenderMicros = 0;
+    this->_framesDropped = 0;
+    this->_handlerArena = nullptr;
+    this->_workerArena = nullptr;
+
+    for (uint8_t b = 0; b < JITTER_BUCKETS; b++) {
+      this->_jitterBuckets[b] = 0;
+    }
+}
+
+void Metrics::countShortRead(){
+    this->_i2sShortReads++;
+}
+
+void Metrics::countReadError(){
+    this->_i2sReadErrors++;
+}
+
+void Metrics::countI2sOverflow(){
+    this->_i2sOverflows++;
+}
+
+void Metrics::countI2sDmaError(){
+    this->_i2sDmaErrors++;
+}
+
+//jitter is the deviation of the frame interval from its running mean, so it does not depend on the block size or sampling frequency
+void Metrics::recordFrame(int64_t frameTime){
+    this->_framesProcessed++;
+
+    if(this->_lastFrameTime != 0){
+      float interval = frameTime - this->_lastFrameTime;
+      this->_meanInterval = this->_meanInterval == 0 ? interval : this->_meanInterval + (interval - this->_meanInterval) / 64;
+
+      uint32_t jitter = fabsf(interval - this->_meanInterval);
+      uint8_t bucket = 0;
+      while (bucket < JITTER_BUCKETS - 1 && jitter > _jitterBounds[bucket]) {
+        bucket++;
+      }
+
+      this->_jitterBuckets[bucket]++;
+      this->_jitterSum += jitter;
+    }
+    this->_lastFrameTime = frameTime;
+
+    if(frameTime - this->_secondStartTime >= 1000000){
+      this->_framesPerSecond = this->_framesProcessed - this->_framesAtSecondStart;
+      this->_framesAtSecondStart = this->_framesProcessed;
+      this->_secondStartTime = frameTime;
+    }
+}
+
+//running means over about the last 64 frames, like the frame interval. Each is written by one task only.
+void Metrics::recordAnalysis(uint32_t micros){
+    float mean = this->_meanAnalysisMicros;
+    this->_meanAnalysisMicros = mean == 0 ? micros : mean + (micros - mean) / 64;
+}
+
+void Metrics::recordRender(uint32_t micros){
+    float mean = this->_meanRenderMicros;
+    this->_meanRenderMicros = mean == 0 ? micros : mean + (micros - mean) / 64;
+}
+
+void Metrics::countFrameDropped(){
+    this->_framesDropped++;
+}
+
+uint32_t Metrics::getFramesPerSecond(){
+    return this->_framesPerSecond;
+}
+
+uint32_t Metrics::getAnalysisMicros(){
+    return this->_meanAnalysisMicros;
+}
+
+uint32_t Metrics::getRenderMicros(){
+    return this->_meanRenderMicros;
+}
+
+uint32_t Metrics::getFramesDropped(){
+    return this->_framesDropped;
+}
+
+uint32_t Metrics::getI2sOverflows(){
+    return this->_i2sOverflows;
+}
+
+void Metrics::countWebRequest(){
+    this->_webRequests++;
+}
+
+void Metrics::countWebRateLimited(){
+    this->_webRateLimited++;
+}
+
+void Metrics::countWebBusy(){
+    this->_webBusy++;
+}
+
+void Metrics::countWebShed(){
+    this->_webShed++;
+}
+
+void Metrics::recordWebHandler(uint32_t micros){
+    if(micros > WEB_HANDLER_BUDGET_US){
+      this->_webOverBudget++;
+    }
+    if(micros > this->_webMaxHandlerMicros){
+      this->_webMaxHandlerMicros = micros;
+    }
+}
+
+void Metrics::setJsonArenas(JsonArena* handlerArena, JsonArena* workerArena){
+    this->_handlerArena = handlerArena;
+    this->_workerArena = workerArena;
+}
+
+void Metrics::writePrometheus(Print& out){
+    writeMetric(out, "sad_i2s_short_reads_total", "counter", "I2S reads that returned less than a full block", this->_i2sShortReads);
+    writeMetric(out, "sad_i2s_read_errors_total", "counter", "I2S reads that failed", this->_i2sReadErrors);
+    writeMetric(out, "sad_i2s_rx_overflows_total", "counter", "Blocks dropped by the I2S driver because the audio loop fell behind", this->_i2sOverflows);
+    writeMetric(out, "sad_i2s_dma_errors_total", "counter", "DMA errors reported by the I2S driver", this->_i2sDmaErrors);
+    writeMetric(out, "sad_frames_processed_total", "counter", "Frames processed by the frame loop", this->_framesProcessed);
+    writeMetric(out, "sad_frames_per_second", "gauge", "Frames processed during the last second", this->_framesPerSecond);
+    writeMetric(out, "sad_analysis_us", "gauge", "Mean time the analysis of a frame takes", this->getAnalysisMicros());
+    writeMetric(out, "sad_render_us", "gauge", "Mean time from the bands being ready until the frame is out", this->getRenderMicros());
+    writeMetric(out, "sad_web_requests_total", "counter", "Web requests served", this->_webRequests);
+    writeMetric(out, "sad_web_rate_limited_total", "counter", "Web requests refused because the client made too many", this->_webRateLimited);
+    writeMetric(out, "sad_web_busy_total", "counter", "Web requests refused because too many were being served", this->_webBusy);
+    writeMetric(out, "sad_web_over_budget_total", "counter", "Web handlers that took longer than their budget", this->_webOverBudget);
+    writeMetric(out, "sad_web_shed_total", "counter", "Web requests refused because their route kept going over budget", this->_webShed);
+    writeMetric(out, "sad_web_handler_max_us", "gauge", "Longest time a web handler took", this->_webMaxHandlerMicros);
+    writeMetric(out, "sad_heap_free_bytes", "gauge", "Free heap", ESP.getFreeHeap());
+    writeMetric(out, "sad_heap_min_free_bytes", "gauge", "Lowest free heap since boot", ESP.getMinFreeHeap());
+    writeMetric(out, "sad_heap_largest_free_block_bytes", "gauge", "Largest block that can be allocated", ESP.getMaxAllocHeap());
+
+    //use of the JSON arenas of the web side
+    if(this->_handlerArena != nullptr){
+      JsonArena* arenas[] = {this->_handlerArena, this->_workerArena};
+      const char* names[] = {"handler", "worker"};
+
+      out.print("# HELP sad_json_arena_bytes Size of the JSON arena\n# TYPE sad_json_arena_bytes gauge\n");
+      for (uint8_t a = 0; a < 2; a++) {
+        out.printf("sad_json_arena_bytes{arena=\"%s\"} %lu\n", names[a], (unsigned long)arenas[a]->getSize());
+      }
+      out.print("# HELP sad_json_arena_high_water_bytes Most bytes of the JSON arena in use at the same time\n# TYPE sad_json_arena_high_water_bytes gauge\n");
+      for (uint8_t a = 0; a < 2; a++) {
+        out.printf("sad_json_arena_high_water_bytes{arena=\"%s\"} %lu\n", names[a], (unsigned long)arenas[a]->getHighWater());
+      }
+      out.print("# HELP sad_json_arena_failures_total Allocations refused because the JSON arena was full\n# TYPE sad_json_arena_failures_total counter\n");
+      for (uint8_t a = 0; a < 2; a++) {
+        out.printf("sad_json_arena_failures_total{arena=\"%s\"} %lu\n", names[a], (unsigned long)arenas[a]->getFailures());
+      }
+    }
+
+    //heap allocations per task (only counted in ALLOC_GUARD builds)
+    if(AllocGuard::isEnabled()){
+      out.print("# HELP sad_task_allocations_total Heap allocations made by the task\n# TYPE sad_task_allocations_total counter\n");
+      for (uint8_t t = 0; t < AllocGuard::getNoOfTasks(); t++) {
+        out.print("sad_task_allocations_total{task=\"");
+        writeLabelValue(out, AllocGuard::getTaskName(t)); //any task can be watched under any name
+        out.printf("\"} %lu\n", (unsigned long)AllocGuard::getAllocations(t));
+      }
+    }
+
+    //frame jitter histogram (buckets are cumulative in the exposition format)
+    out.print("# HELP sad_frame_jitter_us Deviation of the frame interval from its running mean\n");
+    out.print("# TYPE sad_frame_jitter_us histogram\n");
+
+    uint32_t count = 0;
+    for (uint8_t b = 0; b < JITTER_BUCKETS; b++) {
+      count += this->_jitterBuckets[b];
+      if(b < JITTER_BUCKETS - 1){
+        out.printf("sad_frame_jitter_us_bucket{le=\"%lu\"} %lu\n", (unsigned long)_jitterBounds[b], (unsigned long)count);
+      }else{
+        out.printf("sad_frame_jitter_us_bucket{le=\"+Inf\"} %lu\n", (unsigned long)count);
+      }
+    }
+
+    out.printf("sad_frame_jitter_us_sum %llu\n", (unsigned long long)this->_jitterSum);
+    out.printf("sad_frame_jitter_us_count %lu\n", (unsigned long)count);
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+void Metrics::writeMetric(Print& out, const char* name, const char* type, const char* help, uint32_t value){
+    out.printf("# HELP %s %s\n# TYPE %s %s\n%s %lu\n", name, help, name, type, name, (unsigned long)value);
+}
+
+void Metrics::writeLabelValue(Print& out, const char* value){
+    for (const char* c = value; *c != '\0'; c++) {
+      if(*c == '\\' || *c == '"'){
+        out.print('\\');
+        out.print(*c);
+      }else if(*c == '\n'){
+        out.print("\\n");
+      }else{
+        out.print(*c);
+      }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef Metrics_h
+#define Metrics_h
+
+#include "Common.h"
+#include "JsonArena.h"
+#include "AllocGuard.h"
+
+#define JITTER_BUCKETS 12 //number of buckets of the frame jitter histogram (the last one is +Inf)
+#define WEB_HANDLER_BUDGET_US 5000 //web handlers taking longer than this are counted as over budget (they hold up every other request), and their routes shed
+
+//counters and gauges of the audio loop and the web server, exposed in the Prometheus text format at /metrics.
+//every update is a few integer operations, so they are always on.
+class Metrics {
+  private:
+    volatile uint32_t _i2sShortReads; //reads that returned less than a full block
+    volatile uint32_t _i2sReadErrors; //reads that failed
+    volatile uint32_t _i2sOverflows; //blocks the I2S driver dropped because the audio loop did not read them in time
+    volatile uint32_t _i2sDmaErrors; //DMA errors reported by the I2S driver
+    volatile uint32_t _framesProcessed; //frames the loop has processed
+    volatile uint32_t _framesPerSecond; //frames processed during the last second
+    volatile uint32_t _webRequests; //web requests served
+    volatile uint32_t _webRateLimited; //web requests refused because the client made too many
+    volatile uint32_t _webBusy; //web requests refused because too many were being served
+    volatile uint32_t _webOverBudget; //web handlers that took longer than their budget
+    volatile uint32_t _webShed; //web requests refused because their route kept going over budget
+    volatile uint32_t _webMaxHandlerMicros; //longest time a web handler took
+    volatile uint32_t _jitterBuckets[JITTER_BUCKETS]; //frame jitter histogram (not cumulative)
+    volatile uint64_t _jitterSum; //sum of the frame jitter (us)
+    int64_t _lastFrameTime; //time (us since boot) of the previous frame
+    int64_t _secondStartTime; //time (us since boot) the current one second window started
+    uint32_t _framesAtSecondStart; //frames processed when the current window started
+    float _meanInterval; //running mean of the frame interval (us), which the jitter is measured against
+    volatile float _meanAnalysisMicros; //running mean of the time the analysis of a frame takes (FFT or filter bank and the band views)
+    volatile float _meanRenderMicros; //running mean of the time from the bands being ready until the frame is out (LEDs, stream, telemetry)
+    volatile uint32_t _framesDropped; //analysed frames replaced by a newer one before they were displayed (dedicated DSP mode)
+    JsonArena* _handlerArena; //JSON arena of the web handlers (nullptr until set)
+    JsonArena* _workerArena; //JSON arena of the web server thread (nullptr until set)
+    static const uint32_t _jitterBounds[JITTER_BUCKETS - 1]; //upper bounds of the jitter buckets (us)
+    static void writeMetric(Print& out, const char* name, const char* type, const char* help, uint32_t value); //writes a metric with its HELP and TYPE lines
+    static void writeLabelValue(Print& out, const char* value); //writes a label value with its backslashes, quotes and line feeds escaped
+
+  public:
+    Metrics(); //constructor
+    void countShortRead(); //counts a read that returned less than a full block
+    void countReadError(); //counts a failed read
+    void countI2sOverflow(); //counts a block dropped by the I2S driver
+    void countI2sDmaError(); //counts a DMA error
+    void recordFrame(int64_t frameTime); //records a processed frame and the jitter of its interval. Called from the frame loop.
+    void recordAnalysis(uint32_t micros); //records the time the analysis of a frame took. Called from the task that analyses.
+    void recordRender(uint32_t micros); //records the time the rendering of a frame took. Called from the frame loop.
+    void countFrameDropped(); //counts an analysed frame that was never displayed
+    uint32_t getFramesPerSecond(); //returns the frames processed during the last second
+    uint32_t getAnalysisMicros(); //returns the mean time the analysis of a frame takes
+    uint32_t getRenderMicros(); //returns the mean time the rendering of a frame takes
+    uint32_t getFramesDropped(); //returns the analysed frames that were never displayed
+    uint32_t getI2sOverflows(); //returns the blocks dropped by the I2S driver
+    void countWebRequest(); //counts a web request
+    void countWebRateLimited(); //counts a web request refused because the client made too many
+    void countWebBusy(); //counts a web request refused because too many were being served
+    void countWebShed(); //counts a web request refused because its route kept going over budget
+    void recordWebHandler(uint32_t micros); //records the time a web handler took
+    void setJsonArenas(JsonArena* handlerArena, JsonArena* workerArena); //sets the JSON arenas whose use is reported
+    void writePrometheus(Print& out); //writes all metrics in the Prometheus text exposition format
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "RequestGuard.h"
+
+RequestGuard::RequestGuard(){
+    for (uint8_t i = 0; i < WEB_RATE_CLIENTS; i++) {
+      this->_clients[i] = {0, 0, 0};
+    }
+
+    for (uint8_t i = 0; i < WEB_COST_ROUTES; i++) {
+      this->_routes[i] = {0, 0, 0, 0, 0};
+    }
+
+    this->_inFlight = 0;
+}
+
+RequestVerdict RequestGuard::admit(uint32_t address, uint32_t route, unsigned long now){
+    //find the client, or replace the least recently seen one
+    ClientRate* client = &this->_clients[0];
+    for (uint8_t i = 0; i < WEB_RATE_CLIENTS; i++) {
+      if(this->_clients[i].address == address){
+        client = &this->_clients[i];
+        break;
+      }
+      if(now - this->_clients[i].lastMillis > now - client->lastMillis){
+        client = &this->_clients[i];
+      }
+    }
+
+    if(client->address != address){
+      client->address = address;
+      client->tokens = WEB_RATE_BURST;
+    }else{
+      client->tokens = min((float)WEB_RATE_BURST, client->tokens + ((now - client->lastMillis) * WEB_RATE_PER_SECOND / 1000.0f));
+    }
+    client->lastMillis = now;
+
+    if(client->tokens < 1.0f){
+      return REQUEST_RATE_LIMITED;
+    }
+
+    //a shed route is not charged to the client either, as its handler does not run
+    RouteCost* cost = this->findRoute(route, now);
+    if((long)(cost->shedUntil - now) > 0){
+      return REQUEST_SHED;
+    }
+
+    if(this->_inFlight >= WEB_MAX_REQUESTS){
+      return REQUEST_BUSY; //the request is not charged to the client, it can try again right away
+    }
+
+    client->tokens -= 1.0f;
+    this->_inFlight++;
+    return REQUEST_ADMITTED;
+}
+
+void RequestGuard::release(){
+    if(this->_inFlight > 0){
+      this->_inFlight--;
+    }
+}
+
+uint8_t RequestGuard::getInFlight(){
+    return this->_inFlight;
+}
+
+//a handler within budget clears the overruns and the backoff of its route. A route that is shed again right after its last shed
+//ended needs one overrun only, and is shed for twice as long.
+void RequestGuard::recordCost(uint32_t route, uint32_t micros, unsigned long now){
+    RouteCost* cost = this->findRoute(route, now);
+    if(micros <= WEB_HANDLER_BUDGET_US){
+      cost->overruns = 0;
+      cost->doublings = 0;
+      return;
+    }
+
+    if(++cost->overruns < WEB_SHED_OVERRUNS){
+      return;
+    }
+    cost->shedUntil = now + ((unsigned long)WEB_SHED_MS << cost->doublings);
+    cost->overruns = WEB_SHED_OVERRUNS - 1;
+    if(cost->doublings < WEB_SHED_MAX_DOUBLINGS){
+      cost->doublings++;
+    }
+}
+
+uint32_t RequestGuard::getRetryAfter(uint32_t route, unsigned long now){
+    RouteCost* cost = this->findRoute(route, now);
+    long remaining = cost->shedUntil - now;
+    return remaining > 0 ? (remaining + 999) / 1000 : 1;
+}
+
+//FNV-1a over the method and the URL (without the query string, which the server keeps apart)
+uint32_t RequestGuard::routeOf(uint32_t method, const char* url){
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < 4; i++) {
+      hash = (hash ^ ((method >> (i * 8)) & 0xFF)) * 16777619u;
+    }
+    for (; *url != '\0'; url++) {
+      hash = (hash ^ (uint8_t)*url) * 16777619u;
+    }
+    return hash != 0 ? hash : 1; //0 marks a free entry
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+RouteCost* RequestGuard::findRoute(uint32_t route, unsigned long now){
+    RouteCost* cost = &this->_routes[0];
+    for (uint8_t i = 0; i < WEB_COST_ROUTES; i++) {
+      if(this->_routes[i].route == route){
+        cost = &this->_routes[i];
+        break;
+      }
+      if(now - this->_routes[i].lastMillis > now - cost->lastMillis){
+        cost = &this->_routes[i];
+      }
+    }
+
+    if(cost->route != route){
+      *cost = {route, 0, 0, now, now};
+    }
+    cost->lastMillis = now;
+    return cost;
+}
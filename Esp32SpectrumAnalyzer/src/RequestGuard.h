@@ -0,0 +1,60 @@
+#ifndef RequestGuard_h
+#define RequestGuard_h
+
+#include "Common.h"
+#include "Metrics.h"
+
+#define WEB_MAX_REQUESTS 4 //requests served at the same time (each one holds a connection and a response buffer)
+#define WEB_RATE_PER_SECOND 10 //requests per second a client may make on average
+#define WEB_RATE_BURST 20 //requests a client may make in a burst (eg. when the portal loads)
+#define WEB_RATE_CLIENTS 8 //number of clients the rate is tracked for (the least recently seen one makes room for a new one)
+#define WEB_RETRY_AFTER_SECONDS "1" //sent with refused requests
+#define WEB_COST_ROUTES 16 //number of routes the handler cost is tracked for (the least recently seen one makes room for a new one)
+#define WEB_SHED_OVERRUNS 3 //handlers over WEB_HANDLER_BUDGET_US in a row before their route is shed
+#define WEB_SHED_MS 1000 //time a route is first shed for. It doubles every time the route goes over budget again right after.
+#define WEB_SHED_MAX_DOUBLINGS 5 //longest shed is WEB_SHED_MS times 2^WEB_SHED_MAX_DOUBLINGS (32 s)
+
+enum RequestVerdict{
+  REQUEST_ADMITTED,
+  REQUEST_RATE_LIMITED, //the client made too many requests (429)
+  REQUEST_BUSY, //too many requests are being served (503)
+  REQUEST_SHED //the route went over its handler budget and is refused for a while (503)
+};
+
+//token bucket of a client
+struct ClientRate{
+  uint32_t address; //IPv4 address of the client (0 if the entry is free)
+  float tokens; //requests the client may still make right now
+  unsigned long lastMillis; //time the client was last seen
+};
+
+//handler cost of a route (method and URL)
+struct RouteCost{
+  uint32_t route; //hash of the method and URL (0 if the entry is free)
+  uint8_t overruns; //handlers of the route in a row that went over budget
+  uint8_t doublings; //times the shed time of the route has doubled
+  unsigned long shedUntil; //time the route is refused until (if shed)
+  unsigned long lastMillis; //time the route was last requested
+};
+
+//admits web requests before their handlers run, so portal traffic stays within a fixed number of connections and a request rate per client,
+//and keeps every route within the handler budget: a route whose handlers keep going over WEB_HANDLER_BUDGET_US is refused for a while,
+//for twice as long every time it does so again. Only called from the async TCP task, which runs the handlers one at a time, so it needs no locking.
+class RequestGuard {
+  private:
+    ClientRate _clients[WEB_RATE_CLIENTS]; //token buckets of the most recent clients
+    uint8_t _inFlight; //requests admitted and not yet done
+    RouteCost _routes[WEB_COST_ROUTES]; //handler cost of the most recent routes
+    RouteCost* findRoute(uint32_t route, unsigned long now); //returns the entry of the route, replacing the least recently seen one if it has none
+
+  public:
+    RequestGuard(); //constructor
+    RequestVerdict admit(uint32_t address, uint32_t route, unsigned long now); //admits a request, or tells why it is refused. An admitted request must be released when it is done.
+    void release(); //releases an admitted request (called when its connection closes)
+    void recordCost(uint32_t route, uint32_t micros, unsigned long now); //records the time the handler of an admitted request took, and sheds its route if it keeps going over budget
+    uint32_t getRetryAfter(uint32_t route, unsigned long now); //returns the seconds until a shed route is served again (at least 1)
+    static uint32_t routeOf(uint32_t method, const char* url); //returns the hash a route is tracked by
+    uint8_t getInFlight(); //returns the number of requests being served
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "SerialTelemetry.h"
+
+SerialTelemetry::SerialTelemetry(HardwareSerial* serial){
+    this->_serial = serial;
+    this->_sequence = 0;
+    this->_recordsSent = 0;
+    this->_recordsDropped = 0;
+}
+
+//called from the audio loop after every frame
+void SerialTelemetry::publish(const float* levels, const uint8_t* peaks, uint8_t noOfBands, uint8_t noOfRows, const uint32_t* stageMicros, uint32_t fftMicros, uint32_t streamDropped){
+    TelemetryRecord* record = &this->_record;
+    noOfBands = min(noOfBands, (uint8_t)TELEMETRY_MAX_BANDS);
+
+    record->type = TELEMETRY_TYPE_FRAME;
+    record->version = TELEMETRY_VERSION;
+    record->noOfBands = noOfBands;
+    record->noOfRows = noOfRows;
+    record->sequence = this->_sequence++;
+    record->timestamp = millis();
+    memcpy(record->stageMicros, stageMicros, sizeof(record->stageMicros));
+    record->fftMicros = fftMicros;
+    record->recordsDropped = this->_recordsDropped;
+    record->streamDropped = streamDropped;
+
+    for (uint8_t i = 0; i < noOfBands; i++) {
+      record->data[i] = constrain(levels[i], 0.0f, 1.0f) * 255;
+      record->data[noOfBands + i] = peaks[i];
+    }
+
+    //the CRC goes right after the bands, so only the used part of the record is encoded
+    size_t length = TELEMETRY_HEADER_SIZE + (noOfBands * 2);
+    uint16_t crc = crc16((uint8_t*)record, length);
+    record->data[noOfBands * 2] = crc & 0xFF;
+    record->data[noOfBands * 2 + 1] = crc >> 8;
+    length += 2;
+
+    this->_encoded[0] = 0;
+    size_t encodedLength = 1 + cobsEncode((uint8_t*)record, length, &this->_encoded[1]);
+    this->_encoded[encodedLength++] = 0;
+
+    //write the whole record or nothing: waiting for the UART would hold up the display
+    if(this->_serial->availableForWrite() < (int)encodedLength){
+      this->_recordsDropped++;
+      return;
+    }
+
+    this->_serial->write(this->_encoded, encodedLength);
+    this->_recordsSent++;
+}
+
+uint32_t SerialTelemetry::getRecordsSent(){
+    return this->_recordsSent;
+}
+
+uint32_t SerialTelemetry::getRecordsDropped(){
+    return this->_recordsDropped;
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+//bitwise CRC-16/CCITT-FALSE. Records are a few hundred bytes at most, so no lookup table is needed.
+uint16_t SerialTelemetry::crc16(const uint8_t* data, size_t length){
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < length; i++) {
+      crc ^= (uint16_t)data[i] << 8;
+      for (uint8_t bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+      }
+    }
+
+    return crc;
+}
+
+//consistent overhead byte stuffing: removes every 0 byte from the data, so 0 can delimit the records
+size_t SerialTelemetry::cobsEncode(const uint8_t* data, size_t length, uint8_t* encoded){
+    size_t codeIndex = 0; //position of the code byte of the current block
+    size_t encodedLength = 1;
+    uint8_t code = 1; //length of the current block plus one
+
+    for (size_t i = 0; i < length; i++) {
+      if(data[i] == 0){
+        encoded[codeIndex] = code;
+        codeIndex = encodedLength++;
+        code = 1;
+        continue;
+      }
+
+      encoded[encodedLength++] = data[i];
+      code++;
+
+      if(code == 0xFF){ //block full
+        encoded[codeIndex] = code;
+        codeIndex = encodedLength++;
+        code = 1;
+      }
+    }
+
+    encoded[codeIndex] = code;
+    return encodedLength;
+}
@@ -0,0 +1,49 @@
+#ifndef SerialTelemetry_h
+#define SerialTelemetry_h
+
+#include "Common.h"
+#include "LatencyTracer.h"
+
+#define TELEMETRY_TYPE_FRAME 1 //record type of a frame record
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_MAX_BANDS 64 //maximum number of bands a record can carry
+
+//telemetry record of one frame (all fields little endian). Only the fixed fields, 2 x noOfBands bytes of data and the CRC are sent.
+//on the wire, every record is followed by a CRC-16/CCITT-FALSE, COBS encoded and delimited by 0 bytes on both sides,
+//so text printed to the same serial port between records is skipped by the decoder.
+struct TelemetryRecord{
+  uint8_t type; //TELEMETRY_TYPE_FRAME
+  uint8_t version;
+  uint8_t noOfBands; //number of bands in the record
+  uint8_t noOfRows; //number of rows of the matrix (peak rows are relative to it)
+  uint32_t sequence; //incremented for every frame (including the dropped ones), so the decoder can count them
+  uint32_t timestamp; //ms since boot
+  uint32_t stageMicros[NUM_LATENCY_STAGES]; //latency of each pipeline stage for this frame (us)
+  uint32_t fftMicros; //time it took to compute the FFT (us)
+  uint32_t recordsDropped; //number of records dropped because the serial port could not keep up
+  uint32_t streamDropped; //number of frames the UDP streamer dropped
+  uint8_t data[TELEMETRY_MAX_BANDS * 2 + 2]; //band levels (0-255) followed by peak rows and the CRC
+};
+
+#define TELEMETRY_HEADER_SIZE offsetof(TelemetryRecord, data)
+#define TELEMETRY_MAX_ENCODED (sizeof(TelemetryRecord) + sizeof(TelemetryRecord) / 254 + 1 + 2) //record, COBS overhead and both delimiters
+
+class SerialTelemetry {
+  private:
+    HardwareSerial* _serial; //serial port the records are written to
+    TelemetryRecord _record; //record being encoded
+    uint8_t _encoded[TELEMETRY_MAX_ENCODED]; //encoded record
+    uint32_t _sequence; //sequence number of the next record
+    volatile uint32_t _recordsSent; //number of records written
+    volatile uint32_t _recordsDropped; //number of records dropped because the serial port could not keep up
+    static uint16_t crc16(const uint8_t* data, size_t length); //calculates the CRC-16/CCITT-FALSE of the data
+    static size_t cobsEncode(const uint8_t* data, size_t length, uint8_t* encoded); //COBS encodes the data and returns the encoded length
+
+  public:
+    SerialTelemetry(HardwareSerial* serial); //constructor. Give the port a TX buffer (setTxBufferSize) before it is started, so records can be queued.
+    void publish(const float* levels, const uint8_t* peaks, uint8_t noOfBands, uint8_t noOfRows, const uint32_t* stageMicros, uint32_t fftMicros, uint32_t streamDropped); //encodes and writes a frame record. Never blocks: the record is dropped if the serial port has no room for it.
+    uint32_t getRecordsSent(); //returns the number of records written
+    uint32_t getRecordsDropped(); //returns the number of records dropped
+};
+
+#endif
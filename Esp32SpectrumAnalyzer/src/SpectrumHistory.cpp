@@ -0,0 +1,96 @@
+#include "SpectrumHistory.h"
+
+SpectrumHistory::SpectrumHistory(uint8_t noOfBands, uint32_t capacity){
+    this->_noOfBands = noOfBands;
+    this->_frameSize = sizeof(uint32_t) + noOfBands;
+    this->_capacity = max(capacity, (uint32_t)1);
+    this->_frames = new uint8_t[this->_capacity * this->_frameSize] {0};
+    this->_written.store(0);
+}
+
+void SpectrumHistory::record(const float* levels){
+    uint32_t frame = this->_written.load(std::memory_order_relaxed);
+    uint8_t* slot = &this->_frames[(frame % this->_capacity) * this->_frameSize];
+    uint32_t timestamp = millis();
+
+    memcpy(slot, &timestamp, sizeof(timestamp));
+    for (uint8_t i = 0; i < this->_noOfBands; i++) {
+      slot[sizeof(timestamp) + i] = constrain(levels[i], 0.0f, 1.0f) * 255;
+    }
+
+    this->_written.store(frame + 1, std::memory_order_release);
+}
+
+uint32_t SpectrumHistory::getCapacity(){
+    return this->_capacity;
+}
+
+HistoryDownload SpectrumHistory::startDownload(){
+    HistoryDownload download;
+    uint32_t written = this->_written.load(std::memory_order_acquire);
+    uint32_t margin = min((uint32_t)HISTORY_MARGIN_FRAMES, this->_capacity / 4);
+
+    download.count = min(written, this->_capacity - margin);
+    download.first = written - download.count;
+    download.timestamp = millis();
+
+    return download;
+}
+
+size_t SpectrumHistory::getDownloadLength(const HistoryDownload& download){
+    return sizeof(HistoryHeader) + (download.count * this->_frameSize);
+}
+
+//called from the async TCP task for every part of the response, with index the position in the download
+size_t SpectrumHistory::readDownload(HistoryDownload& download, uint8_t* buffer, size_t maxLen, size_t index){
+    size_t length = min(maxLen, this->getDownloadLength(download) - index);
+    size_t copied = 0;
+
+    //header
+    if(index < sizeof(HistoryHeader)){
+      HistoryHeader header = {HISTORY_MAGIC, HISTORY_VERSION, this->_noOfBands, this->_frameSize, download.count, download.timestamp};
+      copied = min(length, sizeof(HistoryHeader) - index);
+      memcpy(buffer, (uint8_t*)&header + index, copied);
+    }
+
+    //frames, whole where they fit. A frame split over two parts of the response is copied aside when its first part is sent.
+    while (copied < length) {
+      size_t position = index + copied - sizeof(HistoryHeader);
+      uint32_t frame = download.first + (position / this->_frameSize);
+      size_t offset = position % this->_frameSize;
+      size_t bytes = min(length - copied, this->_frameSize - offset);
+
+      if(bytes == this->_frameSize){
+        this->copyFrame(frame, &buffer[copied]);
+      }else{
+        if(offset == 0){
+          this->copyFrame(frame, download.splitFrame);
+        }
+        memcpy(&buffer[copied], &download.splitFrame[offset], bytes);
+      }
+
+      copied += bytes;
+    }
+
+    return copied;
+}
+
+
+//PRIVATE MEMBER DEFINITIONS
+//the audio loop writes frame n into the slot of frame n - capacity, so that frame is gone as soon as frame n is being written
+bool SpectrumHistory::isOverwritten(uint32_t frame){
+    return this->_written.load(std::memory_order_acquire) - frame >= this->_capacity;
+}
+
+//frames that fell out of the ring during the download are sent with an invalid timestamp and no levels.
+//the ring is checked again after copying, as the audio loop may have overwritten the frame in the meantime.
+void SpectrumHistory::copyFrame(uint32_t frame, uint8_t* buffer){
+    if(!this->isOverwritten(frame)){
+      memcpy(buffer, &this->_frames[(frame % this->_capacity) * this->_frameSize], this->_frameSize);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire); //the copy has to be done before the ring is checked again
+    if(this->isOverwritten(frame)){
+      memset(buffer, 0xFF, this->_frameSize);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef SpectrumHistory_h
+#define SpectrumHistory_h
+
+#include "Common.h"
+
+#define HISTORY_MAGIC 0x48444153 //"SADH"
+#define HISTORY_VERSION 1
+#define HISTORY_MARGIN_FRAMES 43 //about a second of the oldest frames is left out of a download, so a slow download does not race the audio loop
+#define HISTORY_INVALID_TIMESTAMP 0xFFFFFFFF //timestamp of frames overwritten before they could be downloaded
+
+//header of a history download (all fields little endian). It is followed by frameCount frames, oldest first,
+//each made of a timestamp (uint32, ms since boot) and the level of every band (uint8, 0-255).
+struct HistoryHeader{
+  uint32_t magic;
+  uint8_t version;
+  uint8_t noOfBands; //number of bands in each frame
+  uint16_t frameSize; //size of each frame in bytes
+  uint32_t frameCount; //number of frames in the download
+  uint32_t timestamp; //ms since boot when the download started
+};
+
+#define HISTORY_MAX_FRAME_SIZE (sizeof(uint32_t) + 255) //size of a frame with the maximum number of bands
+
+//frames taken for a download
+struct HistoryDownload{
+  uint32_t first; //index of the first frame (counted since boot)
+  uint32_t count; //number of frames
+  uint32_t timestamp; //ms since boot when the download started
+  uint8_t splitFrame[HISTORY_MAX_FRAME_SIZE]; //copy of a frame that is split over two parts of the response, so both parts come from the same frame
+};
+
+//ring of the most recent frames. Written by the audio loop without locking, and read by any number of downloads at the same time.
+class SpectrumHistory {
+  private:
+    uint8_t _noOfBands; //number of bands in each frame
+    uint16_t _frameSize; //size of each frame in bytes
+    uint32_t _capacity; //number of frames the ring holds
+    uint8_t* _frames; //the ring
+    std::atomic<uint32_t> _written; //number of frames written since boot. Frame i lives in slot i % capacity until frame i + capacity overwrites it.
+    bool isOverwritten(uint32_t frame); //returns true if the audio loop has started overwriting a frame
+    void copyFrame(uint32_t frame, uint8_t* buffer); //copies a whole frame, or marks it invalid if it has been overwritten
+
+  public:
+    SpectrumHistory(uint8_t noOfBands, uint32_t capacity); //constructor. Takes capacity x (4 + noOfBands) bytes.
+    void record(const float* levels); //adds a frame of levels (0.0 - 1.0). Called from the audio loop.
+    uint32_t getCapacity(); //returns the number of frames the ring holds
+    HistoryDownload startDownload(); //takes the frames currently in the ring for a download
+    size_t getDownloadLength(const HistoryDownload& download); //returns the size of a download in bytes
+    size_t readDownload(HistoryDownload& download, uint8_t* buffer, size_t maxLen, size_t index); //copies the bytes of a download starting at index straight from the ring. Returns the number of bytes copied.
+};
+
+#endif
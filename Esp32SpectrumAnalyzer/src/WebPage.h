@@ -1,524 +1,217 @@
-#include "Common.h"
-
-//web page for the spectrum analyzer display.
-//if you want to edit this, you can use the index.html page included in the source code and copy it to this variable.
-char g_webPage[] PROGMEM = R"=====( 
-
-<!DOCTYPE html>
-<html lang="en">
-<head>
-    <meta charset="UTF-8">
-    <meta http-equiv="X-UA-Compatible" content="IE=Edge">
-    <meta name="viewport" content="width=device-width, initial-scale=1">
-    <title>Spectrum Analyzer Display</title>
-      
-    <script src="https://code.jquery.com/jquery-3.7.1.min.js" integrity="sha256-/JqT3SQfawRcv/BIHPThkBvs0OEvtFFmqPF/lYI/Cxo=" crossorigin="anonymous"></script>
-    
-    <style>
-        h1{
-            font-family: Arial, Helvetica, sans-serif;
-        }
-
-        label{
-            font-family: 'Courier New', Courier, monospace;
-        }
-
-        body{
-            background-color: rgb(17, 18, 19);
-            color:aliceblue;
-        }
-
-        .error{
-            color: lightsalmon;
-        }
-
-        .container{
-            margin:30px;
-        }
-
-        .rowColor{
-            cursor: pointer;
-        }
-
-        .colColor{
-            cursor: pointer;
-        }
-
-        .gradientTop{
-            cursor: pointer;
-        }
-
-        .gradientBottom{
-            cursor: pointer;
-        }
-
-        .pixelWrapper {
-          width: 30px;
-          height: 30px;
-          overflow: hidden;
-          border-radius: 50%;
-          cursor: pointer;
-        }
-
-        .pixelWrapperMargin {
-          margin-right: auto;
-          margin-left: auto;
-        }
-    
-        .pixel {
-          width: 100px;
-          height: 100px;
-          top: 50%;
-          left: 50%;
-          transform: translate(-50%, -50%);
-          overflow: hidden;
-          border: none;
-          cursor: pointer;
-        }
-
-        .slider{
-            width: 50%;
-        }
-
-        td{
-            padding-right: 25px;
-            padding-bottom: 15px;
-            margin-left: auto;
-            margin-right: auto;
-        }
-
-        #btnDeploy{
-            width: 150px;
-            height: 70px;
-            background-color: rgb(3, 99, 141);
-            font-weight: bolder;
-            color: aliceblue;
-            cursor: pointer;
-            
-        }
-
-        #globalColor{
-            width: 100%;
-            cursor: pointer;
-        }
-
-      </style>
-</head>
-<body>
-    <h1>Spectrum Analyzer Display</h1>
-
-    <hr>
-    <div id="colorPickerContainer"></div>
-    <div class="container hidden" id="container">
-        <label>Peak wait (millisecs)</label>
-        <div>
-            <input class="slider" type="range" min="1" max="50000" step="10" value="1500" id="sldPeakDelay" oninput="peakDelayChanged();">
-            <span id="spanPeakDelay"></span>
-        </div>
-        <br/><br/>
-    
-        <label>Peak falldown (millisecs)</label>
-        <div>
-            <input class="slider" type="range" min="1" max="250" step="1" value="25" id="sldPeakSpeed" oninput="peakSpeedChanged();"> 
-            <span id="spanPeakSpeed"></span>
-        </div>
-        <br/><br/>
-
-        <label>Speed filter</label>
-        <div>
-            <input class="slider" type="range" min="0" max="200" step="1" value="1" id="sldSpeedFilter" oninput="speedFilterChanged();">
-            <span id="spanSpeedFilter"></span>
-        </div>
-        <br/><br/>
-
-        <label>Brightness</label>
-        <div>
-            <input class="slider" type="range" min="0" max="100" step="1" value="20" id="sldBrightness" oninput="brightnessChanged();">
-            <span id="spanBrightness"></span>
-        </div>
-        <br/><br/>
-
-        <label>Level Attenuation</label>
-        <div>
-            <input class="slider" type="range" min="10000" max="500000" step="1000" value="20" id="sldAttenuation" oninput="attenuationChanged();">
-            <span id="spanAttenuation"></span>
-        </div>
-        <br/><br/>
-
-
-        <label>Peak color</label>
-        <div class="pixelWrapper">
-          <input id="peakPixel" class="pixel" type="color" value="#ffffff"/>
-        </div>
-    
-        <br/><br/>
-        
-        <label>Matrix color</label>
-        <table id="tblMatrix">
-          <tbody>
-            
-          </tbody>
-        </table>
-    
-        <br/><br/>
-        
-        <button id="btnDeploy" onclick="deploy();">Deploy</button>    
-    </div>
-          
-    <script>
-        const _baseUrl = 'http://10.0.0.64'; //window.location.origin;  
-        const _localStorageConfigKey = 'state';
-        var _noOfRows = 0;  
-        var _noOfCols = 0;  
-
-        $(document).ready(function(){
-            get("/config", function(res){ //get fom server.
-                if(res.status === 'success'){
-                    buildUI(res.response);
-                }else{
-                    $('#container').html('<span class="error">Unable to reach Spectrum Analyzer Server APIs!</span>');
-                }                
-            });
-        });
-
-
-        function buildUI(data){
-            _noOfCols = data.noOfCols;
-            _noOfRows = data.noOfRows;
-
-            buildMatrix();
-            
-            //if local config exists, retrieve it and update local UI as well as the server
-            try{
-                const state = localStorage.getItem(_localStorageConfigKey);
-                const objState = JSON.parse(state);
-                updateUI(objState);      
-                deploy();  //deploy to server
-            }catch (error){ //if unable to retrieve/parse local state object, use the values from the server and then sync with server.
-                updateUI(data);
-                deploy();
-            }
-        }
-        
-        function updateUI(objState){
-            //set peak delay
-            $('#sldPeakDelay').val(objState.peakDelay);
-            peakDelayChanged();
-
-            //set peak speed
-            $('#sldPeakSpeed').val(objState.peakSpeed);
-            peakSpeedChanged();
-            
-            //set speed filter
-            $('#sldSpeedFilter').val(objState.speedFilter * 1000);
-            speedFilterChanged();
-
-            //set brightness
-            $('#sldBrightness').val(objState.brightness);
-            brightnessChanged();
-
-            //set attenuation
-            $('#sldAttenuation').val(invertAttenuationValue(objState.atten));
-            attenuationChanged()
-            
-            //set peak pixel
-            $('#peakPixel').val(RGBjsonToString(JSON.stringify(objState.peak)));
-
-            //set matrix pixels
-            for (let i = 0; i < objState.pixels.length; i++) {
-                let displayPixel = $(`#tblMatrix tbody tr td div input[data-idx=${i}].pixel`); 
-                let clr = RGBjsonToString(JSON.stringify(objState.pixels[i]));
-                //console.log(clr);
-                $(displayPixel).val(clr);
-            }
-        }
-
-        function speedFilterChanged(){
-            let speedFilter = $('#sldSpeedFilter').val() / 1000;
-             $('#spanSpeedFilter').html(speedFilter);
-        }
-
-        function peakDelayChanged(){
-            $('#spanPeakDelay').html($('#sldPeakDelay').val());
-        }
-            
-        function peakSpeedChanged(){
-            $('#spanPeakSpeed').html($('#sldPeakSpeed').val());
-        }
-
-        function brightnessChanged(){
-            $('#spanBrightness').html($('#sldBrightness').val());
-        }
-
-        function attenuationChanged(){
-            let attenVal = parseInt($('#sldAttenuation').val());
-            $('#spanAttenuation').html(invertAttenuationValue(attenVal));
-        }
+//web page for the spectrum analyzer display, minified and gzip compressed.
+//generated from index.html by tools/build_webpage.py before every build. Edit index.html instead of this file.
+#ifndef WebPage_h
+#define WebPage_h
 
-        function invertAttenuationValue(value){
-            let attenMin = parseInt($('#sldAttenuation').attr('min'));
-            let attenMax = parseInt($('#sldAttenuation').attr('max'));
-            return invertValue(attenMin, attenMax, value); 
-        }
-
-        function globalColorChanged(ctl){
-            let selectedColor = $(ctl).val();
-            const allPixels = $(`#tblMatrix tbody tr td div input.pixel`); 
-            for (let i = 0; i < allPixels.length; i++) {
-                $(allPixels[i]).val(selectedColor);
-            }            
-        }
-
-        function colColorChanged(ctl){
-            let selectedColor = $(ctl).val();
-            let x = $(ctl).attr("data-x");
-            let colPixels = $(`#tblMatrix tbody tr td div input[data-x=${x}].pixel`); 
-
-            for (let y = 0; y < colPixels.length; y++) {
-                $(colPixels[y]).val(selectedColor);//update locally
-            }
-        }
-
-        function rowColorChanged(ctl){
-            let selectedColor = $(ctl).val();
-            let y = $(ctl).attr("data-y");
-            let rowPixels = $(ctl).closest('tr').find('input.pixel');
-            
-            for (let x = 0; x < rowPixels.length; x++) {
-                $(rowPixels[x]).val(selectedColor);//update locally
-            }
-        }
-
-
-        function gradientChanged(ctl){
-            let topColor =  $('#gradientTop').val();
-            let bottomColor = $('#gradientBottom').val();
-
-            let gradient = generateGradient(topColor, bottomColor, _noOfRows); //generate gradient colors
-
-            for (let x = 0; x < _noOfCols; x++) {
-                let colPixels = $(`#tblMatrix tbody tr td div input[data-x=${x}].pixel`); 
-
-                for (let y = 0; y < _noOfRows; y++) {
-                    let pixel = $(`#tblMatrix tbody tr td div input[data-x=${x}][data-y=${y}].pixel`); 
-                    $(pixel).val(gradient[y]);
-                }
-            }
-        }
-
-
-        function generateGradient(startColor, endColor, steps) {
-            const startRgb = hexToRgb(startColor);
-            const endRgb = hexToRgb(endColor);
-
-            const gradient = [];
-
-            for (let i = 0; i < steps; i++) {
-                const t = i / (steps - 1); // Interpolation factor
-                const r = Math.round(startRgb.r + t * (endRgb.r - startRgb.r));
-                const g = Math.round(startRgb.g + t * (endRgb.g - startRgb.g));
-                const b = Math.round(startRgb.b + t * (endRgb.b - startRgb.b));
-                gradient.push(rgbToHex(r, g, b));
-            }
-
-            return gradient;
-        }
-
-        function hexToRgb(hex) {
-            // Convert HEX to RGB
-            const bigint = parseInt(hex.slice(1), 16);
-            return {
-                r: (bigint >> 16) & 255,
-                g: (bigint >> 8) & 255,
-                b: bigint & 255
-            };
-        }
-
-        function rgbToHex(r, g, b) {
-            // Convert RGB to HEX
-            return `#${((1 << 24) + (r << 16) + (g << 8) + b).toString(16).slice(1).toUpperCase()}`;
-        }
-        
-
-        function post(path, json, cb){
-            $.ajax({
-                type: 'post',
-                url: _baseUrl + path + "?data=" + json,
-                contentType: "x-www-form-urlencoded",
-                success: function(res){
-                    cb({status: 'success', response: res});
-                },
-                error: function(err){
-                    cb({status: 'fail', response: err});
-                }
-            });
-        }    
-        
-        function get(path, cb){
-            $.ajax({
-                type: 'get',
-                url: _baseUrl + path,
-                success: function(res){
-                    cb({status: 'success', response: res});
-                },
-                error: function(err){
-                    cb({status: 'fail', response: res});                    
-                }
-            });
-
-        }    
-        
-        function RGBstringToJson(colorString) { //#ffffff to {"r": 255, "g": 255, "b": 255}
-          const r = parseInt(colorString.substr(1, 2), 16)
-          const g = parseInt(colorString.substr(3, 2), 16)
-          const b = parseInt(colorString.substr(5, 2), 16)
-          
-          return `{"r":${r}, "g":${g}, "b":${b}}`;
-        }
-
-
-        function RGBjsonToString(colorJson) { // {"r": 255, "g": 255, "b": 255} to #ffffff to
-            let objColor = JSON.parse(colorJson);    
-            let r = '';
-            let g = '';
-            let b = '';
-
-            r = objColor.r < 16 ? '0' + objColor.r.toString(16) : objColor.r.toString(16);
-            g = objColor.g < 16 ? '0' + objColor.g.toString(16) : objColor.g.toString(16);
-            b = objColor.b < 16 ? '0' + objColor.b.toString(16) : objColor.b.toString(16);
-            
-            const colorString = "#" +  r + "" + g + "" + b;  
-            return colorString;
-        }
-
-        function buildMatrix(){
-            //build global color picker
-            let row = '<tr>';
-            row+='<td></td>';
-            row+=`<td colspan="${_noOfCols}">`;
-            row+='<input id="globalColor" type="color" value="#ffffff" onchange="globalColorChanged(this);"/>';
-            row+='</td>';
-            row+='</tr>';
-            $('#tblMatrix tbody').append(row);
-
-            //build row color pickers (at the top)
-            row = '<tr>';
-            for(let x=0;x<_noOfCols+1;x++){ //build col color pickers
-                row+='<td>';
-                
-                if(x>0){ 
-                    let xx = x-1;
-                    row+='<div>';
-                    row+='<input id="colColor_' + xx + '" class="colColor" type="color" value="#ffffff" data-x="' + xx + '" onchange="colColorChanged(this);"/>';
-                    row+='</div>'
-                }
-                
-                row+='</td>';
-            }
-            row+='</tr>';
-            $('#tblMatrix tbody').append(row);
-
-
-            for(let y=0;y<_noOfRows;y++){
-                //build row color pickers (left side)
-                row = '<tr>';
-                row+='<td>';
-                row+='<div>';
-                row+='<input id="rowColor_' + y + '" class="rowColor" type="color" value="#ffffff" data-y="' + y + '" onchange="rowColorChanged(this);"/>';
-                row+='</div>'
-                row+='</td>';
-                
-                //build matrix pixel color pickers.
-                for(let x=0;x<_noOfCols;x++){
-                    let r = (_noOfRows-1)-y;
-                    let idx = x * _noOfRows + r;
-                    row+='<td>';
-                    row+='<div class="pixelWrapper pixelWrapperMargin">';
-                    row+='<input id="matrixPixel_' + idx + '" class="pixel" type="color" value="#000000" data-x="' + x + '" data-y="' + y + '" data-idx="' + idx + '"/>';
-                    row+='</div>'
-                    row+='</td>';
-                }
-                
-                //build top gradient
-                if(y==0){
-                    row+='<td rowspan="18" class="gradientCell">';
-                    row+='<div>';
-                    row+='<input id="gradientTop" class="gradientTop" type="color" value="#ffffff" onchange="gradientChanged(this);"/>';
-                    row+='</div>'
-                    row+='<div>';
-                    row+='<input id="gradientBottom" class="gradientBottom" type="color" value="#ffffff" onchange="gradientChanged(this);"/>';
-                    row+='</div>'
-                    row+='</td>';
-                }
-
-                row+='</tr>';
-                $('#tblMatrix tbody').append(row);
-            }
-
-            $('#gradientTop').css('height', $('#gradientTop').parent('div').parent('td').height());
-            $('#gradientBottom').css('height', $('#gradientBottom').parent('div').parent('td').height());
-            
-        }
-
-        function deploy(){            
-            let state = buildState();
-            const payload = JSON.stringify(state);
-
-            localStorage.setItem(_localStorageConfigKey, payload);
-            
-            post("/deploy", payload, function(res){ //update server.
-                //success
-                localStorage.setItem(_localStorageConfigKey, payload); //update local storage
-                updateUI(state);
-            });
-        }
-
-
-        function buildState(){
-            let state = {
-                peakDelay: 125,
-                peakSpeed: 25,
-                speedFilter: 0.7,
-                peak: {},
-                pixels: [],
-            };
-
-            //set properties
-            state.peakDelay =  parseInt($('#sldPeakDelay').val());
-            state.peakSpeed =  parseInt($('#sldPeakSpeed').val());
-            state.speedFilter  = $('#sldSpeedFilter').val() / 1000;
-            state.brightness  = $('#sldBrightness').val();
-            state.atten =  invertAttenuationValue(parseInt($('#sldAttenuation').val()));
-            state.peak = JSON.parse(RGBstringToJson($('#peakPixel').val()));
-
-            //populate matrix pixel data.
-            const allPixels = $(`#tblMatrix tbody tr td div input.pixel`); 
-            for (let i = 0; i < allPixels.length; i++) {
-                const pixel = allPixels[i];
-                const jsonColor = RGBstringToJson($(pixel).val());
-                const objColor = JSON.parse(jsonColor);
-                const idx = parseInt($(pixel).attr('data-idx'));    
-                const x = parseInt($(pixel).attr('data-x'));
-                const y = parseInt($(pixel).attr('data-y'));
-                
-                state.pixels.push({
-                    x: x,
-                    y: y,
-                    i: idx,
-                    r: objColor.r,
-                    g: objColor.g,
-                    b: objColor.b
-                });
-            }            
-            state.pixels.sort((a,b) => a.i < b.i ? -1 : 1); //sort in the order of index.
-            return state;
-        }
-
-        function invertValue(min, max, value){
-            return (min + max) - value;
-        }
-    </script>
-</body>
-</html>
+#include "Common.h"
 
-)=====";  //do not remove this line
\ No newline at end of file
+#define WEB_PAGE_ETAG "\"90b0699f5c11352c\"" //strong ETag of the compressed page
+
+const size_t g_webPageLength = 4051; //compressed size (20538 bytes uncompressed, 12966 bytes minified)
+const uint8_t g_webPage[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb5, 0x1b, 0x6b, 0x73, 0xdb, 0x36, 0xf2, 0xbb, 0x7e, 0x05,
+  0xc2, 0xe4, 0x4a, 0xb2, 0xd6, 0xd3, 0xa9, 0xdb, 0x54, 0x96, 0x9c, 0x49, 0x9c, 0xa4, 0x49, 0x2f, 0x89, 0x3d, 0xb5, 0x73,
+  0xbd, 0x9b, 0x4c, 0xa6, 0xe6, 0x03, 0x92, 0x90, 0x50, 0x04, 0x8f, 0x84, 0x6c, 0xa9, 0xaa, 0xfe, 0xfb, 0xed, 0x02, 0x04,
+  0x09, 0x52, 0x94, 0xe4, 0xa6, 0xbd, 0x76, 0x6a, 0x41, 0x00, 0x76, 0xb1, 0xbb, 0xd8, 0x5d, 0xec, 0x43, 0x1d, 0x3d, 0x78,
+  0x71, 0x71, 0x7e, 0xfd, 0x9f, 0xcb, 0x97, 0x64, 0x26, 0xe6, 0xd1, 0x59, 0x6b, 0x84, 0x1f, 0x24, 0xf2, 0xe2, 0xe9, 0xd8,
+  0xa2, 0xb1, 0x85, 0x13, 0xd4, 0x0b, 0xe1, 0x63, 0x4e, 0x85, 0x47, 0x82, 0x99, 0x97, 0x66, 0x54, 0x8c, 0xad, 0x0f, 0xd7,
+  0xaf, 0x3a, 0x4f, 0x2c, 0x3d, 0x3d, 0x13, 0x22, 0xe9, 0xd0, 0xff, 0x2e, 0xd8, 0xed, 0xd8, 0xfa, 0x77, 0xe7, 0xc3, 0xb3,
+  0xce, 0x39, 0x9f, 0x27, 0x9e, 0x60, 0x7e, 0x44, 0x2d, 0x12, 0xf0, 0x58, 0xd0, 0x18, 0x60, 0xde, 0xbc, 0x1c, 0xbf, 0x0c,
+  0xa7, 0xb4, 0x80, 0x8a, 0xbd, 0x39, 0x1d, 0x5b, 0xb7, 0x8c, 0xde, 0x25, 0x3c, 0x15, 0xc6, 0xc6, 0x3b, 0x16, 0x8a, 0xd9,
+  0x38, 0xa4, 0xb7, 0x2c, 0xa0, 0x1d, 0xf9, 0xa5, 0x4d, 0x58, 0xcc, 0x04, 0xf3, 0xa2, 0x4e, 0x16, 0x78, 0x11, 0x1d, 0x0f,
+  0x10, 0x89, 0x60, 0x22, 0xa2, 0x67, 0x57, 0x09, 0x0d, 0x44, 0xba, 0x98, 0x93, 0x67, 0xb1, 0x17, 0xad, 0x7e, 0xa7, 0x29,
+  0x79, 0xc1, 0xb2, 0x24, 0xf2, 0x56, 0xa3, 0x9e, 0xda, 0xd0, 0x1a, 0x65, 0x62, 0x85, 0x9f, 0xb3, 0xc1, 0xba, 0x35, 0x81,
+  0x33, 0x3a, 0x13, 0x6f, 0xce, 0xa2, 0xd5, 0x90, 0x3c, 0x4b, 0x01, 0x63, 0x9b, 0xbc, 0xa6, 0xd1, 0x2d, 0x15, 0x2c, 0xf0,
+  0xda, 0x24, 0xf3, 0xe2, 0xac, 0x93, 0xd1, 0x94, 0x4d, 0x4e, 0x5b, 0x9b, 0x56, 0xe4, 0xf9, 0x34, 0xaa, 0xc1, 0xd8, 0xe7,
+  0x7c, 0x91, 0x32, 0x38, 0xe5, 0x3d, 0xbd, 0xb3, 0xdb, 0x24, 0xff, 0xd6, 0x26, 0x73, 0x1e, 0xf3, 0x2c, 0xf1, 0x02, 0x8a,
+  0x80, 0x3e, 0x0f, 0x57, 0xeb, 0x96, 0xef, 0x05, 0x5f, 0xa6, 0x29, 0x5f, 0xc4, 0x61, 0x27, 0xe0, 0x11, 0x4f, 0x87, 0x24,
+  0x9d, 0xfa, 0xce, 0xe0, 0x87, 0x36, 0x19, 0x3c, 0x81, 0xff, 0x7e, 0x74, 0x4f, 0x5b, 0x6a, 0xde, 0x8b, 0x80, 0x51, 0x3f,
+  0x5a, 0x48, 0xd8, 0x2e, 0x4d, 0x53, 0x9e, 0xae, 0xf3, 0x25, 0x12, 0xb1, 0xe9, 0x4c, 0x64, 0x5e, 0x04, 0xf8, 0xe5, 0x2a,
+  0x0a, 0xc9, 0x63, 0x31, 0x85, 0x1d, 0x73, 0x2f, 0x9d, 0xb2, 0x78, 0xf8, 0xb8, 0x9f, 0x2c, 0xe5, 0x52, 0xca, 0xef, 0xce,
+  0x11, 0x08, 0x60, 0x17, 0x69, 0x86, 0xc0, 0x09, 0x67, 0x20, 0xd2, 0x34, 0x07, 0x8c, 0xf6, 0xac, 0x4e, 0x53, 0x2f, 0x64,
+  0x20, 0xfc, 0x6b, 0x9e, 0xec, 0xdf, 0xf0, 0x9c, 0x0b, 0xc1, 0xe7, 0xcd, 0x7b, 0x12, 0xb6, 0xa4, 0xd1, 0xaf, 0xa9, 0x97,
+  0x24, 0x20, 0x9f, 0x75, 0x4b, 0xde, 0xdc, 0x90, 0x28, 0xfa, 0x66, 0x14, 0x19, 0xd1, 0xdf, 0xf8, 0x2d, 0x4d, 0x27, 0x11,
+  0xbf, 0x1b, 0x92, 0x19, 0x0b, 0x43, 0x0a, 0xac, 0xf9, 0x3c, 0x0d, 0x69, 0xda, 0xc1, 0x53, 0x16, 0xd9, 0x90, 0x9c, 0xf4,
+  0xff, 0x71, 0x7a, 0xf0, 0x8c, 0x77, 0x52, 0x00, 0x44, 0x4b, 0xa2, 0x93, 0xaa, 0x23, 0xbc, 0x85, 0xe0, 0xa7, 0x7a, 0x2e,
+  0xa2, 0x93, 0x62, 0x4a, 0x83, 0x97, 0xb4, 0x0d, 0xfa, 0x15, 0xe2, 0xf2, 0xaf, 0x82, 0x27, 0x39, 0x05, 0x0a, 0x5a, 0x0e,
+  0x45, 0x0a, 0xba, 0x31, 0xe1, 0xe9, 0x7c, 0x48, 0xe4, 0x30, 0xf2, 0x04, 0x75, 0x3a, 0xb0, 0xd4, 0x26, 0xf8, 0xd7, 0xdd,
+  0xcd, 0xd4, 0x90, 0xc4, 0x3c, 0xa6, 0xcd, 0xec, 0x64, 0x11, 0x0b, 0xf1, 0x2e, 0x73, 0x7a, 0xe4, 0x49, 0x9b, 0x96, 0x08,
+  0xd7, 0xad, 0xc4, 0x0b, 0x43, 0x16, 0x4f, 0x35, 0x53, 0xc7, 0x27, 0x48, 0x99, 0x9e, 0xf4, 0xe5, 0x2d, 0x00, 0xc1, 0x72,
+  0xb6, 0x81, 0xd5, 0x26, 0x89, 0x6c, 0x5a, 0x0f, 0x7d, 0x11, 0xbf, 0xa0, 0x49, 0xc4, 0x57, 0xa5, 0x04, 0x4e, 0x2a, 0x12,
+  0xf8, 0x41, 0x7e, 0x6b, 0xd6, 0xdc, 0xc7, 0x6d, 0xf2, 0xe3, 0x8f, 0xa0, 0xb8, 0xdf, 0x0d, 0x80, 0x59, 0x69, 0x14, 0x77,
+  0x39, 0x94, 0xcf, 0xa3, 0x10, 0x19, 0xca, 0x37, 0x1b, 0xfa, 0xdc, 0xc0, 0xf3, 0xc3, 0x69, 0xc4, 0x7d, 0x4f, 0x2b, 0x63,
+  0x79, 0x11, 0xcd, 0x17, 0x3e, 0xea, 0xe5, 0xd6, 0x3b, 0xea, 0xe5, 0x8e, 0x08, 0x8d, 0x0b, 0xdd, 0xd2, 0x60, 0x9f, 0xe9,
+  0xc3, 0x2a, 0x6c, 0x49, 0xe1, 0x4f, 0xc8, 0x6e, 0x09, 0x0b, 0xc7, 0x96, 0xa4, 0xed, 0x92, 0x05, 0x5f, 0x68, 0x7a, 0xae,
+  0x6d, 0xc8, 0x3a, 0x1b, 0xf5, 0x60, 0x3d, 0xdf, 0x15, 0x44, 0x5e, 0x96, 0xe1, 0xc6, 0x7c, 0x35, 0xbf, 0x46, 0x2b, 0x07,
+  0x2f, 0x60, 0x5a, 0x23, 0xe9, 0x18, 0xce, 0x2e, 0xa9, 0xf7, 0x85, 0xdc, 0x79, 0x4c, 0x10, 0x07, 0x7c, 0x43, 0xc4, 0x32,
+  0x1a, 0x64, 0xee, 0xa8, 0xa7, 0x16, 0x25, 0x4a, 0xf8, 0xcb, 0xe2, 0x64, 0x21, 0x34, 0x6a, 0x75, 0xdb, 0x16, 0x11, 0xab,
+  0x04, 0x3c, 0x1f, 0x68, 0x11, 0x78, 0x43, 0x32, 0x67, 0xf1, 0xd8, 0x1a, 0xc0, 0xa7, 0xb7, 0x1c, 0x5b, 0x27, 0x7d, 0xf8,
+  0xc7, 0x22, 0x99, 0xa0, 0x09, 0x4c, 0xc2, 0xe8, 0xd6, 0x03, 0x39, 0xc2, 0xf0, 0x04, 0xa7, 0x91, 0x90, 0x2c, 0x0a, 0xf1,
+  0xe0, 0x17, 0x14, 0xf8, 0xb4, 0x08, 0x8f, 0xe5, 0x01, 0x63, 0x2b, 0xd1, 0x73, 0xe7, 0x33, 0x44, 0x1b, 0x3a, 0xee, 0x29,
+  0x52, 0x0a, 0x2e, 0x29, 0x56, 0x60, 0x30, 0x28, 0xe1, 0x80, 0x6f, 0x9c, 0x40, 0xa9, 0x2a, 0x32, 0xfd, 0xb4, 0x77, 0x26,
+  0xff, 0x54, 0x98, 0x9b, 0x78, 0x51, 0x14, 0xf2, 0xbb, 0xf8, 0x6f, 0x64, 0xf0, 0xf8, 0xa4, 0x64, 0xaf, 0xe0, 0xee, 0xf8,
+  0xa4, 0xc2, 0x1b, 0xdc, 0x2b, 0x0d, 0x6b, 0xbc, 0xc9, 0xb9, 0x03, 0xbc, 0x29, 0xb8, 0xc3, 0xbc, 0xc9, 0x7d, 0x64, 0xc2,
+  0x22, 0xd0, 0xb1, 0xaf, 0x64, 0xa7, 0xaf, 0xd9, 0xe9, 0x37, 0xb0, 0x33, 0x28, 0xb8, 0x91, 0x27, 0xbd, 0x92, 0x07, 0x19,
+  0xfc, 0x64, 0xe5, 0xec, 0x1e, 0x8e, 0x4c, 0xd8, 0xc3, 0x3c, 0x3d, 0x97, 0xa6, 0x1e, 0xd3, 0x2c, 0xfb, 0x8b, 0x1c, 0x0d,
+  0x9a, 0x38, 0x3a, 0x2e, 0x95, 0xaf, 0x3c, 0xc8, 0xe0, 0xc8, 0x2f, 0x26, 0xf7, 0x30, 0x64, 0x40, 0x1e, 0xe6, 0xe7, 0x2d,
+  0xbd, 0x05, 0x47, 0xfd, 0x4c, 0x40, 0x44, 0xb0, 0x80, 0x48, 0x82, 0xc7, 0x5f, 0xab, 0x77, 0xca, 0xa0, 0x4a, 0xe3, 0x32,
+  0xac, 0xab, 0xdf, 0x6f, 0x62, 0xd0, 0x38, 0xd3, 0xe0, 0xd0, 0x2b, 0x67, 0xf7, 0xb0, 0x68, 0xc2, 0x1e, 0xe6, 0xf1, 0x55,
+  0x0a, 0x31, 0x13, 0x8d, 0x83, 0x15, 0xf1, 0xbd, 0x38, 0xcc, 0x88, 0xf3, 0xfa, 0xf7, 0x36, 0x59, 0xc8, 0xd7, 0x73, 0x52,
+  0x2c, 0xf1, 0x09, 0xa1, 0x5e, 0x30, 0x93, 0x5b, 0xb6, 0x8c, 0x2f, 0xa3, 0x11, 0xb8, 0x40, 0x75, 0x3c, 0x8d, 0x9e, 0xc3,
+  0x96, 0xcb, 0x94, 0x42, 0x80, 0x86, 0x84, 0xf1, 0x04, 0xc9, 0xd0, 0x0c, 0x06, 0x8b, 0x0c, 0x5e, 0x0c, 0xeb, 0xec, 0x5c,
+  0x7e, 0x8e, 0x7a, 0x6a, 0x75, 0x6b, 0x1b, 0x0f, 0x84, 0x77, 0x0b, 0x21, 0xda, 0x85, 0xfc, 0xdc, 0xb9, 0x4d, 0xcc, 0x58,
+  0x1a, 0x5e, 0xe4, 0x7b, 0xaf, 0xf1, 0x0b, 0xe1, 0xfb, 0x21, 0x22, 0xf0, 0x9d, 0x1e, 0x28, 0xf2, 0x5b, 0xf9, 0x69, 0x6c,
+  0xeb, 0x29, 0x1e, 0x8a, 0x1b, 0x45, 0x5e, 0xc4, 0x52, 0x20, 0x2f, 0x10, 0x5c, 0xc5, 0x42, 0x5f, 0x6a, 0xbc, 0x98, 0xfb,
+  0x78, 0xc5, 0xda, 0x9b, 0x68, 0x5b, 0xeb, 0x5b, 0xbd, 0x26, 0xd8, 0x4c, 0xc3, 0x09, 0xba, 0x04, 0x1c, 0x19, 0xfb, 0x1d,
+  0xc6, 0xdf, 0xab, 0xcd, 0x7b, 0x7d, 0x9e, 0x7c, 0x27, 0x2a, 0x72, 0xd6, 0x4a, 0x66, 0x86, 0x1e, 0x56, 0xe5, 0x4c, 0x74,
+  0x50, 0x97, 0xb8, 0x6a, 0x55, 0xf6, 0x6a, 0x12, 0x24, 0xca, 0x82, 0xe2, 0x87, 0x13, 0xf9, 0xcf, 0x5e, 0x4a, 0xde, 0x79,
+  0x22, 0x65, 0xcb, 0x3a, 0x2d, 0xc2, 0x83, 0x80, 0x5a, 0x31, 0xe9, 0x47, 0x6a, 0x8b, 0x8c, 0x83, 0xf3, 0x17, 0xb1, 0x57,
+  0x0e, 0x70, 0x63, 0x15, 0xaf, 0xbf, 0x80, 0x88, 0x41, 0x29, 0x6a, 0x11, 0x04, 0xa0, 0x7a, 0x07, 0xf0, 0x56, 0x7f, 0x19,
+  0x5b, 0xa1, 0x9c, 0x90, 0x2a, 0xad, 0xd6, 0x46, 0x3d, 0x05, 0xb1, 0x0d, 0x9a, 0x25, 0xef, 0x78, 0x48, 0x0d, 0x58, 0x8a,
+  0x6f, 0x75, 0x3e, 0x9d, 0x63, 0x08, 0x21, 0x9a, 0x16, 0xe0, 0x63, 0x5f, 0x5c, 0x5d, 0x42, 0x64, 0x1c, 0x52, 0x03, 0x5b,
+  0x61, 0x2f, 0x91, 0x1f, 0x69, 0x32, 0x72, 0xa1, 0xc9, 0xc8, 0x77, 0xdb, 0x6e, 0xb2, 0x20, 0x65, 0x09, 0x28, 0x08, 0x3c,
+  0xc1, 0x99, 0x20, 0xbf, 0xf9, 0x5e, 0x46, 0x3f, 0xa4, 0x11, 0x19, 0x93, 0x3b, 0x16, 0xc3, 0xeb, 0xd4, 0x8d, 0x78, 0x20,
+  0x2d, 0xae, 0x9b, 0xa4, 0x5c, 0x70, 0x90, 0x19, 0x19, 0x8f, 0xc7, 0xc4, 0x06, 0xff, 0x4e, 0x87, 0x36, 0x79, 0x4a, 0x6c,
+  0x4c, 0x4f, 0x86, 0xbd, 0xde, 0xa0, 0xdf, 0xc5, 0x7f, 0xbf, 0xff, 0xce, 0x26, 0x10, 0xc7, 0xdb, 0xa7, 0x1a, 0x21, 0xc2,
+  0x47, 0x57, 0x82, 0xa7, 0xde, 0x94, 0x42, 0x68, 0x30, 0x61, 0xd3, 0x7f, 0xd2, 0x15, 0xa0, 0xb7, 0x33, 0x01, 0x4c, 0xc0,
+  0xbe, 0x5b, 0x2f, 0x25, 0xbf, 0xc5, 0xfc, 0x62, 0xf2, 0x0b, 0xbf, 0xcb, 0x60, 0xa1, 0x6f, 0x4c, 0x41, 0x18, 0x93, 0x4f,
+  0x85, 0x3c, 0x58, 0xcc, 0x41, 0x16, 0x5d, 0x88, 0xd1, 0x5e, 0xde, 0xc2, 0xe0, 0x2d, 0x03, 0x47, 0x03, 0x11, 0x83, 0x63,
+  0xbf, 0xb8, 0x78, 0x77, 0xae, 0x92, 0x9b, 0xb7, 0xdc, 0x0b, 0x69, 0x08, 0x89, 0xc3, 0x64, 0x11, 0x07, 0x48, 0xb4, 0xe3,
+  0xae, 0x5b, 0x53, 0x2a, 0x1c, 0xab, 0x17, 0xc8, 0xa3, 0x2d, 0x63, 0x09, 0x4c, 0x19, 0x56, 0xd9, 0x04, 0x07, 0x5d, 0x24,
+  0x66, 0x91, 0x29, 0xd6, 0xb2, 0x45, 0x10, 0x80, 0x1b, 0xb5, 0x61, 0xd5, 0x5f, 0xb0, 0x28, 0xfc, 0xf0, 0x46, 0x6e, 0x81,
+  0xff, 0x12, 0x60, 0x89, 0x42, 0x78, 0xb6, 0xa1, 0x51, 0x46, 0x61, 0x75, 0xf5, 0x26, 0x74, 0xec, 0x22, 0x76, 0xb1, 0xdd,
+  0x2e, 0x8b, 0xe1, 0xf3, 0xf5, 0xf5, 0xbb, 0xb7, 0xc8, 0xa0, 0xba, 0x8c, 0xaa, 0xf4, 0x3f, 0xc4, 0x52, 0xcb, 0x04, 0x27,
+  0xa9, 0xf4, 0x3b, 0xdb, 0x41, 0xd6, 0x15, 0x4d, 0x21, 0xd2, 0x25, 0xcf, 0x2e, 0xdf, 0x64, 0x0f, 0xf2, 0xbb, 0xb2, 0x31,
+  0x54, 0xdb, 0xe0, 0xb9, 0x18, 0x1a, 0xe6, 0xf4, 0x13, 0x79, 0x3a, 0x0b, 0x81, 0xca, 0x94, 0x8a, 0x45, 0x1a, 0x93, 0x42,
+  0x44, 0xc0, 0xf1, 0xcb, 0x88, 0xe2, 0xf0, 0x79, 0xbe, 0x07, 0x11, 0x14, 0x80, 0x73, 0xa9, 0xdb, 0xd2, 0xa2, 0x32, 0x47,
+  0xbd, 0xd3, 0x0d, 0x48, 0xc0, 0x41, 0xa6, 0xab, 0x2b, 0xe9, 0x3d, 0x78, 0xfa, 0x2c, 0x8a, 0x9c, 0x9b, 0x87, 0x85, 0x5d,
+  0x10, 0x69, 0x0b, 0x10, 0xa9, 0x13, 0x11, 0x12, 0x19, 0x02, 0xa2, 0xb1, 0x3e, 0x5a, 0x2b, 0x64, 0xe4, 0x8f, 0x3f, 0x40,
+  0x01, 0x36, 0x2a, 0x1b, 0xb8, 0xa9, 0x9e, 0xad, 0x05, 0x1a, 0x7a, 0xc2, 0x83, 0x43, 0xcd, 0x4b, 0xc6, 0xa9, 0xae, 0xfe,
+  0x7e, 0xda, 0x32, 0x55, 0xa2, 0x58, 0xc2, 0xef, 0xa7, 0xb9, 0xdc, 0x4d, 0x37, 0x06, 0xa2, 0x87, 0x37, 0x48, 0xef, 0x84,
+  0xa1, 0x74, 0x52, 0xa7, 0xea, 0xfe, 0x14, 0xcd, 0x60, 0x3b, 0x90, 0x65, 0xac, 0xd6, 0xb9, 0x5e, 0x4a, 0xed, 0x03, 0x00,
+  0x53, 0x3d, 0x51, 0x70, 0x6f, 0x04, 0x9d, 0x3b, 0xcd, 0x4a, 0xeb, 0x6a, 0x9d, 0xe6, 0xfe, 0xe7, 0xab, 0x1c, 0xfc, 0xe7,
+  0xab, 0x8b, 0xf7, 0xdd, 0x04, 0xd3, 0x76, 0x47, 0x62, 0x84, 0x3d, 0x8b, 0x04, 0x88, 0xa0, 0xc0, 0xa3, 0xde, 0x06, 0x73,
+  0x85, 0x03, 0x68, 0x6d, 0xc0, 0x9a, 0xe0, 0xde, 0x1d, 0xa9, 0x0f, 0x20, 0x81, 0x62, 0xb7, 0x94, 0x48, 0x65, 0xa7, 0x29,
+  0xb7, 0x6d, 0xa4, 0x5a, 0xfd, 0xcc, 0x88, 0x15, 0xc4, 0x20, 0xdd, 0x20, 0x10, 0xa6, 0xf7, 0x75, 0x8b, 0xd0, 0x15, 0xf2,
+  0x9b, 0xed, 0x28, 0xb6, 0x8a, 0x44, 0x06, 0x45, 0xbb, 0x90, 0xc8, 0x45, 0x85, 0xa4, 0x16, 0x2e, 0x96, 0x48, 0x8c, 0xa8,
+  0xaa, 0x09, 0x8d, 0x11, 0x9a, 0x91, 0x6f, 0x31, 0x2b, 0x01, 0xc3, 0x6e, 0x0c, 0xd7, 0x4a, 0x8c, 0x65, 0x58, 0xd3, 0x84,
+  0xb0, 0x8c, 0x8c, 0x00, 0xa4, 0x21, 0x4a, 0x2a, 0xf1, 0x18, 0xb1, 0x83, 0x81, 0x88, 0xc5, 0x60, 0x6b, 0xc2, 0x58, 0xfb,
+  0x17, 0x2e, 0x14, 0x42, 0xee, 0xca, 0xb8, 0x04, 0xd0, 0x34, 0xc5, 0x27, 0xe8, 0x3a, 0x4a, 0x42, 0x50, 0xdf, 0x8a, 0x3b,
+  0xd1, 0xaf, 0x64, 0x23, 0xc9, 0xb8, 0xd0, 0xfd, 0x0c, 0x39, 0x98, 0x03, 0x8e, 0xca, 0x76, 0x77, 0xa8, 0xf3, 0x0e, 0xb8,
+  0x88, 0xc6, 0x53, 0x31, 0x93, 0x55, 0x10, 0x09, 0x55, 0xbc, 0x8d, 0x06, 0xc8, 0x2f, 0x3f, 0x3d, 0xff, 0x9c, 0xf1, 0xf8,
+  0x9a, 0x5f, 0x81, 0xde, 0xc7, 0x53, 0x47, 0xea, 0x68, 0x26, 0xc7, 0x6c, 0xb2, 0x72, 0x2a, 0x97, 0xea, 0xca, 0x64, 0x33,
+  0x25, 0x4e, 0x44, 0xe1, 0xb1, 0x95, 0xae, 0x16, 0x3e, 0x46, 0xc6, 0xcd, 0x4b, 0x37, 0xa1, 0xcf, 0x25, 0xec, 0xe8, 0xc8,
+  0x85, 0x04, 0x1f, 0x77, 0x87, 0x2a, 0x1b, 0x94, 0xa7, 0x03, 0x60, 0xc5, 0xab, 0xdc, 0x7c, 0x44, 0x75, 0xee, 0xb0, 0x10,
+  0xe2, 0xc2, 0x47, 0x6b, 0xb6, 0xb1, 0x3e, 0xdd, 0xb8, 0x1f, 0xfb, 0x9f, 0x4e, 0x25, 0x60, 0x10, 0xa5, 0x7f, 0x86, 0x4a,
+  0x89, 0xf1, 0x23, 0xfb, 0x84, 0xa4, 0x82, 0xc8, 0xcd, 0x63, 0xdd, 0x0a, 0x11, 0x85, 0x00, 0xe0, 0x80, 0x9a, 0xf9, 0x34,
+  0x29, 0x99, 0xe2, 0xc2, 0x54, 0xc9, 0x31, 0xd9, 0xab, 0xc8, 0xbd, 0x5c, 0x63, 0xf3, 0x4d, 0xd5, 0x24, 0x02, 0x76, 0x61,
+  0x2c, 0x94, 0x3f, 0x44, 0x80, 0xca, 0x40, 0x5c, 0xf1, 0x80, 0xdb, 0x46, 0xb8, 0x36, 0x30, 0x9a, 0xa6, 0x5c, 0xc5, 0xb7,
+  0xdb, 0xda, 0xb7, 0xd0, 0x57, 0xcd, 0xb3, 0x8e, 0x5e, 0x1b, 0xf9, 0x1e, 0xf4, 0x15, 0x3f, 0x50, 0xf5, 0xdf, 0xdb, 0x46,
+  0x66, 0xe2, 0xaf, 0x58, 0xeb, 0x8e, 0x03, 0xb6, 0x2d, 0xba, 0x72, 0x42, 0x93, 0xa9, 0xa9, 0xab, 0x92, 0x2b, 0x60, 0xa0,
+  0x80, 0x4c, 0x7a, 0xdc, 0x37, 0xb1, 0x70, 0xf6, 0xd9, 0xb7, 0x6b, 0x5e, 0x55, 0x75, 0xbd, 0x4a, 0xda, 0x0e, 0x2f, 0xa0,
+  0xcf, 0xab, 0xbe, 0x60, 0x3b, 0x36, 0xab, 0x13, 0x0d, 0x42, 0xdf, 0xb1, 0xf8, 0x1e, 0x84, 0x42, 0xbc, 0xed, 0x9e, 0x1a,
+  0x40, 0xf2, 0x11, 0x3b, 0x08, 0xe4, 0x2d, 0x01, 0x28, 0x7f, 0xb0, 0x15, 0x3d, 0x06, 0xc5, 0x70, 0x70, 0xbb, 0xc0, 0xd6,
+  0x26, 0x5a, 0x14, 0x06, 0x0b, 0x46, 0x89, 0x48, 0x8b, 0x38, 0x10, 0x91, 0x8b, 0x95, 0x3e, 0xc3, 0x86, 0xdd, 0x2e, 0x38,
+  0x86, 0x97, 0x10, 0xa4, 0x38, 0xaa, 0xac, 0x37, 0x3e, 0x23, 0x49, 0xd5, 0xcc, 0x44, 0xd4, 0x6d, 0xc0, 0xae, 0x4b, 0xa1,
+  0x55, 0xd4, 0xc8, 0xe2, 0x32, 0x07, 0x42, 0xdf, 0x00, 0x69, 0x54, 0x57, 0x16, 0xd7, 0xb6, 0xbd, 0x86, 0xf4, 0x19, 0x4b,
+  0xe9, 0x33, 0xbe, 0x92, 0x04, 0x5d, 0xab, 0xad, 0x92, 0x80, 0x9b, 0x83, 0x88, 0x67, 0x34, 0x13, 0xe0, 0x6e, 0xd1, 0x62,
+  0xb7, 0x62, 0x1c, 0x5b, 0x06, 0x32, 0xca, 0xe7, 0xd8, 0x5f, 0x7b, 0xba, 0x2e, 0xe6, 0x6e, 0x0b, 0x40, 0xf0, 0x44, 0xd2,
+  0x55, 0x98, 0x83, 0x51, 0x18, 0x2e, 0x8d, 0x01, 0x77, 0xaa, 0x12, 0x64, 0xf3, 0x66, 0x55, 0x24, 0xae, 0xee, 0xd7, 0x6b,
+  0xb0, 0x79, 0x8a, 0x51, 0x31, 0x78, 0xce, 0x9f, 0xf2, 0x29, 0x47, 0x9f, 0xda, 0x36, 0xb1, 0xb6, 0xcb, 0x98, 0xdb, 0x7c,
+  0x02, 0x56, 0xea, 0x09, 0x58, 0xc1, 0x13, 0x50, 0xac, 0xc3, 0x57, 0xe5, 0xf5, 0x9b, 0x2e, 0x6b, 0x85, 0x97, 0xb5, 0xba,
+  0xd7, 0x65, 0x69, 0x1a, 0x3f, 0xae, 0x3e, 0xd5, 0xc3, 0x9b, 0x2d, 0x9a, 0x21, 0x98, 0x4a, 0x45, 0x4e, 0x28, 0xc5, 0x57,
+  0x51, 0x8e, 0xb0, 0xb4, 0x90, 0x21, 0x25, 0x45, 0x0c, 0x97, 0x8a, 0x5f, 0xa6, 0x3e, 0xe0, 0x9e, 0xd1, 0xe5, 0x35, 0x87,
+  0xa1, 0x01, 0x58, 0x84, 0x6b, 0x00, 0x5f, 0xdb, 0xa4, 0x31, 0x16, 0x5b, 0x0c, 0xf1, 0x7d, 0xfc, 0xd4, 0xfc, 0x22, 0xca,
+  0xb3, 0x8b, 0x07, 0x50, 0x81, 0x49, 0x3f, 0x8f, 0xf3, 0xe4, 0x8c, 0x0c, 0x20, 0x17, 0x62, 0xf0, 0x46, 0x38, 0x6a, 0xa2,
+  0x43, 0x06, 0x2e, 0x24, 0x42, 0x7d, 0x7d, 0x02, 0x5e, 0x23, 0x04, 0xa2, 0xb3, 0xae, 0x2c, 0xfc, 0x3a, 0x9a, 0xf4, 0x6e,
+  0x4a, 0x8e, 0x00, 0xcd, 0xb7, 0xc4, 0x51, 0x54, 0xc2, 0xf7, 0x0e, 0x29, 0x17, 0xdd, 0x92, 0xc2, 0x1d, 0xf0, 0xd3, 0x1a,
+  0xfc, 0xd4, 0x84, 0x9f, 0x96, 0xf0, 0xfe, 0x0e, 0x78, 0xbf, 0x06, 0xef, 0x9b, 0xf0, 0x3e, 0xc2, 0x6b, 0xd9, 0x74, 0x93,
+  0x45, 0x36, 0x73, 0xd2, 0xa9, 0x7f, 0xcd, 0x5f, 0xd3, 0xa5, 0x03, 0xd7, 0x31, 0x05, 0x8d, 0x72, 0xe5, 0x55, 0xe6, 0xbe,
+  0x48, 0x6f, 0xad, 0x98, 0x43, 0x21, 0x75, 0x18, 0x94, 0xa2, 0xf3, 0xd9, 0x94, 0x49, 0x79, 0x17, 0xce, 0x0e, 0x96, 0xb1,
+  0x60, 0x1f, 0x50, 0x67, 0xe0, 0xb6, 0xc9, 0xe0, 0xfb, 0xd2, 0xc5, 0x41, 0x72, 0x32, 0x24, 0x4e, 0x0e, 0x71, 0x76, 0x86,
+  0x6b, 0xe4, 0x1b, 0x72, 0x7c, 0x72, 0xd2, 0x6e, 0x4d, 0x2b, 0x0b, 0x4f, 0x8a, 0x79, 0x7f, 0xa8, 0x4f, 0x90, 0x13, 0xad,
+  0x4d, 0xd5, 0x3f, 0xd4, 0x99, 0x20, 0x45, 0xfe, 0x73, 0xf3, 0xf0, 0xd1, 0xda, 0x71, 0x06, 0x64, 0x34, 0x22, 0xc7, 0xdf,
+  0xb9, 0x20, 0x1c, 0x27, 0xc5, 0x31, 0x1e, 0x09, 0xe3, 0x29, 0x8e, 0x9f, 0xe0, 0xd0, 0x87, 0x47, 0x44, 0x87, 0x2e, 0xb0,
+  0x58, 0x50, 0x0e, 0xb3, 0x1f, 0xb0, 0x84, 0x71, 0x0e, 0x1e, 0xce, 0x71, 0x37, 0x37, 0xd5, 0x73, 0xb1, 0xec, 0x04, 0xde,
+  0x67, 0x4e, 0xc5, 0x8c, 0x87, 0x6d, 0xb2, 0x48, 0xa3, 0x36, 0x09, 0x7c, 0x34, 0xcc, 0x70, 0x05, 0x3e, 0x62, 0x42, 0x21,
+  0x37, 0x70, 0xe4, 0xac, 0x4c, 0xb0, 0x30, 0x1d, 0x85, 0xdb, 0xa2, 0x13, 0x48, 0x2f, 0x43, 0xd0, 0xaf, 0xb5, 0x02, 0x1c,
+  0x12, 0xf5, 0xb9, 0x01, 0x05, 0xab, 0x4d, 0xb5, 0x09, 0xd6, 0xf1, 0x69, 0x9a, 0xc1, 0x8a, 0x9d, 0xbf, 0x70, 0x9d, 0xeb,
+  0x55, 0x42, 0x6d, 0x48, 0xca, 0xbd, 0x24, 0x89, 0x98, 0xca, 0xe6, 0x7b, 0x18, 0x7b, 0xd9, 0x1b, 0x75, 0xce, 0x50, 0xfe,
+  0xdd, 0xb8, 0xad, 0xae, 0x98, 0x51, 0x99, 0x18, 0xa3, 0xf1, 0x62, 0xce, 0xcb, 0xbf, 0xc0, 0xa9, 0x38, 0xc0, 0xed, 0x0e,
+  0x2a, 0xf4, 0x65, 0xca, 0xe7, 0x2c, 0xa3, 0x90, 0x0d, 0x7f, 0x06, 0xaf, 0x29, 0x93, 0xe8, 0x1a, 0x5c, 0xe0, 0x3b, 0x6b,
+  0x95, 0x4e, 0x0f, 0xcb, 0x5c, 0xba, 0x4d, 0x74, 0xfa, 0x3c, 0xc4, 0xd1, 0x06, 0x81, 0x64, 0x26, 0x84, 0x89, 0xd0, 0x16,
+  0xd4, 0xc4, 0x63, 0x51, 0x05, 0x04, 0x36, 0x6d, 0xdc, 0xaa, 0x97, 0x4d, 0x38, 0x08, 0x32, 0xf1, 0xb0, 0x7b, 0x89, 0xc4,
+  0xa1, 0x1c, 0x65, 0x16, 0xab, 0x24, 0x6c, 0x5f, 0x5e, 0x5c, 0x5d, 0x03, 0x8a, 0xa2, 0x9e, 0x71, 0x44, 0xd4, 0x5e, 0x94,
+  0x36, 0xee, 0xaf, 0xb9, 0x6c, 0xaa, 0x71, 0x55, 0xb1, 0xfc, 0xf4, 0x72, 0x07, 0x92, 0x2a, 0x38, 0xc4, 0xb2, 0x2a, 0x72,
+  0xbd, 0xe6, 0x3f, 0xa3, 0xa0, 0x64, 0x65, 0x49, 0x29, 0x07, 0xa8, 0x16, 0xe9, 0xf5, 0xf2, 0xaa, 0x14, 0xe6, 0xfd, 0x6b,
+  0x2b, 0xb5, 0x86, 0x52, 0x49, 0x89, 0x35, 0x2d, 0x46, 0xbe, 0x1a, 0x6d, 0x0c, 0x6f, 0x51, 0x18, 0x86, 0x81, 0xad, 0x9b,
+  0x2d, 0x7c, 0x38, 0xc9, 0x19, 0xb4, 0xc9, 0xb1, 0x32, 0x12, 0xc3, 0x3d, 0xec, 0x03, 0x78, 0x5c, 0x07, 0xf0, 0x0f, 0x00,
+  0x9c, 0x94, 0x00, 0xda, 0x32, 0x24, 0xe5, 0x8f, 0xd6, 0xe9, 0x46, 0x51, 0xfe, 0x68, 0x3d, 0xdd, 0x28, 0xca, 0x1f, 0xad,
+  0xfd, 0x4d, 0x4d, 0xd3, 0xeb, 0xd1, 0xbd, 0x3c, 0x01, 0x65, 0xa3, 0xe4, 0x71, 0x40, 0x0a, 0x28, 0xa7, 0x52, 0x64, 0xf2,
+  0x81, 0x83, 0x7c, 0x40, 0xbf, 0x86, 0x46, 0xce, 0x5d, 0xa2, 0x55, 0xcf, 0x20, 0x2e, 0x63, 0xed, 0x49, 0x3e, 0x89, 0xc6,
+  0xd8, 0xcf, 0xc7, 0xa9, 0xca, 0xa8, 0x24, 0x26, 0x70, 0xb5, 0x68, 0xd7, 0x58, 0xc2, 0xea, 0xdb, 0x70, 0xb5, 0xe5, 0x7c,
+  0xc5, 0xb2, 0x41, 0xe7, 0x77, 0xac, 0x80, 0x6b, 0x34, 0xd1, 0x4d, 0x77, 0xa0, 0x9b, 0xee, 0x44, 0x37, 0xad, 0xa1, 0xf3,
+  0x4d, 0x74, 0xfe, 0x0e, 0x74, 0xfe, 0x4e, 0x74, 0x7e, 0x0d, 0x9d, 0xba, 0x68, 0xe3, 0x6e, 0x01, 0xbd, 0xf5, 0xd0, 0x02,
+  0x64, 0x04, 0x5f, 0x1d, 0x0b, 0x47, 0x53, 0x3d, 0xf0, 0x0b, 0x6f, 0x6b, 0x00, 0x6c, 0x97, 0x6e, 0x74, 0x2d, 0xa5, 0x78,
+  0x01, 0x95, 0x9f, 0xda, 0x51, 0x36, 0x72, 0xec, 0x7a, 0xcd, 0xc8, 0xd6, 0x17, 0xc5, 0xef, 0x64, 0x89, 0x4c, 0xa4, 0x58,
+  0xdd, 0x82, 0x6f, 0x47, 0x63, 0xf8, 0x12, 0x9e, 0x8d, 0x7a, 0xf0, 0x47, 0xcf, 0xdc, 0xc0, 0x0c, 0x92, 0x83, 0xf1, 0x3b,
+  0x86, 0x19, 0x45, 0xb5, 0x68, 0x63, 0x9d, 0xdd, 0x14, 0x50, 0x65, 0xa1, 0xd8, 0x88, 0x6b, 0xf7, 0x17, 0x87, 0xb1, 0xba,
+  0x2a, 0x83, 0xb3, 0x0a, 0x8c, 0x8e, 0xd7, 0xc4, 0x8c, 0x41, 0x4c, 0x64, 0xf5, 0x0c, 0xca, 0x4c, 0xaa, 0xf0, 0x9b, 0xa4,
+  0x5a, 0x32, 0xd4, 0x65, 0xe0, 0xa0, 0x20, 0x1f, 0x08, 0x3f, 0x7b, 0x01, 0xf0, 0x8f, 0xb5, 0x3f, 0xc7, 0xf6, 0x29, 0x44,
+  0x10, 0x14, 0x5e, 0x54, 0x74, 0x62, 0xfc, 0xce, 0x95, 0x90, 0x06, 0xbf, 0xb0, 0x2a, 0xc3, 0x8b, 0xe5, 0xb8, 0x7f, 0xba,
+  0x1c, 0x15, 0x6c, 0x1d, 0x0d, 0x4e, 0x97, 0x10, 0x5e, 0xac, 0x0d, 0x79, 0xd8, 0x32, 0xe7, 0x5d, 0x9e, 0xf5, 0x75, 0x08,
+  0x8d, 0x31, 0xf4, 0xb2, 0x33, 0x28, 0x68, 0xc1, 0x22, 0xae, 0xdd, 0x20, 0x0b, 0x1d, 0x85, 0xff, 0x86, 0xca, 0x03, 0x50,
+  0x47, 0xc4, 0xb6, 0xca, 0x1e, 0xec, 0xbd, 0x84, 0xa4, 0x83, 0x71, 0x13, 0x43, 0x29, 0xb8, 0x7a, 0x98, 0xdf, 0x24, 0x35,
+  0x49, 0x1c, 0x86, 0x07, 0x15, 0x29, 0x6e, 0xfe, 0x82, 0x1c, 0xb5, 0xe4, 0x56, 0x20, 0xb9, 0xd5, 0xa8, 0x0c, 0x51, 0x57,
+  0x5a, 0x6e, 0x8d, 0x5a, 0x65, 0x1f, 0x14, 0x97, 0xce, 0x18, 0xa4, 0xb8, 0x56, 0x15, 0x69, 0xe9, 0xa5, 0xfb, 0x48, 0x6b,
+  0xa5, 0xa4, 0xb5, 0xaa, 0x0b, 0xab, 0x9e, 0x90, 0xec, 0x16, 0x56, 0x55, 0x54, 0x3b, 0x14, 0x25, 0x57, 0x13, 0xed, 0xf1,
+  0x9c, 0x42, 0x0e, 0x9d, 0x81, 0xdb, 0x59, 0x29, 0x0b, 0x63, 0xa1, 0x54, 0x15, 0x08, 0xed, 0xca, 0x4a, 0xea, 0x11, 0x49,
+  0x77, 0x8a, 0xa5, 0xa9, 0x0f, 0x43, 0xb6, 0x7f, 0x0f, 0x62, 0x35, 0x8a, 0xcf, 0xc8, 0x0c, 0xa4, 0x04, 0xf1, 0x70, 0x53,
+  0x86, 0xfb, 0x1a, 0x36, 0xfd, 0xbc, 0x6f, 0x58, 0x51, 0x37, 0x05, 0xdd, 0x20, 0xd3, 0xb2, 0xae, 0x64, 0x9e, 0x73, 0x50,
+  0x90, 0x1b, 0x34, 0xa3, 0xd5, 0x78, 0xdc, 0x37, 0xad, 0x0b, 0x75, 0x4a, 0xf9, 0x96, 0xc1, 0x93, 0x82, 0xd4, 0x22, 0x7b,
+  0xa3, 0x51, 0x64, 0xdd, 0x43, 0x73, 0x8c, 0x14, 0x6e, 0x0b, 0x87, 0x9c, 0xbb, 0xaf, 0x23, 0xaa, 0x65, 0x8d, 0x07, 0x55,
+  0xe4, 0x10, 0x41, 0x2a, 0x4d, 0xdc, 0xa2, 0x49, 0x4f, 0xff, 0xbf, 0xc8, 0xfa, 0x1b, 0x8c, 0x7c, 0xd3, 0xfa, 0x58, 0xc9,
+  0x8c, 0xdb, 0xa4, 0x9e, 0xfb, 0x7e, 0x2a, 0x72, 0x4d, 0x16, 0x62, 0xf4, 0xa8, 0x7b, 0x21, 0x5d, 0xf9, 0x73, 0x96, 0xae,
+  0xfa, 0xbd, 0x8d, 0x4e, 0x9c, 0x71, 0xbe, 0xcc, 0xfb, 0xb1, 0xae, 0x15, 0x44, 0x88, 0xeb, 0xb5, 0xda, 0x05, 0xfa, 0x93,
+  0x2c, 0xed, 0x6a, 0x40, 0xa7, 0xab, 0xf0, 0x79, 0x8d, 0x30, 0x2f, 0xf6, 0xcb, 0x17, 0x50, 0x56, 0x25, 0x9d, 0xe2, 0x79,
+  0x4d, 0xbc, 0x55, 0xc4, 0xbd, 0x50, 0x87, 0x25, 0x65, 0x01, 0x53, 0xb7, 0x03, 0x54, 0xee, 0x5e, 0xb4, 0xe3, 0xb6, 0x8a,
+  0x4f, 0x18, 0x96, 0xc8, 0x58, 0xd6, 0xea, 0xa9, 0x53, 0xad, 0xb6, 0x46, 0x7a, 0xa0, 0x59, 0xf5, 0xa0, 0xde, 0xac, 0x3a,
+  0x74, 0x92, 0x9a, 0x87, 0xb0, 0x7a, 0xb2, 0xc8, 0x28, 0x60, 0x17, 0xe9, 0x8a, 0x78, 0x53, 0x8f, 0xc5, 0x5d, 0x5b, 0xbf,
+  0xfe, 0x28, 0x85, 0x3c, 0xb9, 0x56, 0x2d, 0x72, 0xe4, 0xdb, 0xec, 0x7e, 0x75, 0x15, 0x91, 0xa7, 0xd8, 0x56, 0x53, 0x9d,
+  0x91, 0x5f, 0x21, 0xf6, 0x7f, 0x86, 0x99, 0x05, 0x68, 0x87, 0x06, 0x82, 0xc0, 0xb1, 0xff, 0x67, 0x5a, 0x6d, 0xe4, 0x9b,
+  0x6f, 0x9a, 0x4e, 0x81, 0xb4, 0x5a, 0x63, 0x2c, 0x3a, 0x54, 0xb9, 0x2d, 0xef, 0x92, 0x03, 0x36, 0x9f, 0x2a, 0x98, 0x40,
+  0xfb, 0x45, 0xce, 0xf8, 0xd7, 0x0a, 0x0c, 0xd3, 0x11, 0x29, 0xaf, 0x19, 0x05, 0x7a, 0x84, 0x80, 0x1b, 0xce, 0xc8, 0x1d,
+  0x4d, 0x29, 0x89, 0xb9, 0x20, 0x9e, 0xe2, 0xbd, 0x2a, 0xc3, 0x4a, 0x5b, 0x29, 0xdb, 0xdb, 0x56, 0x2a, 0xae, 0xdb, 0xec,
+  0x1d, 0x69, 0xed, 0x01, 0x4e, 0xb3, 0xa2, 0xfc, 0xaf, 0x7e, 0x7d, 0x50, 0x16, 0x5c, 0xcd, 0xdf, 0x24, 0x18, 0xf5, 0x7f,
+  0x5b, 0xfd, 0x1a, 0x01, 0xe8, 0x29, 0x41, 0xb3, 0xfa, 0x35, 0xfa, 0xaa, 0x41, 0x16, 0x42, 0xa4, 0x06, 0xba, 0x5d, 0x3f,
+  0xe3, 0xf4, 0xcf, 0x31, 0xd0, 0xa8, 0xfa, 0x4d, 0xec, 0x94, 0x6d, 0x4c, 0xc3, 0xd8, 0xaa, 0x1d, 0x6e, 0xa9, 0x27, 0x0f,
+  0x64, 0xbb, 0x36, 0x9d, 0x3b, 0xf6, 0x2f, 0x54, 0x56, 0x23, 0x08, 0x43, 0xa3, 0xac, 0x37, 0xbe, 0x9f, 0x92, 0x5f, 0xd9,
+  0x2b, 0x46, 0x80, 0x6c, 0x82, 0x7e, 0x89, 0xe0, 0x2f, 0x5d, 0xbd, 0x88, 0x78, 0x70, 0x33, 0x1c, 0x52, 0x07, 0x80, 0x11,
+  0x33, 0x4f, 0xc8, 0xad, 0x5d, 0xf2, 0x9a, 0x47, 0xa1, 0xbc, 0xc2, 0xe7, 0x17, 0x17, 0xd7, 0x24, 0x6f, 0xbb, 0x63, 0xa5,
+  0xe7, 0x31, 0x5c, 0x2a, 0x9c, 0x07, 0x32, 0x82, 0xb4, 0x23, 0xe0, 0x73, 0x4a, 0xf0, 0x17, 0x7a, 0x5d, 0xdb, 0xad, 0xe8,
+  0x9c, 0xb6, 0xd1, 0x2c, 0x41, 0x74, 0x60, 0xa4, 0xd6, 0x76, 0x33, 0x79, 0x7f, 0x43, 0x78, 0xa7, 0xf2, 0x3f, 0x6d, 0xa9,
+  0x5e, 0xf1, 0x59, 0xce, 0x2c, 0x86, 0xea, 0x8d, 0xfc, 0xde, 0x97, 0x89, 0x3c, 0x92, 0x87, 0x91, 0x21, 0x96, 0xae, 0xee,
+  0x26, 0x93, 0x61, 0xeb, 0x40, 0x6f, 0x3a, 0xbb, 0x63, 0xd8, 0xa4, 0x84, 0xd1, 0x36, 0x0d, 0x66, 0x53, 0x7a, 0x2b, 0x89,
+  0xde, 0xe7, 0x11, 0xb0, 0x24, 0x3d, 0x4f, 0x44, 0x96, 0xe7, 0xd8, 0x5f, 0xdd, 0x96, 0xdf, 0xe9, 0x2b, 0xc6, 0xa6, 0xb3,
+  0x08, 0x7c, 0x89, 0x29, 0xef, 0xd5, 0x13, 0xc0, 0xa7, 0xcf, 0xc7, 0x5a, 0x1d, 0x6c, 0x00, 0x9d, 0xbe, 0x66, 0x73, 0xca,
+  0x17, 0xc2, 0x71, 0x5c, 0x7c, 0x43, 0xee, 0x49, 0x3e, 0x56, 0xf6, 0x24, 0x0b, 0x6d, 0xf2, 0xb8, 0xdf, 0x2f, 0x7f, 0x0c,
+  0xb0, 0xbf, 0x80, 0x61, 0x12, 0xbc, 0x29, 0x0d, 0xa1, 0x96, 0x5d, 0xe5, 0x6f, 0x4b, 0xf5, 0xd5, 0x59, 0x97, 0x7d, 0xdb,
+  0x21, 0x19, 0x1c, 0x9f, 0xb4, 0xcb, 0x16, 0x2c, 0x66, 0xcb, 0x6d, 0xb3, 0x83, 0x3a, 0x24, 0xfd, 0xee, 0x0f, 0x6a, 0xc3,
+  0x90, 0xac, 0x37, 0x30, 0x92, 0xc5, 0xda, 0x21, 0xf9, 0xf8, 0xa9, 0x8d, 0x35, 0xb0, 0xac, 0xda, 0x12, 0x06, 0xec, 0x0d,
+  0xcd, 0x86, 0xad, 0x06, 0x93, 0x6b, 0x02, 0xaa, 0x9f, 0xf7, 0xed, 0x04, 0xac, 0xb4, 0x8e, 0x0a, 0x40, 0xb3, 0xcb, 0x76,
+  0xdf, 0x36, 0x5b, 0x56, 0xeb, 0xf0, 0x92, 0x43, 0x4d, 0xa4, 0xac, 0x6c, 0xd9, 0x22, 0x7d, 0x3b, 0x1a, 0x35, 0xf7, 0x6b,
+  0x1d, 0x55, 0x58, 0xae, 0xd6, 0x1c, 0xea, 0xc5, 0x9e, 0x1d, 0x8d, 0x58, 0xa3, 0xf4, 0x5a, 0xb8, 0xd5, 0x92, 0x83, 0x26,
+  0xd7, 0x2d, 0xbd, 0xbd, 0xb1, 0x59, 0x3e, 0x57, 0xb9, 0x2f, 0x47, 0x85, 0xad, 0xf9, 0x68, 0x54, 0x0d, 0x0c, 0xe2, 0x86,
+  0xc6, 0x01, 0xa0, 0x98, 0xd8, 0x3f, 0x1e, 0xd6, 0x2f, 0xa7, 0xa9, 0xb9, 0xec, 0x6e, 0x0a, 0xdd, 0xad, 0xbe, 0x13, 0xcd,
+  0x3d, 0x6c, 0xb8, 0xc3, 0x88, 0x41, 0x00, 0xd5, 0x96, 0x0d, 0xa8, 0xc4, 0xf1, 0x65, 0x81, 0xbf, 0x38, 0xc6, 0x75, 0xbb,
+  0xea, 0xd7, 0x1f, 0x6a, 0xe1, 0x01, 0xcb, 0xde, 0x7b, 0xef, 0x9d, 0xbc, 0x3c, 0x7c, 0xa8, 0xaf, 0xb4, 0x2e, 0x7f, 0x58,
+  0xd1, 0x50, 0xe4, 0xa9, 0x0b, 0xdc, 0xe8, 0x2a, 0x18, 0xf7, 0xa4, 0xfa, 0xd4, 0xb2, 0x46, 0xbd, 0x6e, 0x2d, 0x0d, 0x09,
+  0xa8, 0xed, 0x45, 0xcf, 0xc9, 0x6d, 0xb7, 0x56, 0x3b, 0x57, 0x57, 0xb0, 0xca, 0x76, 0xae, 0x42, 0xb6, 0x01, 0xeb, 0xa9,
+  0x59, 0x10, 0x92, 0x15, 0xe8, 0xb2, 0xa0, 0x23, 0x0b, 0xcf, 0x65, 0x41, 0xa6, 0x78, 0xed, 0x2a, 0x34, 0x66, 0xe0, 0x8e,
+  0x1d, 0xc7, 0x6b, 0xfb, 0xd2, 0xed, 0x78, 0x5d, 0xec, 0x2e, 0xf8, 0xf0, 0xf7, 0x29, 0xe9, 0x0c, 0x08, 0x98, 0x78, 0x59,
+  0xf8, 0x96, 0x60, 0x0d, 0xdd, 0x47, 0xa5, 0xc9, 0x73, 0x6c, 0xf4, 0xcd, 0xcb, 0x1e, 0x5f, 0x51, 0xc3, 0xc6, 0x15, 0x08,
+  0x6b, 0xb1, 0x4d, 0x08, 0xde, 0xaa, 0x68, 0xb1, 0x82, 0xe3, 0xce, 0x7f, 0xeb, 0x35, 0xea, 0xe9, 0xdf, 0xb2, 0xc9, 0xff,
+  0x2d, 0xe5, 0x7f, 0x4e, 0xfa, 0x18, 0xc9, 0xa6, 0x32, 0x00, 0x00,
+};
+
+#endif
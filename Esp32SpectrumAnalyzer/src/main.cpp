@@ -1,6 +1,7 @@
 #include "Analyzer.h"
 #include "LedServer.h"
 #include "LedMatrix.h"
+#include "DspPipeline.h"
 #include "WifiConnection.h"
 
 //CUSTOM CONFIGURATION SECTION
@@ -10,45 +11,227 @@ unsigned short _bandTable[] = { //frequency bands in Hz
   // 100, 200, 400, 600, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 10000, 12000, 14000, 16000
 };
 
+//additional band views computed from the same FFT (eg. for web clients or network lighting), served at /views. Leave a table empty to skip the view.
+unsigned short _webBandTable[] = { //32 bands for web clients
+  140, 190, 240, 290, 340, 390, 440, 490, 540, 590, 640, 690, 790, 930, 1110, 1310,
+  1550, 1840, 2190, 2590, 3070, 3640, 4320, 5120, 6070, 7200, 8540, 10120, 12000, 14230, 16870, 20000
+};
+unsigned short _lightingBandTable[] = { //low, mid and high for network lighting
+  250, 4000, 20000
+};
+
+//layers of the LED display. The background is drawn behind the bars: BACKGROUND_NONE (black), BACKGROUND_GLOW (the bar colors, dimmed)
+//or BACKGROUND_TRAILS (the previous frame, faded, so falling bars leave trails). BACKGROUND_LEVEL is the brightness of the glow or the part of the
+//previous frame kept (0-255). The bars and the peaks are combined with the layers below them with BLEND_REPLACE, BLEND_ADD or BLEND_LIGHTEN.
+#define BACKGROUND_EFFECT BACKGROUND_NONE
+#define BACKGROUND_LEVEL 24
+#define BAR_BLEND BLEND_REPLACE
+#define PEAK_BLEND BLEND_REPLACE
+
+//analysis engine. ENGINE_FFT waits for 1024 samples (about 23 ms) per frame. ENGINE_FILTER_BANK runs a band-pass filter per band over every block
+//of FILTER_BANK_BLOCK samples as it arrives (like a graphic equalizer display chip), so a frame shows the most recent samples: lower latency, more CPU per band.
+#define ANALYSIS_ENGINE ENGINE_FFT
+#define FILTER_BANK_BLOCK 64 //samples per block (power of 2 from 32 to 1024). The frame rate follows how fast the LEDs can be shown.
+
+//stream the displayed frames over UDP to remote display nodes (set STREAM_FRAMES to 0 to disable)
+#define STREAM_FRAMES 1
+#define STREAM_PORT 4210
+IPAddress _streamAddress(239, 1, 2, 3); //multicast group (or the address of a single display node)
+#define PRESENTATION_DELAY_MS 60 //frames are stamped to be shown this long after they are sent, on the analyzer's clock (display nodes sync their clocks to it)
+
+//write a binary record of every frame (levels, peaks, stage timings and counters) to the serial port for bench diagnostics (set SERIAL_TELEMETRY to 1 to enable).
+//decode it on a computer with tools/telemetry_decoder.py. 115200 baud carries up to 64 bands at the full frame rate.
+#define SERIAL_TELEMETRY 0
+#define SERIAL_BAUD 115200
+#define TELEMETRY_TX_BUFFER 1024 //serial TX buffer, so records are queued instead of written byte by byte
+
+//keep the most recent frames for download at /history (set HISTORY_SECONDS to 0 to disable). Takes HISTORY_SECONDS x 43 x (4 + number of bands) bytes.
+//the filter bank engine makes more frames per second, so the history then covers a shorter time.
+#define HISTORY_SECONDS 30
+#define FRAMES_PER_SECOND 43 //44100 Hz / 1024 samples per frame (FFT engine)
+
+//raw audio snapshots, triggered with a POST to /snapshot or the BOOT button and downloaded from /snapshot.wav (set SNAPSHOT_BLOCKS to 0 to disable).
+//each block of 1024 samples (about 23 ms) takes 2 KB.
+#define SNAPSHOT_BLOCKS 22 //about half a second
+#define SNAPSHOT_TRIGGER_PIN 0 //BOOT button (NO_TRIGGER_PIN for none)
+
+//display node mode (build the "display-node" environment): the analyzer is skipped and the frames streamed by another analyzer are displayed.
+//the number of columns is still taken from _bandTable. Nodes show every frame at the presentation time it is stamped with, so several nodes form one LED wall.
+#define PLAYOUT_DELAY_MS 60 //until the clock is synced, frames are held back for this long to absorb network jitter
+#define WALL_FIRST_COLUMN 0 //band of the streamed frames shown in the first column: a node of a wall shows the bands from here on
+
+//task priorities. The frame loop runs on core 1, everything on the network side on core 0. The web handlers run in the async TCP task
+//(priority set with CONFIG_ASYNC_TCP_PRIORITY in platformio.ini); deploys and settings are applied by the web server thread below it.
+#define FRAME_LOOP_PRIORITY 1 //the Arduino loop task that captures the audio and drives the LEDs
+#define WEB_WORKER_PRIORITY 1 //web server thread: applies deploys, saves the settings and looks after WiFi
+
+//allocation guard (build an "alloc-guard" environment): once the frame loop has run this many frames, a heap allocation by it aborts with the
+//caller, so the loop provably runs without allocating. The allocations of every task are counted at /metrics.
+#define ALLOC_WARMUP_FRAMES 200
+
+//dedicated DSP mode: WiFi, the web portal and streaming are off, and core 0 is given to the audio capture and analysis while core 1 drives the LEDs.
+//entered from the portal (stored, so it survives restarts) or by holding DSP_MODE_PIN low at boot (eg. with a jumper). Holding DSP_EXIT_PIN low
+//for 3 seconds returns to normal mode. The FFT frames overlap by FFT_SIZE - DSP_FFT_HOP samples, so there are more of them per second;
+//frames per second, analysis and render times are written to the serial port every 10 seconds.
+#define DSP_MODE_PIN 4 //held low at boot to enter (NO_EXIT_PIN for none). Not the BOOT button: held at power on, it starts the ROM bootloader.
+#define DSP_EXIT_PIN 0 //BOOT button
+#define DSP_FFT_HOP (FFT_SIZE / 2) //samples per block in dedicated DSP mode (power of 2 from 32 to FFT_SIZE)
+#define DSP_ANALYSIS_PRIORITY 2 //the analysis task on core 0, above the idle and timer housekeeping
+
 
 //do not touch from here
 #define ARRAYSIZE(a) (sizeof(a)/sizeof(a[0]))
+static_assert(FILTER_BANK_BLOCK >= MIN_BLOCK_SIZE && FILTER_BANK_BLOCK <= FFT_SIZE && (FILTER_BANK_BLOCK & (FILTER_BANK_BLOCK - 1)) == 0, "FILTER_BANK_BLOCK must be a power of 2 from 32 to 1024");
+static_assert(DSP_FFT_HOP >= MIN_BLOCK_SIZE && DSP_FFT_HOP <= FFT_SIZE && (DSP_FFT_HOP & (DSP_FFT_HOP - 1)) == 0, "DSP_FFT_HOP must be a power of 2 from 32 to 1024");
+static_assert(ARRAYSIZE(_bandTable) <= MAX_VIEW_BANDS && ARRAYSIZE(_webBandTable) <= MAX_VIEW_BANDS && ARRAYSIZE(_lightingBandTable) <= MAX_VIEW_BANDS, "band tables can have at most MAX_VIEW_BANDS bands");
 Analyzer* _analyzer;
 LedServer* _ledServer;
-float* _freqBands;
+float _freqBands[ARRAYSIZE(_bandTable)]; //array to hold frequency band levels
+#ifndef DISPLAY_NODE
+AnalyzerMemory _analyzerMemory; //zero initialized, so it goes into .bss in internal DRAM rather than on the heap
+DspFrame _dspFrame; //frame handed over by the analysis task in dedicated DSP mode
+#endif
 
 void setup() {
-  Serial.begin(115200);
+  if(SERIAL_TELEMETRY){
+    Serial.setTxBufferSize(TELEMETRY_TX_BUFFER); //must be set before the port is started
+  }
+  Serial.begin(SERIAL_BAUD);
 
   unsigned short noOfBands = ARRAYSIZE(_bandTable);
-  _analyzer = new Analyzer(noOfBands, _bandTable);
+
+  //counters and gauges served at /metrics
+  Metrics* metrics = new Metrics();
+  ConfigStore* configStore = new ConfigStore(NUM_LEVELS * noOfBands, noOfBands);
+
+#ifndef DISPLAY_NODE
+  if(DSP_MODE_PIN != NO_EXIT_PIN){
+    pinMode(DSP_MODE_PIN, INPUT_PULLUP);
+  }
+  bool dspMode = configStore->loadRunMode() == RUN_MODE_DSP || (DSP_MODE_PIN != NO_EXIT_PIN && digitalRead(DSP_MODE_PIN) == LOW);
+
+  _analyzer = new Analyzer(&_analyzerMemory, noOfBands, _bandTable);
+  _analyzer->setMetrics(metrics);
+  _analyzer->setEngine(ANALYSIS_ENGINE, ANALYSIS_ENGINE == ENGINE_FILTER_BANK ? FILTER_BANK_BLOCK : (dspMode ? DSP_FFT_HOP : FFT_SIZE));
 
   //set up ADC. If it fails, no point in moving forward.
   if(!_analyzer->setupAdc())
     return;
 
-  //array to hold frequency band levels
-  _freqBands = new float[noOfBands];
+  //add the additional band views (served to the network, so not computed in dedicated DSP mode)
+  if(ARRAYSIZE(_webBandTable) > 0 && !dspMode){
+    _analyzer->addBandView("web", _webBandTable, ARRAYSIZE(_webBandTable));
+  }
+  if(ARRAYSIZE(_lightingBandTable) > 0 && !dspMode){
+    _analyzer->addBandView("lighting", _lightingBandTable, ARRAYSIZE(_lightingBandTable));
+  }
+
+  //trace the latency from audio capture to the LEDs
+  LatencyTracer* latencyTracer = dspMode ? nullptr : new LatencyTracer();
+  if(latencyTracer != nullptr){
+    _analyzer->setLatencyTracer(latencyTracer);
+  }
+
+  //tap the capture path for audio snapshots
+  uint16_t blockSize = _analyzer->getBlockSize(); //the snapshot is tapped block by block, so it covers the same time with any block size
+  AudioSnapshot* audioSnapshot = SNAPSHOT_BLOCKS && !dspMode ? new AudioSnapshot(blockSize, SNAPSHOT_BLOCKS * (FFT_SIZE / blockSize), _analyzer->getSamplingFrequency(), SNAPSHOT_TRIGGER_PIN) : nullptr;
+  if(audioSnapshot != nullptr){
+    _analyzer->setAudioSnapshot(audioSnapshot);
+  }
+
+  //in dedicated DSP mode the radio is not started at all
+  if(dspMode){
+    WiFi.mode(WIFI_OFF);
+  }
+#else
+  bool dspMode = false;
+#endif
+
+  LedMatrix* ledMatrix = new LedMatrix(NUM_LEVELS, noOfBands);
+  ledMatrix->setBackground(BACKGROUND_EFFECT, BACKGROUND_LEVEL);
+  ledMatrix->setBlendModes(BAR_BLEND, PEAK_BLEND);
 
   //prepare arguments for the LED Server
   LedServerArgs args = {
-    .wifiConnection = new WifiConnection(), 
-    .webServer = new WebServer(80), 
-    .ledMatrix = new LedMatrix(NUM_LEVELS, noOfBands) 
+    .wifiConnection = dspMode ? nullptr : new WifiConnection(), 
+    .webServer = dspMode ? nullptr : new AsyncWebServer(80), 
+    .ledMatrix = ledMatrix,
+    .configStore = configStore,
+#ifndef DISPLAY_NODE
+    .frameStreamer = STREAM_FRAMES && !dspMode ? new FrameStreamer(_streamAddress, STREAM_PORT, PRESENTATION_DELAY_MS) : nullptr,
+    .frameReceiver = nullptr,
+    .latencyTracer = latencyTracer,
+    .analyzer = _analyzer,
+    .serialTelemetry = SERIAL_TELEMETRY ? new SerialTelemetry(&Serial) : nullptr,
+    .spectrumHistory = HISTORY_SECONDS && !dspMode ? new SpectrumHistory(noOfBands, HISTORY_SECONDS * FRAMES_PER_SECOND) : nullptr,
+    .audioSnapshot = audioSnapshot,
+#else
+    .frameStreamer = nullptr,
+    .frameReceiver = new FrameReceiver(_streamAddress, STREAM_PORT, PLAYOUT_DELAY_MS, WALL_FIRST_COLUMN),
+    .latencyTracer = nullptr,
+    .analyzer = nullptr,
+    .serialTelemetry = nullptr,
+    .spectrumHistory = HISTORY_SECONDS ? new SpectrumHistory(noOfBands, HISTORY_SECONDS * FRAMES_PER_SECOND) : nullptr,
+    .audioSnapshot = nullptr,
+#endif
+    .metrics = metrics,
+    .workerPriority = WEB_WORKER_PRIORITY
   };
 
   //create new LED server with arguments
   _ledServer = new LedServer(args);
 
-  //before entering the loop, give some time for the thread in the LED server to connect to WiFi etc.
-  delay(2000); 
+  //WiFi and DNS are set up by the thread in the LED server, so enter the loop right away.
+  vTaskPrioritySet(NULL, FRAME_LOOP_PRIORITY);
+  AllocGuard::watchTask("loopTask");
+  uint32_t warmupFrames = ALLOC_WARMUP_FRAMES;
+#ifndef DISPLAY_NODE
+  if(dspMode){
+    //the analysis task captures and analyses on core 0; this loop only renders the frames it hands over
+    DspPipeline* dspPipeline = new DspPipeline(_analyzer, metrics, DSP_EXIT_PIN, ALLOC_WARMUP_FRAMES);
+    dspPipeline->begin(DSP_ANALYSIS_PRIORITY);
+
+    while(!dspPipeline->exitRequested()){
+      int64_t captureTime = dspPipeline->receiveFrame(&_dspFrame);
+      _ledServer->updateClients(_dspFrame.bands, captureTime);
+
+      if(!SERIAL_TELEMETRY){
+        dspPipeline->report(Serial); //the telemetry records would be garbled by the text
+      }
+
+      if(warmupFrames > 0 && --warmupFrames == 0){
+        AllocGuard::armTask();
+      }
+    }
+
+    AllocGuard::disarmTask(); //saving the run mode allocates
+    Serial.println("Leaving dedicated DSP mode");
+    configStore->saveRunMode(RUN_MODE_NORMAL);
+    ESP.restart();
+  }
 
   //main loop to process audio input and display of output
   while(true){
     _analyzer->readAudioSamples();
     _analyzer->convertToBands(_freqBands);
-    _ledServer->updateClients(_freqBands);
+    _ledServer->updateClients(_freqBands, _analyzer->getCaptureTime());
+
+    if(warmupFrames > 0 && --warmupFrames == 0){
+      AllocGuard::armTask();
+    }
+  }
+#else
+  //main loop to display the frames received from the network
+  while(true){
+    if(args.frameReceiver->receiveFrame(_freqBands, noOfBands)){
+      _ledServer->displayLevels(_freqBands, args.frameReceiver->getShowTime());
+
+      if(warmupFrames > 0 && --warmupFrames == 0){
+        AllocGuard::armTask();
+      }
+    }
   }
+#endif
 }
 
 //we do not use Arduino loop in this sketch.
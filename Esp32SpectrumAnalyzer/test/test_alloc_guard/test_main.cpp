@@ -0,0 +1,118 @@
+//Runs the work of the frame loop (analysis, quantization and rendering) with the task armed against allocations, and checks that an
+//allocation by an armed task aborts (the native-test-alloc-guard environment in platformio.ini, which wraps the allocator).
+//
+//usage: pio test -e native-test-alloc-guard -f test_alloc_guard
+#include <Arduino.h>
+#include <unity.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "AllocGuard.h"
+#include "Analyzer.h"
+#include "LevelQuantizer.h"
+#include "LedMatrix.h"
+
+#define NO_OF_ROWS 10
+#define WARMUP_FRAMES 8 //frames run before the task is armed, as ALLOC_WARMUP_FRAMES in main.cpp
+#define ARMED_FRAMES 500 //frames run armed, about 12 s of audio
+#define ADC_MIDSCALE 0x800 //ADC sample of silence
+#define NO_OF_BLOCKS 16 //different blocks of samples the frames cycle through
+
+static unsigned short _bandTable[] = {100, 250, 500, 750, 1000, 2000, 4000, 6000, 8000, 10000}; //_bandTable of main.cpp
+#define NO_OF_BANDS (sizeof(_bandTable) / sizeof(_bandTable[0]))
+
+static AnalyzerMemory _memory;
+static AudioSample _samples[NO_OF_BLOCKS * FFT_SIZE];
+
+//index of the calling task in the table of AllocGuard (it is watched by the first test that runs)
+static uint8_t watchedIndex(){
+  AllocGuard::watchTask("test");
+  for (uint8_t i = 0; i < AllocGuard::getNoOfTasks(); i++) {
+    if(strcmp(AllocGuard::getTaskName(i), "test") == 0){
+      return i;
+    }
+  }
+  TEST_FAIL_MESSAGE("the task is not watched");
+  return 0;
+}
+
+//ADC samples of a few tones over a little noise, as the I2S driver delivers them
+static void makeSamples(uint32_t samplingFrequency){
+  uint32_t noise = 1;
+  for (uint32_t i = 0; i < NO_OF_BLOCKS * FFT_SIZE; i++) {
+    noise ^= noise << 13;
+    noise ^= noise >> 17;
+    noise ^= noise << 5;
+    float t = (float)i / samplingFrequency;
+    float tone = 600.0f * sinf(TWO_PI * 220.0f * t) + 300.0f * sinf(TWO_PI * 1760.0f * t) + 100.0f * sinf(TWO_PI * 7040.0f * t);
+    _samples[i] = ADC_MIDSCALE + (int)lroundf(tone) + (int)(noise % 41) - 20;
+  }
+}
+
+void setUp(){
+  if(!AllocGuard::isEnabled()){
+    TEST_IGNORE_MESSAGE("the allocator is only wrapped in the native-test-alloc-guard environment");
+  }
+}
+
+void tearDown(){
+}
+
+//an allocation in the frame loop aborts the whole test run, so a regression fails loudly; the count is checked as well
+void test_frame_loop_does_not_allocate(){
+  uint8_t index = watchedIndex();
+  Analyzer analyzer(&_memory, NO_OF_BANDS, _bandTable);
+  LevelQuantizer quantizer(NO_OF_ROWS);
+  LedMatrix ledMatrix(NO_OF_ROWS, NO_OF_BANDS);
+  makeSamples(analyzer.getSamplingFrequency());
+
+  float bands[MAX_VIEW_BANDS];
+  unsigned short values[NO_OF_BANDS];
+  int64_t frameTime = 0;
+  uint32_t allocations = 0;
+  for (uint32_t f = 0; f < WARMUP_FRAMES + ARMED_FRAMES; f++) {
+    if(f == WARMUP_FRAMES){
+      allocations = AllocGuard::getAllocations(index);
+      AllocGuard::armTask();
+    }
+
+    analyzer.loadSamples(&_samples[(f % NO_OF_BLOCKS) * FFT_SIZE]);
+    analyzer.convertToBands(bands);
+    quantizer.update(bands, NO_OF_BANDS, 1.0f);
+    for (uint8_t b = 0; b < NO_OF_BANDS; b++) {
+      values[b] = quantizer.quantize(bands[b]);
+    }
+    frameTime += REFERENCE_FRAME_MICROS;
+    ledMatrix.renderFrame(values, frameTime, 1.0f);
+  }
+  AllocGuard::disarmTask();
+
+  TEST_ASSERT_EQUAL_UINT32(allocations, AllocGuard::getAllocations(index));
+}
+
+//the child arms itself and allocates, which has to abort it
+void test_armed_allocation_aborts(){
+  fflush(stdout);
+  pid_t child = fork();
+  if(child == 0){
+    watchedIndex();
+    AllocGuard::armTask();
+    void* volatile pointer = malloc(16);
+    free(pointer);
+    _exit(0); //not caught
+  }
+
+  int status = 0;
+  TEST_ASSERT_EQUAL(child, waitpid(child, &status, 0));
+  TEST_ASSERT_TRUE(WIFSIGNALED(status));
+  TEST_ASSERT_EQUAL(SIGABRT, WTERMSIG(status));
+}
+
+void setup(){
+  UNITY_BEGIN();
+  RUN_TEST(test_frame_loop_does_not_allocate);
+  RUN_TEST(test_armed_allocation_aborts);
+  exit(UNITY_END());
+}
+
+void loop(){
+}
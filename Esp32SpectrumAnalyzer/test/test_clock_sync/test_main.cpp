@@ -0,0 +1,197 @@
+//Feeds the same exchanges to the clock sync of the firmware and to its Python port (tools/clock_sync.py, used by the frame tools and
+//wall_sync_test.py) and checks that both estimate the same, exchange by exchange, and that the estimate follows the server clock
+//(the native-test environment in platformio.ini). Needs python3 on the PATH.
+//
+//usage: pio test -e native-test -f test_clock_sync
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "ClockSync.h"
+
+#define EXCHANGES_PATH "test_clock_sync.txt" //written in the working directory and removed at the end
+#define TEST_SOURCE "test/test_clock_sync/test_main.cpp" //this file, relative to the project directory
+#define NO_OF_EXCHANGES 600 //5 minutes at one exchange every 500 ms
+#define EXCHANGE_INTERVAL_US 500000 //as CLOCK_SYNC_INTERVAL_MS of the firmware
+#define LATER_US 10000000 //the offsets are compared at the end of each exchange and this much later, which checks the drift as well
+#define RESTART_STEP_US 30000000 //the server clock jumps by this much halfway through the scenarios that restart it
+#define DRIFT_TOLERANCE_PPM 30.0f //half the 4 ms spread of the delays over the 32 s of CLOCK_SYNC_SAMPLES is 62 ppm at worst; the fit
+                                 //over the faster half averages most of it out (about 20 ppm off at most in the scenarios below)
+
+//one request/response exchange: t1 and t4 on the client clock, t2 and t3 on the server clock
+struct Exchange{
+  int64_t t1;
+  int64_t t2;
+  int64_t t3;
+  int64_t t4;
+};
+
+//a server clock and a network
+struct Scenario{
+  double driftPpm; //how much faster the server clock runs
+  int64_t offset; //server clock minus client clock at client time 0
+  bool restart; //the server restarts halfway through
+  uint32_t seed;
+};
+
+static const Scenario _scenarios[] = {
+  {40.0, 5000000, false, 1},
+  {-35.0, -123456789, false, 2},
+  {0.0, 777, true, 3},
+  {120.0, 0, true, 4},
+};
+#define NO_OF_SCENARIOS (sizeof(_scenarios) / sizeof(_scenarios[0]))
+
+//the estimate after an exchange, as both implementations report it
+struct Estimate{
+  int accepted;
+  int synced;
+  long long offset; //at t4
+  long long laterOffset; //LATER_US after t4
+  double driftPpm;
+  long long roundTrip;
+  long long residual;
+};
+
+static uint32_t nextRandom(uint32_t* state){
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+//one way delays of 1 to 5 ms, with one in ten queued for up to 50 ms more, and now and then a response that claims the server took
+//longer than the whole exchange (rejected)
+static std::vector<Exchange> makeExchanges(const Scenario& scenario){
+  std::vector<Exchange> exchanges;
+  uint32_t random = scenario.seed;
+  int64_t offset = scenario.offset;
+  int64_t now = 1000000;
+
+  for (uint16_t n = 0; n < NO_OF_EXCHANGES; n++) {
+    if(scenario.restart && n == NO_OF_EXCHANGES / 2){
+      offset -= RESTART_STEP_US;
+    }
+
+    now += EXCHANGE_INTERVAL_US + nextRandom(&random) % 1000;
+    int64_t up = 1000 + nextRandom(&random) % 4000 + (nextRandom(&random) % 10 == 0 ? nextRandom(&random) % 50000 : 0);
+    int64_t down = 1000 + nextRandom(&random) % 4000 + (nextRandom(&random) % 10 == 0 ? nextRandom(&random) % 50000 : 0);
+    int64_t processing = 50 + nextRandom(&random) % 200;
+
+    Exchange exchange;
+    exchange.t1 = now;
+    exchange.t2 = now + up + offset + llround((now + up) * scenario.driftPpm / 1e6);
+    exchange.t3 = exchange.t2 + processing;
+    exchange.t4 = now + up + processing + down;
+    if(n % 97 == 50){
+      exchange.t3 = exchange.t2 + (exchange.t4 - exchange.t1) + 10;
+    }
+    exchanges.push_back(exchange);
+  }
+  return exchanges;
+}
+
+//runs the exchanges through the firmware's ClockSync
+static std::vector<Estimate> estimateNative(const std::vector<Exchange>& exchanges, ClockSync* sync){
+  std::vector<Estimate> estimates;
+  uint8_t request[CLOCK_SYNC_PACKET_SIZE];
+  uint8_t response[CLOCK_SYNC_PACKET_SIZE];
+
+  for (const Exchange& exchange : exchanges) {
+    sync->makeRequest(request, exchange.t1);
+    TEST_ASSERT_EQUAL(CLOCK_SYNC_PACKET_SIZE, ClockSync::makeResponse(request, sizeof(request), exchange.t2, exchange.t3, response));
+
+    Estimate estimate;
+    estimate.accepted = sync->handleResponse(response, sizeof(response), exchange.t4);
+    estimate.synced = sync->isSynced();
+    estimate.offset = sync->getOffset(exchange.t4);
+    estimate.laterOffset = sync->getOffset(exchange.t4 + LATER_US);
+    estimate.driftPpm = sync->getDriftPpm();
+    estimate.roundTrip = sync->getRoundTrip();
+    estimate.residual = sync->getResidual();
+    estimates.push_back(estimate);
+  }
+  return estimates;
+}
+
+//runs the exchanges through the Python port, which reads them from a file
+static std::vector<Estimate> estimatePython(const std::vector<Exchange>& exchanges){
+  FILE* file = fopen(EXCHANGES_PATH, "w");
+  TEST_ASSERT_NOT_NULL(file);
+  for (const Exchange& exchange : exchanges) {
+    fprintf(file, "%lld %lld %lld %lld\n", (long long)exchange.t1, (long long)exchange.t2, (long long)exchange.t3, (long long)exchange.t4);
+  }
+  fclose(file);
+
+  //the tool is found next to this file, so the test runs from the project directory as well as from elsewhere
+  std::string source = __FILE__;
+  size_t projectLength = source.rfind(TEST_SOURCE);
+  std::string command = "python3 " + (projectLength == std::string::npos ? std::string() : source.substr(0, projectLength))
+    + "tools/clock_sync.py < " EXCHANGES_PATH;
+
+  std::vector<Estimate> estimates;
+  FILE* output = popen(command.c_str(), "r");
+  TEST_ASSERT_NOT_NULL(output);
+  Estimate estimate;
+  while(fscanf(output, "%d %d %lld %lld %lf %lld %lld", &estimate.accepted, &estimate.synced, &estimate.offset, &estimate.laterOffset,
+    &estimate.driftPpm, &estimate.roundTrip, &estimate.residual) == 7){
+    estimates.push_back(estimate);
+  }
+  TEST_ASSERT_EQUAL_MESSAGE(0, pclose(output), "python3 tools/clock_sync.py failed");
+  remove(EXCHANGES_PATH);
+  return estimates;
+}
+
+void setUp(){
+}
+
+void tearDown(){
+}
+
+void test_python_port_matches(){
+  for (const Scenario& scenario : _scenarios) {
+    std::vector<Exchange> exchanges = makeExchanges(scenario);
+    ClockSync sync;
+    std::vector<Estimate> native = estimateNative(exchanges, &sync);
+    std::vector<Estimate> python = estimatePython(exchanges);
+    TEST_ASSERT_EQUAL(native.size(), python.size());
+
+    for (size_t n = 0; n < native.size(); n++) {
+      char message[96];
+      snprintf(message, sizeof(message), "scenario %u, exchange %u", (unsigned)scenario.seed, (unsigned)n);
+      TEST_ASSERT_EQUAL_MESSAGE(native[n].accepted, python[n].accepted, message);
+      TEST_ASSERT_EQUAL_MESSAGE(native[n].synced, python[n].synced, message);
+      TEST_ASSERT_EQUAL_MESSAGE(native[n].offset, python[n].offset, message);
+      TEST_ASSERT_EQUAL_MESSAGE(native[n].laterOffset, python[n].laterOffset, message);
+      TEST_ASSERT_TRUE_MESSAGE((float)python[n].driftPpm == (float)native[n].driftPpm, message); //getDriftPpm returns a float
+      TEST_ASSERT_EQUAL_MESSAGE(native[n].roundTrip, python[n].roundTrip, message);
+      TEST_ASSERT_EQUAL_MESSAGE(native[n].residual, python[n].residual, message);
+    }
+  }
+}
+
+//the estimate after the last exchange is within the spread of the delays of the true offset, and within DRIFT_TOLERANCE_PPM of the
+//true drift
+void test_follows_server_clock(){
+  for (const Scenario& scenario : _scenarios) {
+    std::vector<Exchange> exchanges = makeExchanges(scenario);
+    ClockSync sync;
+    estimateNative(exchanges, &sync);
+
+    int64_t end = exchanges.back().t4;
+    int64_t offset = scenario.offset - (scenario.restart ? RESTART_STEP_US : 0) + llround(end * scenario.driftPpm / 1e6);
+    TEST_ASSERT_TRUE(sync.isSynced());
+    TEST_ASSERT_INT64_WITHIN(2000, offset, sync.getOffset(end));
+    TEST_ASSERT_FLOAT_WITHIN(DRIFT_TOLERANCE_PPM, scenario.driftPpm, sync.getDriftPpm());
+  }
+}
+
+void setup(){
+  UNITY_BEGIN();
+  RUN_TEST(test_python_port_matches);
+  RUN_TEST(test_follows_server_clock);
+  exit(UNITY_END());
+}
+
+void loop(){
+}
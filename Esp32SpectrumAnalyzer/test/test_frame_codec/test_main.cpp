@@ -0,0 +1,253 @@
+//Round trips of the frame codec over random band levels, and the frames the decoder has to reject (the native-test environment in platformio.ini).
+//
+//usage: pio test -e native-test -f test_frame_codec
+#include <Arduino.h>
+#include <unity.h>
+#include "FrameCodec.h"
+
+#define FUZZ_FRAMES 5000 //frames encoded per band count
+#define FUZZ_MUTATIONS 20000 //corrupted frames decoded
+#define KEYFRAME_INTERVAL 16
+
+static const uint8_t _bandCounts[] = {1, 3, 10, 32, 64};
+static uint32_t _seed;
+
+static uint32_t nextRandom(){
+  _seed = _seed * 1664525 + 1013904223;
+  return _seed >> 8;
+}
+
+//levels that move like music: mostly small steps, now and then a jump, and peaks that only fall slowly
+static void nextLevels(uint8_t* levels, uint8_t* peaks, uint8_t noOfBands){
+  for (uint8_t b = 0; b < noOfBands; b++) {
+    uint32_t r = nextRandom();
+    if(r % 16 == 0){
+      levels[b] = r >> 8;
+    }else if(r % 4 != 0){
+      levels[b] += (int)((r >> 8) % 21) - 10;
+    }
+    peaks[b] = levels[b] / 26 > peaks[b] ? levels[b] / 26 : (r % 8 == 0 && peaks[b] > 0 ? peaks[b] - 1 : peaks[b]);
+  }
+}
+
+static void assertFrame(const SpectrumFrame& frame, const uint8_t* levels, const uint8_t* peaks, uint8_t noOfBands, uint8_t noOfRows){
+  TEST_ASSERT_EQUAL_UINT8(noOfBands, frame.noOfBands);
+  TEST_ASSERT_EQUAL_UINT8(noOfRows, frame.noOfRows);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(levels, frame.levels, noOfBands);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(peaks, frame.peaks, noOfBands);
+}
+
+//compares the fields the decoder sets, as the padding of the struct is not copied
+static bool sameFrame(const SpectrumFrame& a, const SpectrumFrame& b){
+  return a.sequence == b.sequence && a.timestamp == b.timestamp && a.presentation == b.presentation && a.noOfBands == b.noOfBands &&
+    a.noOfRows == b.noOfRows && memcmp(a.levels, b.levels, a.noOfBands) == 0 && memcmp(a.peaks, b.peaks, a.noOfBands) == 0;
+}
+
+void setUp(){
+  _seed = 1;
+}
+
+void tearDown(){
+}
+
+void test_round_trip(){
+  uint8_t buffer[FRAME_MAX_SIZE];
+  uint8_t levels[FRAME_MAX_BANDS] = {};
+  uint8_t peaks[FRAME_MAX_BANDS] = {};
+
+  for (uint8_t noOfBands : _bandCounts) {
+    FrameEncoder encoder(KEYFRAME_INTERVAL);
+    FrameDecoder decoder;
+    uint16_t sinceKeyframe = 0;
+    uint32_t deltas = 0;
+
+    for (uint32_t f = 0; f < FUZZ_FRAMES; f++) {
+      nextLevels(levels, peaks, noOfBands);
+      size_t length = encoder.encode(levels, peaks, noOfBands, 10, f * 23, f * 23000 + 1, buffer, sizeof(buffer));
+      TEST_ASSERT_TRUE(length >= FRAME_HEADER_SIZE && length <= FRAME_HEADER_SIZE + noOfBands * 2u);
+
+      TEST_ASSERT_EQUAL(FRAME_DECODED, decoder.decode(buffer, length));
+      const SpectrumFrame& frame = decoder.getFrame();
+      assertFrame(frame, levels, peaks, noOfBands, 10);
+      TEST_ASSERT_EQUAL_UINT32(f, frame.sequence);
+      TEST_ASSERT_EQUAL_UINT32(f * 23, frame.timestamp);
+      TEST_ASSERT_EQUAL_UINT32(f * 23000 + 1, frame.presentation);
+
+      //a keyframe at least every KEYFRAME_INTERVAL frames
+      FrameHeader header;
+      TEST_ASSERT_TRUE(FrameDecoder::readHeader(buffer, length, &header));
+      sinceKeyframe = (header.flags & FRAME_FLAG_KEYFRAME) ? 0 : sinceKeyframe + 1;
+      deltas += sinceKeyframe > 0;
+      TEST_ASSERT_LESS_THAN(KEYFRAME_INTERVAL, sinceKeyframe);
+    }
+    TEST_ASSERT_GREATER_THAN(0, deltas); //the levels change slowly enough for delta frames
+  }
+}
+
+//a delta is only sent when it is smaller than the values themselves
+void test_keyframe_fallback(){
+  uint8_t buffer[FRAME_MAX_SIZE];
+  uint8_t levels[32] = {};
+  uint8_t peaks[32] = {};
+  FrameEncoder encoder(KEYFRAME_INTERVAL);
+  FrameDecoder decoder;
+  FrameHeader header;
+
+  size_t length = encoder.encode(levels, peaks, 32, 10, 0, 0, buffer, sizeof(buffer));
+  TEST_ASSERT_TRUE(FrameDecoder::readHeader(buffer, length, &header));
+  TEST_ASSERT_TRUE(header.flags & FRAME_FLAG_KEYFRAME); //the first frame has no base
+  TEST_ASSERT_EQUAL(FRAME_DECODED, decoder.decode(buffer, length));
+
+  //unchanged: a delta of one token per 128 values
+  length = encoder.encode(levels, peaks, 32, 10, 0, 0, buffer, sizeof(buffer));
+  TEST_ASSERT_TRUE(FrameDecoder::readHeader(buffer, length, &header));
+  TEST_ASSERT_FALSE(header.flags & FRAME_FLAG_KEYFRAME);
+  TEST_ASSERT_EQUAL(FRAME_HEADER_SIZE + 1, length);
+  TEST_ASSERT_EQUAL(FRAME_DECODED, decoder.decode(buffer, length));
+
+  //every value jumps: the literal runs would be larger than a keyframe
+  for (uint8_t b = 0; b < 32; b++) {
+    levels[b] = 200 - b;
+    peaks[b] = 9;
+  }
+  length = encoder.encode(levels, peaks, 32, 10, 0, 0, buffer, sizeof(buffer));
+  TEST_ASSERT_TRUE(FrameDecoder::readHeader(buffer, length, &header));
+  TEST_ASSERT_TRUE(header.flags & FRAME_FLAG_KEYFRAME);
+  TEST_ASSERT_EQUAL(FRAME_HEADER_SIZE + 64, length);
+  TEST_ASSERT_EQUAL(FRAME_DECODED, decoder.decode(buffer, length));
+  assertFrame(decoder.getFrame(), levels, peaks, 32, 10);
+
+  //a new matrix size and a requested keyframe both start again from a keyframe
+  length = encoder.encode(levels, peaks, 32, 16, 0, 0, buffer, sizeof(buffer));
+  TEST_ASSERT_TRUE(FrameDecoder::readHeader(buffer, length, &header));
+  TEST_ASSERT_TRUE(header.flags & FRAME_FLAG_KEYFRAME);
+  TEST_ASSERT_EQUAL(FRAME_DECODED, decoder.decode(buffer, length));
+
+  encoder.requestKeyframe();
+  length = encoder.encode(levels, peaks, 32, 16, 0, 0, buffer, sizeof(buffer));
+  TEST_ASSERT_TRUE(FrameDecoder::readHeader(buffer, length, &header));
+  TEST_ASSERT_TRUE(header.flags & FRAME_FLAG_KEYFRAME);
+  TEST_ASSERT_EQUAL(FRAME_DECODED, decoder.decode(buffer, length));
+
+  //too small a buffer is refused rather than overrun
+  TEST_ASSERT_EQUAL(0, encoder.encode(levels, peaks, 32, 16, 0, 0, buffer, FRAME_HEADER_SIZE + 63));
+}
+
+//a delta needs the frame before it; decoding starts again at the next keyframe
+void test_missing_base(){
+  uint8_t frames[3][FRAME_MAX_SIZE];
+  size_t lengths[3];
+  uint8_t levels[10] = {};
+  uint8_t peaks[10] = {};
+  FrameEncoder encoder(KEYFRAME_INTERVAL);
+
+  for (uint8_t f = 0; f < 3; f++) {
+    levels[f] = 5;
+    lengths[f] = encoder.encode(levels, peaks, 10, 10, f, 0, frames[f], FRAME_MAX_SIZE);
+  }
+  encoder.requestKeyframe();
+  uint8_t keyframe[FRAME_MAX_SIZE];
+  size_t keyframeLength = encoder.encode(levels, peaks, 10, 10, 3, 0, keyframe, sizeof(keyframe));
+
+  FrameDecoder decoder;
+  TEST_ASSERT_EQUAL(FRAME_MISSING_BASE, decoder.decode(frames[1], lengths[1])); //nothing decoded yet
+  TEST_ASSERT_EQUAL(FRAME_DECODED, decoder.decode(frames[0], lengths[0]));
+  TEST_ASSERT_EQUAL(FRAME_MISSING_BASE, decoder.decode(frames[2], lengths[2])); //frame 1 was lost
+  TEST_ASSERT_EQUAL(FRAME_DECODED, decoder.decode(keyframe, keyframeLength));
+  assertFrame(decoder.getFrame(), levels, peaks, 10, 10);
+}
+
+//every truncation of a frame is rejected and leaves the last frame as it was
+void test_truncated_frames(){
+  uint8_t buffer[FRAME_MAX_SIZE];
+  uint8_t levels[FRAME_MAX_BANDS] = {};
+  uint8_t peaks[FRAME_MAX_BANDS] = {};
+
+  for (uint8_t noOfBands : _bandCounts) {
+    FrameEncoder encoder(KEYFRAME_INTERVAL);
+    FrameDecoder decoder;
+
+    for (uint32_t f = 0; f < 200; f++) {
+      nextLevels(levels, peaks, noOfBands);
+      size_t length = encoder.encode(levels, peaks, noOfBands, 10, f, 0, buffer, sizeof(buffer));
+
+      SpectrumFrame before = decoder.getFrame();
+      for (size_t cut = 0; cut < length; cut++) {
+        TEST_ASSERT_TRUE(decoder.decode(buffer, cut) != FRAME_DECODED);
+        TEST_ASSERT_TRUE(sameFrame(before, decoder.getFrame()));
+      }
+      TEST_ASSERT_EQUAL(FRAME_DECODED, decoder.decode(buffer, length));
+    }
+  }
+}
+
+//random corruption never reads or writes out of bounds (run under the sanitizers to be sure), and a rejected frame leaves the last frame as it was
+void test_corrupted_frames(){
+  uint8_t buffer[FRAME_MAX_SIZE];
+  uint8_t corrupted[FRAME_MAX_SIZE];
+  uint8_t levels[FRAME_MAX_BANDS] = {};
+  uint8_t peaks[FRAME_MAX_BANDS] = {};
+  FrameEncoder encoder(KEYFRAME_INTERVAL);
+  FrameDecoder decoder;
+  FrameDecoder reference;
+  uint32_t rejected = 0;
+
+  for (uint32_t m = 0; m < FUZZ_MUTATIONS; m++) {
+    uint8_t noOfBands = _bandCounts[m / 1000 % sizeof(_bandCounts)];
+    nextLevels(levels, peaks, noOfBands);
+    size_t length = encoder.encode(levels, peaks, noOfBands, 10, m, 0, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL(FRAME_DECODED, reference.decode(buffer, length));
+
+    //flip a few bytes of the payload, or of the header now and then
+    memcpy(corrupted, buffer, length);
+    uint8_t flips = 1 + nextRandom() % 3;
+    for (uint8_t i = 0; i < flips; i++) {
+      uint32_t r = nextRandom();
+      size_t position = r % 8 == 0 ? r % FRAME_HEADER_SIZE : FRAME_HEADER_SIZE + r % (length - FRAME_HEADER_SIZE);
+      corrupted[position] ^= 1 << ((r >> 8) % 8);
+    }
+
+    SpectrumFrame before = decoder.getFrame();
+    if(decoder.decode(corrupted, length) != FRAME_DECODED){
+      rejected++;
+      TEST_ASSERT_TRUE(sameFrame(before, decoder.getFrame()));
+    }
+
+    //resynchronise with the sender, as the receiver does at the next keyframe
+    decoder = reference;
+  }
+  TEST_ASSERT_GREATER_THAN(0, rejected);
+}
+
+//version 2 frames (without the presentation time) still decode
+void test_version_2_frames(){
+  uint8_t buffer[FRAME_MAX_SIZE];
+  uint8_t levels[3] = {10, 20, 30};
+  uint8_t peaks[3] = {1, 2, 3};
+  FrameEncoder encoder(KEYFRAME_INTERVAL);
+  size_t length = encoder.encode(levels, peaks, 3, 10, 7, 99, buffer, sizeof(buffer));
+
+  buffer[4] = 2;
+  memmove(buffer + FRAME_V2_HEADER_SIZE, buffer + FRAME_HEADER_SIZE, length - FRAME_HEADER_SIZE);
+  length -= FRAME_HEADER_SIZE - FRAME_V2_HEADER_SIZE;
+
+  FrameDecoder decoder;
+  TEST_ASSERT_EQUAL(FRAME_DECODED, decoder.decode(buffer, length));
+  assertFrame(decoder.getFrame(), levels, peaks, 3, 10);
+  TEST_ASSERT_EQUAL_UINT32(7, decoder.getFrame().timestamp);
+  TEST_ASSERT_EQUAL_UINT32(0, decoder.getFrame().presentation);
+}
+
+void setup(){
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_keyframe_fallback);
+  RUN_TEST(test_missing_base);
+  RUN_TEST(test_truncated_frames);
+  RUN_TEST(test_corrupted_frames);
+  RUN_TEST(test_version_2_frames);
+  exit(UNITY_END());
+}
+
+void loop(){
+}
@@ -0,0 +1,240 @@
+//Runs program material through the analyzer and the level quantizer as the display does, and checks the timing of the AGC and that digital
+//silence lights no row (the native-test environment in platformio.ini).
+//
+//usage: pio test -e native-test -f test_level_quantizer
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+#include "Analyzer.h"
+#include "LevelQuantizer.h"
+#include "SimAudio.h"
+
+#define WAV_PATH "test_level_quantizer.wav" //written in the working directory and removed at the end
+#define WAV_RATE 44100
+#define NO_OF_ROWS 10
+#define QUIET_GAIN 0.04f //program level before and after the burst
+#define LOUD_GAIN 0.4f //program level of the burst, 20 dB louder
+
+//sections of the recording (s)
+#define BURST_START 4.0
+#define BURST_END 6.0
+#define SILENCE_START 10.0
+#define WAV_SECONDS 30.0 //the silence is long enough for the AGC to fall from the program to a floor of 1
+
+static unsigned short _bandTable[] = {100, 250, 500, 750, 1000, 2000, 4000, 6000, 8000, 10000}; //_bandTable of main.cpp
+#define NO_OF_BANDS (sizeof(_bandTable) / sizeof(_bandTable[0]))
+
+static AnalyzerMemory _memory;
+
+//AGC reference and rows of each frame
+struct QuantizedFrame{
+  double time; //end of the frame (s)
+  float referenceDb;
+  uint8_t rows[NO_OF_BANDS];
+};
+
+//program-like material: a bass line and a few chords with a pulsing envelope, over a little noise, peaking at about 1
+static float program(double t, uint32_t* noise){
+  static const float notes[4][3] = { {220.0f, 277.2f, 329.6f}, {196.0f, 246.9f, 293.7f}, {174.6f, 220.0f, 261.6f}, {196.0f, 246.9f, 311.1f} };
+  const float* chord = notes[(int)(t / 0.5) % 4];
+  float beat = fmod(t, 0.25) / 0.25;
+  float envelope = 0.5f + 0.5f * expf(-6.0f * beat);
+
+  float sample = 0.3f * sinf(TWO_PI * chord[0] / 2 * t) * envelope;
+  for (uint8_t n = 0; n < 3; n++) {
+    sample += 0.15f * sinf(TWO_PI * chord[n] * 2 * t) + 0.05f * sinf(TWO_PI * chord[n] * 8 * t);
+  }
+  *noise ^= *noise << 13;
+  *noise ^= *noise >> 17;
+  *noise ^= *noise << 5;
+  return sample + 0.02f * ((int32_t)*noise / 2147483648.0f);
+}
+
+//writes the recording as a 16 bit mono WAV file
+static bool writeRecording(const char* path){
+  FILE* file = fopen(path, "wb");
+  if(file == nullptr){
+    return false;
+  }
+
+  uint32_t noOfSamples = WAV_SECONDS * WAV_RATE;
+  uint32_t dataLength = noOfSamples * 2;
+  uint8_t header[44] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 1, 0,
+    WAV_RATE & 0xFF, (WAV_RATE >> 8) & 0xFF, 0, 0, (WAV_RATE * 2) & 0xFF, ((WAV_RATE * 2) >> 8) & 0xFF, ((WAV_RATE * 2) >> 16) & 0xFF, 0, 2, 0, 16, 0,
+    'd', 'a', 't', 'a', 0, 0, 0, 0};
+  uint32_t riffLength = 36 + dataLength;
+  memcpy(header + 4, &riffLength, 4);
+  memcpy(header + 40, &dataLength, 4);
+  fwrite(header, 1, sizeof(header), file);
+
+  uint32_t noise = 1;
+  for (uint32_t i = 0; i < noOfSamples; i++) {
+    double t = (double)i / WAV_RATE;
+    float gain = t >= SILENCE_START ? 0.0f : (t >= BURST_START && t < BURST_END ? LOUD_GAIN : QUIET_GAIN);
+    int16_t sample = gain == 0.0f ? 0 : (int16_t)constrain(program(t, &noise) * gain * 32767.0f, -32767.0f, 32767.0f);
+    fwrite(&sample, 2, 1, file);
+  }
+  return fclose(file) == 0;
+}
+
+//analyses the recording in frames hop samples apart and quantizes them, as the frame loop and the display do
+static std::vector<QuantizedFrame> analyse(uint16_t hop, float floor){
+  Analyzer analyzer(&_memory, NO_OF_BANDS, _bandTable);
+  LevelQuantizer quantizer(NO_OF_ROWS);
+  if(floor > 0){
+    quantizer.setFloor(floor);
+  }
+
+  uint32_t samplingFrequency = analyzer.getSamplingFrequency();
+  AudioSource source;
+  TEST_ASSERT_TRUE(source.begin(WAV_PATH, "", 1.0f, samplingFrequency));
+  std::vector<AudioSample> samples(source.getLength());
+  for (AudioSample& sample : samples) {
+    sample = source.nextRaw();
+  }
+
+  std::vector<QuantizedFrame> frames;
+  float bands[MAX_VIEW_BANDS];
+  for (size_t start = 0; start + FFT_SIZE <= samples.size(); start += hop) {
+    analyzer.loadSamples(&samples[start]);
+    analyzer.convertToBands(bands);
+    quantizer.update(bands, NO_OF_BANDS, (float)hop / FFT_SIZE);
+
+    QuantizedFrame frame;
+    frame.time = (double)(start + FFT_SIZE) / samplingFrequency;
+    frame.referenceDb = 20.0f * log10f(quantizer.getReference());
+    for (uint8_t b = 0; b < NO_OF_BANDS; b++) {
+      frame.rows[b] = quantizer.quantize(bands[b]);
+    }
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+//index of the first frame ending at or after the time
+static size_t frameAt(const std::vector<QuantizedFrame>& frames, double time){
+  size_t f = 0;
+  while(f < frames.size() && frames[f].time < time){
+    f++;
+  }
+  return f;
+}
+
+//highest AGC reference of the frames ending between the times (dB)
+static float highestReference(const std::vector<QuantizedFrame>& frames, double from, double to){
+  float highest = -1000.0f;
+  for (size_t f = frameAt(frames, from); f < frames.size() && frames[f].time < to; f++) {
+    highest = max(highest, frames[f].referenceDb);
+  }
+  return highest;
+}
+
+//time from the start of the burst until the AGC reference is within 3 dB of the level of the burst (s)
+static double attackTime(const std::vector<QuantizedFrame>& frames){
+  float burstDb = highestReference(frames, BURST_START, BURST_END);
+  size_t f = frameAt(frames, BURST_START);
+  while(f < frames.size() && frames[f].referenceDb < burstDb - 3.0f){
+    f++;
+  }
+  return frames[f].time - BURST_START;
+}
+
+//fall of the AGC reference per second over the first 2 s after the burst, while the program is well below it (dB/s)
+static double releaseRate(const std::vector<QuantizedFrame>& frames){
+  size_t first = frameAt(frames, BURST_END + 0.1);
+  size_t last = frameAt(frames, BURST_END + 2.1);
+  return (frames[first].referenceDb - frames[last].referenceDb) / (frames[last].time - frames[first].time);
+}
+
+void setUp(){
+}
+
+void tearDown(){
+}
+
+//the reference follows a burst 20 dB louder than the program within a few frames
+void test_attack(){
+  std::vector<QuantizedFrame> frames = analyse(FFT_SIZE, 1);
+  float programDb = highestReference(frames, BURST_START - 1.0, BURST_START);
+  float burstDb = highestReference(frames, BURST_START, BURST_END);
+  TEST_ASSERT_FLOAT_WITHIN(3.0f, 20.0f, burstDb - programDb);
+
+  //AGC_ATTACK closes 60% of the gap per frame: 3 dB of a 20 dB gap are left after 3 frames, plus the frame the burst starts in
+  double frameSeconds = (double)FFT_SIZE / WAV_RATE;
+  TEST_ASSERT_LESS_OR_EQUAL(5 * frameSeconds, attackTime(frames));
+}
+
+//after the burst the reference falls by AGC_RELEASE_DB per frame, about 6.5 dB a second
+void test_release(){
+  std::vector<QuantizedFrame> frames = analyse(FFT_SIZE, 1);
+  double frameSeconds = (double)FFT_SIZE / WAV_RATE;
+  TEST_ASSERT_FLOAT_WITHIN(0.05, AGC_RELEASE_DB / frameSeconds, releaseRate(frames));
+
+  //the program is shown on the full matrix again once the reference has come down to it
+  float programDb = highestReference(frames, BURST_START - 1.0, BURST_START);
+  TEST_ASSERT_FLOAT_WITHIN(1.5f, programDb, highestReference(frames, SILENCE_START - 1.0, SILENCE_START));
+}
+
+//the timing is set per second, so overlapping frames (twice the frame rate) attack and release as fast
+void test_timing_with_overlapping_frames(){
+  std::vector<QuantizedFrame> frames = analyse(FFT_SIZE, 1);
+  std::vector<QuantizedFrame> overlapping = analyse(FFT_SIZE / 2, 1);
+
+  double frameSeconds = (double)FFT_SIZE / WAV_RATE;
+  TEST_ASSERT_FLOAT_WITHIN(frameSeconds, attackTime(frames), attackTime(overlapping));
+  TEST_ASSERT_FLOAT_WITHIN(0.05, releaseRate(frames), releaseRate(overlapping));
+}
+
+//digital silence lights no row, with the default floor and with a floor so low that the lower rows work out to a threshold below 1
+void test_silence(){
+  std::vector<QuantizedFrame> frames = analyse(FFT_SIZE, 0);
+  std::vector<QuantizedFrame> lowFloor = analyse(FFT_SIZE, 1);
+  size_t silence = frameAt(frames, SILENCE_START + (double)FFT_SIZE / WAV_RATE); //first frame without any of the program
+
+  for (size_t f = silence; f < frames.size(); f++) {
+    for (uint8_t b = 0; b < NO_OF_BANDS; b++) {
+      TEST_ASSERT_EQUAL_UINT8(0, frames[f].rows[b]);
+      TEST_ASSERT_EQUAL_UINT8(0, lowFloor[f].rows[b]);
+    }
+  }
+
+  //the reference ends at each floor
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 100.0f, frames.back().referenceDb);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, lowFloor.back().referenceDb);
+}
+
+//bands of 0 and below light no row, however low the reference
+void test_quantize_at_floor(){
+  LevelQuantizer quantizer(NO_OF_ROWS);
+  quantizer.setFloor(1);
+  float bands[NO_OF_BANDS] = {};
+  for (uint16_t f = 0; f < 1000; f++) {
+    quantizer.update(bands, NO_OF_BANDS, 1.0f);
+  }
+
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.0f, quantizer.getReference());
+  TEST_ASSERT_EQUAL_UINT8(0, quantizer.quantize(0.0f));
+  TEST_ASSERT_EQUAL_UINT8(0, quantizer.quantize(-3.0f));
+  TEST_ASSERT_EQUAL_UINT8(0, quantizer.quantize(0.5f));
+  TEST_ASSERT_EQUAL_UINT8(NO_OF_ROWS, quantizer.quantize(1.0f));
+}
+
+void setup(){
+  UNITY_BEGIN();
+  if(!writeRecording(WAV_PATH)){
+    TEST_MESSAGE("Unable to write " WAV_PATH);
+    exit(UNITY_END() + 1);
+  }
+
+  RUN_TEST(test_attack);
+  RUN_TEST(test_release);
+  RUN_TEST(test_timing_with_overlapping_frames);
+  RUN_TEST(test_silence);
+  RUN_TEST(test_quantize_at_floor);
+
+  remove(WAV_PATH);
+  exit(UNITY_END());
+}
+
+void loop(){
+}
@@ -0,0 +1,312 @@
+//Renders /metrics and checks it against the Prometheus text exposition format: HELP and TYPE lines before the samples of each metric,
+//metric and label names, quoted and escaped label values, histogram buckets, and the line feed at the end (the native-test environment
+//in platformio.ini).
+//
+//usage: pio test -e native-test -f test_metrics
+#include <Arduino.h>
+#include <unity.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "Metrics.h"
+
+#define FRAME_MICROS 23220 //interval of the recorded frames
+#define NO_OF_FRAMES 500
+#define NO_OF_WEB_REQUESTS 7
+
+//collects what is printed to it
+class TextPrint : public Print {
+  public:
+    std::string text;
+    size_t write(uint8_t value) override { this->text += (char)value; return 1; }
+    size_t write(const uint8_t* buffer, size_t size) override { this->text.append((const char*)buffer, size); return size; }
+};
+
+//a sample line: name{labels} value
+struct Sample{
+  std::string name;
+  std::map<std::string, std::string> labels; //unescaped values
+  double value;
+};
+
+static Metrics* _metrics;
+static std::string _exposition;
+
+static bool isMetricName(const std::string& name){
+  if(name.empty() || !(isalpha(name[0]) || name[0] == '_' || name[0] == ':')){
+    return false;
+  }
+  for (char c : name) {
+    if(!(isalnum(c) || c == '_' || c == ':')){
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool isLabelName(const std::string& name){
+  return !name.empty() && name.find(':') == std::string::npos && isMetricName(name) && name.compare(0, 2, "__") != 0;
+}
+
+static std::vector<std::string> splitLines(const std::string& text){
+  std::vector<std::string> lines;
+  size_t start = 0;
+  for (size_t end = text.find('\n'); end != std::string::npos; end = text.find('\n', start)) {
+    lines.push_back(text.substr(start, end - start));
+    start = end + 1;
+  }
+  return lines;
+}
+
+//parses a sample line. Returns false (with the reason in error) if it is not valid.
+static bool parseSample(const std::string& line, Sample* sample, std::string* error){
+  size_t position = 0;
+  while(position < line.size() && line[position] != '{' && line[position] != ' '){
+    position++;
+  }
+  sample->name = line.substr(0, position);
+  if(!isMetricName(sample->name)){
+    *error = "bad metric name";
+    return false;
+  }
+
+  if(position < line.size() && line[position] == '{'){
+    position++;
+    while(position < line.size() && line[position] != '}'){
+      size_t equals = line.find('=', position);
+      if(equals == std::string::npos || equals + 1 >= line.size() || line[equals + 1] != '"'){
+        *error = "label value not quoted";
+        return false;
+      }
+      std::string labelName = line.substr(position, equals - position);
+      if(!isLabelName(labelName) || sample->labels.count(labelName) > 0){
+        *error = "bad or repeated label name";
+        return false;
+      }
+
+      //the value runs to the next quote that is not escaped; only \\, \" and \n may be escaped
+      std::string value;
+      position = equals + 2;
+      while(position < line.size() && line[position] != '"'){
+        if(line[position] == '\\'){
+          char escaped = position + 1 < line.size() ? line[position + 1] : '\0';
+          if(escaped != '\\' && escaped != '"' && escaped != 'n'){
+            *error = "bad escape in label value";
+            return false;
+          }
+          value += escaped == 'n' ? '\n' : escaped;
+          position += 2;
+        }else{
+          value += line[position++];
+        }
+      }
+      if(position >= line.size()){
+        *error = "label value not closed";
+        return false;
+      }
+      sample->labels[labelName] = value;
+      position++;
+
+      if(position < line.size() && line[position] == ','){
+        position++;
+      }
+    }
+    if(position >= line.size()){
+      *error = "labels not closed";
+      return false;
+    }
+    position++;
+  }
+
+  if(position >= line.size() || line[position] != ' '){
+    *error = "no value";
+    return false;
+  }
+  std::string value = line.substr(position + 1);
+  char* end;
+  sample->value = value == "+Inf" ? INFINITY : strtod(value.c_str(), &end);
+  if(value != "+Inf" && (value.empty() || *end != '\0')){
+    *error = "bad value";
+    return false;
+  }
+  return true;
+}
+
+//metric a sample belongs to: its name, or the name of the histogram for its _bucket, _sum and _count samples
+static std::string familyOf(const std::string& name, const std::map<std::string, std::string>& types){
+  static const char* suffixes[] = {"_bucket", "_sum", "_count"};
+  for (const char* suffix : suffixes) {
+    size_t length = strlen(suffix);
+    if(name.size() > length && name.compare(name.size() - length, length, suffix) == 0){
+      std::string family = name.substr(0, name.size() - length);
+      auto type = types.find(family);
+      if(type != types.end() && type->second == "histogram"){
+        return family;
+      }
+    }
+  }
+  return name;
+}
+
+static void render(){
+  TextPrint out;
+  _metrics->writePrometheus(out);
+  _exposition = out.text;
+}
+
+void setUp(){
+  render();
+}
+
+void tearDown(){
+}
+
+void test_ends_with_line_feed(){
+  TEST_ASSERT_FALSE(_exposition.empty());
+  TEST_ASSERT_EQUAL('\n', _exposition.back());
+  TEST_ASSERT_TRUE(_exposition.find('\r') == std::string::npos);
+  TEST_ASSERT_TRUE(_exposition.find("\n\n") == std::string::npos);
+}
+
+//every metric has one HELP and one TYPE line, in that order, before its samples, and its samples are not split up by other metrics
+void test_help_and_type_lines(){
+  std::map<std::string, std::string> types;
+  std::set<std::string> helped;
+  std::set<std::string> finished;
+  std::string current;
+
+  for (const std::string& line : splitLines(_exposition)) {
+    if(line.compare(0, 7, "# HELP ") == 0){
+      std::string name = line.substr(7, line.find(' ', 7) - 7);
+      TEST_ASSERT_TRUE_MESSAGE(isMetricName(name), line.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(helped.insert(name).second, line.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(line.size() > 8 + name.size(), line.c_str()); //a HELP line has text
+      if(!current.empty()){
+        finished.insert(current);
+      }
+      current = name;
+    }else if(line.compare(0, 7, "# TYPE ") == 0){
+      size_t space = line.find(' ', 7);
+      std::string name = line.substr(7, space - 7);
+      std::string type = space == std::string::npos ? "" : line.substr(space + 1);
+      TEST_ASSERT_TRUE_MESSAGE(name == current && types.count(name) == 0, line.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(type == "counter" || type == "gauge" || type == "histogram", line.c_str());
+      types[name] = type;
+    }else{
+      TEST_ASSERT_TRUE_MESSAGE(line[0] != '#', line.c_str());
+      Sample sample;
+      std::string error;
+      TEST_ASSERT_TRUE_MESSAGE(parseSample(line, &sample, &error), (error + ": " + line).c_str());
+
+      std::string family = familyOf(sample.name, types);
+      TEST_ASSERT_TRUE_MESSAGE(family == current && types.count(family) == 1, line.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(finished.count(family) == 0, line.c_str());
+      if(types[family] == "counter"){
+        TEST_ASSERT_TRUE_MESSAGE(sample.name.size() > 6 && sample.name.compare(sample.name.size() - 6, 6, "_total") == 0, line.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(sample.value >= 0, line.c_str());
+      }
+    }
+  }
+  TEST_ASSERT_EQUAL(helped.size(), types.size());
+}
+
+//the buckets are cumulative, in ascending order of their le label, and end with +Inf, which matches the count
+void test_histogram(){
+  double previousBound = -1;
+  double previousCount = -1;
+  double infinity = -1;
+  double count = -1;
+  uint8_t buckets = 0;
+
+  for (const std::string& line : splitLines(_exposition)) {
+    Sample sample;
+    std::string error;
+    if(line[0] == '#' || !parseSample(line, &sample, &error)){
+      continue;
+    }
+
+    if(sample.name == "sad_frame_jitter_us_bucket"){
+      TEST_ASSERT_EQUAL(1, sample.labels.count("le"));
+      std::string le = sample.labels["le"];
+      double bound = le == "+Inf" ? INFINITY : atof(le.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(bound > previousBound, line.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(sample.value >= previousCount, line.c_str());
+      previousBound = bound;
+      previousCount = sample.value;
+      infinity = le == "+Inf" ? sample.value : infinity;
+      buckets++;
+    }else if(sample.name == "sad_frame_jitter_us_count"){
+      count = sample.value;
+    }
+  }
+
+  TEST_ASSERT_EQUAL(JITTER_BUCKETS, buckets);
+  TEST_ASSERT_TRUE(std::isinf(previousBound));
+  TEST_ASSERT_EQUAL(NO_OF_FRAMES - 1, count); //the first frame has no interval
+  TEST_ASSERT_EQUAL(count, infinity);
+}
+
+//the values are the counts recorded
+void test_values(){
+  std::map<std::string, double> values;
+  for (const std::string& line : splitLines(_exposition)) {
+    Sample sample;
+    std::string error;
+    if(line[0] != '#' && parseSample(line, &sample, &error) && sample.labels.empty()){
+      values[sample.name] = sample.value;
+    }
+  }
+
+  TEST_ASSERT_EQUAL(NO_OF_FRAMES, values["sad_frames_processed_total"]);
+  TEST_ASSERT_EQUAL(NO_OF_WEB_REQUESTS, values["sad_web_requests_total"]);
+  TEST_ASSERT_EQUAL(1, values["sad_web_over_budget_total"]);
+  TEST_ASSERT_EQUAL(WEB_HANDLER_BUDGET_US + 1, values["sad_web_handler_max_us"]);
+}
+
+//names that need escaping come out escaped (the task labels are only written in ALLOC_GUARD builds)
+void test_label_escaping(){
+  if(!AllocGuard::isEnabled()){
+    TEST_MESSAGE("no task labels without ALLOC_GUARD");
+    return;
+  }
+
+  bool found = false;
+  for (const std::string& line : splitLines(_exposition)) {
+    Sample sample;
+    std::string error;
+    if(line.compare(0, 26, "sad_task_allocations_total") == 0){
+      TEST_ASSERT_TRUE_MESSAGE(parseSample(line, &sample, &error), (error + ": " + line).c_str());
+      found = found || sample.labels["task"] == "test \"task\"\\1\n";
+    }
+  }
+  TEST_ASSERT_TRUE(found);
+}
+
+void setup(){
+  _metrics = new Metrics();
+  _metrics->setJsonArenas(new JsonArena(1024), new JsonArena(1024));
+  AllocGuard::watchTask("test \"task\"\\1\n");
+
+  //frames with some jitter, and a few web requests, one over budget
+  int64_t frameTime = 1000000;
+  for (uint16_t f = 0; f < NO_OF_FRAMES; f++) {
+    frameTime += FRAME_MICROS + (f % 7 == 0 ? 3000 : 0) - (f % 11 == 0 ? 400 : 0);
+    _metrics->recordFrame(frameTime);
+  }
+  for (uint8_t r = 0; r < NO_OF_WEB_REQUESTS; r++) {
+    _metrics->countWebRequest();
+    _metrics->recordWebHandler(r == 0 ? WEB_HANDLER_BUDGET_US + 1 : 100);
+  }
+
+  UNITY_BEGIN();
+  RUN_TEST(test_ends_with_line_feed);
+  RUN_TEST(test_help_and_type_lines);
+  RUN_TEST(test_histogram);
+  RUN_TEST(test_values);
+  RUN_TEST(test_label_escaping);
+  exit(UNITY_END());
+}
+
+void loop(){
+}
@@ -0,0 +1,144 @@
+//Admission of web requests: the burst and sustained rate of a client, the connection cap, and the shedding of a route that keeps going
+//over the handler budget (the native-test environment in platformio.ini).
+//
+//usage: pio test -e native-test -f test_request_guard
+#include <Arduino.h>
+#include <unity.h>
+#include "RequestGuard.h"
+
+#define CLIENT 0x0100007F //127.0.0.1
+#define OTHER_CLIENT 0x0200007F //127.0.0.2
+#define OVER_BUDGET (WEB_HANDLER_BUDGET_US + 1)
+
+static RequestGuard* _guard;
+static uint32_t _route;
+static uint32_t _otherRoute;
+
+//admits a request and releases it at once, as a handler that is done straight away
+static RequestVerdict serve(uint32_t address, uint32_t route, unsigned long now){
+  RequestVerdict verdict = _guard->admit(address, route, now);
+  if(verdict == REQUEST_ADMITTED){
+    _guard->release();
+  }
+  return verdict;
+}
+
+//runs the handler of the route over budget until the route is shed. Returns the number of handlers that ran.
+static uint8_t overrun(uint32_t route, unsigned long now){
+  for (uint8_t n = 1; n <= WEB_SHED_OVERRUNS; n++) {
+    TEST_ASSERT_EQUAL(REQUEST_ADMITTED, serve(CLIENT, route, now));
+    _guard->recordCost(route, OVER_BUDGET, now);
+    if(_guard->admit(CLIENT, route, now) == REQUEST_SHED){
+      return n;
+    }
+    _guard->release();
+  }
+  return 0;
+}
+
+void setUp(){
+  _guard = new RequestGuard();
+  _route = RequestGuard::routeOf(HTTP_GET, "/config");
+  _otherRoute = RequestGuard::routeOf(HTTP_GET, "/metrics");
+}
+
+void tearDown(){
+  delete _guard;
+}
+
+void test_routes(){
+  TEST_ASSERT_NOT_EQUAL(_route, _otherRoute);
+  TEST_ASSERT_NOT_EQUAL(_route, RequestGuard::routeOf(HTTP_POST, "/config"));
+  TEST_ASSERT_EQUAL(_route, RequestGuard::routeOf(HTTP_GET, "/config"));
+}
+
+void test_burst_and_rate(){
+  for (uint8_t n = 0; n < WEB_RATE_BURST; n++) {
+    TEST_ASSERT_EQUAL(REQUEST_ADMITTED, serve(CLIENT, _route, 1000));
+  }
+  TEST_ASSERT_EQUAL(REQUEST_RATE_LIMITED, serve(CLIENT, _route, 1000));
+  TEST_ASSERT_EQUAL(REQUEST_ADMITTED, serve(OTHER_CLIENT, _route, 1000)); //every client has its own bucket
+
+  //the bucket refills at WEB_RATE_PER_SECOND
+  unsigned long now = 1000;
+  uint32_t admitted = 0;
+  for (uint16_t n = 0; n < 1000; n++) {
+    now += 10;
+    admitted += serve(CLIENT, _route, now) == REQUEST_ADMITTED;
+  }
+  TEST_ASSERT_UINT32_WITHIN(1, WEB_RATE_PER_SECOND * 10, admitted);
+}
+
+void test_connection_cap(){
+  for (uint8_t n = 0; n < WEB_MAX_REQUESTS; n++) {
+    TEST_ASSERT_EQUAL(REQUEST_ADMITTED, _guard->admit(CLIENT, _route, 1000));
+  }
+  TEST_ASSERT_EQUAL(REQUEST_BUSY, _guard->admit(OTHER_CLIENT, _route, 1000));
+  TEST_ASSERT_EQUAL(WEB_MAX_REQUESTS, _guard->getInFlight());
+
+  _guard->release();
+  TEST_ASSERT_EQUAL(REQUEST_ADMITTED, _guard->admit(OTHER_CLIENT, _route, 1000));
+}
+
+void test_shed_after_overruns(){
+  TEST_ASSERT_EQUAL(WEB_SHED_OVERRUNS, overrun(_route, 1000));
+  TEST_ASSERT_EQUAL(WEB_SHED_MS / 1000, _guard->getRetryAfter(_route, 1000));
+  TEST_ASSERT_EQUAL(REQUEST_ADMITTED, serve(CLIENT, _otherRoute, 1000)); //other routes are still served
+
+  TEST_ASSERT_EQUAL(REQUEST_SHED, serve(CLIENT, _route, 1000 + WEB_SHED_MS - 1));
+  TEST_ASSERT_EQUAL(REQUEST_ADMITTED, serve(CLIENT, _route, 1000 + WEB_SHED_MS));
+}
+
+void test_within_budget_clears_overruns(){
+  for (uint8_t n = 0; n < WEB_SHED_OVERRUNS * 3; n++) {
+    TEST_ASSERT_EQUAL(REQUEST_ADMITTED, serve(CLIENT, _route, 1000 + n * 200));
+    _guard->recordCost(_route, n % WEB_SHED_OVERRUNS == 0 ? WEB_HANDLER_BUDGET_US : OVER_BUDGET, 1000 + n * 200);
+  }
+  TEST_ASSERT_EQUAL(REQUEST_ADMITTED, serve(CLIENT, _route, 3000));
+}
+
+void test_backoff_doubles(){
+  unsigned long now = 1000;
+  unsigned long shedMillis = WEB_SHED_MS;
+  TEST_ASSERT_EQUAL(WEB_SHED_OVERRUNS, overrun(_route, now));
+
+  //each time the route goes over budget again right after its shed, it is shed for twice as long, up to the longest shed
+  for (uint8_t n = 0; n < WEB_SHED_MAX_DOUBLINGS + 2; n++) {
+    now += shedMillis;
+    TEST_ASSERT_EQUAL(1, overrun(_route, now));
+    shedMillis = min(shedMillis * 2, (unsigned long)WEB_SHED_MS << WEB_SHED_MAX_DOUBLINGS);
+    TEST_ASSERT_EQUAL(shedMillis / 1000, _guard->getRetryAfter(_route, now));
+    TEST_ASSERT_EQUAL(REQUEST_SHED, serve(CLIENT, _route, now + shedMillis - 1));
+  }
+
+  //a handler within budget ends the backoff
+  now += shedMillis;
+  TEST_ASSERT_EQUAL(REQUEST_ADMITTED, serve(CLIENT, _route, now));
+  _guard->recordCost(_route, WEB_HANDLER_BUDGET_US, now);
+  TEST_ASSERT_EQUAL(WEB_SHED_OVERRUNS, overrun(_route, now + 10000));
+  TEST_ASSERT_EQUAL(WEB_SHED_MS / 1000, _guard->getRetryAfter(_route, now + 10000));
+}
+
+void test_shed_is_not_charged(){
+  overrun(_route, 1000);
+  for (uint8_t n = 0; n < WEB_RATE_BURST * 2; n++) {
+    TEST_ASSERT_EQUAL(REQUEST_SHED, _guard->admit(OTHER_CLIENT, _route, 1000));
+  }
+  TEST_ASSERT_EQUAL(0, _guard->getInFlight());
+  TEST_ASSERT_EQUAL(REQUEST_ADMITTED, serve(OTHER_CLIENT, _otherRoute, 1000));
+}
+
+void setup(){
+  UNITY_BEGIN();
+  RUN_TEST(test_routes);
+  RUN_TEST(test_burst_and_rate);
+  RUN_TEST(test_connection_cap);
+  RUN_TEST(test_shed_after_overruns);
+  RUN_TEST(test_within_budget_clears_overruns);
+  RUN_TEST(test_backoff_doubles);
+  RUN_TEST(test_shed_is_not_charged);
+  exit(UNITY_END());
+}
+
+void loop(){
+}
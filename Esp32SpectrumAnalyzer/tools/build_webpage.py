@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+# Minifies and gzips the web portal (src/index.html) into src/WebPage.h, together with a strong ETag of the compressed page.
+#
+# Runs before every PlatformIO build (see extra_scripts in platformio.ini), or by hand after editing index.html:
+#     python3 tools/build_webpage.py
+#
+# WebPage.h is only rewritten when the page changes, so an unchanged page does not trigger a rebuild.
+
+import gzip
+import hashlib
+import os
+import re
+
+BYTES_PER_LINE = 20
+
+
+def minify(html):
+    html = re.sub(r'<!--.*?-->', '', html, flags=re.S)
+    lines = []
+    for line in html.splitlines():
+        line = re.sub(r'^\s*//.*$', '', line)  # whole line script comments
+        line = re.sub(r'\s+//[^\'"`]*$', '', line)  # trailing script comments (not when quotes follow, eg. URLs in strings)
+        line = line.strip()
+        if line:
+            lines.append(line)
+    return '\n'.join(lines)  # line breaks are kept, so statements without semicolons still work
+
+
+def build(project_dir):
+    source = os.path.join(project_dir, 'src', 'index.html')
+    target = os.path.join(project_dir, 'src', 'WebPage.h')
+
+    with open(source, encoding='utf-8') as f:
+        html = f.read()
+
+    minified = minify(html).encode('utf-8')
+    compressed = gzip.compress(minified, compresslevel=9, mtime=0)  # no timestamp, so the same page always gives the same bytes and ETag
+    etag = hashlib.sha256(compressed).hexdigest()[:16]
+
+    lines = [
+        '//web page for the spectrum analyzer display, minified and gzip compressed.',
+        '//generated from index.html by tools/build_webpage.py before every build. Edit index.html instead of this file.',
+        '#ifndef WebPage_h',
+        '#define WebPage_h',
+        '',
+        '#include "Common.h"',
+        '',
+        '#define WEB_PAGE_ETAG "\\"%s\\"" //strong ETag of the compressed page' % etag,
+        '',
+        'const size_t g_webPageLength = %d; //compressed size (%d bytes uncompressed, %d bytes minified)' % (len(compressed), len(html.encode('utf-8')), len(minified)),
+        'const uint8_t g_webPage[] PROGMEM = {',
+    ]
+    for i in range(0, len(compressed), BYTES_PER_LINE):
+        lines.append('  ' + ', '.join('0x%02x' % b for b in compressed[i:i + BYTES_PER_LINE]) + ',')
+    lines += ['};', '', '#endif', '']
+    header = '\n'.join(lines)
+
+    if os.path.exists(target):
+        with open(target, encoding='utf-8') as f:
+            if f.read() == header:
+                return
+
+    with open(target, 'w', encoding='utf-8') as f:
+        f.write(header)
+    print('Web page: %d bytes, %d minified, %d compressed -> %s' % (len(html), len(minified), len(compressed), target))
+
+
+if __name__ == '__main__':
+    build(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+else:
+    Import('env')  # noqa: F821 (provided by PlatformIO)
+
+    build(env.subst('$PROJECT_DIR'))  # noqa: F821
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+# Client and server side of the display nodes' clock sync protocol (see src/ClockSync.h), shared by the frame tools.
+# A client sends requests stamped with its clock, the server answers with its clock when the request arrived and when
+# the response left. The offset and drift of the server clock are fitted over the exchanges with the shortest round trips.
+#
+# usage: python3 clock_sync.py < exchanges
+#
+# Run on its own, it replays exchanges given one per line as "t1 t2 t3 t4" and prints the estimate after each, so the port can be
+# compared with the firmware (test/test_clock_sync does).
+
+import math
+import struct
+import sys
+
+PACKET = struct.Struct('<IBBHqqq')  # magic, version, type, sequence, t1, t2, t3
+CLOCK_SYNC_MAGIC = 0x53444153
+CLOCK_SYNC_VERSION = 1
+CLOCK_SYNC_PORT = 4211
+CLOCK_SYNC_REQUEST = 1
+CLOCK_SYNC_RESPONSE = 2
+CLOCK_SYNC_SAMPLES = 64
+CLOCK_SYNC_MIN_SAMPLES = 4
+CLOCK_SYNC_MIN_DRIFT_SPAN_US = 2000000
+CLOCK_SYNC_MAX_DRIFT_PPM = 500.0
+CLOCK_SYNC_STEP_US = 100000
+
+
+def _unpack(data, packet_type):
+    if len(data) != PACKET.size:
+        return None
+    fields = PACKET.unpack(data)
+    if fields[0] != CLOCK_SYNC_MAGIC or fields[1] != CLOCK_SYNC_VERSION or fields[2] != packet_type:
+        return None
+    return fields
+
+
+def make_response(request, receive_time, send_time):
+    # server side: answers a request (times on the server clock). Returns None if it is not a request.
+    fields = _unpack(request, CLOCK_SYNC_REQUEST)
+    if fields is None:
+        return None
+    return PACKET.pack(CLOCK_SYNC_MAGIC, CLOCK_SYNC_VERSION, CLOCK_SYNC_RESPONSE, fields[3], fields[4], receive_time, send_time)
+
+
+class ClockSync:
+    def __init__(self):
+        self.sequence = 0
+        self.reset()
+
+    def reset(self):
+        self.samples = []  # (local time, offset, round trip), in the slots of the firmware's ring buffer
+        self.next_sample = 0  # slot of the next exchange
+        self.request_time = 0
+        self.reference_local = 0
+        self.reference_offset = 0
+        self.drift = 0.0
+        self.round_trip = 0
+        self.residual = 0
+        self.synced = False
+
+    def make_request(self, now):
+        self.sequence = (self.sequence + 1) & 0xFFFF
+        self.request_time = now  # a response to an earlier request is ignored from now on
+        return PACKET.pack(CLOCK_SYNC_MAGIC, CLOCK_SYNC_VERSION, CLOCK_SYNC_REQUEST, self.sequence, now, 0, 0)
+
+    def handle_response(self, data, now):
+        fields = _unpack(data, CLOCK_SYNC_RESPONSE)
+        if fields is None or self.request_time == 0:
+            return False
+        _, _, _, sequence, t1, t2, t3 = fields
+        if sequence != self.sequence or t1 != self.request_time:
+            return False
+        self.request_time = 0
+
+        local_time = t1 + _div(now - t1, 2)
+        offset = _div((t2 - t1) + (t3 - now), 2)
+        round_trip = (now - t1) - (t3 - t2)
+        if round_trip < 0:
+            return False
+
+        # a jump much larger than the round trip can explain means the server clock started over
+        if self.synced and round_trip < CLOCK_SYNC_STEP_US and abs(offset - self.get_offset(local_time)) > CLOCK_SYNC_STEP_US:
+            self.reset()
+
+        if len(self.samples) < CLOCK_SYNC_SAMPLES:
+            self.samples.append((local_time, offset, round_trip))
+        else:
+            self.samples[self.next_sample] = (local_time, offset, round_trip)
+        self.next_sample = (self.next_sample + 1) % CLOCK_SYNC_SAMPLES
+
+        if len(self.samples) >= CLOCK_SYNC_MIN_SAMPLES:
+            self._fit()
+            self.synced = True
+        return True
+
+    def to_server(self, local_time):
+        return local_time + self.get_offset(local_time)
+
+    def to_local(self, server_time):
+        return server_time - self.get_offset(server_time - self.reference_offset)
+
+    def get_offset(self, local_time):
+        return self.reference_offset + _round(self.drift * (local_time - self.reference_local))
+
+    def drift_ppm(self):
+        return self.drift * 1e6
+
+    def _fit(self):
+        # stable sort by round trip over the slots, like the insertion sort of the firmware: equal round trips are taken in slot order,
+        # which decides the exchanges fitted once the ring has wrapped
+        fitted = sorted(self.samples, key=lambda sample: sample[2])
+        count = max((len(fitted) + 1) // 2, min(len(fitted), CLOCK_SYNC_MIN_SAMPLES))
+        fitted = fitted[:count]
+
+        base_x, base_y, base_round_trip = fitted[0]
+        xs = [sample[0] - base_x for sample in fitted]
+        ys = [sample[1] - base_y for sample in fitted]
+        mean_x = sum(xs) / count
+        mean_y = sum(ys) / count
+        sum_xy = sum((x - mean_x) * (y - mean_y) for x, y in zip(xs, ys))
+        sum_xx = sum((x - mean_x) ** 2 for x in xs)
+
+        if max(xs) - min(xs) >= CLOCK_SYNC_MIN_DRIFT_SPAN_US and sum_xx > 0.0:
+            max_drift = CLOCK_SYNC_MAX_DRIFT_PPM / 1e6
+            self.drift = max(-max_drift, min(max_drift, sum_xy / sum_xx))
+
+        self.reference_local = base_x + _round(mean_x)
+        self.reference_offset = base_y + _round(mean_y)
+        self.round_trip = base_round_trip
+        self.residual = int(math.sqrt(sum((sample[1] - self.get_offset(sample[0])) ** 2 for sample in fitted) / count))
+
+
+def _div(a, b):
+    # integer division truncating towards 0, as in C
+    return abs(a) // b if a >= 0 else -(abs(a) // b)
+
+
+def _round(x):
+    # rounding half away from 0, as llround
+    return int(math.floor(abs(x) + 0.5)) * (1 if x >= 0 else -1)
+
+
+def replay(lines, out, later_us=10000000):
+    # for each exchange: accepted, synced, the offset at t4 and later_us after it, the drift (ppm), the round trip and the residual
+    sync = ClockSync()
+    for line in lines:
+        t1, t2, t3, t4 = (int(field) for field in line.split())
+        response = make_response(sync.make_request(t1), t2, t3)
+        accepted = sync.handle_response(response, t4)
+        out.write('%d %d %d %d %.17g %d %d\n' % (accepted, sync.synced, sync.get_offset(t4), sync.get_offset(t4 + later_us),
+                                                  sync.drift_ppm(), sync.round_trip, sync.residual))
+
+
+if __name__ == '__main__':
+    replay(sys.stdin, sys.stdout)
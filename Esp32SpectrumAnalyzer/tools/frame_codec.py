@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+# Encoder and decoder for the analyzer's binary frame format (see src/FrameCodec.h), shared by the frame tools.
+# A frame is either a keyframe carrying all band levels and peak rows, or a delta frame carrying the changes
+# since the frame with the previous sequence number.
+
+import struct
+
+HEADER = struct.Struct('<IBBBBIII')  # magic, version, noOfBands, noOfRows, flags, sequence, timestamp, presentation
+HEADER_V2 = struct.Struct('<IBBBBII')  # versions 1 and 2: no presentation time
+FRAME_MAGIC = 0x46444153
+FRAME_VERSION = 3
+FRAME_MAX_BANDS = 64
+FLAG_KEYFRAME = 0x01
+
+MAX_UNCHANGED_RUN = 128
+MAX_LITERAL_RUN = 64
+DELTA_BIAS = 32
+
+
+class InvalidFrame(Exception):
+    pass
+
+
+class MissingBase(Exception):
+    pass  # delta frame whose previous frame was not decoded
+
+
+def _small_change(previous, value):
+    return -DELTA_BIAS <= value - previous < DELTA_BIAS
+
+
+def _encode_delta(previous, values):
+    out = bytearray()
+    i = 0
+    count = len(values)
+    while i < count:
+        if values[i] == previous[i]:
+            run = 1
+            while i + run < count and run < MAX_UNCHANGED_RUN and values[i + run] == previous[i + run]:
+                run += 1
+            out.append(run - 1)
+        elif _small_change(previous[i], values[i]):
+            run = 1
+            out.append(0x80 | (values[i] - previous[i] + DELTA_BIAS))
+        else:
+            run = 1
+            while i + run < count and run < MAX_LITERAL_RUN and not _small_change(previous[i + run], values[i + run]):
+                run += 1
+            out.append(0xC0 | (run - 1))
+            out += bytes(values[i:i + run])
+        i += run
+    return bytes(out)
+
+
+class Encoder:
+    def __init__(self, keyframe_interval=16):
+        self.keyframe_interval = keyframe_interval
+        self.sequence = 0
+        self.previous = None  # (bands, rows, values)
+        self.since_keyframe = 0
+
+    def encode(self, levels, peaks, rows, timestamp, presentation=0):
+        bands = len(levels)
+        values = bytes(levels) + bytes(peaks)
+        payload = None
+        if self.previous is not None and self.previous[:2] == (bands, rows) and self.since_keyframe + 1 < self.keyframe_interval:
+            payload = _encode_delta(self.previous[2], values)
+            if len(payload) >= len(values):
+                payload = None
+
+        if payload is None:
+            flags, payload = FLAG_KEYFRAME, values
+            self.since_keyframe = 0
+        else:
+            flags = 0
+            self.since_keyframe += 1
+
+        frame = HEADER.pack(FRAME_MAGIC, FRAME_VERSION, bands, rows, flags, self.sequence & 0xFFFFFFFF, timestamp & 0xFFFFFFFF, presentation & 0xFFFFFFFF) + payload
+        self.sequence += 1
+        self.previous = (bands, rows, values)
+        return frame
+
+
+class Decoder:
+    def __init__(self):
+        self.frame = None  # dict of the last frame decoded
+
+    def decode(self, data):
+        if len(data) < HEADER_V2.size or len(data) > HEADER.size + 2 * FRAME_MAX_BANDS:
+            raise InvalidFrame('bad length')
+        magic, version, bands, rows, flags, sequence, timestamp = HEADER_V2.unpack_from(data)
+        if magic != FRAME_MAGIC or version not in (1, 2, FRAME_VERSION) or bands > FRAME_MAX_BANDS:
+            raise InvalidFrame('bad header')
+        if version == 1:
+            flags = FLAG_KEYFRAME
+
+        presentation, header_size = 0, HEADER_V2.size
+        if version == FRAME_VERSION:
+            if len(data) < HEADER.size:
+                raise InvalidFrame('bad length')
+            presentation, header_size = HEADER.unpack_from(data)[7], HEADER.size
+
+        payload = data[header_size:]
+        count = 2 * bands
+        if flags & FLAG_KEYFRAME:
+            if len(payload) != count:
+                raise InvalidFrame('bad keyframe length')
+            values = bytearray(payload)
+        else:
+            base = self.frame
+            if base is None or sequence != (base['sequence'] + 1) & 0xFFFFFFFF or (base['bands'], base['rows']) != (bands, rows):
+                raise MissingBase()
+            values = bytearray(base['levels'] + base['peaks'])
+            i = position = 0
+            while position < len(payload):
+                token = payload[position]
+                position += 1
+                if token < 0x80:
+                    i += token + 1
+                elif token < 0xC0:
+                    if i >= count:
+                        raise InvalidFrame('delta past the end')
+                    values[i] = (values[i] + (token & 0x3F) - DELTA_BIAS) & 0xFF
+                    i += 1
+                else:
+                    run = (token & 0x3F) + 1
+                    if i + run > count or position + run > len(payload):
+                        raise InvalidFrame('literal past the end')
+                    values[i:i + run] = payload[position:position + run]
+                    position += run
+                    i += run
+            if i != count:
+                raise InvalidFrame('tokens do not cover the frame')
+
+        self.frame = {
+            'sequence': sequence,
+            'timestamp': timestamp,
+            'presentation': presentation,
+            'bands': bands,
+            'rows': rows,
+            'keyframe': bool(flags & FLAG_KEYFRAME),
+            'levels': list(values[:bands]),
+            'peaks': list(values[bands:]),
+        }
+        return self.frame
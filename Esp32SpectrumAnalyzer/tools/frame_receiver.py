@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+# Receives the UDP frames streamed by the spectrum analyzer (see src/FrameStreamer.h)
+# and prints packets per second, bytes per frame and lost/reordered packets based on the sequence numbers.
+#
+# usage: python3 frame_receiver.py [--group 239.1.2.3] [--port 4210] [--unicast]
+
+import argparse
+import socket
+import struct
+import time
+
+from frame_codec import HEADER_V2, Decoder, InvalidFrame, MissingBase
+
+
+def open_socket(group, port, unicast):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(('', port))
+    if not unicast:
+        membership = struct.pack('4sl', socket.inet_aton(group), socket.INADDR_ANY)
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, membership)
+    sock.settimeout(1.0)
+    return sock
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--group', default='239.1.2.3')
+    parser.add_argument('--port', type=int, default=4210)
+    parser.add_argument('--unicast', action='store_true', help='do not join the multicast group')
+    parser.add_argument('--verbose', action='store_true', help='print every frame')
+    args = parser.parse_args()
+
+    sock = open_socket(args.group, args.port, args.unicast)
+    expected = None
+    received = lost = reordered = invalid = undecodable = 0
+    decoder = Decoder()
+    window_bytes = 0
+    window_start = time.monotonic()
+    window_count = 0
+
+    while True:
+        try:
+            data, _ = sock.recvfrom(2048)
+        except socket.timeout:
+            data = None
+
+        if data is not None:
+            try:
+                frame = decoder.decode(data)
+            except InvalidFrame:
+                invalid += 1
+                continue
+            except MissingBase:
+                frame = None
+                undecodable += 1  # delta frame after a lost or reordered one, decodable again from the next keyframe
+
+            sequence = HEADER_V2.unpack_from(data)[5]
+            received += 1
+            window_count += 1
+            window_bytes += len(data)
+            if expected is not None:
+                if sequence > expected:
+                    lost += sequence - expected
+                elif sequence < expected:
+                    reordered += 1
+                    lost = max(0, lost - 1)
+            if expected is None or sequence >= expected:
+                expected = sequence + 1
+
+            if args.verbose and frame is not None:
+                kind = 'key' if frame['keyframe'] else 'delta'
+                print(f"#{sequence} t={frame['timestamp']} {kind} {len(data)} bytes rows={frame['rows']} levels={frame['levels']} peaks={frame['peaks']}")
+
+        now = time.monotonic()
+        if now - window_start >= 1.0:
+            pps = window_count / (now - window_start)
+            total = received + lost
+            loss = (100.0 * lost / total) if total else 0.0
+            size = (window_bytes / window_count) if window_count else 0.0
+            print(f'{pps:7.1f} packets/s  {size:5.1f} bytes/frame  received={received} lost={lost} ({loss:.2f}%) reordered={reordered} undecodable={undecodable} invalid={invalid}')
+            window_start = now
+            window_count = 0
+            window_bytes = 0
+
+
+if __name__ == '__main__':
+    main()
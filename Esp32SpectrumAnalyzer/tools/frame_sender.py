@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+# Sends synthetic spectrum frames in the analyzer's UDP frame format (see src/FrameStreamer.h),
+# with optional injected jitter, loss and reordering, to exercise a display node's jitter buffer.
+#
+# usage: python3 frame_sender.py [--group 239.1.2.3] [--port 4210] [--bands 10] [--fps 43]
+#                                [--jitter-ms 20] [--loss 0.05] [--reorder 0.02] [--keyframe-interval 16]
+
+import argparse
+import heapq
+import math
+import random
+import socket
+import time
+
+from frame_codec import Encoder
+
+
+def build_frame(encoder, timestamp_ms, bands, rows):
+    # a sweeping sine per band, so stutter and concealment are easy to spot on the LEDs
+    levels = bytes(int(127.5 + 127.5 * math.sin(timestamp_ms / 300.0 + b * 0.6)) for b in range(bands))
+    peaks = bytes(min(rows - 1, level * rows // 256) for level in levels)
+    return encoder.encode(levels, peaks, rows, timestamp_ms)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--group', default='239.1.2.3', help='multicast group or unicast address of the node')
+    parser.add_argument('--port', type=int, default=4210)
+    parser.add_argument('--bands', type=int, default=10)
+    parser.add_argument('--rows', type=int, default=10)
+    parser.add_argument('--fps', type=float, default=44100 / 1024)
+    parser.add_argument('--jitter-ms', type=float, default=0.0, help='maximum random extra delay per packet')
+    parser.add_argument('--loss', type=float, default=0.0, help='probability of dropping a packet')
+    parser.add_argument('--reorder', type=float, default=0.0, help='probability of delaying a packet behind the next one')
+    parser.add_argument('--keyframe-interval', type=int, default=16, help='send all values at least every this many frames (1 = keyframes only)')
+    parser.add_argument('--seconds', type=float, default=0.0, help='stop after this long (0 = run forever)')
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 1)
+
+    interval = 1.0 / args.fps
+    start = time.monotonic()
+    pending = []  # (send time, sequence, packet)
+    sequence = sent = dropped = 0
+    encoder = Encoder(args.keyframe_interval)
+    next_frame = start
+
+    while args.seconds <= 0 or time.monotonic() - start < args.seconds:
+        now = time.monotonic()
+
+        if now >= next_frame:
+            timestamp_ms = int((next_frame - start) * 1000)
+            packet = build_frame(encoder, timestamp_ms, args.bands, args.rows)
+            if random.random() < args.loss:
+                dropped += 1
+            else:
+                delay = random.uniform(0, args.jitter_ms) / 1000.0
+                if random.random() < args.reorder:
+                    delay += interval * 1.5
+                heapq.heappush(pending, (next_frame + delay, sequence, packet))
+            sequence += 1
+            next_frame += interval
+
+        while pending and pending[0][0] <= now:
+            _, _, packet = heapq.heappop(pending)
+            sock.sendto(packet, (args.group, args.port))
+            sent += 1
+
+        time.sleep(0.0005)
+
+    print(f'frames={sequence} sent={sent} dropped={dropped}')
+
+
+if __name__ == '__main__':
+    main()
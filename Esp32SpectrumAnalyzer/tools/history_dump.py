@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+# Downloads the spectrum history kept by the analyzer (see src/SpectrumHistory.h) and prints it as CSV:
+# seconds before the download, followed by the level (0-255) of every band. Frames lost during the download are skipped.
+#
+# usage: python3 history_dump.py http://<analyzer ip> [--file history.bin]
+
+import argparse
+import struct
+import sys
+import urllib.request
+
+HEADER = struct.Struct('<IBBHII')  # magic, version, noOfBands, frameSize, frameCount, timestamp
+HISTORY_MAGIC = 0x48444153
+HISTORY_VERSION = 1
+INVALID_TIMESTAMP = 0xFFFFFFFF
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('url', nargs='?', help='base URL of the analyzer')
+    parser.add_argument('--file', help='read a downloaded history file instead')
+    args = parser.parse_args()
+
+    if args.file:
+        with open(args.file, 'rb') as f:
+            data = f.read()
+    elif args.url:
+        data = urllib.request.urlopen(args.url.rstrip('/') + '/history', timeout=10).read()
+    else:
+        parser.error('give the URL of the analyzer or --file')
+
+    magic, version, bands, frame_size, count, now = HEADER.unpack_from(data)
+    if magic != HISTORY_MAGIC or version != HISTORY_VERSION or len(data) != HEADER.size + count * frame_size:
+        sys.exit('not a spectrum history download')
+
+    print('seconds,' + ','.join(f'band{b}' for b in range(bands)))
+    skipped = 0
+    for i in range(count):
+        frame = data[HEADER.size + i * frame_size:HEADER.size + (i + 1) * frame_size]
+        timestamp = struct.unpack_from('<I', frame)[0]
+        if timestamp == INVALID_TIMESTAMP:
+            skipped += 1
+            continue
+        print(f'{(timestamp - now) / 1000.0:.3f},' + ','.join(str(level) for level in frame[4:]))
+
+    print(f'{count} frames, {skipped} lost during the download', file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,87 @@
+"""
+Lists the statically allocated memory of the firmware per subsystem, worked out from the symbols of the ELF file.
+
+Runs after every PlatformIO build (see extra_scripts in platformio.ini), or by hand on a built ELF file:
+    python tools/memory_report.py .pio/build/esp32doit-devkit-v1/firmware.elf [path to nm]
+
+DRAM is .data + .bss (what is left of it is the heap), flash is code + read only data.
+Buffers allocated with new at startup do not show up here; they come out of the heap.
+"""
+
+import re
+import subprocess
+import sys
+
+# subsystem a symbol belongs to, by the first pattern its (demangled) name matches
+SUBSYSTEMS = [
+    ("Analyzer", r"Analyzer|_analyzerMemory|arduinoFFT|FilterBank"),
+    ("LedMatrix", r"LedMatrix|FastLED|CFastLED|CLEDController|CPixelLEDController|ClocklessController"),
+    ("LedServer", r"LedServer|g_webPage|RequestGuard"),
+    ("ConfigStore", r"ConfigStore"),
+    ("FrameStreamer", r"FrameStreamer|FrameEncoder"),
+    ("FrameReceiver", r"FrameReceiver|FrameDecoder"),
+    ("LatencyTracer", r"LatencyTracer"),
+    ("main", r"^_(bandTable|webBandTable|lightingBandTable|freqBands|streamAddress|analyzer|ledServer)$"),
+    ("web server", r"AsyncWebServer|AsyncWebHandler|AsyncTCP|AsyncClient|AsyncServer|AsyncUDP|async_tcp|ArduinoJson|WiFiManager"),
+    ("wifi/network", r"WiFi|wifi|esp_wifi|lwip|tcp_|udp_|ip4|ip6|netif|dhcp|mdns|MDNS|pbuf|ppTask|net80211|ieee80211"),
+    ("freertos/idf", r"xTask|vTask|pvPort|xPort|xQueue|rtos|esp_|heap_|spi_flash|nvs|i2s|adc|rtc|uart|gpio|intr|ets_|_lock|Cache"),
+]
+
+DRAM_TYPES = {"d": ".data", "D": ".data", "b": ".bss", "B": ".bss"}
+FLASH_TYPES = {"t": "code", "T": "code", "r": "rodata", "R": "rodata", "w": "code", "W": "code"}
+
+
+def subsystem_of(name):
+    for subsystem, pattern in SUBSYSTEMS:
+        if re.search(pattern, name):
+            return subsystem
+    return "other"
+
+
+def read_symbols(elf, nm):
+    output = subprocess.run([nm, "-S", "-C", "--size-sort", elf], capture_output=True, text=True, check=True).stdout
+    for line in output.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) == 4:
+            yield int(parts[1], 16), parts[2], parts[3]
+
+
+def report(elf, nm):
+    totals = {}
+    largest = []
+
+    for size, symbolType, name in read_symbols(elf, nm):
+        if symbolType in DRAM_TYPES:
+            column = DRAM_TYPES[symbolType]
+            largest.append((size, column, name))
+        elif symbolType in FLASH_TYPES:
+            column = FLASH_TYPES[symbolType]
+        else:
+            continue
+
+        subsystem = totals.setdefault(subsystem_of(name), {".data": 0, ".bss": 0, "code": 0, "rodata": 0})
+        subsystem[column] += size
+
+    print("\nStatic memory per subsystem (bytes)")
+    print("%-16s %10s %10s %10s %10s %10s" % ("subsystem", ".data", ".bss", "DRAM", "code", "rodata"))
+    for name, sizes in sorted(totals.items(), key=lambda item: -(item[1][".data"] + item[1][".bss"])):
+        print("%-16s %10d %10d %10d %10d %10d" % (name, sizes[".data"], sizes[".bss"], sizes[".data"] + sizes[".bss"], sizes["code"], sizes["rodata"]))
+
+    print("\nLargest DRAM symbols")
+    for size, column, name in sorted(largest, reverse=True)[:10]:
+        print("%10d %-6s %s" % (size, column, name[:100]))
+    print()
+
+
+def nm_for(env):
+    return re.sub(r"g(cc|\+\+)$", "nm", env.subst("$CC"))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        sys.exit("usage: memory_report.py <firmware.elf> [nm]")
+    report(sys.argv[1], sys.argv[2] if len(sys.argv) > 2 else "nm")
+else:
+    Import("env")  # noqa: F821 (provided by PlatformIO)
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", lambda source, target, env: report(str(target[0]), nm_for(env)))  # noqa: F821
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+# Runs the host simulation of the firmware (pio run -e native-sim) on a fixed input and compares its report with a saved baseline,
+# so a change that slows down the frame loop shows up without a board.
+#
+# usage: python3 sim_benchmark.py [--program .pio/build/native-sim/program] [--seconds 30] [--audio <file.wav>] [--realtime]
+#                                 [--baseline sim_baseline.json] [--save-baseline] [--tolerance 10]
+#
+# By default the audio is made as fast as the host allows (--fast), so the real time factor and the frames per second measure the cost
+# of a frame. With --realtime the audio comes at its own pace and the show latency percentiles are the figures to watch.
+# Exits with 1 if a figure is worse than the baseline by more than --tolerance percent, or if audio blocks were dropped.
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+# figures compared (True when higher is better). The latency of a fast run is too short to compare, and the speed of a real time run is fixed.
+FAST_FIGURES = {'realtimeFactor': True, 'framesPerSecond': True}
+REALTIME_FIGURES = {'latencyUs.p50': False, 'latencyUs.p99': False, 'showIntervalUs.p99': False}
+
+
+def run(args):
+    command = [args.program, '--seconds', str(args.seconds), '--generator', args.generator, '--no-led-timing']
+    if args.audio:
+        command += ['--audio', args.audio]
+    if not args.realtime:
+        command.append('--fast')
+
+    with tempfile.TemporaryDirectory() as nvs:
+        command += ['--nvs', nvs, '--serial', os.devnull, '--http-port', str(args.http_port)]
+        result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, timeout=args.seconds * 10 + 60)
+
+    for line in result.stdout.decode(errors='replace').splitlines():
+        if line.startswith('SIM_REPORT '):
+            return json.loads(line[len('SIM_REPORT '):])
+    sys.exit('no SIM_REPORT from %s (exit code %d)' % (args.program, result.returncode))
+
+
+def figure(report, name):
+    value = report
+    for key in name.split('.'):
+        value = value[key]
+    return value
+
+
+def compare(report, baseline, figures, tolerance):
+    failed = False
+    for name, higherIsBetter in figures.items():
+        now, then = figure(report, name), figure(baseline, name)
+        if then == 0:
+            change = 0
+        else:
+            change = (now - then) / then * 100 if higherIsBetter else (then - now) / then * 100
+        worse = change < -tolerance
+        failed = failed or worse
+        print('%-18s %12.2f %12.2f %+8.1f%%%s' % (name, then, now, change, '  WORSE' if worse else ''))
+    return failed
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Benchmarks the host simulation of the firmware')
+    parser.add_argument('--program', default='.pio/build/native-sim/program')
+    parser.add_argument('--seconds', type=float, default=30, help='seconds of audio to run')
+    parser.add_argument('--audio', help='WAV file to play instead of the generator')
+    parser.add_argument('--generator', default='sweep')
+    parser.add_argument('--realtime', action='store_true', help='deliver the audio at its own pace')
+    parser.add_argument('--http-port', type=int, default=18080, help='kept off the default port, so a running simulation is not in the way')
+    parser.add_argument('--baseline', default='sim_baseline.json')
+    parser.add_argument('--save-baseline', action='store_true', help='save this run as the baseline instead of comparing')
+    parser.add_argument('--tolerance', type=float, default=10, help='percent a figure may be worse than the baseline')
+    args = parser.parse_args()
+
+    report = run(args)
+    print(json.dumps(report, indent=2))
+
+    if report['blocksDropped'] > 0:
+        print('%d audio blocks were dropped' % report['blocksDropped'])
+        sys.exit(1)
+
+    if args.save_baseline:
+        with open(args.baseline, 'w') as f:
+            json.dump(report, f, indent=2)
+        print('saved as %s' % args.baseline)
+        return
+
+    if not os.path.exists(args.baseline):
+        sys.exit('no baseline at %s (make one with --save-baseline)' % args.baseline)
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+
+    print('%-18s %12s %12s %9s' % ('', 'baseline', 'now', 'change'))
+    figures = REALTIME_FIGURES if args.realtime else FAST_FIGURES
+    sys.exit(1 if compare(report, baseline, figures, args.tolerance) else 0)
+
+
+if __name__ == '__main__':
+    main()
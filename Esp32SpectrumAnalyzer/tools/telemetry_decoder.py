@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+# Decodes the binary telemetry the spectrum analyzer writes to its serial port (see src/SerialTelemetry.h)
+# and prints records per second, lost/dropped records and the latest stage timings.
+#
+# usage: python3 telemetry_decoder.py /dev/ttyUSB0 [--baud 115200] [--verbose]
+#
+# The port is opened with pyserial if it is installed. Otherwise it is read as a plain file
+# (eg. a pseudo-terminal, or a tty set up beforehand with: stty -F /dev/ttyUSB0 115200 raw).
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+HEADER = struct.Struct('<BBBBII5IIII')  # type, version, noOfBands, noOfRows, sequence, timestamp, stageMicros[5], fftMicros, recordsDropped, streamDropped
+TELEMETRY_TYPE_FRAME = 1
+TELEMETRY_VERSION = 1
+STAGES = ['readWait', 'analysis', 'render', 'show', 'total']
+
+
+def open_port(path, baud):
+    try:
+        import serial
+        port = serial.Serial(path, baud, timeout=0.2)
+        return lambda: port.read(4096)
+    except ImportError:
+        fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+        return lambda: read_file(fd)
+
+
+def read_file(fd):
+    try:
+        return os.read(fd, 4096) or None  # None once the file or pseudo-terminal is closed
+    except OSError:
+        return None
+
+
+def cobs_decode(data):
+    decoded = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        decoded += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            decoded.append(0)
+    return bytes(decoded)
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def parse_record(packet):
+    record = cobs_decode(packet)
+    if record is None or len(record) < HEADER.size + 2:
+        return None
+
+    body, crc = record[:-2], record[-2] | (record[-1] << 8)
+    if crc16(body) != crc:
+        return None
+
+    fields = HEADER.unpack_from(body)
+    record_type, version, bands = fields[0], fields[1], fields[2]
+    if record_type != TELEMETRY_TYPE_FRAME or version != TELEMETRY_VERSION or len(body) != HEADER.size + 2 * bands:
+        return None
+
+    return {
+        'bands': bands,
+        'rows': fields[3],
+        'sequence': fields[4],
+        'timestamp': fields[5],
+        'stages': dict(zip(STAGES, fields[6:11])),
+        'fftMicros': fields[11],
+        'recordsDropped': fields[12],
+        'streamDropped': fields[13],
+        'levels': list(body[HEADER.size:HEADER.size + bands]),
+        'peaks': list(body[HEADER.size + bands:]),
+    }
+
+
+class Decoder:
+    # splits the byte stream into records at the 0 delimiters. Text printed between records ends up in packets that fail the CRC.
+    def __init__(self):
+        self.pending = bytearray()
+        self.invalid = 0
+
+    def feed(self, data):
+        self.pending += data
+        *packets, self.pending = self.pending.split(b'\x00')
+        records = []
+        for packet in packets:
+            if not packet:
+                continue
+            record = parse_record(bytes(packet))
+            if record is None:
+                self.invalid += 1
+            else:
+                records.append(record)
+        return records
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('port')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--verbose', action='store_true', help='print every record')
+    args = parser.parse_args()
+
+    read = open_port(args.port, args.baud)
+    decoder = Decoder()
+    expected = None
+    received = lost = 0
+    latest = None
+    window_start = time.monotonic()
+    window_count = 0
+
+    while True:
+        data = read()
+        if data is None:
+            break
+
+        for record in decoder.feed(data):
+            received += 1
+            window_count += 1
+            if expected is not None and record['sequence'] > expected:
+                lost += record['sequence'] - expected  # dropped on the device or lost on the line
+            expected = record['sequence'] + 1
+            latest = record
+
+            if args.verbose:
+                print(f"#{record['sequence']} t={record['timestamp']} levels={record['levels']} peaks={record['peaks']} stages={record['stages']}")
+
+        now = time.monotonic()
+        if now - window_start >= 1.0:
+            rate = window_count / (now - window_start)
+            line = f'{rate:6.1f} records/s  received={received} missing={lost} invalid={decoder.invalid}'
+            if latest is not None:
+                stages = ' '.join(f'{name}={micros}' for name, micros in latest['stages'].items())
+                line += f"  deviceDropped={latest['recordsDropped']} fft={latest['fftMicros']}us {stages}"
+            print(line)
+            sys.stdout.flush()
+            window_start = now
+            window_count = 0
+
+
+if __name__ == '__main__':
+    main()
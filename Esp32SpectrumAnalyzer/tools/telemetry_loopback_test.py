@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+# Loopback test of the serial telemetry: the telemetry writer of the host benchmarks (pio run -e native-bench) publishes records through
+# SerialTelemetry into a pseudo-terminal, as the firmware does into its UART, and this script reads them back with telemetry_decoder.py.
+#
+# usage: python3 telemetry_loopback_test.py [--program .pio/build/native-bench/program]
+#
+# Checks:
+#   framing: every record sent decodes, in sequence, whatever chunks the bytes arrive in
+#   resync: text printed between records is skipped, and so is a record cut by text printed into the middle of it
+#   CRC: records with a corrupted byte are rejected and counted as missing
+#   drops: with the port overdriven, the records missing at the decoder are the ones the writer counted as dropped
+# Exits with 1 if a check fails. Needs a POSIX pty (Linux or macOS).
+
+import argparse
+import json
+import os
+import random
+import select
+import subprocess
+import sys
+import time
+import tty
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from telemetry_decoder import Decoder  # noqa: E402
+
+
+def run_writer(program, bands, fps, frames, text_every):
+    # returns the bytes written to the serial port and the writer's report
+    master, slave = os.openpty()
+    tty.setraw(slave)  # no line feed translation: the records are binary
+    command = [program, '--no-led-timing', '--serial', os.ttyname(slave), '--', 'telemetry', str(bands), str(fps), str(frames), str(text_every)]
+    writer = subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+    os.close(slave)
+
+    data = bytearray()
+    while True:
+        ready, _, _ = select.select([master], [], [], 0.5)
+        if ready:
+            try:
+                chunk = os.read(master, 65536)
+            except OSError:  # no one has the port open: the writer has not opened it yet, or has closed it
+                if writer.poll() is not None:
+                    break
+                time.sleep(0.01)
+                continue
+            data += chunk
+        elif writer.poll() is not None:
+            break
+    os.close(master)
+
+    output = writer.communicate(timeout=30)[0].decode(errors='replace')
+    for line in output.splitlines():
+        if line.startswith('TELEMETRY '):
+            return bytes(data), json.loads(line[len('TELEMETRY '):])
+    sys.exit('no TELEMETRY report from %s (exit code %d)' % (program, writer.returncode))
+
+
+def decode(data, chunks=True):
+    # feeds the bytes to the decoder in random chunks. Returns the records and the decoder.
+    decoder = Decoder()
+    records = []
+    rng = random.Random(1)
+    position = 0
+    while position < len(data):
+        size = rng.randint(1, 300) if chunks else len(data)
+        records += decoder.feed(data[position:position + size])
+        position += size
+    return records, decoder
+
+
+def missing(records):
+    # records missing from the sequence numbers received
+    return sum(b['sequence'] - a['sequence'] - 1 for a, b in zip(records, records[1:])) + (records[0]['sequence'] if records else 0)
+
+
+def packets(data):
+    # (start, end) of the non-empty packets between 0 delimiters
+    spans, start = [], 0
+    for end in [i for i, byte in enumerate(data) if byte == 0] + [len(data)]:
+        if end > start:
+            spans.append((start, end))
+        start = end + 1
+    return spans
+
+
+class Checks:
+    def __init__(self):
+        self.failed = 0
+
+    def check(self, name, passed, detail=''):
+        print('%-60s %s%s' % (name, 'PASS' if passed else 'FAIL', '  ' + detail if detail else ''))
+        self.failed += not passed
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--program', default='.pio/build/native-bench/program')
+    args = parser.parse_args()
+    checks = Checks()
+
+    # a rate the port keeps up with: 32 bands at 43 frames per second, a line of text every 20 frames (and records after the last one)
+    data, report = run_writer(args.program, 32, 43, 210, 20)
+    records, decoder = decode(data)
+    checks.check('writer sent every record', report['dropped'] == 0 and report['sent'] == report['frames'], str(report))
+    checks.check('every record decodes', len(records) == report['sent'], '%d of %d' % (len(records), report['sent']))
+    checks.check('records in sequence', [r['sequence'] for r in records] == list(range(report['frames'])))
+    checks.check('text between records skipped', decoder.invalid == report['textLines'], '%d invalid packets, %d text lines' % (decoder.invalid, report['textLines']))
+    levels = [(b * 7) % 64 / 63.0 * 255 for b in range(32)]  # those of the first frame, truncated to bytes by the writer
+    checks.check('first record carries the levels written', bool(records) and records[0]['bands'] == 32 and
+                 all(abs(got - want) < 1 for got, want in zip(records[0]['levels'], levels)))
+
+    # corrupt one byte in every 10th record (never to 0, which would split the packet)
+    record_spans = [(start, end) for start, end in packets(data) if data[start:end].find(b'Text line') < 0]
+    corrupted = bytearray(data)
+    bad = record_spans[5::10]
+    for start, end in bad:
+        position = (start + end) // 2
+        corrupted[position] = corrupted[position] ^ 0x20 or 0x01
+    records, decoder = decode(bytes(corrupted))
+    checks.check('corrupted records rejected by the CRC', decoder.invalid == report['textLines'] + len(bad) and len(records) == report['sent'] - len(bad),
+                 '%d invalid, %d corrupted' % (decoder.invalid - report['textLines'], len(bad)))
+    checks.check('corrupted records counted as missing', missing(records) == len(bad))
+
+    # text printed into the middle of a record: that record is lost, the next one decodes
+    start, end = record_spans[50]
+    cut = data[:(start + end) // 2] + b'Boot message\r\n' + data[(start + end) // 2:]
+    records, decoder = decode(cut)
+    sequences = [r['sequence'] for r in records]
+    checks.check('resync after text inside a record', len(records) == report['sent'] - 1 and 50 not in sequences and 51 in sequences)
+
+    # overdriven: 64 bands at 200 frames per second is about 37 KB/s into a 115200 baud port (11.5 KB/s)
+    data, report = run_writer(args.program, 64, 200, 400, 25)
+    records, decoder = decode(data)
+    trailing = report['frames'] - 1 - records[-1]['sequence'] if records else 0
+    checks.check('overdriven port drops records', report['dropped'] > 0, str(report))
+    checks.check('every record sent decodes', len(records) == report['sent'], '%d of %d' % (len(records), report['sent']))
+    checks.check('records missing at the decoder = records dropped', missing(records) + trailing == report['dropped'],
+                 '%d missing, %d dropped' % (missing(records) + trailing, report['dropped']))
+    checks.check('dropped count carried in the records', bool(records) and records[-1]['recordsDropped'] + trailing == report['dropped'])
+
+    print('FAIL' if checks.failed else 'PASS')
+    sys.exit(1 if checks.failed else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+# Runs an LED wall on this computer to check the clock sync and presentation times of the display nodes (see src/ClockSync.h):
+# a conductor process streams frames stamped with a presentation time and answers clock sync requests like the analyzer,
+# and every node process runs on a simulated clock of its own (random offset and drift) and "shows" each frame when its
+# estimate of the conductor's clock reaches the presentation time. All packets go through an artificial network delay.
+#
+# usage: python3 wall_sync_test.py [--nodes 4] [--seconds 20] [--delay-ms 2] [--jitter-ms 2] [--asymmetry-ms 0]
+#                                  [--max-drift-ppm 50] [--tolerance-us 1000]
+#
+# The skew of a frame is the spread of the true times the nodes showed it at. Exits with 1 if the 99th percentile of the skew
+# (after --warmup-seconds) is above --tolerance-us. An asymmetric delay shifts every offset estimate by half the asymmetry,
+# the same for all nodes, so it shows in the error against the presentation time rather than in the skew.
+
+import argparse
+import heapq
+import multiprocessing
+import os
+import random
+import select
+import socket
+import threading
+import time
+
+from clock_sync import CLOCK_SYNC_PORT, ClockSync, make_response
+from frame_codec import Decoder, Encoder, InvalidFrame, MissingBase
+
+SYNC_INTERVAL_MS = 500  # as CLOCK_SYNC_INTERVAL_MS of the firmware
+SYNC_FAST_INTERVAL_MS = 100  # as CLOCK_SYNC_FAST_INTERVAL_MS
+SPIN_US = 1000  # the last part of the wait is spun (yielding, so nodes sharing a core take turns)
+
+
+def true_now():
+    # CLOCK_MONOTONIC is the same for every process, so it is the reference the nodes are measured against. The conductor runs on it.
+    return time.monotonic_ns() // 1000
+
+
+class Link:
+    # sends datagrams after an artificial network delay (base + random jitter), in the order they are due
+    def __init__(self, sock, delay_ms, jitter_ms):
+        self.sock = sock
+        self.delay_us = delay_ms * 1000
+        self.jitter_us = jitter_ms * 1000
+        self.pending = []
+        self.count = 0
+        self.condition = threading.Condition()
+        threading.Thread(target=self._run, daemon=True).start()
+
+    def send(self, data, address, extra_us=0):
+        due = true_now() + self.delay_us + random.uniform(0, self.jitter_us) + extra_us
+        with self.condition:
+            heapq.heappush(self.pending, (due, self.count, data, address))
+            self.count += 1
+            self.condition.notify()
+
+    def _run(self):
+        while True:
+            with self.condition:
+                while not self.pending:
+                    self.condition.wait()
+                due, _, data, address = self.pending[0]
+                wait = (due - true_now()) / 1e6
+                if wait > 0:
+                    self.condition.wait(wait)
+                    continue
+                heapq.heappop(self.pending)
+            self.sock.sendto(data, address)
+
+
+class NodeClock:
+    # the clock of a node: offset from the reference and running fast or slow by drift_ppm
+    def __init__(self, offset_us, drift_ppm):
+        self.start = true_now()
+        self.offset = offset_us
+        self.rate = 1.0 + drift_ppm / 1e6
+
+    def now(self):
+        return self.start + self.offset + int((true_now() - self.start) * self.rate)
+
+    def to_true(self, local):
+        return self.start + (local - self.start - self.offset) / self.rate
+
+
+def conductor(frame_ports, sync_port, args, stop):
+    frame_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sync_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sync_sock.bind(('127.0.0.1', sync_port))
+    sync_sock.settimeout(0.05)
+    link = Link(frame_sock, args.delay_ms, args.jitter_ms)
+    sync_link = Link(sync_sock, args.delay_ms, args.jitter_ms)
+
+    def answer():
+        while not stop.is_set():
+            try:
+                request, address = sync_sock.recvfrom(64)
+            except socket.timeout:
+                continue
+            receive_time = true_now()
+            response = make_response(request, receive_time, true_now())
+            if response is not None:
+                sync_link.send(response, address, args.asymmetry_ms * 1000)
+
+    threading.Thread(target=answer, daemon=True).start()
+
+    encoder = Encoder()
+    interval_us = 1e6 * 1024 / 44100
+    start = next_frame = true_now()
+    while not stop.is_set():
+        wait = (next_frame - true_now()) / 1e6
+        if wait > 0:
+            time.sleep(wait)
+        now = true_now()
+        levels = bytes(random.randrange(256) for _ in range(args.bands))
+        packet = encoder.encode(levels, bytes(args.bands), 10, (now - start) // 1000, now + int(args.presentation_delay_ms * 1000))
+        for port in frame_ports:
+            link.send(packet, ('127.0.0.1', port), args.asymmetry_ms * 1000)
+        next_frame += interval_us
+
+
+def node(index, frame_port, sync_port, offset_us, drift_ppm, args, results, stop):
+    clock = NodeClock(offset_us, drift_ppm)
+    sync = ClockSync()
+    decoder = Decoder()
+    frame_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    frame_sock.bind(('127.0.0.1', frame_port))
+    sync_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sync_sock.bind(('127.0.0.1', 0))
+    sync_link = Link(sync_sock, args.delay_ms, args.jitter_ms)
+    shows = []  # (local show time, sequence, presentation time on the conductor's clock)
+    last_sync = 0
+    shown = []
+
+    while not stop.is_set():
+        now = clock.now()
+        if now - last_sync >= (SYNC_INTERVAL_MS if sync.synced else SYNC_FAST_INTERVAL_MS) * 1000:
+            sync_link.send(sync.make_request(now), ('127.0.0.1', sync_port))
+            last_sync = now
+
+        timeout = 0.01
+        if shows:
+            timeout = max(0.0, min(timeout, (shows[0][0] - now - SPIN_US) / 1e6))
+        readable, _, _ = select.select([frame_sock, sync_sock], [], [], timeout)
+
+        if sync_sock in readable:
+            data = sync_sock.recv(64)
+            sync.handle_response(data, clock.now())
+
+        if frame_sock in readable:
+            data = frame_sock.recv(2048)
+            try:
+                frame = decoder.decode(data)
+            except (InvalidFrame, MissingBase):
+                frame = None
+            if frame is not None and sync.synced and frame['presentation']:
+                # unwrap the low 32 bits of the presentation time around the conductor's clock now
+                conductor_now = sync.to_server(clock.now())
+                presentation = conductor_now + ((frame['presentation'] - conductor_now + 2 ** 31) % 2 ** 32 - 2 ** 31)
+                heapq.heappush(shows, (sync.to_local(presentation), frame['sequence'], presentation))
+
+        # show the frames that are due: spin out the last part of the wait, then take the true time
+        while shows and shows[0][0] - clock.now() <= SPIN_US:
+            show_time, sequence, presentation = heapq.heappop(shows)
+            while clock.now() < show_time:
+                os.sched_yield()
+            shown.append((sequence, true_now(), presentation))
+
+    now = clock.now()
+    results.put({
+        'node': index,
+        'shown': shown,
+        'offset_error': sync.to_server(now) - true_now() if sync.synced else None,
+        'drift_ppm': sync.drift_ppm(),
+        'true_drift_ppm': (1.0 / (1.0 + drift_ppm / 1e6) - 1.0) * 1e6,
+        'round_trip': sync.round_trip,
+        'residual': sync.residual,
+    })
+
+
+def percentile(values, fraction):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(fraction * len(values)))] if values else 0
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--nodes', type=int, default=4)
+    parser.add_argument('--seconds', type=float, default=20)
+    parser.add_argument('--warmup-seconds', type=float, default=5, help='frames shown before this are not counted (the clocks sync and the drift is fitted)')
+    parser.add_argument('--delay-ms', type=float, default=2.0, help='network delay of every packet')
+    parser.add_argument('--jitter-ms', type=float, default=2.0, help='maximum random extra delay of every packet')
+    parser.add_argument('--asymmetry-ms', type=float, default=0.0, help='extra delay from the conductor to the nodes only')
+    parser.add_argument('--max-drift-ppm', type=float, default=50.0, help='node clocks run up to this much fast or slow')
+    parser.add_argument('--presentation-delay-ms', type=float, default=60.0, help='as PRESENTATION_DELAY_MS of the firmware')
+    parser.add_argument('--bands', type=int, default=10)
+    parser.add_argument('--port', type=int, default=14210, help='first local port (conductor sync port, then one frame port per node)')
+    parser.add_argument('--tolerance-us', type=float, default=1000, help='bound for the 99th percentile of the skew')
+    parser.add_argument('--seed', type=int, default=None)
+    args = parser.parse_args()
+    random.seed(args.seed)
+
+    sync_port = args.port if args.port else CLOCK_SYNC_PORT
+    frame_ports = [sync_port + 1 + i for i in range(args.nodes)]
+    clocks = [(random.uniform(-1e9, 1e9), random.uniform(-args.max_drift_ppm, args.max_drift_ppm)) for _ in range(args.nodes)]
+
+    stop = multiprocessing.Event()
+    results = multiprocessing.Queue()
+    nodes = [multiprocessing.Process(target=node, args=(i, frame_ports[i], sync_port, int(offset), drift, args, results, stop)) for i, (offset, drift) in enumerate(clocks)]
+    for process in nodes:
+        process.start()
+    time.sleep(0.2)  # nodes listening before the first frame
+    started = true_now()
+    leader = multiprocessing.Process(target=conductor, args=(frame_ports, sync_port, args, stop))
+    leader.start()
+
+    time.sleep(args.seconds)
+    stop.set()
+    reports = sorted((results.get() for _ in nodes), key=lambda report: report['node'])
+    for process in nodes + [leader]:
+        process.join()
+
+    # frames shown by every node, after the warmup
+    warmup_end = started + args.warmup_seconds * 1e6
+    shows = {}
+    errors = []
+    for report in reports:
+        for sequence, shown, presentation in report['shown']:
+            if presentation >= warmup_end:
+                shows.setdefault(sequence, []).append(shown)
+                errors.append(shown - presentation)
+    skews = [max(times) - min(times) for times in shows.values() if len(times) == len(nodes)]
+
+    for report, (offset, drift) in zip(reports, clocks):
+        offset_error = report['offset_error']
+        print(f'node {report["node"]}  clock {offset / 1e6:+9.3f} s {drift:+6.1f} ppm  frames {len(report["shown"]):5d}  '
+              f'drift estimate {report["drift_ppm"]:+7.2f} ppm (true {report["true_drift_ppm"]:+7.2f})  '
+              f'offset error {"unsynced" if offset_error is None else f"{offset_error:+6d} us"}  '
+              f'round trip {report["round_trip"]} us  residual {report["residual"]} us')
+    print(f'frames       {len(skews)} shown by all {len(nodes)} nodes')
+    print(f'skew         p50 {percentile(skews, 0.5)} us  p99 {percentile(skews, 0.99)} us  max {max(skews, default=0)} us  (bound {args.tolerance_us:g} us)')
+    print(f'show error   p50 {percentile(errors, 0.5):+.0f} us  p99 {percentile([abs(e) for e in errors], 0.99):.0f} us (against the presentation time)')
+
+    if not skews or percentile(skews, 0.99) > args.tolerance_us:
+        print('FAIL')
+        raise SystemExit(1)
+    print('PASS')
+
+
+if __name__ == '__main__':
+    main()
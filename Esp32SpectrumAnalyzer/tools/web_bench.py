@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+# Benchmarks the web server of the host simulation (pio run -e native-sim) on the loopback interface, against a stand-in of the synchronous
+# server it replaced, whose web thread woke up every 10 ms and then served at most one waiting request from start to finish.
+#
+# usage: python3 web_bench.py [--program .pio/build/native-sim/program] [--seconds 10] [--clients 4]
+#
+# For each server it prints the request latency (p50 and p99) with one client and with --clients at once, and the CPU time and wakeups
+# per second of the web threads (async_tcp and WebServerTask of the simulation, the serving thread of the stand-in) idle and under load.
+# Each client has its own loopback address and stays below the rate limit, so no request is refused. Reads /proc, so Linux only.
+# The stand-in is Python, so its CPU time is only an upper bound; its wakeups and latency are those of a 10 ms poll.
+
+import argparse
+import http.client
+import os
+import socket
+import sys
+import tempfile
+import threading
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from web_load_test import current_settings, fetch, start_sim, stop_sim  # noqa: E402
+
+POLL_SECONDS = 0.01  # poll interval of the old web server thread
+REQUESTS_PER_SECOND = 5  # per client, below the rate limit of the firmware (10 per second)
+SIM_THREADS = ('async_tcp', 'WebServerTask')
+
+
+class PollingStandIn(threading.Thread):
+    # the old server: every POLL_SECONDS the web thread takes one waiting connection and answers it with the response the simulation gave
+    def __init__(self, responses):
+        super().__init__(daemon=True)
+        self.responses = responses
+        self.listener = socket.socket()
+        self.listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.listener.bind(('127.0.0.1', 0))
+        self.listener.listen(64)
+        self.listener.setblocking(False)
+        self.base = 'http://127.0.0.1:%d' % self.listener.getsockname()[1]
+        self.stopping = False
+        self.tid = None
+
+    def run(self):
+        self.tid = threading.get_native_id()
+        while not self.stopping:
+            time.sleep(POLL_SECONDS)
+            try:
+                connection, _ = self.listener.accept()
+            except BlockingIOError:
+                continue
+            with connection:
+                connection.setblocking(True)
+                connection.settimeout(1)
+                self.serve(connection)
+
+    def serve(self, connection):
+        request = b''
+        while b'\r\n\r\n' not in request:
+            chunk = connection.recv(4096)
+            if not chunk:
+                return
+            request += chunk
+        head, body = request.split(b'\r\n\r\n', 1)
+        lines = head.decode(errors='replace').split('\r\n')
+        length = next((int(line.split(':', 1)[1]) for line in lines[1:] if line.lower().startswith('content-length:')), 0)
+        while len(body) < length:
+            chunk = connection.recv(4096)
+            if not chunk:
+                return
+            body += chunk
+
+        path = lines[0].split(' ')[1]
+        status, content = self.responses.get(path, (404, b''))
+        connection.sendall(b'HTTP/1.1 %d OK\r\nContent-Length: %d\r\nConnection: close\r\n\r\n' % (status, len(content)) + content)
+
+
+def thread_stats(pid, tids):
+    # CPU time (s) and voluntary context switches (wakeups after sleeping) of the threads, summed
+    cpu, wakeups = 0.0, 0
+    for tid in tids:
+        with open('/proc/%d/task/%d/schedstat' % (pid, tid)) as schedstat:
+            cpu += int(schedstat.read().split()[0]) / 1e9  # ns on the CPU, finer than the clock ticks of stat
+        with open('/proc/%d/task/%d/status' % (pid, tid)) as status:
+            for line in status:
+                if line.startswith('voluntary_ctxt_switches:'):
+                    wakeups += int(line.split()[1])
+    return cpu, wakeups
+
+
+def named_threads(pid, names):
+    tids = []
+    for tid in os.listdir('/proc/%d/task' % pid):
+        with open('/proc/%d/task/%s/comm' % (pid, tid)) as comm:
+            if comm.read().strip() in names:
+                tids.append(int(tid))
+    return tids
+
+
+def measure_idle(pid, tids, seconds):
+    cpu, wakeups = thread_stats(pid, tids)
+    time.sleep(seconds)
+    cpu_after, wakeups_after = thread_stats(pid, tids)
+    return (cpu_after - cpu) * 1000 / seconds, (wakeups_after - wakeups) / seconds
+
+
+def client(base, address, requests, deploy_payload, latencies, statuses, lock):
+    host, port = base[len('http://'):].split(':')
+    for i in range(requests):
+        started = time.monotonic()
+        connection = http.client.HTTPConnection(host, int(port), timeout=10, source_address=(address, 0))
+        try:
+            if i % 5 == 4 and deploy_payload is not None:
+                connection.request('POST', '/deploy', body=deploy_payload, headers={'Content-Type': 'application/json'})
+            else:
+                connection.request('GET', '/' if i % 2 == 0 else '/config')
+            response = connection.getresponse()
+            response.read()
+            status = response.status
+        except OSError:
+            status = None
+        finally:
+            connection.close()
+        elapsed = time.monotonic() - started
+
+        with lock:
+            latencies.append(elapsed * 1000)
+            statuses[status] = statuses.get(status, 0) + 1
+        time.sleep(max(0, 1 / REQUESTS_PER_SECOND - elapsed))
+
+
+def measure_load(base, pid, tids, clients, seconds, deploy_payload):
+    latencies, statuses, lock = [], {}, threading.Lock()
+    requests = int(seconds * REQUESTS_PER_SECOND)
+    cpu, wakeups = thread_stats(pid, tids)
+    started = time.monotonic()
+    threads = [threading.Thread(target=client, args=(base, '127.0.1.%d' % (c + 1), requests, deploy_payload, latencies, statuses, lock))
+               for c in range(clients)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    elapsed = time.monotonic() - started
+    cpu_after, wakeups_after = thread_stats(pid, tids)
+
+    latencies.sort()
+    p50 = latencies[len(latencies) // 2]
+    p99 = latencies[min(len(latencies) - 1, int(len(latencies) * 0.99))]
+    return p50, p99, (cpu_after - cpu) * 1000 / elapsed, (wakeups_after - wakeups) / elapsed, statuses
+
+
+def report(name, base, pid, tids, args, deploy_payload):
+    idle_cpu, idle_wakeups = measure_idle(pid, tids, args.seconds)
+    single = measure_load(base, pid, tids, 1, args.seconds, deploy_payload)
+    loaded = measure_load(base, pid, tids, args.clients, args.seconds, deploy_payload)
+    print('%-18s%8.2f ms/s%8.1f /s%9.1f ms%9.1f ms%9.1f ms%9.1f ms%8.2f ms/s%8.1f /s' % (
+        name, idle_cpu, idle_wakeups, single[0], single[1], loaded[0], loaded[1], loaded[2], loaded[3]))
+    # /config answers 503 while a deploy is being applied, which the portal retries
+    return [status for status in list(single[4]) + list(loaded[4]) if status is None or (status >= 400 and status != 503)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Benchmarks the web server of the host simulation against the old polling server')
+    parser.add_argument('--program', default='.pio/build/native-sim/program')
+    parser.add_argument('--http-port', type=int, default=18080, help='kept off the default port, so a running simulation is not in the way')
+    parser.add_argument('--seconds', type=float, default=10, help='length of each measurement')
+    parser.add_argument('--clients', type=int, default=4, help='clients at once for the loaded measurement')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as nvs:
+        sim, base = start_sim(args.program, args.http_port, nvs)
+        try:
+            responses = {path: fetch(base + path) for path in ('/', '/config')}
+            deploy_payload = current_settings(base).encode()
+            responses['/deploy'] = (202, b'{"result":"queued","deploy":1}')
+
+            stand_in = PollingStandIn(responses)
+            stand_in.start()
+            while stand_in.tid is None:
+                time.sleep(0.01)
+
+            print('%-18s%13s%11s%12s%12s%12s%12s%13s%11s' % ('', 'idle CPU', 'wakeups', '1 p50', '1 p99', '%d p50' % args.clients,
+                                                          '%d p99' % args.clients, 'load CPU', 'wakeups'))
+            failed = report('polling stand-in', stand_in.base, os.getpid(), [stand_in.tid], args, deploy_payload)
+            stand_in.stopping = True
+            failed += report('async (native-sim)', base, sim.pid, named_threads(sim.pid, SIM_THREADS), args, deploy_payload)
+        finally:
+            stop_sim(sim)
+
+    if failed:
+        print('requests failed or were refused: %s' % sorted(failed, key=str))
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+# Fires concurrent web clients at the spectrum analyzer and checks that the frame loop is not disturbed by them:
+# the frame jitter histogram and the I2S overflow counter at /metrics are read before and after the load.
+#
+# usage: python3 web_load_test.py http://<ip> [--clients 16] [--seconds 30] [--deploy] [--max-jitter-us 1000]
+#        python3 web_load_test.py --sim [.pio/build/native-sim/program] [options]
+#
+# With --sim the host simulation of the firmware (pio run -e native-sim) is started with real time audio, loaded and stopped again. The
+# simulation runs the tasks of core 0 at a lower host priority than the frame loop, as they would not share a core with it on the board.
+#
+# Exits with 1 if the 99th percentile of the frame jitter during the load is above --max-jitter-us, or if audio blocks were dropped.
+# All clients come from this computer, so most requests are expected to be refused by the rate limit (429) or the connection cap (503).
+
+import argparse
+import json
+import os
+import re
+import signal
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import urllib.error
+import urllib.request
+
+PATHS = ['/', '/config', '/metrics', '/stream', '/latency', '/views', '/history']
+BUCKET = re.compile(r'^sad_frame_jitter_us_bucket\{le="([^"]+)"\} (\d+)$')
+COUNTER = re.compile(r'^(sad_[a-z0-9_]+) (\d+)$')
+SIM_WARMUP_SECONDS = 3  # the frame interval the jitter is measured against settles after start-up
+SIM_MAX_JITTER_US = 2500  # default bound with --sim: the p99 of the simulation idle on one host CPU (up to 2.5 ms, under 1 ms on the board)
+SIM_CLIENT_NICE = 19  # the clients run on another computer when a device is tested, so with --sim they are kept below the frame loop
+
+
+def fetch(url, data=None, timeout=10):
+    # a POST sends its data as a JSON body
+    headers = {'Content-Type': 'application/json'} if data is not None else {}
+    try:
+        with urllib.request.urlopen(urllib.request.Request(url, data=data, headers=headers, method='POST' if data is not None else 'GET'), timeout=timeout) as response:
+            return response.status, response.read()
+    except urllib.error.HTTPError as e:
+        return e.code, b''
+    except (urllib.error.URLError, OSError):
+        return None, b''
+
+
+def current_settings(base):
+    # a deploy payload of the settings the analyzer has, so deploying it changes nothing
+    status, body = fetch(base + '/config')
+    if status != 200:
+        sys.exit('unable to read /config')
+    config = json.loads(body)
+    return json.dumps({key: config[key] for key in ('peakDelay', 'peakSpeed', 'speedFilter', 'atten', 'brightness', 'peak', 'pixels', 'bands') if key in config})
+
+
+def scrape(base):
+    # retried, since the scrape itself can be refused while the load is running
+    for _ in range(20):
+        status, body = fetch(base + '/metrics')
+        if status == 200:
+            break
+        time.sleep(0.5)
+    else:
+        sys.exit('unable to read /metrics')
+
+    buckets, counters = [], {}
+    for line in body.decode().splitlines():
+        match = BUCKET.match(line)
+        if match:
+            buckets.append((float('inf') if match.group(1) == '+Inf' else float(match.group(1)), int(match.group(2))))
+            continue
+        match = COUNTER.match(line)
+        if match:
+            counters[match.group(1)] = int(match.group(2))
+    return buckets, counters
+
+
+def percentile_bound(before, after, fraction):
+    # upper bound of the bucket the percentile falls in, from the frames counted between the two scrapes
+    counts = [(bound, count - previous) for (bound, count), (_, previous) in zip(after, before)]
+    total = counts[-1][1] if counts else 0
+    for bound, count in counts:
+        if total and count >= fraction * total:
+            return bound, total
+    return float('inf'), total
+
+
+def client(base, deadline, deploy_payload, results, lock):
+    i = 0
+    while time.monotonic() < deadline:
+        if deploy_payload is not None and i % 5 == 0:
+            status, _ = fetch(base + '/deploy', data=deploy_payload.encode())
+        else:
+            status, _ = fetch(base + PATHS[i % len(PATHS)])
+        i += 1
+
+        with lock:
+            results[status] = results.get(status, 0) + 1
+        if status is None:
+            time.sleep(0.05)  # connection refused or reset: back off a little
+
+
+def start_sim(program, port, nvs):
+    # real time audio, so the frame loop runs at the pace it has on the board
+    command = [program, '--generator', 'sweep', '--nvs', nvs, '--serial', os.devnull, '--http-port', str(port)]
+    sim = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    base = 'http://127.0.0.1:%d' % port
+    for _ in range(100):
+        if sim.poll() is not None:
+            sys.exit('%s exited with code %d' % (program, sim.returncode))
+        if fetch(base + '/metrics', timeout=1)[0] == 200:
+            time.sleep(SIM_WARMUP_SECONDS)
+            return sim, base
+        time.sleep(0.1)
+    sim.kill()
+    sys.exit('%s did not serve %s' % (program, base))
+
+
+def stop_sim(sim):
+    sim.send_signal(signal.SIGINT)  # the simulation prints its report and ends
+    try:
+        sim.wait(timeout=10)
+    except subprocess.TimeoutExpired:
+        sim.kill()
+
+
+def run(args, base):
+    deploy_payload = current_settings(base) if args.deploy else None
+
+    before, counters_before = scrape(base)
+    started = time.monotonic()
+    results, lock = {}, threading.Lock()
+    deadline = time.monotonic() + args.seconds
+    threads = [threading.Thread(target=client, args=(base, deadline, deploy_payload, results, lock)) for _ in range(args.clients)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    after, counters_after = scrape(base)
+    elapsed = time.monotonic() - started
+
+    def delta(name):
+        return counters_after.get(name, 0) - counters_before.get(name, 0)
+
+    p99, frames = percentile_bound(before, after, 0.99)
+    overflows = delta('sad_i2s_rx_overflows_total')
+    statuses = '  '.join(f'{status or "error"}: {count}' for status, count in sorted(results.items(), key=lambda item: str(item[0])))
+
+    print(f'requests     {sum(results.values())} in {args.seconds:.0f} s from {args.clients} clients  ({statuses})')
+    print(f'frames       {frames}  ({delta("sad_frames_processed_total") / elapsed:.1f} per second)')
+    print(f'jitter p99   <= {p99:g} us  (bound {args.max_jitter_us:g} us)')
+    print(f'overflows    {overflows}')
+    print(f'web          rate limited {delta("sad_web_rate_limited_total")}  busy {delta("sad_web_busy_total")}  over budget {delta("sad_web_over_budget_total")}  shed {delta("sad_web_shed_total")}  longest handler {counters_after.get("sad_web_handler_max_us", 0)} us')
+
+    if frames == 0 or p99 > args.max_jitter_us or overflows > 0:
+        print('FAIL')
+        sys.exit(1)
+    print('PASS')
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('url', nargs='?', help='address of the analyzer, eg. http://sad.local')
+    parser.add_argument('--sim', nargs='?', const='.pio/build/native-sim/program', metavar='PROGRAM',
+                        help='start the host simulation of the firmware and load it instead of a device')
+    parser.add_argument('--http-port', type=int, default=18080, help='port of the simulation, kept off the default one')
+    parser.add_argument('--clients', type=int, default=16)
+    parser.add_argument('--seconds', type=float, default=30)
+    parser.add_argument('--deploy', action='store_true', help='also deploy the current settings again (they are not changed)')
+    parser.add_argument('--max-jitter-us', type=float, help='bound for the 99th percentile of the frame jitter (default 1000, %d with --sim)' % SIM_MAX_JITTER_US)
+    args = parser.parse_args()
+    if (args.url is None) == (args.sim is None):
+        parser.error('give the address of the analyzer or --sim')
+    if args.max_jitter_us is None:
+        args.max_jitter_us = 1000 if args.sim is None else SIM_MAX_JITTER_US
+
+    if args.sim is None:
+        run(args, args.url.rstrip('/'))
+        return
+    with tempfile.TemporaryDirectory() as nvs:
+        sim, base = start_sim(args.sim, args.http_port, nvs)
+        try:
+            os.nice(SIM_CLIENT_NICE)  # the client threads started from now on inherit it, the simulation does not
+            run(args, base)
+        finally:
+            stop_sim(sim)
+
+
+if __name__ == '__main__':
+    main()